@@ -45,9 +45,24 @@ namespace Falcor
         public:
             using SharedPtr = std::shared_ptr<ReadTextureTask>;
             static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+
+            /** Read a texture again, reusing the staging buffer. Used to recycle a set of tasks without allocating a staging buffer per read.
+                The staging buffer is only reallocated if the texture's size or format changed. The previous data must have been consumed.
+            */
+            void reissue(const Texture* pTexture, uint32_t subresourceIndex);
+
+            /** Check if the GPU finished the copy. If true, getData() will not block.
+            */
+            bool isReady() const;
+
             std::vector<uint8> getData();
+
+            /** Get the data into an existing vector. Doesn't reallocate if the vector already has the right size.
+            */
+            void getData(std::vector<uint8>& data);
         private:
             ReadTextureTask() = default;
+            void copy(const Texture* pTexture, uint32_t subresourceIndex);
             GpuFence::SharedPtr mpFence;
             Buffer::SharedPtr mpBuffer;
             CopyContext* mpContext;
@@ -84,6 +84,7 @@ namespace Falcor
         // Apply the vars. Must be first because applyComputeVars() might cause a flush        
         if (pVars)
         {
+            if (pState->getProgram()) pState->getProgram()->bindRuntimeDefines(pVars);
             if (applyComputeVars(pVars) == false) return false;
         }
         else mpLowLevelData->getCommandList()->SetComputeRootSignature(RootSignature::getEmpty()->getApiHandle());
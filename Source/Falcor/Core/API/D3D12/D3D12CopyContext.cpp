@@ -146,39 +146,62 @@ namespace Falcor
     {
         SharedPtr pThis = SharedPtr(new ReadTextureTask);
         pThis->mpContext = pCtx;
+        pThis->mpFence = GpuFence::create();
+        pThis->copy(pTexture, subresourceIndex);
+        return pThis;
+    }
+
+    void CopyContext::ReadTextureTask::reissue(const Texture* pTexture, uint32_t subresourceIndex)
+    {
+        copy(pTexture, subresourceIndex);
+    }
+
+    void CopyContext::ReadTextureTask::copy(const Texture* pTexture, uint32_t subresourceIndex)
+    {
         //Get footprint
         D3D12_RESOURCE_DESC texDesc = pTexture->getApiHandle()->GetDesc();
-        D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = pThis->mFootprint;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = mFootprint;
         uint64_t rowSize;
         uint64_t size;
         ID3D12Device* pDevice = gpDevice->getApiHandle();
-        pDevice->GetCopyableFootprints(&texDesc, subresourceIndex, 1, 0, &footprint, &pThis->mRowCount, &rowSize, &size);
+        pDevice->GetCopyableFootprints(&texDesc, subresourceIndex, 1, 0, &footprint, &mRowCount, &rowSize, &size);
+        mTextureFormat = pTexture->getFormat();
 
-        //Create buffer 
-        pThis->mpBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        // The buffer is only reallocated when the footprint size changed, so reissuing a task for a texture of the same size and format doesn't allocate
+        if (mpBuffer == nullptr || mpBuffer->getSize() != size)
+        {
+            mpBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        }
 
         //Copy from texture to buffer
         D3D12_TEXTURE_COPY_LOCATION srcLoc = { pTexture->getApiHandle(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, subresourceIndex };
-        D3D12_TEXTURE_COPY_LOCATION dstLoc = { pThis->mpBuffer->getApiHandle(), D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, footprint };
-        pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
-        pCtx->getLowLevelData()->getCommandList()->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+        D3D12_TEXTURE_COPY_LOCATION dstLoc = { mpBuffer->getApiHandle(), D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, mFootprint };
+        mpContext->resourceBarrier(pTexture, Resource::State::CopySource);
+        mpContext->getLowLevelData()->getCommandList()->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
 
-        // Create a fence and signal
-        pThis->mpFence = GpuFence::create();
-        pCtx->flush(false);
-        pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
-        pThis->mTextureFormat = pTexture->getFormat();
+        // Signal the fence
+        mpContext->flush(false);
+        mpFence->gpuSignal(mpContext->getLowLevelData()->getCommandQueue());
+    }
 
-        return pThis;
+    bool CopyContext::ReadTextureTask::isReady() const
+    {
+        return mpFence->getGpuValue() >= mpFence->getCpuValue() - 1;
     }
 
     std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
+    {
+        std::vector<uint8> result;
+        getData(result);
+        return result;
+    }
+
+    void CopyContext::ReadTextureTask::getData(std::vector<uint8>& result)
     {
         mpFence->syncCpu();
         D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = mFootprint;
 
         //Get buffer data
-        std::vector<uint8> result;
         uint32_t actualRowSize = footprint.Footprint.Width * getFormatBytesPerBlock(mTextureFormat);
         result.resize(mRowCount * actualRowSize);
         uint8* pData = reinterpret_cast<uint8*>(mpBuffer->map(Buffer::MapType::Read));
@@ -196,7 +219,6 @@ namespace Falcor
         }
 
         mpBuffer->unmap();
-        return result;
     }
 
     static void d3d12ResourceBarrier(const Resource* pResource, Resource::State newState, Resource::State oldState, uint32_t subresourceIndex, ID3D12GraphicsCommandList* pCmdList)
@@ -241,7 +263,8 @@ namespace Falcor
     bool CopyContext::textureBarrier(const Texture* pTexture, Resource::State newState)
     {
         bool recorded = d3d12GlobalResourceBarrier(pTexture, newState, mpLowLevelData->getCommandList());
-        pTexture->setGlobalState(newState);
+        // Only write the state when it changes, so concurrent no-op barriers on a shared resource don't race
+        if (recorded) pTexture->setGlobalState(newState);
         mCommandsPending = mCommandsPending || recorded;
         return recorded;
     }
@@ -250,7 +273,7 @@ namespace Falcor
     {
         if (pBuffer && pBuffer->getCpuAccess() != Buffer::CpuAccess::None) return false;
         bool recorded = d3d12GlobalResourceBarrier(pBuffer, newState, mpLowLevelData->getCommandList());
-        pBuffer->setGlobalState(newState);
+        if (recorded) pBuffer->setGlobalState(newState);
         mCommandsPending = mCommandsPending || recorded;
         return recorded;
     }
@@ -80,34 +80,38 @@ namespace Falcor
 
     D3D12DescriptorHeap::Allocation::SharedPtr D3D12DescriptorHeap::allocateDescriptors(uint32_t count)
     {
-        if (setupCurrentChunk(count) == false) return nullptr;
+        std::lock_guard<std::mutex> lock(mMutex);
+        uint32_t slot = Threading::getCurrentThreadSlot();
+        if (slot >= mCurrentChunks.size()) mCurrentChunks.resize(slot + 1);
+        Chunk::SharedPtr& pCurrentChunk = mCurrentChunks[slot];
+        if (setupCurrentChunk(pCurrentChunk, count) == false) return nullptr;
 
-        if (mpCurrentChunk->chunkCount * kDescPerChunk - mpCurrentChunk->currentDesc < count)
+        if (pCurrentChunk->chunkCount * kDescPerChunk - pCurrentChunk->currentDesc < count)
         {
             return nullptr;
         }
 
-        Allocation::SharedPtr pAlloc = Allocation::create(shared_from_this(), mpCurrentChunk->getCurrentAbsoluteIndex(), count, mpCurrentChunk);
+        Allocation::SharedPtr pAlloc = Allocation::create(shared_from_this(), pCurrentChunk->getCurrentAbsoluteIndex(), count, pCurrentChunk);
 
         // Update the chunk
-        mpCurrentChunk->allocCount++;
-        mpCurrentChunk->currentDesc += count;
+        pCurrentChunk->allocCount++;
+        pCurrentChunk->currentDesc += count;
         return pAlloc;
     }
 
-    bool D3D12DescriptorHeap::setupCurrentChunk(uint32_t descCount)
+    bool D3D12DescriptorHeap::setupCurrentChunk(Chunk::SharedPtr& pCurrentChunk, uint32_t descCount)
     {
-        if (mpCurrentChunk)
+        if (pCurrentChunk)
         {
             // Check if the current chunk has enough space
-            if (mpCurrentChunk->getRemainingDescs() >= descCount) return true;
+            if (pCurrentChunk->getRemainingDescs() >= descCount) return true;
 
-            if (mpCurrentChunk->allocCount == 0)
+            if (pCurrentChunk->allocCount == 0)
             {
                 // Chunk is empty, doesn't necessarily mean it has enough space, need to check
-                if (mpCurrentChunk->chunkCount * kDescPerChunk >= descCount)
+                if (pCurrentChunk->chunkCount * kDescPerChunk >= descCount)
                 {
-                    mpCurrentChunk->reset();
+                    pCurrentChunk->reset();
                     return true;
                 }
             }
@@ -115,12 +119,12 @@ namespace Falcor
 
         // Need a new chunk
         uint32_t chunkCount = (descCount + kDescPerChunk - 1) / kDescPerChunk;
+        Chunk::SharedPtr pNewChunk;
 
         if (chunkCount == 1 && mFreeChunks.empty() == false)
         {
-            mpCurrentChunk = mFreeChunks.back();
+            pNewChunk = mFreeChunks.back();
             mFreeChunks.pop_back();
-            return true;
         }
         else if (chunkCount > 1 && mFreeLargeChunks.empty() == false)
         {
@@ -128,27 +132,54 @@ namespace Falcor
             auto it = std::lower_bound(mFreeLargeChunks.begin(), mFreeLargeChunks.end(), chunkCount, ChunkComparator());
             if (it != mFreeLargeChunks.end())
             {
-                mpCurrentChunk = *it;
+                pNewChunk = *it;
                 mFreeLargeChunks.erase(it);
-                return true;
             }
         }
 
-        // No free chunks. Allocate
-        if (mAllocatedChunks + chunkCount > mMaxChunkCount)
+        if (pNewChunk == nullptr)
         {
-            return false;
+            // No free chunks. Allocate
+            if (mAllocatedChunks + chunkCount > mMaxChunkCount)
+            {
+                return false;
+            }
+
+            pNewChunk = Chunk::SharedPtr(new Chunk(mAllocatedChunks, chunkCount));
+            mAllocatedChunks += chunkCount;
         }
 
-        mpCurrentChunk = Chunk::SharedPtr(new Chunk(mAllocatedChunks, chunkCount));
-        mAllocatedChunks += chunkCount;
+        retireChunk(pCurrentChunk);
+        pCurrentChunk = pNewChunk;
+        pCurrentChunk->isCurrent = true;
         return true;
     }
     
+    void D3D12DescriptorHeap::retireChunk(Chunk::SharedPtr& pChunk)
+    {
+        if (!pChunk) return;
+
+        pChunk->isCurrent = false;
+        if (pChunk->allocCount == 0)
+        {
+            pChunk->reset();
+            if (pChunk->chunkCount == 1) mFreeChunks.push_back(pChunk);
+            else mFreeLargeChunks.insert(pChunk);
+        }
+        pChunk = nullptr;
+    }
+
+    void D3D12DescriptorHeap::retireWorkerChunks()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (size_t slot = 1; slot < mCurrentChunks.size(); slot++) retireChunk(mCurrentChunks[slot]);
+    }
+
     void D3D12DescriptorHeap::releaseChunk(Chunk::SharedPtr pChunk)
     {
+        std::lock_guard<std::mutex> lock(mMutex);
         pChunk->allocCount--;
-        if (pChunk->allocCount == 0 && (pChunk != mpCurrentChunk))
+        if (pChunk->allocCount == 0 && (pChunk->isCurrent == false))
         {
             pChunk->reset();
             if(pChunk->chunkCount == 1) mFreeChunks.push_back(pChunk);
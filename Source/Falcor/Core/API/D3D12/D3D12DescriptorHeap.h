@@ -27,9 +27,13 @@
 ***************************************************************************/
 #pragma once
 #include <queue>
+#include <mutex>
 
 namespace Falcor
 {
+    /** Chunked descriptor heap. Allocation is thread-safe, and every thread pool worker sub-allocates from its own current chunk.
+        Threads outside the pool share one current chunk. The workers' chunks are retired by retireWorkerChunks(), once per frame.
+    */
     class D3D12DescriptorHeap : public std::enable_shared_from_this<D3D12DescriptorHeap>
     {
     public:
@@ -73,6 +77,10 @@ namespace Falcor
         const ApiHandle& getApiHandle() const { return mApiHandle; }
         D3D12_DESCRIPTOR_HEAP_TYPE getType() const { return mType; }
 
+        /** Retire the current chunks of the thread pool workers. Called from DescriptorPool::executeDeferredReleases()
+        */
+        void retireWorkerChunks();
+
         uint32_t getReservedChunkCount() const { return mMaxChunkCount; }
         uint32_t getDescriptorSize() const { return mDescriptorSize; }
     private:
@@ -90,6 +98,7 @@ namespace Falcor
         uint32_t mAllocatedChunks = 0;
         ApiHandle mApiHandle;
         D3D12_DESCRIPTOR_HEAP_TYPE mType;
+        std::mutex mMutex;
 
         struct Chunk
         {
@@ -105,6 +114,7 @@ namespace Falcor
             uint32_t chunkCount = 1; // For outstanding requests we can allocate more then a single chunk. This is the number of chunks we actually allocated
             uint32_t allocCount = 0;
             uint32_t currentDesc = 0;
+            bool isCurrent = false; // True while the chunk is the current chunk of one of the allocating threads
         };
 
         // Helper to compare Chunk::SharedPtr types
@@ -121,10 +131,11 @@ namespace Falcor
             };
         };
 
-        bool setupCurrentChunk(uint32_t descCount);
+        bool setupCurrentChunk(Chunk::SharedPtr& pCurrentChunk, uint32_t descCount);
         void releaseChunk(Chunk::SharedPtr pChunk);
+        void retireChunk(Chunk::SharedPtr& pChunk);
 
-        Chunk::SharedPtr mpCurrentChunk;
+        std::vector<Chunk::SharedPtr> mCurrentChunks; // The current chunk of each thread slot. See Threading::getCurrentThreadSlot()
         std::vector<Chunk::SharedPtr> mFreeChunks; // Free list for standard sized chunks (1 chunk * kDescPerChunk)
         std::multiset<Chunk::SharedPtr, ChunkComparator> mFreeLargeChunks; // Free list for large chunks with the capacity of multiple chunks (>1 chunk * kDescPerChunk)
     };
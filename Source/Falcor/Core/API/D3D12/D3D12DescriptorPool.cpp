@@ -82,6 +82,14 @@ namespace Falcor
         return true;
     }
 
+    void DescriptorPool::apiExecuteDeferredReleases()
+    {
+        for (auto& pHeap : mpApiData->pHeaps)
+        {
+            if (pHeap) pHeap->retireWorkerChunks();
+        }
+    }
+
     const DescriptorPool::ApiHandle& DescriptorPool::getApiHandle(uint32_t heapIndex) const
     {
         assert(heapIndex < arraysize(mpApiData->pHeaps));
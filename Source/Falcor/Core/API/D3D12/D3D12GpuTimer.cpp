@@ -27,6 +27,7 @@
 ***************************************************************************/
 #include "stdafx.h"
 #include "Core/API/GpuTimer.h"
+#include "Core/API/Device.h"
 
 namespace Falcor
 {
@@ -48,4 +49,19 @@ namespace Falcor
         result[1] = pRes[1];
         mpResolveBuffer->unmap();
     }
+
+    bool GpuTimer::getClockCalibration(uint64_t& gpuTimestamp, CpuTimer::TimePoint& cpuTime)
+    {
+        uint64_t cpuTimestamp;
+        const CommandQueueHandle& pQueue = gpDevice->getRenderContext()->getLowLevelData()->getCommandQueue();
+        if (FAILED(pQueue->GetClockCalibration(&gpuTimestamp, &cpuTimestamp))) return false;
+
+        // The CPU timestamp is a QueryPerformanceCounter() value. CpuTimer uses std::chrono::high_resolution_clock, which is also based on QueryPerformanceCounter(). Convert the same way the STL does, to avoid overflows
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        const uint64_t kNanoPerSec = 1000000000;
+        uint64_t ns = (cpuTimestamp / freq.QuadPart) * kNanoPerSec + (cpuTimestamp % freq.QuadPart) * kNanoPerSec / freq.QuadPart;
+        cpuTime = CpuTimer::TimePoint(std::chrono::duration_cast<CpuTimer::TimePoint::duration>(std::chrono::nanoseconds(ns)));
+        return true;
+    }
 }
@@ -299,6 +299,7 @@ namespace Falcor
             // Apply the vars. Must be first because applyGraphicsVars() might cause a flush
             if (pVars)
             {
+                if (pState->getProgram()) pState->getProgram()->bindRuntimeDefines(pVars);
                 if (applyGraphicsVars(pVars) == false) return false;
             }
             else mpLowLevelData->getCommandList()->SetGraphicsRootSignature(RootSignature::getEmpty()->getApiHandle());
@@ -42,11 +42,13 @@ namespace Falcor
 
     void DescriptorPool::executeDeferredReleases()
     {
+        std::lock_guard<std::mutex> lock(mMutex);
         uint64_t gpuVal = mpFence->getGpuValue();
         while (mpDeferredReleases.size() && mpDeferredReleases.top().fenceValue <= gpuVal)
         {
             mpDeferredReleases.pop();
         }
+        apiExecuteDeferredReleases();
     }
 
     void DescriptorPool::releaseAllocation(std::shared_ptr<DescriptorSetApiData> pData)
@@ -54,6 +56,7 @@ namespace Falcor
         DeferredRelease d;
         d.pData = pData;
         d.fenceValue = mpFence->getCpuValue();
+        std::lock_guard<std::mutex> lock(mMutex);
         mpDeferredReleases.push(d);
     }
 }
@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include <queue>
+#include <mutex>
 
 namespace Falcor
 {
@@ -97,10 +98,12 @@ namespace Falcor
         friend DescriptorSet;
         DescriptorPool(const Desc& desc, const GpuFence::SharedPtr & pFence);
         bool apiInit();
+        void apiExecuteDeferredReleases();
         void releaseAllocation(std::shared_ptr<DescriptorSetApiData> pData);
         Desc mDesc;
         std::shared_ptr<ApiData> mpApiData;
         GpuFence::SharedPtr mpFence;
+        std::mutex mMutex; // Guards the deferred release queue. Descriptor sets are created and destroyed from multiple threads when recording in parallel
 
         struct DeferredRelease
         {
@@ -38,33 +38,61 @@ namespace Falcor
 
     GpuMemoryHeap::SharedPtr GpuMemoryHeap::create(Type type, size_t pageSize, const GpuFence::SharedPtr& pFence)
     {
-        SharedPtr pAllocator = SharedPtr(new GpuMemoryHeap(type, pageSize, pFence));
-        pAllocator->allocateNewPage();
-        return pAllocator;
+        return SharedPtr(new GpuMemoryHeap(type, pageSize, pFence));
     }
 
-    void GpuMemoryHeap::allocateNewPage()
+    GpuMemoryHeap::PageData* GpuMemoryHeap::getActivePage(size_t& pageId)
     {
-        if (mpActivePage)
+        uint32_t slot = Threading::getCurrentThreadSlot();
+        if (slot >= mActivePages.size() || mActivePages[slot] == 0) return allocateNewPage(pageId);
+
+        pageId = mActivePages[slot];
+        return mUsedPages[pageId].get();
+    }
+
+    void GpuMemoryHeap::retireActivePage(uint32_t slot)
+    {
+        if (slot >= mActivePages.size() || mActivePages[slot] == 0) return;
+
+        size_t pageId = mActivePages[slot];
+        mActivePages[slot] = 0;
+        auto& pOldPage = mUsedPages[pageId];
+        pOldPage->isActive = false;
+        if (pOldPage->allocationsCount == 0)
         {
-            mUsedPages[mCurrentPageId] = std::move(mpActivePage);
+            mAvailablePages.push(std::move(pOldPage));
+            mUsedPages.erase(pageId);
         }
+    }
+
+    GpuMemoryHeap::PageData* GpuMemoryHeap::allocateNewPage(size_t& pageId)
+    {
+        // Retire the current page of this thread
+        uint32_t slot = Threading::getCurrentThreadSlot();
+        retireActivePage(slot);
 
+        PageData::UniquePtr pPage;
         if (mAvailablePages.size())
         {
-            mpActivePage = std::move(mAvailablePages.front());
+            pPage = std::move(mAvailablePages.front());
             mAvailablePages.pop();
-            mpActivePage->allocationsCount = 0;
-            mpActivePage->currentOffset = 0;
+            pPage->allocationsCount = 0;
         }
         else
         {
-            mpActivePage = std::make_unique<PageData>();
-            initBasePageData((*mpActivePage), mPageSize);
+            pPage = std::make_unique<PageData>();
+            initBasePageData((*pPage), mPageSize);
         }
 
-        mpActivePage->currentOffset = 0;
-        mCurrentPageId++;
+        pPage->currentOffset = 0;
+        pPage->isActive = true;
+        pageId = ++mCurrentPageId;
+        if (slot >= mActivePages.size()) mActivePages.resize(slot + 1, 0);
+        mActivePages[slot] = pageId;
+
+        PageData* pData = pPage.get();
+        mUsedPages[pageId] = std::move(pPage);
+        return pData;
     }
 
     GpuMemoryHeap::Allocation GpuMemoryHeap::allocate(size_t size, size_t alignment)
@@ -77,20 +105,24 @@ namespace Falcor
         }
         else
         {
+            std::lock_guard<std::mutex> lock(mMutex);
+            size_t pageId;
+            PageData* pPage = getActivePage(pageId);
+
             // Calculate the start
-            size_t currentOffset = align_to(alignment, mpActivePage->currentOffset);
+            size_t currentOffset = align_to(alignment, pPage->currentOffset);
             if (currentOffset + size > mPageSize)
             {
                 currentOffset = 0;
-                allocateNewPage();
+                pPage = allocateNewPage(pageId);
             }
 
-            data.pageID = mCurrentPageId;
+            data.pageID = pageId;
             data.offset = currentOffset;
-            data.pData = mpActivePage->pData + currentOffset;
-            data.pResourceHandle = mpActivePage->pResourceHandle;
-            mpActivePage->currentOffset = currentOffset + size;
-            mpActivePage->allocationsCount++;
+            data.pData = pPage->pData + currentOffset;
+            data.pResourceHandle = pPage->pResourceHandle;
+            pPage->currentOffset = currentOffset + size;
+            pPage->allocationsCount++;
         }
 
         data.fenceValue = mpFence->getCpuValue();
@@ -100,38 +132,39 @@ namespace Falcor
     void GpuMemoryHeap::release(Allocation& data)
     {
         assert(data.pResourceHandle);
+        std::lock_guard<std::mutex> lock(mMutex);
         mDeferredReleases.push(data);
     }
 
     void GpuMemoryHeap::executeDeferredReleases()
     {
+        std::lock_guard<std::mutex> lock(mMutex);
         uint64_t gpuVal = mpFence->getGpuValue();
         while (mDeferredReleases.size() && mDeferredReleases.top().fenceValue <= gpuVal)
         {
             const Allocation& data = mDeferredReleases.top();
-            if (data.pageID == mCurrentPageId)
-            {
-                mpActivePage->allocationsCount--;
-                if (mpActivePage->allocationsCount == 0)
-                {
-                    mpActivePage->currentOffset = 0;
-                }
-            }
-            else
+            if (data.pageID != Allocation::kMegaPageId)
             {
-                if (data.pageID != Allocation::kMegaPageId)
+                auto& pData = mUsedPages[data.pageID];
+                pData->allocationsCount--;
+                if (pData->allocationsCount == 0)
                 {
-                    auto& pData = mUsedPages[data.pageID];
-                    pData->allocationsCount--;
-                    if (pData->allocationsCount == 0)
+                    if (pData->isActive)
+                    {
+                        pData->currentOffset = 0;
+                    }
+                    else
                     {
                         mAvailablePages.push(std::move(pData));
                         mUsedPages.erase(data.pageID);
                     }
                 }
-                // else it's a mega-page. Popping it will release the resource
             }
+            // else it's a mega-page. Popping it will release the resource
             mDeferredReleases.pop();
         }
+
+        // Hand the pool workers' pages back, so a page doesn't stay allocated for a worker that stopped recording
+        for (uint32_t slot = 1; slot < (uint32_t)mActivePages.size(); slot++) retireActivePage(slot);
     }
 }
@@ -27,10 +27,15 @@
 ***************************************************************************/
 #pragma once
 #include <queue>
+#include <mutex>
 #include "Core/API/GpuFence.h"
 
 namespace Falcor
-{   
+{
+    /** Linear sub-allocator for transient GPU memory.
+        The heap is thread-safe. Every thread pool worker allocates from its own active page, so allocations made while recording different command lists in parallel don't interleave.
+        Threads outside the pool share one active page. The workers' pages are retired in executeDeferredReleases(), once per frame.
+    */
     class dlldecl GpuMemoryHeap
     {
     public:
@@ -73,6 +78,7 @@ namespace Falcor
         {
             uint32_t allocationsCount = 0;
             size_t currentOffset = 0;
+            bool isActive = false;      // True while the page is the active page of one of the allocating threads
 
             using UniquePtr = std::unique_ptr<PageData>;
         };
@@ -81,13 +87,16 @@ namespace Falcor
         GpuFence::SharedPtr mpFence;
         size_t mPageSize = 0;
         size_t mCurrentPageId = 0;
-        PageData::UniquePtr mpActivePage;
+        std::mutex mMutex;
 
         std::priority_queue<Allocation> mDeferredReleases;
-        std::unordered_map<size_t, PageData::UniquePtr> mUsedPages;
+        std::unordered_map<size_t, PageData::UniquePtr> mUsedPages;                 // All pages with live allocations, including the active pages
+        std::vector<size_t> mActivePages;                                            // The active page ID of each thread slot, 0 if none. See Threading::getCurrentThreadSlot()
         std::queue<PageData::UniquePtr> mAvailablePages;
 
-        void allocateNewPage();
+        PageData* getActivePage(size_t& pageId);
+        PageData* allocateNewPage(size_t& pageId);
+        void retireActivePage(uint32_t slot);
         void initBasePageData(BaseData& data, size_t size);
     };
 }
@@ -98,6 +98,8 @@ namespace Falcor
         {
             uint64_t result[2];
             apiResolve(result);
+            mStartTicks = result[0];
+            mEndTicks = result[1];
 
             double start = (double)result[0];
             double end = (double)result[1];
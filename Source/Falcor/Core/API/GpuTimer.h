@@ -28,6 +28,7 @@
 #pragma once
 #include "Core/API/LowLevelContextData.h"
 #include "Core/API/Buffer.h"
+#include "Utils/Timing/CpuTimer.h"
 
 namespace Falcor
 { 
@@ -63,6 +64,17 @@ namespace Falcor
         */
         double getElapsedTime();
 
+        /** Get the raw GPU timestamps of the last Begin()/End() pair, in ticks. Only valid after getElapsedTime() was called.
+            Use Device#getGpuTimestampFrequency() to convert ticks to milliseconds.
+        */
+        void getTimestamps(uint64_t& start, uint64_t& end) const { start = mStartTicks; end = mEndTicks; }
+
+        /** Sample the GPU timestamp counter and the CPU clock at the same moment.
+            Used to map GPU timestamps onto the CPU timeline.
+            \return false if the API doesn't support clock calibration.
+        */
+        static bool getClockCalibration(uint64_t& gpuTimestamp, CpuTimer::TimePoint& cpuTime);
+
     private:
         GpuTimer();
         enum Status
@@ -77,6 +89,8 @@ namespace Falcor
         uint32_t mStart;
         uint32_t mEnd;
         double mElapsedTime;
+        uint64_t mStartTicks = 0;
+        uint64_t mEndTicks = 0;
         void apiBegin();
         void apiEnd();
         void apiResolve(uint64_t result[2]);
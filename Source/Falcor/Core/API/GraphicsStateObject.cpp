@@ -76,6 +76,39 @@ namespace Falcor
         return b;
     }
 
+    size_t GraphicsStateObject::Desc::getHash() const
+    {
+        // FNV-1a over the content of the desc. State objects are hashed by pointer, like operator==() compares them
+        uint64_t hash = 0xcbf29ce484222325ull;
+        auto update = [&hash](uint64_t value)
+        {
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                hash = (hash ^ (value & 0xff)) * 0x100000001b3ull;
+                value >>= 8;
+            }
+        };
+
+        // A null state and the default state are equal
+        auto statePtr = [](const void* pState, const void* pDefault) { return (uint64_t)(pState == pDefault ? nullptr : pState); };
+
+        for (uint32_t i = 0; i < Fbo::getMaxColorTargetCount(); i++)
+        {
+            update((uint64_t)mFboDesc.getColorTargetFormat(i) | ((uint64_t)mFboDesc.isColorTargetUav(i) << 32));
+        }
+        update((uint64_t)mFboDesc.getDepthStencilFormat() | ((uint64_t)mFboDesc.isDepthStencilUav() << 32));
+        update(mFboDesc.getSampleCount());
+        update((uint64_t)mpLayout.get());
+        update((uint64_t)mpProgram.get());
+        update((uint64_t)mpRootSignature.get());
+        update(mSampleMask);
+        update((uint64_t)mPrimType | ((uint64_t)mSinglePassStereoEnabled << 32));
+        update(statePtr(mpRasterizerState.get(), spDefaultRasterizerState.get()));
+        update(statePtr(mpBlendState.get(), spDefaultBlendState.get()));
+        update(statePtr(mpDepthStencilState.get(), spDefaultDepthStencilState.get()));
+        return (size_t)hash;
+    }
+
     GraphicsStateObject::~GraphicsStateObject()
     {
         gpDevice->releaseResource(mApiHandle);
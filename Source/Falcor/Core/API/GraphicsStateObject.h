@@ -87,6 +87,10 @@ namespace Falcor
 
             bool operator==(const Desc& other) const;
 
+            /** Get a hash of the desc. Descs which compare equal have the same hash
+            */
+            size_t getHash() const;
+
         private:
             friend class GraphicsStateObject;
             Fbo::Desc mFboDesc;
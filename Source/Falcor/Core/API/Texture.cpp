@@ -29,7 +29,7 @@
 #include "Texture.h"
 #include "Device.h"
 #include "RenderContext.h"
-#include "Utils/Threading.h"
+#include "Utils/Image/AsyncImageWriter.h"
 
 namespace Falcor
 {
@@ -237,28 +237,16 @@ namespace Falcor
         // Handle the special case where we have an HDR texture with less then 3 channels
         FormatType type = getFormatType(mFormat);
         uint32_t channels = getFormatChannelCount(mFormat);
-        std::vector<uint8> textureData;
-        ResourceFormat resourceFormat = mFormat;
-
         if (type == FormatType::Float && channels < 3)
         {
             Texture::SharedPtr pOther = Texture::create2D(getWidth(mipLevel), getHeight(mipLevel), ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource);
             pContext->blit(getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
-            textureData = pContext->readTextureSubresource(pOther.get(), 0);
-            resourceFormat = ResourceFormat::RGBA32Float;
+            AsyncImageWriter::write(pOther.get(), 0, 0, filename, format, exportFlags);
         }
         else
         {
-            uint32_t subresource = getSubresourceIndex(arraySlice, mipLevel);
-            textureData = pContext->readTextureSubresource(this, subresource);
+            AsyncImageWriter::write(this, mipLevel, arraySlice, filename, format, exportFlags);
         }
-
-        auto func = [=]()
-        {
-            Bitmap::saveImage(filename, getWidth(mipLevel), getHeight(mipLevel), format, exportFlags, resourceFormat, true, (void*)textureData.data());
-        };
-
-        Threading::dispatchTask(func);
     }
 
     void Texture::uploadInitData(const void* pData, bool autoGenMips)
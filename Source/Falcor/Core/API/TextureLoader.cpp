@@ -28,7 +28,8 @@
 #include "stdafx.h"
 #include "Core/API/Texture.h"
 #include "Utils/Image/DDSHeader.h"
-#include "Utils/BinaryFileStream.h"
+#include "Utils/Image/MipGenerator.h"
+#include "Utils/Image/StreamingImageLoader.h"
 #include "Utils/StringUtils.h"
 #include <cstring>
 
@@ -492,89 +493,63 @@ namespace Falcor
         }
     }
 
-    //Flip the data so it follows opengl conventions
-    void flipData(DdsData& ddsData, ResourceFormat format, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipDepth, bool isCubemap = false)
-    {
-        if (!isCompressedFormat(format) && !kTopDown)
-        {
-            std::vector<uint8_t> oldData(ddsData.data.size());
-            oldData.swap(ddsData.data);
-            const uint8_t* currentTexture = oldData.data();
-            const uint8_t* currentDepth = oldData.data();
-            uint8_t* currentPos = ddsData.data.data();
-
-            for (uint32_t mipCounter = 0; mipCounter < mipDepth; ++mipCounter)
-            {
-                uint32_t heightPitch = max(width >> mipCounter, 1U) * getFormatBytesPerBlock(format);
-                uint32_t currentMipHeight = max(height >> mipCounter, 1U);
-                uint32_t depthPitch = currentMipHeight * heightPitch;    
-
-                for (uint32_t depthCounter = 0; depthCounter < depth; ++depthCounter)
-                {
-                    currentTexture = currentDepth + depthPitch * depthCounter;
-                    
-                    if (isCubemap)
-                    {
-                        if (depthCounter % 6 == 2)
-                        {
-                            currentTexture += depthPitch;
-                        }
-                        else if (depthCounter % 6 == 3)
-                        {
-                            currentTexture -= depthPitch;
-                        }
-                    }
-                    
-                    for (uint32_t heightCounter = 1; heightCounter <= currentMipHeight; ++heightCounter)
-                    {
-                        std::memcpy(currentPos, currentTexture + (currentMipHeight - heightCounter) * heightPitch, heightPitch);
-                        currentPos += heightPitch;
-                    }
-                    
-                }
-
-                currentDepth += depthPitch * depth;
-            }
-        }
-    }
+    // DDS rows are stored top-down. The texel data is uploaded straight from the file mapping, which relies on textures being top-down as well.
+    static_assert(kTopDown, "DDS loading doesn't flip rows");
 
-    void loadDDSDataFromFile(const std::string filename, DdsData& ddsData)
+    bool loadDDSDataFromFile(const std::string filename, DdsData& ddsData)
     {
         std::string fullpath;
         if (findFileInDataDirectories(filename, fullpath) == false)
         {
             msgBox("Error when loading DDS file. Can't find texture file " + filename);
             //could not find file
-            return;
+            return false;
         }
 
-        BinaryFileStream stream(fullpath, BinaryFileStream::Mode::Read);
+        size_t fileSize;
+        const uint8_t* pFile = (const uint8_t*)mapFile(fullpath, fileSize);
+        if (!pFile)
+        {
+            logError("Can't read the dds file " + filename);
+            return false;
+        }
+        ddsData.pStorage = std::shared_ptr<const void>(pFile, [fileSize](const void* pData) { unmapFile(pData, fileSize); });
+
+        size_t offset = 0;
+        auto readStruct = [&](auto& val)
+        {
+            if (offset + sizeof(val) > fileSize) return false;
+            std::memcpy(&val, pFile + offset, sizeof(val));
+            offset += sizeof(val);
+            return true;
+        };
 
         //check the dds identifier
         uint32_t ddsIdentifier;
-        stream >> ddsIdentifier;
-        if (ddsIdentifier != kDdsMagicNumber)
+        if (!readStruct(ddsIdentifier) || ddsIdentifier != kDdsMagicNumber || !readStruct(ddsData.header))
         {
             //not valid dds file apparently
             logError(std::string("The dds file ") + filename + std::string(" is not a valid dds file"));
-            return;
+            return false;
         }
 
-        stream >> ddsData.header;
-
         if((ddsData.header.pixelFormat.flags & DdsHeader::PixelFormat::kFourCCFlag) && (makeFourCC("DX10") == ddsData.header.pixelFormat.fourCC))
         {
             ddsData.hasDX10Header = true;
-            stream >> ddsData.dx10Header;
+            if (!readStruct(ddsData.dx10Header))
+            {
+                logError(std::string("The dds file ") + filename + std::string(" is not a valid dds file"));
+                return false;
+            }
         }
         else
         {
             ddsData.hasDX10Header = false;
         }
 
-        uint32_t dataSize = stream.getRemainingStreamSize();
-        ddsData.data.resize(dataSize);
-        stream.read(ddsData.data.data(), dataSize);
+        ddsData.pData = pFile + offset;
+        ddsData.dataSize = fileSize - offset;
+        return true;
     }
 
     static ResourceFormat convertBgrxFormatToBgra(DdsData& ddsData, ResourceFormat format)
@@ -592,10 +567,14 @@ namespace Falcor
             return format;
         }
 
-        for (size_t i = 3; i < ddsData.data.size(); i+=4)
+        // The file mapping is read-only, patch a copy
+        auto pData = std::make_shared<std::vector<uint8_t>>(ddsData.pData, ddsData.pData + ddsData.dataSize);
+        for (size_t i = 3; i < pData->size(); i+=4)
         {
-            ddsData.data[i] = 0xFF;
+            (*pData)[i] = 0xFF;
         }
+        ddsData.pData = pData->data();
+        ddsData.pStorage = pData;
 #endif
         return format;
     }
@@ -610,21 +589,18 @@ namespace Falcor
         switch(ddsData.dx10Header.resourceDimension)
         {
         case DXResourceDimension::RESOURCE_DIMENSION_TEXTURE1D:
-            return Texture::create1D(ddsData.header.width, format, arraySize, mipLevels, ddsData.data.data(), bindFlags);
+            return Texture::create1D(ddsData.header.width, format, arraySize, mipLevels, ddsData.pData, bindFlags);
         case DXResourceDimension::RESOURCE_DIMENSION_TEXTURE2D:
             if(ddsData.dx10Header.miscFlag & DdsHeaderDX10::kCubeMapMask)
             {
-                flipData(ddsData, format, ddsData.header.width, ddsData.header.height, 6 * arraySize, mipLevels == Texture::kMaxPossible ? 1 : mipLevels, true);
-                return Texture::createCube(ddsData.header.width, ddsData.header.height, format, arraySize, mipLevels, ddsData.data.data(), bindFlags);
+                return Texture::createCube(ddsData.header.width, ddsData.header.height, format, arraySize, mipLevels, ddsData.pData, bindFlags);
             }
             else
             {
-                flipData(ddsData, format, ddsData.header.width, ddsData.header.height, arraySize, mipLevels == Texture::kMaxPossible ? 1 : mipLevels);
-                return Texture::create2D(ddsData.header.width, ddsData.header.height, format, arraySize, mipLevels, ddsData.data.data(), bindFlags);
+                return Texture::create2D(ddsData.header.width, ddsData.header.height, format, arraySize, mipLevels, ddsData.pData, bindFlags);
             }
         case DXResourceDimension::RESOURCE_DIMENSION_TEXTURE3D:
-            flipData(ddsData, format, ddsData.header.width, ddsData.header.height, ddsData.header.depth, mipLevels == Texture::kMaxPossible ? 1 : mipLevels);
-            return Texture::create3D(ddsData.header.width, ddsData.header.height, ddsData.header.depth, format, mipLevels, ddsData.data.data(), bindFlags);
+            return Texture::create3D(ddsData.header.width, ddsData.header.height, ddsData.header.depth, format, mipLevels, ddsData.pData, bindFlags);
         case DXResourceDimension::RESOURCE_DIMENSION_BUFFER:
         case DXResourceDimension::RESOURCE_DIMENSION_UNKNOWN:
             //these file formats are not supported 
@@ -642,29 +618,97 @@ namespace Falcor
         //load the volume or 3D texture
         if(ddsData.header.flags & DdsHeader::kDepthMask)
         {
-            flipData(ddsData, format, ddsData.header.width, ddsData.header.height, ddsData.header.depth, mipLevels == Texture::kMaxPossible ? 1 : mipLevels);
-            return Texture::create3D(ddsData.header.width, ddsData.header.height, ddsData.header.depth, format, mipLevels, ddsData.data.data(), bindFlags);
+            return Texture::create3D(ddsData.header.width, ddsData.header.height, ddsData.header.depth, format, mipLevels, ddsData.pData, bindFlags);
         }
         //load the cubemap texture
         else if(ddsData.header.caps[1] & DdsHeader::kCaps2CubeMapMask)
         {
-            return Texture::createCube(ddsData.header.width, ddsData.header.height, format, 1, mipLevels, ddsData.data.data(), bindFlags);
+            return Texture::createCube(ddsData.header.width, ddsData.header.height, format, 1, mipLevels, ddsData.pData, bindFlags);
         }
         //This is a 2D Texture
         else
         {
-            flipData(ddsData, format, ddsData.header.width, ddsData.header.height, 1, mipLevels == Texture::kMaxPossible ? 1 : mipLevels);
-            return Texture::create2D(ddsData.header.width, ddsData.header.height, format, 1, mipLevels, ddsData.data.data(), bindFlags);
+            return Texture::create2D(ddsData.header.width, ddsData.header.height, format, 1, mipLevels, ddsData.pData, bindFlags);
         }
 
         should_not_get_here();
         return nullptr;
     }
 
+    /** Check that the file holds all the texel data the texture creation reads. The data is read straight from the file mapping, so a truncated file would be read past its end.
+    */
+    bool validateDdsDataSize(const DdsData& ddsData, const std::string& filename, ResourceFormat format, uint32_t mipLevels)
+    {
+        // D3D12 limits. Also keeps the size computation below from overflowing
+        const uint32_t kMaxDimension = 16384;
+        const uint32_t kMaxArraySize = 2048;
+
+        uint32_t width = ddsData.header.width;
+        uint32_t height = ddsData.header.height;
+        uint32_t depth = 1;
+        uint32_t sliceCount = 1;
+        if (ddsData.hasDX10Header)
+        {
+            sliceCount = ddsData.dx10Header.arraySize;
+            switch (ddsData.dx10Header.resourceDimension)
+            {
+            case DXResourceDimension::RESOURCE_DIMENSION_TEXTURE1D:
+                height = 1;
+                break;
+            case DXResourceDimension::RESOURCE_DIMENSION_TEXTURE2D:
+                if (ddsData.dx10Header.miscFlag & DdsHeaderDX10::kCubeMapMask) sliceCount *= 6;
+                break;
+            case DXResourceDimension::RESOURCE_DIMENSION_TEXTURE3D:
+                depth = ddsData.header.depth;
+                break;
+            default:
+                // Reported when creating the texture
+                return true;
+            }
+        }
+        else if (ddsData.header.flags & DdsHeader::kDepthMask) depth = ddsData.header.depth;
+        else if (ddsData.header.caps[1] & DdsHeader::kCaps2CubeMapMask) sliceCount = 6;
+
+        if (format == ResourceFormat::Unknown)
+        {
+            logError("The dds file " + filename + " has an unsupported format");
+            return false;
+        }
+
+        if (width == 0 || height == 0 || depth == 0 || sliceCount == 0 || width > kMaxDimension || height > kMaxDimension || depth > kMaxDimension || sliceCount > kMaxArraySize * 6)
+        {
+            logError("The dds file " + filename + " has invalid dimensions");
+            return false;
+        }
+
+        // When mips are generated, only the first level is read
+        uint32_t maxMipLevels = bitScanReverse(width | height | depth) + 1;
+        uint32_t mipCount = (mipLevels == Texture::kMaxPossible) ? 1 : std::min(mipLevels, maxMipLevels);
+
+        const uint64_t blockWidth = getFormatWidthCompressionRatio(format);
+        const uint64_t blockHeight = getFormatHeightCompressionRatio(format);
+        uint64_t sliceSize = 0;
+        for (uint32_t m = 0; m < mipCount; m++)
+        {
+            uint64_t w = std::max(width >> m, 1u);
+            uint64_t h = std::max(height >> m, 1u);
+            uint64_t d = std::max(depth >> m, 1u);
+            sliceSize += div_round_up(w, blockWidth) * div_round_up(h, blockHeight) * d * getFormatBytesPerBlock(format);
+        }
+
+        uint64_t expectedSize = sliceSize * sliceCount;
+        if (expectedSize > ddsData.dataSize)
+        {
+            logError("The dds file " + filename + " is truncated. It holds " + std::to_string(ddsData.dataSize) + " bytes of texel data, but its header requires " + std::to_string(expectedSize) + " bytes");
+            return false;
+        }
+        return true;
+    }
+
     Texture::SharedPtr createTextureFromDDSFile(const std::string filename, bool generateMips, bool loadAsSrgb, Texture::BindFlags bindFlags)
     {
         DdsData ddsData;
-        loadDDSDataFromFile(filename, ddsData);
+        if (loadDDSDataFromFile(filename, ddsData) == false) return nullptr;
 
         ResourceFormat format = getDdsResourceFormat(ddsData);
         assert(format != ResourceFormat::Unknown);
@@ -684,6 +728,8 @@ namespace Falcor
             mipLevels = Texture::kMaxPossible;
         }
 
+        if (validateDdsDataSize(ddsData, filename, format, mipLevels) == false) return nullptr;
+
         if (ddsData.hasDX10Header)
         {
             return createTextureFromDx10Dds(ddsData, filename, format, mipLevels, bindFlags);
@@ -710,16 +756,42 @@ namespace Falcor
         }
         else
         {
-            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
-            if(pBitmap)
+            // Mip chains are generated on the CPU and cached, so on a cache hit the image isn't even decoded
+            MipGenerator::Options mipOptions;
+            MipGenerator::MipChain mipChain;
+            std::string fullpath;
+            bool useMipCache = generateMipLevels && findFileInDataDirectories(filename, fullpath);
+
+            if (useMipCache && MipGenerator::loadFromCache(fullpath, loadAsSrgb, mipOptions, mipChain))
+            {
+                pTex = Texture::create2D(mipChain.width, mipChain.height, mipChain.format, 1, mipChain.mipCount, mipChain.data.data(), bindFlags);
+            }
+            else if (StreamingImageLoader::canStream(filename))
             {
-                ResourceFormat texFormat = pBitmap->getFormat();
-                if(loadAsSrgb)
+                // HDR images are decoded straight into the texture format. Their mips are generated on the GPU, so that huge images never need a full-size float copy on the CPU
+                pTex = StreamingImageLoader::createTexture(filename, {}, generateMipLevels, bindFlags);
+            }
+            else
+            {
+                Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
+                if(pBitmap)
                 {
-                    texFormat = linearToSrgbFormat(texFormat);
-                }
+                    ResourceFormat texFormat = pBitmap->getFormat();
+                    if(loadAsSrgb)
+                    {
+                        texFormat = linearToSrgbFormat(texFormat);
+                    }
 
-                pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pBitmap->getData(), bindFlags);
+                    if (generateMipLevels && MipGenerator::generate(pBitmap->getData(), pBitmap->getWidth(), pBitmap->getHeight(), texFormat, mipOptions, mipChain))
+                    {
+                        if (useMipCache) MipGenerator::storeInCache(fullpath, loadAsSrgb, mipOptions, mipChain);
+                        pTex = Texture::create2D(mipChain.width, mipChain.height, mipChain.format, 1, mipChain.mipCount, mipChain.data.data(), bindFlags);
+                    }
+                    else
+                    {
+                        pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pBitmap->getData(), bindFlags);
+                    }
+                }
             }
         }
 
@@ -39,7 +39,11 @@ namespace Falcor
     bool ComputeContext::prepareForDispatch()
     {
         assert(mpComputeState);
-        if(mpComputeVars) applyComputeVars();
+        if(mpComputeVars)
+        {
+            if (mpComputeState->getProgram()) mpComputeState->getProgram()->bindRuntimeDefines(mpComputeVars.get());
+            applyComputeVars();
+        }
 
         ComputeStateObject::SharedPtr pCso = mpComputeState->getCSO(mpComputeVars.get());
         vkCmdBindPipeline(mpLowLevelData->getCommandList(), VK_PIPELINE_BIND_POINT_COMPUTE, pCso->getApiHandle());
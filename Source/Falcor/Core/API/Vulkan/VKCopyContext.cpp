@@ -184,8 +184,11 @@ namespace Falcor
 
         dataSize = getMipLevelPackedDataSize(pTexture, vkCopy.imageExtent.width, vkCopy.imageExtent.height, vkCopy.imageExtent.depth, pTexture->getFormat());
 
-        // Upload the data to a staging buffer
-        pStaging = Buffer::create(dataSize, Buffer::BindFlags::None, pSrcData ? Buffer::CpuAccess::Write : Buffer::CpuAccess::Read, pSrcData);
+        // Upload the data to a staging buffer. A readback buffer of the right size is reused
+        if (pSrcData || pStaging == nullptr || pStaging->getSize() != dataSize)
+        {
+            pStaging = Buffer::create(dataSize, Buffer::BindFlags::None, pSrcData ? Buffer::CpuAccess::Write : Buffer::CpuAccess::Read, pSrcData);
+        }
         vkCopy.bufferOffset = pStaging->getGpuAddressOffset();
     }
 
@@ -223,31 +226,50 @@ namespace Falcor
     {
         SharedPtr pThis = SharedPtr(new ReadTextureTask);
         pThis->mpContext = pCtx;
+        pThis->mpFence = GpuFence::create();
+        pThis->copy(pTexture, subresourceIndex);
+        return pThis;
+    }
 
+    void CopyContext::ReadTextureTask::reissue(const Texture* pTexture, uint32_t subresourceIndex)
+    {
+        copy(pTexture, subresourceIndex);
+    }
+
+    void CopyContext::ReadTextureTask::copy(const Texture* pTexture, uint32_t subresourceIndex)
+    {
         VkBufferImageCopy vkCopy;
-        initTexAccessParams(pTexture, subresourceIndex, vkCopy, pThis->mpBuffer, nullptr, {}, uvec3(-1, -1, -1), pThis->mDataSize);
+        initTexAccessParams(pTexture, subresourceIndex, vkCopy, mpBuffer, nullptr, {}, uvec3(-1, -1, -1), mDataSize);
 
         // Execute the copy
-        pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
-        pCtx->resourceBarrier(pThis->mpBuffer.get(), Resource::State::CopyDest);
-        vkCmdCopyImageToBuffer(pCtx->getLowLevelData()->getCommandList(), pTexture->getApiHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pThis->mpBuffer->getApiHandle(), 1, &vkCopy);
+        mpContext->resourceBarrier(pTexture, Resource::State::CopySource);
+        mpContext->resourceBarrier(mpBuffer.get(), Resource::State::CopyDest);
+        vkCmdCopyImageToBuffer(mpContext->getLowLevelData()->getCommandList(), pTexture->getApiHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mpBuffer->getApiHandle(), 1, &vkCopy);
 
-        // Create a fence and signal
-        pThis->mpFence = GpuFence::create();
-        pCtx->flush(false);
-        pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
+        // Signal the fence
+        mpContext->flush(false);
+        mpFence->gpuSignal(mpContext->getLowLevelData()->getCommandQueue());
+    }
 
-        return pThis;
+    bool CopyContext::ReadTextureTask::isReady() const
+    {
+        return mpFence->getGpuValue() >= mpFence->getCpuValue() - 1;
     }
 
     std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
+    {
+        std::vector<uint8> result;
+        getData(result);
+        return result;
+    }
+
+    void CopyContext::ReadTextureTask::getData(std::vector<uint8>& result)
     {
         mpFence->syncCpu();
         // Map and read the results
-        std::vector<uint8> result(mDataSize);
+        result.resize(mDataSize);
         uint8* pData = reinterpret_cast<uint8*>(mpBuffer->map(Buffer::MapType::Read));
         std::memcpy(result.data(), pData, mDataSize);
-        return result;
     }
 
     void CopyContext::uavBarrier(const Resource* pResource)
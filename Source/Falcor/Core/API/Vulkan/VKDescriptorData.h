@@ -28,24 +28,29 @@
 ***************************************************************************/
 #pragma once
 #include "API/Device.h"
+#include <mutex>
 
 namespace Falcor
 {
     struct DescriptorPoolApiData
     {
         DescriptorHeapHandle descriptorPool;
+        std::mutex mutex; // vkAllocateDescriptorSets() and vkFreeDescriptorSets() require external synchronization of the pool. Sets are created and destroyed from multiple threads when recording in parallel
     };
 
     struct DescriptorSetApiData
     {
-        DescriptorSetApiData(VkDescriptorSetLayout l, VkDescriptorPool p, VkDescriptorSet s) : layout(l), set(s), pool(p) {}
+        DescriptorSetApiData(VkDescriptorSetLayout l, std::shared_ptr<DescriptorPoolApiData> p, VkDescriptorSet s) : layout(l), set(s), pPool(p) {}
         VkDescriptorSetLayout layout;
-        VkDescriptorPool pool;
+        std::shared_ptr<DescriptorPoolApiData> pPool;
         VkDescriptorSet set;
 
         ~DescriptorSetApiData()
         {
-            vkFreeDescriptorSets(gpDevice->getApiHandle(), pool, 1, &set);
+            {
+                std::lock_guard<std::mutex> lock(pPool->mutex);
+                vkFreeDescriptorSets(gpDevice->getApiHandle(), pPool->descriptorPool, 1, &set);
+            }
             vkDestroyDescriptorSetLayout(gpDevice->getApiHandle(), layout, nullptr);
         }
     };
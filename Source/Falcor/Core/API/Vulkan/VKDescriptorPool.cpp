@@ -97,6 +97,10 @@ namespace Falcor
         return true;
     }
 
+    void DescriptorPool::apiExecuteDeferredReleases()
+    {
+    }
+
     const DescriptorPool::ApiHandle& DescriptorPool::getApiHandle(uint32_t heapIndex) const
     {
         return mpApiData->descriptorPool;
@@ -44,8 +44,11 @@ namespace Falcor
         allocInfo.descriptorPool = mpPool->getApiHandle(0);
         allocInfo.descriptorSetCount = 1;
         allocInfo.pSetLayouts = &layout;
-        vk_call(vkAllocateDescriptorSets(gpDevice->getApiHandle(), &allocInfo, &mApiHandle));
-        mpApiData = std::make_shared<DescriptorSetApiData>(layout, mpPool->getApiHandle(0), mApiHandle);
+        {
+            std::lock_guard<std::mutex> lock(mpPool->mpApiData->mutex);
+            vk_call(vkAllocateDescriptorSets(gpDevice->getApiHandle(), &allocInfo, &mApiHandle));
+        }
+        mpApiData = std::make_shared<DescriptorSetApiData>(layout, mpPool->mpApiData, mApiHandle);
 
         return true;
     }
@@ -46,4 +46,10 @@ namespace Falcor
     {
         vk_call(vkGetQueryPoolResults(gpDevice->getApiHandle(), mpHeap, mStart, 2, sizeof(uint64_t) * 2, result, sizeof(result[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
     }
+
+    bool GpuTimer::getClockCalibration(uint64_t& gpuTimestamp, CpuTimer::TimePoint& cpuTime)
+    {
+        // Requires VK_EXT_calibrated_timestamps, which we don't use
+        return false;
+    }
 }
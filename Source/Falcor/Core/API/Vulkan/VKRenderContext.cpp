@@ -198,6 +198,7 @@ namespace Falcor
         {
             if (mpGraphicsVars)
             {
+                if (mpGraphicsState->getProgram()) mpGraphicsState->getProgram()->bindRuntimeDefines(mpGraphicsVars.get());
                 if (applyGraphicsVars() == false) return; // Skip the call
             }
         }
@@ -126,6 +126,17 @@ namespace Falcor
             return VariablesBuffer::setVariable(offset, 0, value);
         }
 
+        /** Set a variable into the buffer using a variable handle. See VariablesBuffer::getVariableHandle().
+            The type is validated against the declaration in the shader. If there's a mismatch, an error will be logged and the call will be ignored.
+            \param[in] handle The variable handle. It is resolved again if it was created for a buffer with a different layout.
+            \param[in] value Value to set
+        */
+        template<typename T>
+        bool setVariable(VariableHandle& handle, const T& value)
+        {
+            return VariablesBuffer::setVariable(handle, 0, value);
+        }
+
         /** Set a variable array in the buffer.
             The function will validate that the value Type matches the declaration in the shader. If there's a mismatch, an error will be logged and the call will be ignored.
             \param[in] name The variable name. See notes about naming in the ConstantBuffer class description.
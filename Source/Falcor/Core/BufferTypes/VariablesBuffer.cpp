@@ -88,6 +88,34 @@ namespace Falcor
         return pVar ? pVar->getOffset() : kInvalidOffset;
     }
 
+    VariablesBuffer::VariableHandle VariablesBuffer::getVariableHandle(const std::string& varName) const
+    {
+        VariableHandle handle(varName);
+        resolveVariableHandle(handle);
+        return handle;
+    }
+
+    bool VariablesBuffer::resolveVariableHandle(VariableHandle& handle) const
+    {
+        // Fast path. The weak pointer keeps the control block alive, so comparing owners can't match a different layout.
+        if (!handle.pReflector.owner_before(mpReflector) && !mpReflector.owner_before(handle.pReflector)) return handle.isValid();
+
+        handle.pReflector = mpReflector;
+        handle.offset = kInvalidOffset;
+        handle.type = ReflectionBasicType::Type::Unknown;
+
+        const auto& pVar = mpReflector->findMember(handle.name);
+        if (pVar == nullptr)
+        {
+            logError("Variable \"" + handle.name + "\" was not found in buffer \"" + mName + "\". Ignoring calls using its handle.");
+            return false;
+        }
+        const ReflectionBasicType* pBasicType = pVar->getType()->asBasicType();
+        handle.offset = pVar->getOffset();
+        handle.type = pBasicType ? pBasicType->getType() : ReflectionBasicType::Type::Unknown;
+        return true;
+    }
+
     bool VariablesBuffer::uploadToGPU(size_t offset, size_t size)
     {
         if(mDirty == false)  return false;
@@ -255,6 +283,62 @@ namespace Falcor
     set_constant_by_name(uint64_t);
 #undef set_constant_by_name
 
+    template<typename VarType>
+    bool VariablesBuffer::setVariable(VariableHandle& handle, size_t elementIndex, const VarType& value)
+    {
+        verify_element_index();
+        if (resolveVariableHandle(handle) == false) return false;
+#if _LOG_ENABLED
+        ReflectionBasicType::Type callType = getReflectionTypeFromCType<VarType>();
+        if (handle.type != callType)
+        {
+            logError("Error when setting variable \"" + handle.name + "\" to buffer \"" + mName + "\". Type mismatch. Expecting " + to_string(handle.type) + " but the user provided a " + to_string(callType));
+            return false;
+        }
+#endif
+        const uint8_t* pVar = mData.data() + handle.offset + elementIndex * mElementSize;
+        *(VarType*)pVar = value;
+        mDirty = true;
+        return true;
+    }
+
+#define set_constant_by_handle(_t) template dlldecl bool VariablesBuffer::setVariable(VariableHandle& handle, size_t elementIndex, const _t& value)
+
+    set_constant_by_handle(bool);
+    set_constant_by_handle(glm::bvec2);
+    set_constant_by_handle(glm::bvec3);
+    set_constant_by_handle(glm::bvec4);
+
+    set_constant_by_handle(uint32_t);
+    set_constant_by_handle(glm::uvec2);
+    set_constant_by_handle(glm::uvec3);
+    set_constant_by_handle(glm::uvec4);
+
+    set_constant_by_handle(int32_t);
+    set_constant_by_handle(glm::ivec2);
+    set_constant_by_handle(glm::ivec3);
+    set_constant_by_handle(glm::ivec4);
+
+    set_constant_by_handle(float);
+    set_constant_by_handle(glm::vec2);
+    set_constant_by_handle(glm::vec3);
+    set_constant_by_handle(glm::vec4);
+
+    set_constant_by_handle(glm::mat2);
+    set_constant_by_handle(glm::mat2x3);
+    set_constant_by_handle(glm::mat2x4);
+
+    set_constant_by_handle(glm::mat3);
+    set_constant_by_handle(glm::mat3x2);
+    set_constant_by_handle(glm::mat3x4);
+
+    set_constant_by_handle(glm::mat4);
+    set_constant_by_handle(glm::mat4x2);
+    set_constant_by_handle(glm::mat4x3);
+
+    set_constant_by_handle(uint64_t);
+#undef set_constant_by_handle
+
     template<typename VarType> 
     bool VariablesBuffer::setVariableArray(size_t offset, size_t elementIndex, const VarType* pValue, size_t count)
     {
@@ -390,6 +474,12 @@ namespace Falcor
         return true;
     }
 
+    bool VariablesBuffer::compareBlob(const void* pSrc, size_t offset, size_t size) const
+    {
+        if (offset == kInvalidOffset || offset + size > mSize) return false;
+        return std::memcmp(mData.data() + offset, pSrc, size) == 0;
+    }
+
     void VariablesBuffer::renderUI(Gui* pGui, const char* uiGroup)
     {
         VariablesBufferUI variablesBufferUI(*this);
@@ -71,11 +71,42 @@ namespace Falcor
         */
         bool setBlob(const void* pSrc, size_t offset, size_t size) override;
 
+        /** Check if a block of data matches the CPU copy of the buffer. Changes the GPU makes to the buffer are not reflected in the CPU copy.
+            \param[in] pSrc Pointer to the data to compare.
+            \param[in] offset Offset inside the buffer.
+            \param[in] size Number of bytes to compare.
+            \return true if the data matches, false if it differs or the range is out of bounds
+        */
+        bool compareBlob(const void* pSrc, size_t offset, size_t size) const;
+
         /** Get a variable offset inside the buffer. See notes about naming in the VariablesBuffer class description. Constant name can be provided with an implicit array-index, similar to VariablesBuffer#SetVariableArray.
             \return Offset or kInvalidOffset if the variable doesn't exist.
         */
         size_t getVariableOffset(const std::string& varName) const;
 
+        /** A variable offset resolved once by name and reused across calls. Setting a variable through a handle skips the name lookup and the per-call offset validation.
+            The handle remembers the buffer layout it was resolved against. If it is used with a buffer created from a different reflection, it is resolved again by name.
+        */
+        struct VariableHandle
+        {
+            VariableHandle() = default;
+            VariableHandle(const std::string& name) : name(name) {}
+
+            std::string name;                                               ///< The variable name
+            std::weak_ptr<const ReflectionResourceType> pReflector;         ///< The buffer layout the handle was resolved against
+            size_t offset = kInvalidOffset;                                 ///< The variable offset, or kInvalidOffset if the name wasn't found
+            ReflectionBasicType::Type type = ReflectionBasicType::Type::Unknown;
+
+            /** Check if the handle points to a variable in the buffer it was last resolved against
+            */
+            bool isValid() const { return offset != kInvalidOffset; }
+        };
+
+        /** Get a handle for a variable. If the name doesn't exist, an error is logged and an invalid handle is returned.
+            \param[in] varName The variable name. See notes about naming in the VariablesBuffer class description.
+        */
+        VariableHandle getVariableHandle(const std::string& varName) const;
+
         size_t getElementCount() const { return mElementCount; }
 
         size_t getElementSize() const { return mElementSize; }
@@ -102,6 +133,11 @@ namespace Falcor
         template<typename T>
         bool setVariableArray(const std::string& name, size_t elementIndex, const T* pValue, size_t count);
 
+        template<typename T>
+        bool setVariable(VariableHandle& handle, size_t elementIndex, const T& value);
+
+        bool resolveVariableHandle(VariableHandle& handle) const;
+
         ReflectionResourceType::SharedConstPtr mpReflector;
         std::vector<uint8_t> mData;
         mutable bool mDirty = true;
@@ -0,0 +1,197 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "FileWatcher.h"
+#include <filesystem>
+#include <mutex>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace Falcor
+{
+    FileWatcherData* FileWatcher::spData = nullptr;
+
+    namespace
+    {
+        struct Subscription
+        {
+            std::vector<std::string> files;
+            FileWatcher::Callback callback;
+        };
+
+        struct WatcherState
+        {
+            std::mutex mutex;
+            bool initialized = false;
+            FileWatcher::SubscriptionId nextId = 1;
+            std::unordered_map<FileWatcher::SubscriptionId, Subscription> subscriptions;
+            std::unordered_map<std::string, std::unordered_set<FileWatcher::SubscriptionId>> fileSubscribers;
+            std::unordered_set<std::string> directories;
+            std::unordered_map<std::string, CpuTimer::TimePoint> changes;   // Changed files and the time of their last change
+            uint32_t debounceInMs = 100;
+        };
+
+        // Never destroyed, programs may unsubscribe during static destruction
+        WatcherState& getState()
+        {
+            static WatcherState* pState = new WatcherState;
+            return *pState;
+        }
+
+        std::string normalizePath(const std::string& filename)
+        {
+            std::error_code ec;
+            fs::path path = fs::weakly_canonical(fs::path(filename), ec);
+            if (ec) path = fs::absolute(fs::path(filename)).lexically_normal();
+            std::string s = path.string();
+#ifdef _WIN32
+            std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+#endif
+            return s;
+        }
+    }
+
+    FileWatcher::SubscriptionId FileWatcher::subscribe(const std::vector<std::string>& files, const Callback& callback)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.initialized)
+        {
+            platformInit();
+            state.initialized = true;
+        }
+
+        SubscriptionId id = state.nextId++;
+        Subscription& s = state.subscriptions[id];
+        s.callback = callback;
+
+        for (const auto& f : files)
+        {
+            if (!doesFileExist(f)) continue;
+            std::string path = normalizePath(f);
+            s.files.push_back(path);
+            state.fileSubscribers[path].insert(id);
+
+            std::string dir = fs::path(path).parent_path().string();
+            if (state.directories.insert(dir).second) platformWatchDirectory(dir);
+        }
+        return id;
+    }
+
+    void FileWatcher::unsubscribe(SubscriptionId id)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.subscriptions.find(id);
+        if (it == state.subscriptions.end()) return;
+
+        for (const auto& f : it->second.files)
+        {
+            auto fileIt = state.fileSubscribers.find(f);
+            if (fileIt == state.fileSubscribers.end()) continue;
+            fileIt->second.erase(id);
+            if (fileIt->second.empty()) state.fileSubscribers.erase(fileIt);
+        }
+        state.subscriptions.erase(it);
+    }
+
+    void FileWatcher::onFileChanged(const std::string& filename)
+    {
+        auto& state = getState();
+        std::string path = normalizePath(filename);
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.fileSubscribers.find(path) != state.fileSubscribers.end()) state.changes[path] = CpuTimer::getCurrentTimePoint();
+    }
+
+    void FileWatcher::dispatchChanges()
+    {
+        auto& state = getState();
+        std::map<SubscriptionId, std::vector<std::string>> ready;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.changes.empty()) return;
+
+            auto now = CpuTimer::getCurrentTimePoint();
+            for (auto it = state.changes.begin(); it != state.changes.end();)
+            {
+                if (CpuTimer::calcDuration(it->second, now) < state.debounceInMs)
+                {
+                    ++it;
+                    continue;
+                }
+
+                auto fileIt = state.fileSubscribers.find(it->first);
+                if (fileIt != state.fileSubscribers.end())
+                {
+                    for (auto id : fileIt->second) ready[id].push_back(it->first);
+                }
+                it = state.changes.erase(it);
+            }
+        }
+
+        // Callbacks may subscribe or unsubscribe, so don't hold the lock while calling them
+        for (const auto& r : ready)
+        {
+            Callback callback;
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                auto it = state.subscriptions.find(r.first);
+                if (it == state.subscriptions.end()) continue;
+                callback = it->second.callback;
+            }
+            if (callback) callback(r.second);
+        }
+    }
+
+    void FileWatcher::setDebounceInterval(uint32_t intervalInMs)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.debounceInMs = intervalInMs;
+    }
+
+    void FileWatcher::shutdown()
+    {
+        auto& state = getState();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (!state.initialized) return;
+            state.initialized = false;
+        }
+
+        // The watcher thread takes the lock when reporting changes
+        platformShutdown();
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.subscriptions.clear();
+        state.fileSubscribers.clear();
+        state.directories.clear();
+        state.changes.clear();
+    }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <functional>
+#include <vector>
+
+namespace Falcor
+{
+    struct FileWatcherData;
+
+    /** Central service for watching files for changes.
+        Clients subscribe with a set of files. Directories are watched by the OS (inotify on Linux, ReadDirectoryChangesW on Windows) on a background thread, so no file is polled.
+        Changes are collected until dispatchChanges() is called on the main thread. A subscription's callback is invoked once no more changes were seen for its files during the debounce interval.
+    */
+    class dlldecl FileWatcher
+    {
+    public:
+        using SubscriptionId = uint64_t;
+        using Callback = std::function<void(const std::vector<std::string>& changedFiles)>;
+        static const SubscriptionId kInvalidSubscription = 0;
+
+        /** Watch a set of files.
+            \param[in] files The files to watch. Files which don't exist are ignored.
+            \param[in] callback Function to call from dispatchChanges() when some of the files were modified.
+            \return A subscription ID, to be passed to unsubscribe().
+        */
+        static SubscriptionId subscribe(const std::vector<std::string>& files, const Callback& callback);
+
+        /** Stop watching files. The callback will not be invoked after this call returns.
+        */
+        static void unsubscribe(SubscriptionId id);
+
+        /** Invoke the callbacks of subscriptions whose files changed and then stayed untouched for the debounce interval.
+            Should be called once a frame from the main thread.
+        */
+        static void dispatchChanges();
+
+        /** Set the time a file needs to stay unchanged before its subscribers are notified. Editors usually write a file in several steps.
+        */
+        static void setDebounceInterval(uint32_t intervalInMs);
+
+        /** Stop the watcher thread and remove all subscriptions
+        */
+        static void shutdown();
+
+    private:
+        friend struct FileWatcherData;
+        static void onFileChanged(const std::string& filename);
+
+        // Platform specific
+        static void platformInit();
+        static void platformWatchDirectory(const std::string& dir);
+        static void platformShutdown();
+        static FileWatcherData* spData;
+    };
+}
@@ -0,0 +1,124 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "Core/Platform/FileWatcher.h"
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE;
+    }
+
+    struct FileWatcherData
+    {
+        int inotifyFd = -1;
+        int wakeFd = -1;        // eventfd signaled to stop the thread
+        std::mutex mutex;
+        std::unordered_map<int, std::string> directories;   // Watch descriptor to directory
+        std::thread thread;
+
+        static void threadFunc(FileWatcherData* pData)
+        {
+            alignas(inotify_event) char buffer[4096];
+            pollfd fds[2] = { { pData->inotifyFd, POLLIN, 0 }, { pData->wakeFd, POLLIN, 0 } };
+
+            while (true)
+            {
+                if (poll(fds, 2, -1) < 0)
+                {
+                    if (errno == EINTR) continue;
+                    logError("FileWatcher: poll() failed, file changes will no longer be reported");
+                    return;
+                }
+                if (fds[1].revents & POLLIN) return;
+                if ((fds[0].revents & POLLIN) == 0) continue;
+
+                ssize_t length = read(pData->inotifyFd, buffer, sizeof(buffer));
+                for (ssize_t offset = 0; offset < length;)
+                {
+                    const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    offset += sizeof(inotify_event) + pEvent->len;
+                    if (pEvent->len == 0 || (pEvent->mask & kWatchMask) == 0) continue;
+
+                    std::string dir;
+                    {
+                        std::lock_guard<std::mutex> lock(pData->mutex);
+                        auto it = pData->directories.find(pEvent->wd);
+                        if (it != pData->directories.end()) dir = it->second;
+                    }
+                    if (dir.size()) FileWatcher::onFileChanged(dir + "/" + pEvent->name);
+                }
+            }
+        }
+    };
+
+    void FileWatcher::platformInit()
+    {
+        spData = new FileWatcherData;
+        spData->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        spData->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (spData->inotifyFd < 0 || spData->wakeFd < 0)
+        {
+            logError("FileWatcher: Can't initialize inotify");
+            return;
+        }
+        spData->thread = std::thread(FileWatcherData::threadFunc, spData);
+    }
+
+    void FileWatcher::platformWatchDirectory(const std::string& dir)
+    {
+        if (spData->inotifyFd < 0) return;
+        int wd = inotify_add_watch(spData->inotifyFd, dir.c_str(), kWatchMask);
+        if (wd < 0)
+        {
+            logWarning("FileWatcher: Can't watch directory `" + dir + "`");
+            return;
+        }
+        std::lock_guard<std::mutex> lock(spData->mutex);
+        spData->directories[wd] = dir;
+    }
+
+    void FileWatcher::platformShutdown()
+    {
+        if (spData->thread.joinable())
+        {
+            uint64_t value = 1;
+            if (write(spData->wakeFd, &value, sizeof(value)) < 0) {}
+            spData->thread.join();
+        }
+        if (spData->inotifyFd >= 0) close(spData->inotifyFd);
+        if (spData->wakeFd >= 0) close(spData->wakeFd);
+        safe_delete(spData);
+    }
+}
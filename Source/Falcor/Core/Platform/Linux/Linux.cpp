@@ -26,6 +26,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #include "stdafx.h"
+#include <sys/mman.h>
 // #include "Utils/StringUtils.h"
 // #include "Utils/Platform/OS.h"
 // #include "Utils/Logger.h"
@@ -528,4 +529,27 @@ namespace Falcor
     {
         return dlsym(dll, funcName.c_str());
     }
+
+    const void* mapFile(const std::string& filename, size_t& size)
+    {
+        size = 0;
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        void* pData = nullptr;
+        struct stat s;
+        if (fstat(fd, &s) == 0 && s.st_size > 0)
+        {
+            pData = mmap(nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (pData == MAP_FAILED) pData = nullptr;
+            else size = (size_t)s.st_size;
+        }
+        close(fd);
+        return pData;
+    }
+
+    void unmapFile(const void* pData, size_t size)
+    {
+        if (pData) munmap(const_cast<void*>(pData), size);
+    }
 }
@@ -339,6 +339,17 @@ namespace Falcor
     */
     dlldecl std::string readFile(const std::string& filename);
 
+    /** Map a file into memory for reading
+        \param[in] filename The file to map
+        \param[out] size The size of the file in bytes
+        \return A pointer to the file content, or nullptr if the file can't be mapped or is empty. Release it with unmapFile().
+    */
+    dlldecl const void* mapFile(const std::string& filename, size_t& size);
+
+    /** Release a mapping created by mapFile()
+    */
+    dlldecl void unmapFile(const void* pData, size_t size);
+
     /** Load a shared-library
     */
     dlldecl DllHandle loadDll(const std::string& libPath);
@@ -0,0 +1,175 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "Core/Platform/FileWatcher.h"
+#include <mutex>
+
+namespace Falcor
+{
+    struct FileWatcherData
+    {
+        struct Directory
+        {
+            std::string path;
+            HANDLE hDir = INVALID_HANDLE_VALUE;
+            OVERLAPPED overlapped = {};     // hEvent isn't used by completion routines, so it points back to the directory
+            std::vector<uint32_t> buffer;   // FILE_NOTIFY_INFORMATION needs DWORD alignment
+            bool pending = false;           // True while a read was issued and its completion routine didn't run yet
+        };
+
+        HANDLE hWakeEvent = nullptr;
+        std::mutex mutex;
+        bool stop = false;
+        std::vector<std::string> newDirectories;    // Added by the main thread, opened by the watcher thread
+        std::thread thread;
+
+        static std::string toUtf8(const WCHAR* pName, size_t length)
+        {
+            int size = WideCharToMultiByte(CP_UTF8, 0, pName, (int)length, nullptr, 0, nullptr, nullptr);
+            std::string str(size, '\0');
+            if (size) WideCharToMultiByte(CP_UTF8, 0, pName, (int)length, &str[0], size, nullptr, nullptr);
+            return str;
+        }
+
+        static bool issueRead(Directory& d)
+        {
+            const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+            d.pending = ReadDirectoryChangesW(d.hDir, d.buffer.data(), (DWORD)(d.buffer.size() * sizeof(uint32_t)), FALSE, filter, nullptr, &d.overlapped, onReadComplete) != 0;
+            return d.pending;
+        }
+
+        /** Completion routine of the directory reads. Runs on the watcher thread while it waits alertably
+        */
+        static VOID CALLBACK onReadComplete(DWORD error, DWORD bytes, LPOVERLAPPED pOverlapped)
+        {
+            Directory& d = *reinterpret_cast<Directory*>(pOverlapped->hEvent);
+            d.pending = false;
+            if (error == ERROR_OPERATION_ABORTED) return; // Cancelled on shutdown
+
+            // Zero bytes means the buffer overflowed. We lose the changes, but keep watching.
+            if (error == ERROR_SUCCESS && bytes)
+            {
+                const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(d.buffer.data());
+                while (true)
+                {
+                    const FILE_NOTIFY_INFORMATION* pInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(pBytes);
+                    if (pInfo->Action == FILE_ACTION_MODIFIED || pInfo->Action == FILE_ACTION_ADDED || pInfo->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                    {
+                        FileWatcher::onFileChanged(d.path + "\\" + toUtf8(pInfo->FileName, pInfo->FileNameLength / sizeof(WCHAR)));
+                    }
+                    if (pInfo->NextEntryOffset == 0) break;
+                    pBytes += pInfo->NextEntryOffset;
+                }
+            }
+
+            if (!issueRead(d)) logWarning("FileWatcher: Can't watch directory `" + d.path + "` anymore, changes to its files will be missed");
+        }
+
+        static void threadFunc(FileWatcherData* pData)
+        {
+            // The pending reads are owned by this thread, since I/O issued by a thread is cancelled when it exits.
+            // Reads complete through completion routines, which run during the alertable wait below. Unlike waiting on an event per directory, this has no limit on the number of directories
+            std::vector<std::unique_ptr<Directory>> directories;
+
+            while (true)
+            {
+                DWORD result = WaitForSingleObjectEx(pData->hWakeEvent, INFINITE, TRUE);
+                if (result == WAIT_IO_COMPLETION) continue;
+                if (result != WAIT_OBJECT_0)
+                {
+                    logError("FileWatcher: Wait failed, file changes will no longer be reported");
+                    break;
+                }
+
+                std::vector<std::string> newDirs;
+                {
+                    std::lock_guard<std::mutex> lock(pData->mutex);
+                    if (pData->stop) break;
+                    newDirs.swap(pData->newDirectories);
+                }
+
+                for (const auto& path : newDirs)
+                {
+                    auto pDir = std::make_unique<Directory>();
+                    pDir->path = path;
+                    pDir->hDir = CreateFileA(path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+                    if (pDir->hDir == INVALID_HANDLE_VALUE)
+                    {
+                        logWarning("FileWatcher: Can't watch directory `" + path + "`");
+                        continue;
+                    }
+                    pDir->overlapped.hEvent = reinterpret_cast<HANDLE>(pDir.get());
+                    pDir->buffer.resize(4096);
+                    if (!issueRead(*pDir))
+                    {
+                        logWarning("FileWatcher: Can't watch directory `" + path + "`");
+                        CloseHandle(pDir->hDir);
+                        continue;
+                    }
+                    directories.push_back(std::move(pDir));
+                }
+            }
+
+            // The completion routines of the cancelled reads still reference the directories, so let them run before releasing anything
+            for (auto& d : directories) CancelIo(d->hDir);
+            for (auto& d : directories)
+            {
+                while (d->pending) SleepEx(INFINITE, TRUE);
+                CloseHandle(d->hDir);
+            }
+        }
+    };
+
+    void FileWatcher::platformInit()
+    {
+        spData = new FileWatcherData;
+        spData->hWakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        spData->thread = std::thread(FileWatcherData::threadFunc, spData);
+    }
+
+    void FileWatcher::platformWatchDirectory(const std::string& dir)
+    {
+        {
+            std::lock_guard<std::mutex> lock(spData->mutex);
+            spData->newDirectories.push_back(dir);
+        }
+        SetEvent(spData->hWakeEvent);
+    }
+
+    void FileWatcher::platformShutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(spData->mutex);
+            spData->stop = true;
+        }
+        SetEvent(spData->hWakeEvent);
+        spData->thread.join();
+        CloseHandle(spData->hWakeEvent);
+        safe_delete(spData);
+    }
+}
@@ -634,6 +634,35 @@ namespace Falcor
         return GetProcAddress(dll, funcName.c_str());
     }
 
+    const void* mapFile(const std::string& filename, size_t& size)
+    {
+        size = 0;
+        HANDLE hFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE) return nullptr;
+
+        const void* pData = nullptr;
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0)
+        {
+            HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (hMapping)
+            {
+                pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+                // The view keeps the mapping object alive
+                CloseHandle(hMapping);
+            }
+        }
+        CloseHandle(hFile);
+
+        if (pData) size = (size_t)fileSize.QuadPart;
+        return pData;
+    }
+
+    void unmapFile(const void* pData, size_t size)
+    {
+        if (pData) UnmapViewOfFile(pData);
+    }
+
     void postQuitMessage(int32_t exitCode)
     {
         PostQuitMessage(exitCode);
@@ -338,6 +338,11 @@ namespace Falcor
         while (parseArrayIndex(name, name, index)) {};
 
         ParameterBlockReflection::BindLocation bindLoc = mpReflector->getResourceBinding(name);
+        setResourceSrvUavCommon(bindLoc, descOffset, type, pResource, funcName);
+    }
+
+    void ParameterBlock::setResourceSrvUavCommon(const BindLocation& bindLoc, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const std::string& funcName)
+    {
         if (checkResourceIndices(bindLoc, descOffset, type, funcName) == false) return;
         auto& desc = mAssignedResources[bindLoc.setIndex][bindLoc.rangeIndex][descOffset];
         if (desc.pResource == pResource) return;
@@ -559,6 +564,88 @@ namespace Falcor
         return getResourceSrvUavCommon<Texture>(name, pVar->getDescOffset(), type, "getTexture()");
     }
 
+    ParameterBlock::BindingHandle ParameterBlock::getHandle(const std::string& name) const
+    {
+        BindingHandle handle(name);
+        resolveHandle(handle);
+        return handle;
+    }
+
+    bool ParameterBlock::resolveHandle(BindingHandle& handle) const
+    {
+        // Fast path. Comparing the owners is enough, the weak pointer keeps the control block alive so it can't be reused by another reflection.
+        if (!handle.pReflector.owner_before(mpReflector) && !mpReflector.owner_before(handle.pReflector)) return handle.isValid();
+
+        handle.pReflector = mpReflector;
+        handle.bindLocation = BindLocation();
+
+        const ReflectionVar::SharedConstPtr pVar = mpReflector->getResource(handle.name);
+        const ReflectionResourceType* pType = pVar ? pVar->getType()->unwrapArray()->asResourceType() : nullptr;
+        if (pType == nullptr)
+        {
+            logError("Resource \"" + handle.name + "\" was not found in parameter block \"" + mpReflector->getName() + "\". Ignoring calls using its binding handle.");
+            return false;
+        }
+
+        std::string name = handle.name;
+        uint32_t index;
+        while (parseArrayIndex(name, name, index)) {};
+
+        handle.bindLocation = mpReflector->getResourceBinding(name);
+        handle.arrayIndex = pVar->getDescOffset();
+        handle.resourceType = pType->getType();
+        handle.shaderAccess = pType->getShaderAccess();
+        return handle.isValid();
+    }
+
+    bool ParameterBlock::setResourceSrvUavCommon(BindingHandle& handle, ReflectionResourceType::Type resourceType, DescriptorSet::Type srvType, DescriptorSet::Type uavType, const Resource::SharedPtr& pResource, const std::string& funcName)
+    {
+        if (resolveHandle(handle) == false) return false;
+#if _LOG_ENABLED
+        if (handle.resourceType != resourceType)
+        {
+            logError("ParameterBlock::" + funcName + " was called, but variable \"" + handle.name + "\" has different resource type. Expecting " + to_string(handle.resourceType) + " but provided resource is " + to_string(resourceType) + ". Ignoring call");
+            return false;
+        }
+#endif
+        DescriptorSet::Type type = (handle.shaderAccess == ReflectionResourceType::ShaderAccess::ReadWrite) ? uavType : srvType;
+        setResourceSrvUavCommon(handle.bindLocation, handle.arrayIndex, type, pResource, funcName);
+        return true;
+    }
+
+    bool ParameterBlock::setRawBuffer(BindingHandle& handle, const Buffer::SharedPtr& pBuf)
+    {
+        return setResourceSrvUavCommon(handle, ReflectionResourceType::Type::RawBuffer, DescriptorSet::Type::RawBufferSrv, DescriptorSet::Type::RawBufferUav, pBuf, "setRawBuffer()");
+    }
+
+    bool ParameterBlock::setTypedBuffer(BindingHandle& handle, const TypedBufferBase::SharedPtr& pBuf)
+    {
+        return setResourceSrvUavCommon(handle, ReflectionResourceType::Type::TypedBuffer, DescriptorSet::Type::TypedBufferSrv, DescriptorSet::Type::TypedBufferUav, pBuf, "setTypedBuffer()");
+    }
+
+    bool ParameterBlock::setStructuredBuffer(BindingHandle& handle, const StructuredBuffer::SharedPtr& pBuf)
+    {
+        return setResourceSrvUavCommon(handle, ReflectionResourceType::Type::StructuredBuffer, DescriptorSet::Type::StructuredBufferSrv, DescriptorSet::Type::StructuredBufferUav, pBuf, "setStructuredBuffer()");
+    }
+
+    bool ParameterBlock::setTexture(BindingHandle& handle, const Texture::SharedPtr& pTexture)
+    {
+        return setResourceSrvUavCommon(handle, ReflectionResourceType::Type::Texture, DescriptorSet::Type::TextureSrv, DescriptorSet::Type::TextureUav, pTexture, "setTexture()");
+    }
+
+    bool ParameterBlock::setSampler(BindingHandle& handle, const Sampler::SharedPtr& pSampler)
+    {
+        if (resolveHandle(handle) == false) return false;
+#if _LOG_ENABLED
+        if (handle.resourceType != ReflectionResourceType::Type::Sampler)
+        {
+            logError("ParameterBlock::setSampler() was called, but variable \"" + handle.name + "\" is not a sampler. Ignoring call");
+            return false;
+        }
+#endif
+        return setSampler(handle.bindLocation, handle.arrayIndex, pSampler);
+    }
+
     template<typename ViewType>
     Resource::SharedPtr getResourceFromView(const ViewType* pView)
     {
@@ -191,6 +191,66 @@ namespace Falcor
         */
         const Sampler::SharedPtr& getSampler(const BindLocation& bindLocation, uint32_t arrayIndex) const;
 
+        /** A resource binding resolved once by name and reused across calls. Use it for resources that are set every frame, to skip the name lookup in the reflection.
+            The handle remembers the reflection it was resolved against. If it is used with a block that has a different reflection (for example after the program was recompiled), it is resolved again by name.
+        */
+        struct BindingHandle
+        {
+            BindingHandle() = default;
+            BindingHandle(const std::string& name) : name(name) {}
+
+            std::string name;                                                   ///< The resource name, including array indices if any
+            std::weak_ptr<const ParameterBlockReflection> pReflector;           ///< The reflection the handle was resolved against
+            BindLocation bindLocation;                                          ///< The bind-location in the block. Invalid if the name wasn't found.
+            uint32_t arrayIndex = 0;                                            ///< The array index, or 0 for non-arrays
+            ReflectionResourceType::Type resourceType = ReflectionResourceType::Type::Texture;
+            ReflectionResourceType::ShaderAccess shaderAccess = ReflectionResourceType::ShaderAccess::Undefined;
+
+            /** Check if the handle points to a resource in the block it was last resolved against
+            */
+            bool isValid() const { return bindLocation.setIndex != BindLocation::kInvalidLocation; }
+        };
+
+        /** Get a binding handle for a resource. If the name doesn't exist, an error is logged and an invalid handle is returned.
+            \param[in] name The name of the resource in the shader
+        */
+        BindingHandle getHandle(const std::string& name) const;
+
+        /** Set a raw-buffer using a binding handle. The handle is resolved again if it was created for a different reflection.
+            \param[in] handle The binding handle
+            \param[in] pBuf The buffer object
+            \return false if the call failed, otherwise true
+        */
+        bool setRawBuffer(BindingHandle& handle, const Buffer::SharedPtr& pBuf);
+
+        /** Set a typed buffer using a binding handle. The handle is resolved again if it was created for a different reflection.
+            \param[in] handle The binding handle
+            \param[in] pBuf The buffer object
+            \return false if the call failed, otherwise true
+        */
+        bool setTypedBuffer(BindingHandle& handle, const TypedBufferBase::SharedPtr& pBuf);
+
+        /** Set a structured buffer using a binding handle. The handle is resolved again if it was created for a different reflection.
+            \param[in] handle The binding handle
+            \param[in] pBuf The buffer object
+            \return false if the call failed, otherwise true
+        */
+        bool setStructuredBuffer(BindingHandle& handle, const StructuredBuffer::SharedPtr& pBuf);
+
+        /** Bind a texture using a binding handle. The handle is resolved again if it was created for a different reflection.
+            \param[in] handle The binding handle
+            \param[in] pTexture The texture object to bind
+            \return false if the call failed, otherwise true
+        */
+        bool setTexture(BindingHandle& handle, const Texture::SharedPtr& pTexture);
+
+        /** Bind a sampler using a binding handle. The handle is resolved again if it was created for a different reflection.
+            \param[in] handle The binding handle
+            \param[in] pSampler The sampler object to bind
+            \return false if the call failed, otherwise true
+        */
+        bool setSampler(BindingHandle& handle, const Sampler::SharedPtr& pSampler);
+
         /** Get the program reflection interface
         */
         ParameterBlockReflection::SharedConstPtr getReflection() const { return mpReflector; }
@@ -249,6 +309,9 @@ namespace Falcor
 
         std::vector<RootSet> mRootSets;
         void setResourceSrvUavCommon(std::string name, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const std::string& funcName);
+        void setResourceSrvUavCommon(const BindLocation& bindLoc, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const std::string& funcName);
+        bool resolveHandle(BindingHandle& handle) const;
+        bool setResourceSrvUavCommon(BindingHandle& handle, ReflectionResourceType::Type resourceType, DescriptorSet::Type srvType, DescriptorSet::Type uavType, const Resource::SharedPtr& pResource, const std::string& funcName);
         template<typename ResourceType>
         typename ResourceType::SharedPtr getResourceSrvUavCommon(const std::string& name, uint32_t descOffset, DescriptorSet::Type type, const std::string& funcName) const;
 
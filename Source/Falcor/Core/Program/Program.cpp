@@ -27,6 +27,8 @@
 ***************************************************************************/
 #include "stdafx.h"
 #include "Program.h"
+#include "ShaderCache.h"
+#include "ProgramVars.h"
 #include "Slang/slang.h"
 #include "Utils/StringUtils.h"
 
@@ -150,6 +152,45 @@ namespace Falcor
     // Program
     std::vector<Program*> Program::sPrograms;
 
+    namespace
+    {
+        struct CompileRegistry
+        {
+            std::mutex mutex;
+            bool recording = false;
+            std::vector<Program::CompileRecord> records;
+            std::unordered_map<std::string, std::vector<Program::DefineList>> prewarm;
+        };
+
+        CompileRegistry& getCompileRegistry()
+        {
+            static CompileRegistry registry;
+            return registry;
+        }
+
+        const char* kRuntimeDefinesMacro = "FALCOR_RUNTIME_DEFINES";
+        const char* kRuntimeDefinesBlock = "RuntimeDefinesCB";
+        const std::string kRuntimeDefinePrefix = "rtdef_";
+
+        // Runtime defines are only updated from the main thread
+        Program::RuntimeDefineStats gRuntimeDefineStats;
+
+        bool parseRuntimeDefineValue(const std::string& str, int32_t& value)
+        {
+            // An empty define behaves like `#define NAME 1`
+            if (str.empty())
+            {
+                value = 1;
+                return true;
+            }
+            char* pEnd = nullptr;
+            long v = std::strtol(str.c_str(), &pEnd, 0);
+            if (*pEnd != '\0') return false;
+            value = (int32_t)v;
+            return true;
+        }
+    }
+
     Program::Program()
     {
         sPrograms.push_back(this);
@@ -159,10 +200,67 @@ namespace Falcor
     {
         mDesc = desc;
         mDefineList = programDefines;
+
+        std::vector<DefineList> prewarm;
+        {
+            auto& registry = getCompileRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            auto it = registry.prewarm.find(getProgramDescString());
+            if (it != registry.prewarm.end()) prewarm = it->second;
+        }
+        for (const auto& defines : prewarm) dispatchCompile(defines);
+    }
+
+    void Program::setCompileRecording(bool enable)
+    {
+        auto& registry = getCompileRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.recording = enable;
+        registry.records.clear();
+    }
+
+    std::vector<Program::CompileRecord> Program::getCompileRecords()
+    {
+        auto& registry = getCompileRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        return registry.records;
+    }
+
+    void Program::addPrewarmPermutations(const std::string& program, const std::vector<DefineList>& defineLists)
+    {
+        auto& registry = getCompileRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto& v = registry.prewarm[program];
+        v.insert(v.end(), defineLists.begin(), defineLists.end());
+    }
+
+    void Program::recordCompile(const DefineList& defines, const CompiledData& data, double createTime, bool success) const
+    {
+        auto& registry = getCompileRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (!registry.recording) return;
+
+        CompileRecord record;
+        record.program = getProgramDescString();
+        record.defines = defines;
+        record.compileTime = data.compileTime + createTime;
+        record.setupTime = data.setupTime;
+        record.slangTime = data.slangTime;
+        record.reflectionTime = data.reflectionTime;
+        record.createTime = createTime;
+        record.success = success;
+        record.cacheHit = data.cacheHit;
+        for (const auto& f : data.fileTimes) record.dependencies.push_back(f.first);
+        std::sort(record.dependencies.begin(), record.dependencies.end());
+        registry.records.push_back(record);
     }
 
     Program::~Program()
     {
+        // Background compiles reference this object
+        finishPendingCompiles();
+        FileWatcher::unsubscribe(mFileWatchId);
+
         // Remove the current program from the program vector
         for(auto it = sPrograms.begin() ; it != sPrograms.end() ; it++)
         {
@@ -208,6 +306,8 @@ namespace Falcor
 
     bool Program::addDefine(const std::string& name, const std::string& value)
     {
+        if (isRuntimeDefine(name)) return setRuntimeDefine(name, value);
+
         // Make sure that it doesn't exist already
         if(mDefineList.find(name) != mDefineList.end())
         {
@@ -237,6 +337,9 @@ namespace Falcor
 
     bool Program::removeDefine(const std::string& name)
     {
+        // Runtime defines can't be undefined, the closest thing is 0
+        if (isRuntimeDefine(name)) return setRuntimeDefine(name, "0");
+
         if(mDefineList.find(name) != mDefineList.end())
         {
             mLinkRequired = true;
@@ -280,15 +383,144 @@ namespace Falcor
     
     bool Program::setDefines(const DefineList& dl)
     {
-        if (dl != mDefineList)
+        bool dirty = false;
+        DefineList defines;
+        for (const auto& d : dl)
+        {
+            if (isRuntimeDefine(d.first)) setRuntimeDefine(d.first, d.second);
+            else defines[d.first] = d.second;
+        }
+
+        if (defines != mDefineList)
         {
             mLinkRequired = true;
-            mDefineList = dl;
-            return true;
+            mDefineList = defines;
+            dirty = true;
+        }
+        return dirty;
+    }
+
+    bool Program::setRuntimeDefine(const std::string& name, const std::string& value)
+    {
+        int32_t v;
+        if (parseRuntimeDefineValue(value, v) == false)
+        {
+            logWarning("Program::addDefine() - runtime define '" + name + "' requires an integer value, got '" + value + "'. Ignoring call.");
+            return false;
+        }
+
+        // The program version doesn't change, so this never reports a modification
+        int32_t& current = mRuntimeDefineValues[mRuntimeDefines.at(name)];
+        if (current != v)
+        {
+            current = v;
+            mRuntimeDefinesDirty = true;
+            gRuntimeDefineStats.valueUpdates++;
         }
         return false;
     }
 
+    void Program::addRuntimeDefine(const std::string& name)
+    {
+        if (isRuntimeDefine(name)) return;
+
+        // Background compiles read the runtime define names, and the existing versions were compiled with the define as a literal
+        finishPendingCompiles();
+        mFailedCompiles.clear();
+        mProgramVersions.clear();
+        mRuntimeDefineCombinations.clear();
+        mLinkRequired = true;
+
+        int32_t value = 0;
+        auto it = mDefineList.find(name);
+        if (it != mDefineList.end())
+        {
+            if (parseRuntimeDefineValue(it->second, value) == false)
+            {
+                logWarning("Program::addRuntimeDefine() - define '" + name + "' has the non-integer value '" + it->second + "'. Initializing it to 0.");
+                value = 0;
+            }
+            mDefineList.erase(it);
+        }
+
+        mRuntimeDefines[name] = (uint32_t)mRuntimeDefineValues.size();
+        mRuntimeDefineValues.push_back(value);
+        mRuntimeDefinesDirty = true;
+    }
+
+    int32_t Program::getRuntimeDefine(const std::string& name) const
+    {
+        auto it = mRuntimeDefines.find(name);
+        return (it != mRuntimeDefines.end()) ? mRuntimeDefineValues[it->second] : 0;
+    }
+
+    void Program::bindRuntimeDefines(ProgramVars* pVars) const
+    {
+        if (mRuntimeDefines.empty() || pVars == nullptr) return;
+
+        // Statistics. Every distinct set of values used with the same program version would have been a separate compile.
+        const ProgramVersion* pVersion = mActiveProgram.pVersion.get();
+        if (mRuntimeDefinesDirty || pVersion != mpRuntimeDefinesVersion)
+        {
+            auto& combinations = mRuntimeDefineCombinations[pVersion];
+            if (combinations.insert(mRuntimeDefineValues).second && combinations.size() > 1) gRuntimeDefineStats.compilesAvoided++;
+            mpRuntimeDefinesVersion = pVersion;
+            mRuntimeDefinesDirty = false;
+        }
+
+        // The buffer is optimized away if the shader doesn't use any of the defines
+        if (pVars->getReflection()->getResource(kRuntimeDefinesBlock) == nullptr) return;
+        ConstantBuffer::SharedPtr pCB = pVars->getConstantBuffer(kRuntimeDefinesBlock);
+        if (pCB == nullptr) return;
+
+        // Only write the values when they changed. Writing dirties the buffer, which is then uploaded again
+        const size_t size = mRuntimeDefineValues.size() * sizeof(int32_t);
+        if (pCB->compareBlob(mRuntimeDefineValues.data(), 0, size) == false) pCB->setBlob(mRuntimeDefineValues.data(), 0, size);
+    }
+
+    Program::RuntimeDefineStats Program::getRuntimeDefineStats()
+    {
+        return gRuntimeDefineStats;
+    }
+
+    void Program::resetRuntimeDefineStats()
+    {
+        gRuntimeDefineStats = RuntimeDefineStats();
+    }
+
+    void Program::addFileDependencies(const string_time_map& files) const
+    {
+        for (const auto& f : files) mFileTimeMap[f.first] = f.second;
+        if (mFileTimeMap.size() == mWatchedFileCount) return;
+
+        // The dependency set grew, replace the subscription
+        std::vector<std::string> watchList;
+        for (const auto& f : mFileTimeMap) watchList.push_back(f.first);
+        FileWatcher::unsubscribe(mFileWatchId);
+        Program* pThis = const_cast<Program*>(this);
+        mFileWatchId = FileWatcher::subscribe(watchList, [pThis](const std::vector<std::string>& changedFiles) { pThis->onFilesChanged(changedFiles); });
+        mWatchedFileCount = mFileTimeMap.size();
+    }
+
+    void Program::onFilesChanged(const std::vector<std::string>& changedFiles)
+    {
+        logInfo("`" + changedFiles[0] + "` changed, reloading:\n" + getProgramDescString());
+
+        if (mAsyncCompilation && mActiveProgram.pVersion)
+        {
+            // Keep the current version active while the new one compiles in the background
+            finishPendingCompiles();
+            mFailedCompiles.clear();
+            mProgramVersions.clear();
+            mLinkRequired = true;
+            dispatchCompile(mDefineList);
+        }
+        else
+        {
+            reset();
+        }
+    }
+
     bool Program::checkIfFilesChanged()
     {
         if(mActiveProgram.pVersion == nullptr)
@@ -311,12 +543,143 @@ namespace Falcor
         return false;
     }
 
+    void Program::setAsyncCompilation(bool enable, VersionReadyCallback readyCallback)
+    {
+        if (!enable) finishPendingCompiles();
+        mAsyncCompilation = enable;
+        mVersionReadyCallback = readyCallback;
+    }
+
+    bool Program::updatePendingCompiles() const
+    {
+        bool activeChanged = false;
+        for (auto it = mPendingCompiles.begin(); it != mPendingCompiles.end();)
+        {
+            if (it->second.task.isRunning())
+            {
+                ++it;
+                continue;
+            }
+
+            // The compile finished, create the API objects on this thread
+            std::string& log = *it->second.pLog;
+            auto start = CpuTimer::getCurrentTimePoint();
+            VersionData programVersion = createVersion(*it->second.pData, log);
+            recordCompile(it->first, *it->second.pData, CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()), programVersion.pVersion != nullptr);
+            if (programVersion.pVersion)
+            {
+                addFileDependencies(it->second.pData->fileTimes);
+                mProgramVersions[it->first] = programVersion;
+                if (it->first == mDefineList)
+                {
+                    mActiveProgram = programVersion;
+                    activeChanged = true;
+                }
+            }
+            else
+            {
+                // Keep using the last valid version. We will not try this combination again until the files change.
+                logError("Program Linkage failed.\n\n" + getProgramDescString() + "\n" + log);
+                mFailedCompiles.insert(it->first);
+            }
+            it = mPendingCompiles.erase(it);
+        }
+        return activeChanged;
+    }
+
+    void Program::dispatchCompile(const DefineList& defines) const
+    {
+        if (mPendingCompiles.find(defines) != mPendingCompiles.end()) return;
+
+        auto pData = std::make_shared<CompiledData>();
+        auto pLog = std::make_shared<std::string>();
+        Threading::Task task = Threading::dispatchTask([this, defines, pData, pLog]() { *pData = compile(defines, *pLog); });
+        mPendingCompiles.emplace(defines, PendingCompile(task, pData, pLog));
+    }
+
+    void Program::finishPendingCompiles() const
+    {
+        for (auto& pending : mPendingCompiles) pending.second.task.finish();
+        mPendingCompiles.clear();
+    }
+
+    bool Program::precompile(const std::vector<DefineList>& defineLists) const
+    {
+        struct Job
+        {
+            DefineList defines;
+            std::shared_ptr<CompiledData> pData;
+            std::shared_ptr<std::string> pLog;
+        };
+
+        std::vector<Job> jobs;
+        std::vector<Threading::Task> tasks;
+        for (const auto& defines : defineLists)
+        {
+            if (mProgramVersions.find(defines) != mProgramVersions.end()) continue;
+            if (std::any_of(jobs.begin(), jobs.end(), [&defines](const Job& j) { return j.defines == defines; })) continue;
+
+            Job job = { defines, std::make_shared<CompiledData>(), std::make_shared<std::string>() };
+            auto pData = job.pData;
+            auto pLog = job.pLog;
+            tasks.push_back(Threading::dispatchTask([this, defines, pData, pLog]() { *pData = compile(defines, *pLog); }));
+            jobs.push_back(job);
+        }
+
+        for (auto& t : tasks) t.finish();
+
+        bool success = true;
+        for (auto& job : jobs)
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            VersionData programVersion = createVersion(*job.pData, *job.pLog);
+            recordCompile(job.defines, *job.pData, CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()), programVersion.pVersion != nullptr);
+            if (programVersion.pVersion == nullptr)
+            {
+                logError("Program Linkage failed.\n\n" + getProgramDescString() + "\n" + *job.pLog);
+                success = false;
+                continue;
+            }
+            addFileDependencies(job.pData->fileTimes);
+            mProgramVersions[job.defines] = programVersion;
+        }
+        return success;
+    }
+
     const ProgramVersion::SharedConstPtr& Program::getActiveVersion() const
     {
+        if (mPendingCompiles.size())
+        {
+            if (updatePendingCompiles())
+            {
+                mLinkRequired = false;
+                if (mVersionReadyCallback) mVersionReadyCallback(this);
+            }
+        }
+
         if (mLinkRequired)
         {
-            const auto& it = mProgramVersions.find(mDefineList);
-            if (it == mProgramVersions.end())
+            bool async = mAsyncCompilation && mActiveProgram.pVersion;
+            auto it = mProgramVersions.find(mDefineList);
+            if (it == mProgramVersions.end() && !async)
+            {
+                // If this permutation is already compiling in the background, wait for it instead of compiling it again
+                auto pending = mPendingCompiles.find(mDefineList);
+                if (pending != mPendingCompiles.end())
+                {
+                    pending->second.task.finish();
+                    updatePendingCompiles();
+                    it = mProgramVersions.find(mDefineList);
+                }
+            }
+
+            if (it == mProgramVersions.end() && async)
+            {
+                // Keep rendering with the previous version while the new one compiles in the background
+                if (mFailedCompiles.find(mDefineList) == mFailedCompiles.end()) dispatchCompile(mDefineList);
+                return mActiveProgram.pVersion;
+            }
+            else if (it == mProgramVersions.end())
             {
                 // Note that link() updates mActiveProgram only if the operation was successful.
                 // On error we get false, and mActiveProgram points to the last successfully compiled version.
@@ -340,17 +703,54 @@ namespace Falcor
         return mActiveProgram.pVersion;
     }
 
+    namespace
+    {
+        // A Slang session can't be used by multiple threads concurrently, so every thread gets its own.
+        // Builtins are recorded here and replayed into each session the next time the thread asks for it.
+        struct SlangBuiltins
+        {
+            std::mutex mutex;
+            std::vector<std::pair<std::string, std::string>> modules;
+        };
+
+        SlangBuiltins& getSlangBuiltins()
+        {
+            static SlangBuiltins builtins;
+            return builtins;
+        }
+
+        /** Owns a thread's session. The session is destroyed when the thread exits, so the sessions of the thread pool workers are released by Threading::shutdown()
+        */
+        struct ThreadSlangSession
+        {
+            SlangSession* pSession = spCreateSession(NULL);
+            size_t builtinCount = 0;
+            ~ThreadSlangSession() { spDestroySession(pSession); }
+        };
+    }
+
     SlangSession* getSlangSession()
     {
-        // TODO: figure out a strategy for finalizing the Slang session, if desired
+        thread_local ThreadSlangSession session;
 
-        static SlangSession* slangSession = spCreateSession(NULL);
-        return slangSession;
+        auto& builtins = getSlangBuiltins();
+        std::lock_guard<std::mutex> lock(builtins.mutex);
+        for (; session.builtinCount < builtins.modules.size(); session.builtinCount++)
+        {
+            const auto& m = builtins.modules[session.builtinCount];
+            spAddBuiltins(session.pSession, m.first.c_str(), m.second.c_str());
+        }
+        return session.pSession;
     }
 
     void loadSlangBuiltins(char const* name, char const* text)
     {
-        spAddBuiltins(getSlangSession(), name, text);
+        {
+            auto& builtins = getSlangBuiltins();
+            std::lock_guard<std::mutex> lock(builtins.mutex);
+            builtins.modules.push_back({ name, text });
+        }
+        getSlangSession();
     }
 
     // Translation a Falcor `ShaderType` to the corresponding `SlangStage`
@@ -391,7 +791,17 @@ namespace Falcor
 
     Program::VersionData Program::preprocessAndCreateProgramVersion(std::string& log) const
     {
-        mFileTimeMap.clear();
+        CompiledData data = compile(mDefineList, log);
+        auto start = CpuTimer::getCurrentTimePoint();
+        VersionData programVersion = createVersion(data, log);
+        recordCompile(mDefineList, data, CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()), programVersion.pVersion != nullptr);
+        addFileDependencies(data.fileTimes);
+        return programVersion;
+    }
+
+    Program::CompiledData Program::compile(const DefineList& defines, std::string& log) const
+    {
+        auto start = CpuTimer::getCurrentTimePoint();
 
         // Run all of the shaders through Slang, so that we can get final code,
         // reflection data, etc.
@@ -417,9 +827,35 @@ namespace Falcor
         bool dumpIR = is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::DumpIntermediates);
         spSetDumpIntermediates(slangRequest, dumpIR);
 
+        // Runtime defines expand to a member of a constant buffer, which is declared by FALCOR_RUNTIME_DEFINES.
+        // The macro is always defined, so shaders can expand it whether or not the program has runtime defines.
+        DefineList compileDefines = defines;
+        {
+            std::vector<std::string> names(mRuntimeDefines.size());
+            for (const auto& d : mRuntimeDefines) names[d.second] = d.first;
+
+            std::string decl;
+            if (names.size())
+            {
+                bool raytracing = false;
+#ifdef FALCOR_D3D12
+                for (uint32_t i = (uint32_t)ShaderType::RayGeneration; i < kShaderCount; i++) raytracing |= mDesc.mEntryPoints[i].isValid();
+#endif
+                // Ray-tracing programs need the buffer in the global root signature
+                decl = std::string(raytracing ? "shared " : "") + "cbuffer " + kRuntimeDefinesBlock + " {";
+                for (const auto& name : names)
+                {
+                    decl += " int " + kRuntimeDefinePrefix + name + ";";
+                    compileDefines[name] = kRuntimeDefinePrefix + name;
+                }
+                decl += " }";
+            }
+            compileDefines[kRuntimeDefinesMacro] = decl;
+        }
+
         // Pass any `#define` flags along to Slang, since we aren't doing our
         // own preprocessing any more.
-        for (auto shaderDefine : mDefineList)
+        for (auto shaderDefine : compileDefines)
         {
             spAddPreprocessorDefine(slangRequest, shaderDefine.first.c_str(), shaderDefine.second.c_str());
         }
@@ -476,6 +912,37 @@ namespace Falcor
 
         // Don't actually perform semantic checking: just pass through functions bodies to downstream compiler
         slangFlags |= SLANG_COMPILE_FLAG_NO_CHECKING | SLANG_COMPILE_FLAG_SPLIT_MIXED_TYPES;
+
+        // Look for the compiled code in the shader cache. If the entry contains the reflection data we don't need Slang at all.
+        // Otherwise, Slang only needs to run its front-end to produce the reflection data
+        std::string cacheKey;
+        ShaderCache::Entry cacheEntry;
+        bool cacheHit = false;
+        if (ShaderCache::isEnabled() && !dumpIR)
+        {
+            cacheKey = ShaderCache::createKey(getCacheKeyDesc(compileDefines, slangTarget, getSlangProfileString(mDesc.mShaderModel)));
+            cacheHit = ShaderCache::load(cacheKey, cacheEntry);
+
+            std::vector<ProgramReflection::SharedPtr> reflectors;
+            auto reflectionStart = CpuTimer::getCurrentTimePoint();
+            if (cacheHit && cacheEntry.reflection.size() && ProgramReflection::deserialize(cacheEntry.reflection, reflectors) && reflectors.size() == 3)
+            {
+                spDestroyCompileRequest(slangRequest);
+                CompiledData data;
+                data.reflectionTime = CpuTimer::calcDuration(reflectionStart, CpuTimer::getCurrentTimePoint());
+                for (uint32_t i = 0; i < kShaderCount; i++) data.blobs[i] = cacheEntry.blobs[i];
+                data.reflectors.pReflector = reflectors[0];
+                data.reflectors.pLocalReflector = reflectors[1];
+                data.reflectors.pGlobalReflector = reflectors[2];
+                for (const auto& dep : cacheEntry.dependencies) data.fileTimes[dep] = getFileModifiedTime(dep);
+                data.success = true;
+                data.cacheHit = true;
+                data.compileTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+                data.setupTime = data.compileTime - data.reflectionTime;
+                return data;
+            }
+            if (cacheHit) slangFlags |= SLANG_COMPILE_FLAG_NO_CODEGEN;
+        }
         spSetCompileFlags(slangRequest, slangFlags);
 
         // Now lets add all our input shader code, one-by-one
@@ -499,8 +966,9 @@ namespace Falcor
                 std::string fullpath;
                 if (!findFileInDataDirectories(src.pLibrary->getFilename(), fullpath))
                 {
-                    logError(std::string("Can't find file ") + src.pLibrary->getFilename());
-                    return VersionData();
+                    log += std::string("Can't find file ") + src.pLibrary->getFilename() + "\n";
+                    spDestroyCompileRequest(slangRequest);
+                    return CompiledData();
                 }
                 spAddTranslationUnitSourceFile(slangRequest, translationUnitIndex, fullpath.c_str());
             }
@@ -530,17 +998,20 @@ namespace Falcor
                 getSlangStage(ShaderType(i)));
         }
 
+        auto slangStart = CpuTimer::getCurrentTimePoint();
         int anySlangErrors = spCompile(slangRequest);
         log += spGetDiagnosticOutput(slangRequest);
         if(anySlangErrors)
         {
             spDestroyCompileRequest(slangRequest);
-            return VersionData();
+            return CompiledData();
         }
 
         // Extract the generated code for each stage
         int entryPointCounter = 0;
-        Shader::Blob shaderBlob[kShaderCount];
+        CompiledData data;
+        data.setupTime = CpuTimer::calcDuration(start, slangStart);
+        auto& shaderBlob = data.blobs;
 
         for (uint32_t i = 0; i < kShaderCount; i++)
         {
@@ -552,33 +1023,83 @@ namespace Falcor
             int entryPointIndex = entryPointCounter++;
             int targetIndex = 0; // We always compile for a single target
 
-            spGetEntryPointCodeBlob(slangRequest, entryPointIndex, targetIndex, shaderBlob[i].writeRef());
+            if (cacheHit) shaderBlob[i] = cacheEntry.blobs[i];
+            else spGetEntryPointCodeBlob(slangRequest, entryPointIndex, targetIndex, shaderBlob[i].writeRef());
         }
 
-        VersionData programVersion;
-
         // Extract the reflection data
-        programVersion.reflectors.pReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::All, log);
-        programVersion.reflectors.pLocalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Local, log);
-        programVersion.reflectors.pGlobalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Global, log);
+        auto reflectionStart = CpuTimer::getCurrentTimePoint();
+        data.slangTime = CpuTimer::calcDuration(slangStart, reflectionStart);
+        data.reflectors.pReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::All, log);
+        data.reflectors.pLocalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Local, log);
+        data.reflectors.pGlobalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Global, log);
 
         // Extract list of files referenced, for dependency-tracking purposes
         int depFileCount = spGetDependencyFileCount(slangRequest);
         for(int ii = 0; ii < depFileCount; ++ii)
         {
             std::string depFilePath = spGetDependencyFilePath(slangRequest, ii);
-            mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            data.fileTimes[depFilePath] = getFileModifiedTime(depFilePath);
+            if (cacheKey.size() && !cacheHit) cacheEntry.dependencies.push_back(depFilePath);
         }
 
         spDestroyCompileRequest(slangRequest);
 
+        // The code is stored in the cache once the program version was created successfully
+        if (cacheKey.size() && !cacheHit)
+        {
+            data.cacheKey = cacheKey;
+            data.dependencies = std::move(cacheEntry.dependencies);
+            ProgramReflection::serialize({ data.reflectors.pReflector, data.reflectors.pLocalReflector, data.reflectors.pGlobalReflector }, data.reflection);
+        }
+        data.reflectionTime = CpuTimer::calcDuration(reflectionStart, CpuTimer::getCurrentTimePoint());
+        data.success = true;
+        data.cacheHit = cacheHit;
+        data.compileTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        return data;
+    }
+
+    Program::VersionData Program::createVersion(const CompiledData& data, std::string& log) const
+    {
+        if (!data.success) return VersionData();
+
         // Now that we've preprocessed things, dispatch to the actual program creation logic,
         // which may vary in subclasses of `Program`
-        programVersion.pVersion = createProgramVersion(log, shaderBlob, programVersion.reflectors);
+        VersionData programVersion;
+        programVersion.reflectors = data.reflectors;
+        programVersion.pVersion = createProgramVersion(log, data.blobs, programVersion.reflectors);
+
+        if (programVersion.pVersion && data.cacheKey.size())
+        {
+            ShaderCache::Entry cacheEntry;
+            cacheEntry.dependencies = data.dependencies;
+            for (uint32_t i = 0; i < kShaderCount; i++) cacheEntry.blobs[i] = data.blobs[i];
+            cacheEntry.reflection = data.reflection;
+            ShaderCache::store(data.cacheKey, cacheEntry);
+        }
 
         return programVersion;
     }
 
+    std::string Program::getCacheKeyDesc(const DefineList& defines, int slangTarget, const std::string& profile) const
+    {
+        // Everything which affects the generated code. The content of the source files is checked by the cache, through the dependency list
+        std::string desc = "target=" + std::to_string(slangTarget) + ";profile=" + profile + ";flags=" + std::to_string((uint32_t)mDesc.getCompilerFlags()) + "\n";
+        for (const auto& dir : getDataDirectoriesList()) desc += "searchPath=" + dir + "\n";
+        for (const auto& d : defines) desc += "define=" + d.first + "=" + d.second + "\n";
+        for (const auto& src : mDesc.mSources)
+        {
+            if (src.type == Desc::Source::Type::File) desc += "file=" + src.pLibrary->getFilename() + "\n";
+            else desc += "string=" + std::to_string(src.str.size()) + ":" + src.str + "\n";
+        }
+        for (uint32_t i = 0; i < kShaderCount; i++)
+        {
+            const auto& e = mDesc.mEntryPoints[i];
+            if (e.index >= 0) desc += "entry=" + std::to_string(i) + ":" + std::to_string(e.index) + ":" + e.name + "\n";
+        }
+        return desc;
+    }
+
     ProgramVersion::SharedPtr Program::createProgramVersion(std::string& log, const Shader::Blob shaderBlob[kShaderCount], const ProgramReflectors& reflectors) const
     {
         // create the shaders
@@ -646,9 +1167,14 @@ namespace Falcor
 
     void Program::reset()
     {
+        finishPendingCompiles();
+        mFailedCompiles.clear();
         mActiveProgram = VersionData();
         mProgramVersions.clear();
         mFileTimeMap.clear();
+        FileWatcher::unsubscribe(mFileWatchId);
+        mFileWatchId = FileWatcher::kInvalidSubscription;
+        mWatchedFileCount = 0;
         mLinkRequired = true;
     }
 
@@ -26,9 +26,13 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include <functional>
+#include <set>
 #include "Core/API/Shader.h"
 #include "Core/Program/ShaderLibrary.h"
 #include "Core/Program/ProgramVersion.h"
+#include "Core/Platform/FileWatcher.h"
+#include "Utils/Threading.h"
 
 namespace Falcor
 {
@@ -84,8 +88,15 @@ namespace Falcor
         /** Get the macro definition list of the active program version.
         */
         virtual const DefineList& getDefines() const = 0;
+
+        /** Turn a macro definition into a runtime define, whose value is read from a constant buffer instead of being compiled into the program. See Program::addRuntimeDefine().
+            \param[in] name The name of the define.
+        */
+        virtual void addRuntimeDefine(const std::string& name) = 0;
     };
 
+    class ProgramVars;
+
     /** High-level abstraction of a program class.
         This class manages different versions of the same program. Different versions means same shader files, different macro definitions. This allows simple usage in case different macros are required - for example static vs. animated models.
     */
@@ -100,6 +111,34 @@ namespace Falcor
 
         using DefineList = Shader::DefineList;
 
+        /** Callback invoked on the main thread when a program version compiled in the background becomes active
+        */
+        using VersionReadyCallback = std::function<void(const Program*)>;
+
+        /** Information about a single compiled program version. See setCompileRecording().
+        */
+        struct CompileRecord
+        {
+            std::string program;        // The program description string
+            DefineList defines;
+            double compileTime = 0;     // Time in milliseconds spent running Slang and creating the version
+            double setupTime = 0;       // Time in milliseconds spent setting up the Slang request and looking up the shader cache
+            double slangTime = 0;       // Time in milliseconds spent in Slang. Covers preprocessing, the front-end and code generation, which Slang runs as a single step
+            double reflectionTime = 0;  // Time in milliseconds spent creating the reflection objects
+            double createTime = 0;      // Time in milliseconds spent creating the program version's API objects
+            bool success = false;
+            bool cacheHit = false;      // True if the shader code came from the persistent shader cache
+            std::vector<std::string> dependencies;  // All the files the program version depends on, as reported by Slang
+        };
+
+        /** Runtime define statistics. See addRuntimeDefine().
+        */
+        struct RuntimeDefineStats
+        {
+            uint64_t valueUpdates = 0;      // Number of times a runtime define changed its value
+            uint64_t compilesAvoided = 0;   // Number of define combinations that would have compiled a new program version if the runtime defines were regular defines
+        };
+
         /** Description of a program to be created.
         */
         class dlldecl Desc
@@ -211,10 +250,32 @@ namespace Falcor
 
         virtual ~Program() = 0;
 
-        /** Get the API handle of the active program
+        /** Get the API handle of the active program.
+            When async compilation is enabled and a valid version already exists, a new define combination is compiled on the thread pool and the previous version is returned until the new one is ready.
         */
         const ProgramVersion::SharedConstPtr& getActiveVersion() const;
 
+        /** Enable/disable background compilation of new program versions.
+            \param[in] enable If true, getActiveVersion() will not block while a new define combination is compiling, as long as a previous version is available.
+            \param[in] readyCallback Optional. Called from getActiveVersion() once a background compile finished and the new version became active.
+        */
+        void setAsyncCompilation(bool enable, VersionReadyCallback readyCallback = {});
+
+        /** Check if background compilation is enabled
+        */
+        bool isAsyncCompilationEnabled() const { return mAsyncCompilation; }
+
+        /** Check if a background compile for the current defines is in flight
+        */
+        bool isCompilePending() const { return mPendingCompiles.find(mDefineList) != mPendingCompiles.end(); }
+
+        /** Compile a list of define permutations in parallel on the thread pool. Blocks until all of them are done.
+            The versions are cached, so switching to one of these define lists later will not trigger a compilation.
+            \param[in] defineLists The permutations to compile. Versions which already exist are skipped.
+            \return True if all the permutations compiled successfully, otherwise false. Errors are written to the log.
+        */
+        bool precompile(const std::vector<DefineList>& defineLists) const;
+
         /** Adds a macro definition to the program. If the macro already exists, it will be replaced.
             \param[in] name The name of define.
             \param[in] value Optional. The value of the define string.
@@ -258,10 +319,55 @@ namespace Falcor
         */
         virtual const DefineList& getDefines() const override { return mDefineList; }
 
-        /** Reload and relink all programs.
+        /** Turn a macro definition into a runtime define. Meant for integer defines which are toggled frequently, like a bounce count or a feature switch.
+            Setting a new value with addDefine() or setDefines() doesn't create a new program version, and these calls report the define as unmodified. The value is written into the `RuntimeDefinesCB` constant buffer by bindRuntimeDefines(), which the render context calls before every draw, dispatch and ray-trace call.
+            The shader must expand `FALCOR_RUNTIME_DEFINES` at global scope to declare the constant buffer. A runtime define is not a compile-time constant, so it can't be used in preprocessor conditionals, array sizes or loop-unrolling decisions.
+            D3D12 has no specialization constants, so the price of a runtime define is a constant buffer load and a dynamic branch in the shader.
+            \param[in] name The name of the define. If the define exists, its value is kept and must be an integer. Otherwise the value is initialized to 0.
+        */
+        virtual void addRuntimeDefine(const std::string& name) override;
+
+        /** Check if a define is a runtime define
+        */
+        bool isRuntimeDefine(const std::string& name) const { return mRuntimeDefines.find(name) != mRuntimeDefines.end(); }
+
+        /** Get the value of a runtime define, or 0 if the name isn't a runtime define
+        */
+        int32_t getRuntimeDefine(const std::string& name) const;
+
+        /** Write the values of the runtime defines into a vars object. Does nothing if the program has no runtime defines, or if the vars don't contain the runtime defines constant buffer.
+            The constant buffer is only written, and uploaded again, when the values it holds differ.
+        */
+        void bindRuntimeDefines(ProgramVars* pVars) const;
+
+        /** Get the runtime define statistics of all programs
+        */
+        static RuntimeDefineStats getRuntimeDefineStats();
+
+        /** Reset the runtime define statistics
+        */
+        static void resetRuntimeDefineStats();
+
+        /** Reload and relink all programs whose files changed.
+            Programs also reload automatically when one of their files is modified, see FileWatcher. If async compilation is enabled, the new version is compiled in the background.
         */
         static void reloadAllPrograms();
 
+        /** Enable/disable recording of every program version compiled by any program. Clears the existing records.
+        */
+        static void setCompileRecording(bool enable);
+
+        /** Get the records collected since compile recording was enabled
+        */
+        static std::vector<CompileRecord> getCompileRecords();
+
+        /** Register permutations to compile in the background as soon as a program with a matching description is created.
+            Used to restore a known set of permutations in parallel, instead of compiling them one by one when they are first requested.
+            \param[in] program The program description string, as found in CompileRecord::program.
+            \param[in] defineLists The permutations to compile.
+        */
+        static void addPrewarmPermutations(const std::string& program, const std::vector<DefineList>& defineLists);
+
         const ProgramReflection::SharedPtr& getReflector() const { getActiveVersion(); return mActiveProgram.reflectors.pReflector; }
         const ProgramReflection::SharedPtr& getLocalReflector() const { getActiveVersion(); return mActiveProgram.reflectors.pLocalReflector; }
         const ProgramReflection::SharedPtr& getGlobalReflector() const { getActiveVersion(); return mActiveProgram.reflectors.pGlobalReflector; }
@@ -285,8 +391,31 @@ namespace Falcor
             ProgramReflectors reflectors;
         };
 
+        using string_time_map = std::unordered_map<std::string, time_t>;
+
+        /** The output of the Slang compilation step. Doesn't touch any API objects, so it can be generated on any thread.
+        */
+        struct CompiledData
+        {
+            bool success = false;
+            Shader::Blob blobs[kShaderCount];
+            ProgramReflectors reflectors;
+            string_time_map fileTimes;
+            std::string cacheKey;                   // Non-empty if the result should be stored into the shader cache
+            std::vector<std::string> dependencies;
+            std::vector<uint8_t> reflection;        // Serialized reflectors, stored into the shader cache together with the code
+            bool cacheHit = false;
+            double compileTime = 0;                 // Milliseconds
+            double setupTime = 0;
+            double slangTime = 0;
+            double reflectionTime = 0;
+        };
+
         bool link() const;
         VersionData preprocessAndCreateProgramVersion(std::string& log) const;
+        CompiledData compile(const DefineList& defines, std::string& log) const;
+        VersionData createVersion(const CompiledData& data, std::string& log) const;
+        std::string getCacheKeyDesc(const DefineList& defines, int slangTarget, const std::string& profile) const;
         virtual ProgramVersion::SharedPtr createProgramVersion(std::string& log, const Shader::Blob shaderBlob[kShaderCount], const ProgramReflectors& reflectors) const;
 
         // The description used to create this program
@@ -294,6 +423,14 @@ namespace Falcor
 
         DefineList mDefineList;
 
+        // Runtime defines. Their values are uploaded to a constant buffer and are not part of mDefineList.
+        std::map<std::string, uint32_t> mRuntimeDefines;    // Name -> index into mRuntimeDefineValues, which is also the member index in the constant buffer
+        std::vector<int32_t> mRuntimeDefineValues;
+        mutable bool mRuntimeDefinesDirty = false;
+        mutable const ProgramVersion* mpRuntimeDefinesVersion = nullptr;
+        mutable std::map<const ProgramVersion*, std::set<std::vector<int32_t>>> mRuntimeDefineCombinations;
+        bool setRuntimeDefine(const std::string& name, const std::string& value);
+
         // We are doing lazy compilation, so these are mutable
         mutable bool mLinkRequired = true;
         mutable std::map<const DefineList, VersionData> mProgramVersions;
@@ -302,8 +439,31 @@ namespace Falcor
         std::string getProgramDescString() const;
         static std::vector<Program*> sPrograms;
 
-        using string_time_map = std::unordered_map<std::string, time_t>;
         mutable string_time_map mFileTimeMap;
+        mutable FileWatcher::SubscriptionId mFileWatchId = FileWatcher::kInvalidSubscription;
+        mutable size_t mWatchedFileCount = 0;
+
+        void addFileDependencies(const string_time_map& files) const;
+        void onFilesChanged(const std::vector<std::string>& changedFiles);
+
+        // Background compilation
+        struct PendingCompile
+        {
+            PendingCompile(const Threading::Task& t, std::shared_ptr<CompiledData> pD, std::shared_ptr<std::string> pL) : task(t), pData(pD), pLog(pL) {}
+            Threading::Task task;
+            std::shared_ptr<CompiledData> pData;
+            std::shared_ptr<std::string> pLog;
+        };
+
+        bool mAsyncCompilation = false;
+        VersionReadyCallback mVersionReadyCallback;
+        mutable std::map<DefineList, PendingCompile> mPendingCompiles;
+        mutable std::set<DefineList> mFailedCompiles;
+
+        bool updatePendingCompiles() const;
+        void finishPendingCompiles() const;
+        void dispatchCompile(const DefineList& defines) const;
+        void recordCompile(const DefineList& defines, const CompiledData& data, double createTime, bool success) const;
 
         bool checkIfFilesChanged();
         void reset();
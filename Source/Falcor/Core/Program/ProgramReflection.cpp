@@ -30,6 +30,7 @@
 #include "Utils/StringUtils.h"
 #include "Slang/slang.h"
 #include <map>
+#include <functional>
 using namespace slang;
 
 namespace Falcor
@@ -1532,4 +1533,426 @@ namespace Falcor
         const auto& offsetIt = mOffsetDescMap.find(offset);
         return (offsetIt == mOffsetDescMap.end()) ? empty : offsetIt->second;
     }
+
+    namespace
+    {
+        const uint32_t kSerializedVersion = 1;
+        const uint32_t kInvalidNode = -1;
+
+        // Node kinds of the serialized type/variable table. Types use the values of ReflectionType::Type
+        const uint8_t kVarNode = 0xFF;
+
+        class BlobWriter
+        {
+        public:
+            BlobWriter(std::vector<uint8_t>& data) : mData(data) {}
+
+            template<typename T>
+            BlobWriter& operator<<(const T& val)
+            {
+                write(&val, sizeof(T));
+                return *this;
+            }
+
+            BlobWriter& operator<<(const std::vector<uint8_t>& data)
+            {
+                write(data.data(), data.size());
+                return *this;
+            }
+
+            void write(const void* pData, size_t size)
+            {
+                const uint8_t* pBytes = (const uint8_t*)pData;
+                mData.insert(mData.end(), pBytes, pBytes + size);
+            }
+        private:
+            std::vector<uint8_t>& mData;
+        };
+
+        class BlobReader
+        {
+        public:
+            BlobReader(const std::vector<uint8_t>& data) : mData(data) {}
+
+            template<typename T>
+            BlobReader& operator>>(T& val)
+            {
+                read(&val, sizeof(T));
+                return *this;
+            }
+
+            void read(void* pData, size_t size)
+            {
+                if (mFail || mOffset + size > mData.size())
+                {
+                    mFail = true;
+                    memset(pData, 0, size);
+                    return;
+                }
+                memcpy(pData, mData.data() + mOffset, size);
+                mOffset += size;
+            }
+
+            bool isFail() const { return mFail; }
+            bool isEnd() const { return mOffset == mData.size(); }
+            void setFail() { mFail = true; }
+        private:
+            const std::vector<uint8_t>& mData;
+            size_t mOffset = 0;
+            bool mFail = false;
+        };
+    }
+
+    void ProgramReflection::serialize(const std::vector<SharedConstPtr>& reflectors, std::vector<uint8_t>& blob)
+    {
+        // The types and variables are stored in a single node table. A node only references nodes which precede it, so the table can be recreated in a single pass.
+        // The encoded record of a node doubles as its interning key, which is what allows the different reflectors to share nodes
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, uint32_t> stringIndices;
+        std::vector<uint8_t> nodes;
+        uint32_t nodeCount = 0;
+        std::unordered_map<std::string, uint32_t> nodeIndices;
+        std::unordered_map<const void*, uint32_t> visited;
+
+        auto addString = [&](const std::string& s)
+        {
+            auto it = stringIndices.find(s);
+            if (it != stringIndices.end()) return it->second;
+            uint32_t index = (uint32_t)strings.size();
+            strings.push_back(s);
+            stringIndices[s] = index;
+            return index;
+        };
+
+        auto addNode = [&](const void* pObject, const std::vector<uint8_t>& record)
+        {
+            std::string key(record.begin(), record.end());
+            auto it = nodeIndices.find(key);
+            uint32_t index;
+            if (it != nodeIndices.end())
+            {
+                index = it->second;
+            }
+            else
+            {
+                BlobWriter(nodes) << record;
+                index = nodeCount++;
+                nodeIndices[key] = index;
+            }
+            visited[pObject] = index;
+            return index;
+        };
+
+        std::function<uint32_t(const ReflectionVar*)> addVar;
+        std::function<uint32_t(const ReflectionType*)> addType = [&](const ReflectionType* pType)
+        {
+            if (pType == nullptr) return kInvalidNode;
+            auto it = visited.find(pType);
+            if (it != visited.end()) return it->second;
+
+            std::vector<uint8_t> record;
+            BlobWriter w(record);
+            w << (uint8_t)pType->getType();
+            switch (pType->getType())
+            {
+            case ReflectionType::Type::Array:
+            {
+                const ReflectionArrayType* pArray = pType->asArrayType();
+                uint32_t elementType = addType(pArray->getType().get());
+                w << (uint64_t)pType->mOffset << pArray->getArraySize() << pArray->getArrayStride() << elementType;
+            }
+            break;
+            case ReflectionType::Type::Struct:
+            {
+                const ReflectionStructType* pStruct = pType->asStructType();
+                std::vector<uint32_t> members;
+                members.reserve(pStruct->getMemberCount());
+                for (const auto& pMember : *pStruct) members.push_back(addVar(pMember.get()));
+                w << (uint64_t)pType->mOffset << (uint64_t)pStruct->getSize() << addString(pStruct->getName()) << (uint32_t)members.size();
+                w.write(members.data(), members.size() * sizeof(uint32_t));
+            }
+            break;
+            case ReflectionType::Type::Basic:
+            {
+                const ReflectionBasicType* pBasic = pType->asBasicType();
+                w << (uint64_t)pType->mOffset << (uint32_t)pBasic->getType() << (uint8_t)pBasic->isRowMajor() << (uint64_t)pBasic->getSize();
+            }
+            break;
+            case ReflectionType::Type::Resource:
+            {
+                const ReflectionResourceType* pResource = pType->asResourceType();
+                uint32_t structType = addType(pResource->getStructType().get());
+                w << (uint32_t)pResource->getType() << (uint32_t)pResource->getDimensions() << (uint32_t)pResource->getStructuredBufferType();
+                w << (uint32_t)pResource->getReturnType() << (uint32_t)pResource->getShaderAccess() << structType;
+            }
+            break;
+            default:
+                should_not_get_here();
+            }
+            return addNode(pType, record);
+        };
+
+        addVar = [&](const ReflectionVar* pVar)
+        {
+            auto it = visited.find(pVar);
+            if (it != visited.end()) return it->second;
+
+            uint32_t type = addType(pVar->getType().get());
+            std::vector<uint8_t> record;
+            BlobWriter w(record);
+            w << kVarNode << addString(pVar->getName()) << type << (uint64_t)pVar->getOffset() << pVar->getDescOffset() << pVar->getRegisterSpace() << (uint32_t)pVar->getModifier();
+            return addNode(pVar, record);
+        };
+
+        auto writeVariableMap = [&](BlobWriter& w, const VariableMap& varMap)
+        {
+            w << (uint32_t)varMap.size();
+            for (const auto& v : varMap)
+            {
+                w << addString(v.first) << v.second.bindLocation << addString(v.second.semanticName) << (uint32_t)v.second.type;
+            }
+        };
+
+        // The reflectors are encoded first, since they populate the string and node tables
+        std::vector<uint8_t> reflectorData;
+        BlobWriter rw(reflectorData);
+        rw << (uint32_t)reflectors.size();
+        for (const auto& pReflector : reflectors)
+        {
+            rw << pReflector->mThreadGroupSize.x << pReflector->mThreadGroupSize.y << pReflector->mThreadGroupSize.z << (uint8_t)pReflector->mIsSampleFrequency;
+            rw << (uint32_t)pReflector->mpParameterBlocks.size();
+            for (const auto& pBlock : pReflector->mpParameterBlocks)
+            {
+                rw << addString(pBlock->mName) << pBlock->mpResourceVars->getMemberCount();
+                for (const auto& pVar : *pBlock->mpResourceVars) rw << addVar(pVar.get());
+                rw << (uint32_t)pBlock->mResources.size();
+                for (const auto& res : pBlock->mResources)
+                {
+                    rw << addString(res.name) << (uint32_t)res.setType << res.descOffset << res.descCount << res.regIndex << res.regSpace << addType(res.pType.get());
+                }
+            }
+            writeVariableMap(rw, pReflector->mPsOut);
+            writeVariableMap(rw, pReflector->mVertAttr);
+            writeVariableMap(rw, pReflector->mVertAttrBySemantic);
+        }
+
+        blob.clear();
+        BlobWriter w(blob);
+        w << kSerializedVersion << (uint32_t)strings.size();
+        for (const auto& s : strings)
+        {
+            w << (uint32_t)s.size();
+            w.write(s.data(), s.size());
+        }
+        w << nodeCount << nodes << reflectorData;
+    }
+
+    bool ProgramReflection::deserialize(const std::vector<uint8_t>& blob, std::vector<SharedPtr>& reflectors)
+    {
+        BlobReader r(blob);
+        uint32_t version = 0;
+        r >> version;
+        if (version != kSerializedVersion) return false;
+
+        uint32_t stringCount = 0;
+        r >> stringCount;
+        if (stringCount > blob.size()) return false;
+        std::vector<std::string> strings(stringCount);
+        for (auto& s : strings)
+        {
+            uint32_t length = 0;
+            r >> length;
+            if (r.isFail() || length > blob.size()) return false;
+            s.resize(length);
+            r.read(&s[0], length);
+        }
+
+        auto getString = [&](uint32_t index) -> const std::string&
+        {
+            static const std::string empty;
+            if (index < strings.size()) return strings[index];
+            r.setFail();
+            return empty;
+        };
+
+        uint32_t nodeCount = 0;
+        r >> nodeCount;
+        if (r.isFail() || nodeCount > blob.size()) return false;
+        std::vector<ReflectionType::SharedConstPtr> types(nodeCount);
+        std::vector<ReflectionVar::SharedConstPtr> vars(nodeCount);
+
+        // Nodes only reference preceding nodes, so an index which wasn't created yet means the blob is malformed
+        uint32_t currentNode = 0;
+        auto getType = [&](uint32_t index, bool optional) -> ReflectionType::SharedConstPtr
+        {
+            if (optional && index == kInvalidNode) return nullptr;
+            if (index < currentNode && types[index]) return types[index];
+            r.setFail();
+            return nullptr;
+        };
+
+        auto getVar = [&](uint32_t index) -> ReflectionVar::SharedConstPtr
+        {
+            if (index < currentNode && vars[index]) return vars[index];
+            r.setFail();
+            return nullptr;
+        };
+
+        auto getResourceType = [&](uint32_t index) -> ReflectionResourceType::SharedConstPtr
+        {
+            ReflectionType::SharedConstPtr pType = getType(index, false);
+            if (pType && pType->getType() == ReflectionType::Type::Resource) return std::static_pointer_cast<const ReflectionResourceType>(pType);
+            r.setFail();
+            return nullptr;
+        };
+
+        for (; currentNode < nodeCount && !r.isFail(); currentNode++)
+        {
+            uint8_t kind = 0;
+            r >> kind;
+            if (kind == kVarNode)
+            {
+                uint32_t name, type, descOffset, regSpace, modifier;
+                uint64_t offset;
+                r >> name >> type >> offset >> descOffset >> regSpace >> modifier;
+                ReflectionType::SharedConstPtr pType = getType(type, false);
+                if (r.isFail()) return false;
+                vars[currentNode] = ReflectionVar::create(getString(name), pType, (size_t)offset, descOffset, regSpace, (ReflectionVar::Modifier)modifier);
+                continue;
+            }
+
+            switch ((ReflectionType::Type)kind)
+            {
+            case ReflectionType::Type::Array:
+            {
+                uint64_t offset;
+                uint32_t arraySize, arrayStride, elementType;
+                r >> offset >> arraySize >> arrayStride >> elementType;
+                ReflectionType::SharedConstPtr pElementType = getType(elementType, false);
+                if (r.isFail()) return false;
+                types[currentNode] = ReflectionArrayType::create((size_t)offset, arraySize, arrayStride, pElementType);
+            }
+            break;
+            case ReflectionType::Type::Struct:
+            {
+                uint64_t offset, size;
+                uint32_t name, memberCount;
+                r >> offset >> size >> name >> memberCount;
+                if (r.isFail() || memberCount > nodeCount) return false;
+                ReflectionStructType::SharedPtr pStruct = ReflectionStructType::create((size_t)offset, (size_t)size, getString(name));
+                for (uint32_t m = 0; m < memberCount; m++)
+                {
+                    uint32_t member;
+                    r >> member;
+                    ReflectionVar::SharedConstPtr pMember = getVar(member);
+                    if (r.isFail()) return false;
+                    pStruct->addMember(pMember);
+                }
+                types[currentNode] = pStruct;
+            }
+            break;
+            case ReflectionType::Type::Basic:
+            {
+                uint64_t offset, size;
+                uint32_t type;
+                uint8_t isRowMajor;
+                r >> offset >> type >> isRowMajor >> size;
+                types[currentNode] = ReflectionBasicType::create((size_t)offset, (ReflectionBasicType::Type)type, isRowMajor != 0, (size_t)size);
+            }
+            break;
+            case ReflectionType::Type::Resource:
+            {
+                uint32_t type, dims, structuredType, retType, access, structType;
+                r >> type >> dims >> structuredType >> retType >> access >> structType;
+                ReflectionType::SharedConstPtr pStructType = getType(structType, true);
+                if (r.isFail()) return false;
+                ReflectionResourceType::SharedPtr pResource = ReflectionResourceType::create((ReflectionResourceType::Type)type, (ReflectionResourceType::Dimensions)dims,
+                    (ReflectionResourceType::StructuredType)structuredType, (ReflectionResourceType::ReturnType)retType, (ReflectionResourceType::ShaderAccess)access);
+                if (pStructType) pResource->setStructType(pStructType);
+                types[currentNode] = pResource;
+            }
+            break;
+            default:
+                return false;
+            }
+        }
+
+        auto readVariableMap = [&](VariableMap& varMap)
+        {
+            uint32_t count = 0;
+            r >> count;
+            if (r.isFail() || count > blob.size()) return false;
+            varMap.reserve(count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint32_t name, semantic, type;
+                ShaderVariable var;
+                r >> name >> var.bindLocation >> semantic >> type;
+                var.semanticName = getString(semantic);
+                var.type = (ReflectionBasicType::Type)type;
+                varMap[getString(name)] = var;
+            }
+            return !r.isFail();
+        };
+
+        uint32_t reflectorCount = 0;
+        r >> reflectorCount;
+        if (r.isFail() || reflectorCount > blob.size()) return false;
+        std::vector<SharedPtr> result;
+        result.reserve(reflectorCount);
+        for (uint32_t i = 0; i < reflectorCount; i++)
+        {
+            SharedPtr pReflector = SharedPtr(new ProgramReflection());
+            uint8_t isSampleFrequency = 0;
+            uint32_t blockCount = 0;
+            r >> pReflector->mThreadGroupSize.x >> pReflector->mThreadGroupSize.y >> pReflector->mThreadGroupSize.z >> isSampleFrequency >> blockCount;
+            if (r.isFail() || blockCount > blob.size()) return false;
+            pReflector->mIsSampleFrequency = isSampleFrequency != 0;
+
+            for (uint32_t b = 0; b < blockCount; b++)
+            {
+                uint32_t name, varCount;
+                r >> name >> varCount;
+                if (r.isFail() || varCount > nodeCount) return false;
+                const std::string& blockName = getString(name);
+                if (pReflector->mParameterBlocksIndices.find(blockName) != pReflector->mParameterBlocksIndices.end()) return false;
+
+                ParameterBlockReflection::SharedPtr pBlock = ParameterBlockReflection::create(blockName);
+                for (uint32_t v = 0; v < varCount; v++)
+                {
+                    uint32_t var;
+                    r >> var;
+                    ReflectionVar::SharedConstPtr pVar = getVar(var);
+                    if (r.isFail()) return false;
+                    pBlock->mpResourceVars->addMember(pVar);
+                }
+
+                uint32_t resourceCount = 0;
+                r >> resourceCount;
+                if (r.isFail() || resourceCount > blob.size()) return false;
+                pBlock->mResources.resize(resourceCount);
+                for (auto& res : pBlock->mResources)
+                {
+                    uint32_t resName, setType, type;
+                    r >> resName >> setType >> res.descOffset >> res.descCount >> res.regIndex >> res.regSpace >> type;
+                    res.name = getString(resName);
+                    res.setType = (ParameterBlockReflection::ResourceDesc::Type)setType;
+                    res.pType = getResourceType(type);
+                    if (r.isFail()) return false;
+                }
+
+                // The descriptor-set layouts and bind-locations are derived from the resource list
+                pBlock->finalize();
+                pReflector->addParameterBlock(pBlock);
+            }
+
+            if (!readVariableMap(pReflector->mPsOut) || !readVariableMap(pReflector->mVertAttr) || !readVariableMap(pReflector->mVertAttrBySemantic)) return false;
+            if (pReflector->mpDefaultBlock) pReflector->updateDefaultBlockResourceBindings();
+            result.push_back(pReflector);
+        }
+
+        if (r.isFail() || !r.isEnd()) return false;
+        reflectors = std::move(result);
+        return true;
+    }
 }
@@ -100,6 +100,7 @@ namespace Falcor
         virtual bool operator==(const ReflectionType& other) const = 0;
         virtual bool operator!=(const ReflectionType& other) const { return !(*this == other); }
     protected:
+        friend class ProgramReflection;
         ReflectionType(size_t offset, Type type) : mType(type), mOffset(offset) {}
         size_t mOffset;
         Type mType;
@@ -671,7 +672,22 @@ namespace Falcor
         /** Merge to reflection objects into a new one
         */
         static SharedPtr merge(const ProgramReflection& first, const ProgramReflection& second);
+
+        /** Serialize reflection objects into a compact binary blob.
+            Types and variables are interned, so structurally identical nodes are stored once. This makes the reflectors of the different resource scopes of a program share most of their data.
+            \param[in] reflectors The objects to serialize
+            \param[out] blob The serialized data
+        */
+        static void serialize(const std::vector<SharedConstPtr>& reflectors, std::vector<uint8_t>& blob);
+
+        /** Recreate reflection objects from a blob created by serialize(). Interned types and variables are shared between the new objects.
+            \param[in] blob The serialized data
+            \param[out] reflectors The reflection objects, in the order they were serialized
+            \return false if the blob is malformed, otherwise true
+        */
+        static bool deserialize(const std::vector<uint8_t>& blob, std::vector<SharedPtr>& reflectors);
     private:
+        ProgramReflection() = default;
         ProgramReflection(slang::ShaderReflection* pSlangReflector, ResourceScope scopeToReflect, std::string& log);
         ProgramReflection(const ProgramReflection&) = default;
         void addParameterBlock(const ParameterBlockReflection::SharedConstPtr& pBlock);
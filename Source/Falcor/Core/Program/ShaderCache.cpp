@@ -0,0 +1,422 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "ShaderCache.h"
+#include "Slang/slang.h"
+#include "Utils/BinaryFileStream.h"
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+
+namespace fs = std::filesystem;
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMagic = 0x31435346; // 'FSC1'
+        const uint32_t kVersion = 2;
+        const std::string kEntryExt = ".bin";
+
+        /** 128-bit hash, made of two 64-bit FNV-1a hashes with different offsets
+        */
+        struct Hash
+        {
+            uint64_t lo = 0xcbf29ce484222325ull;
+            uint64_t hi = 0x84222325cbf29ce4ull;
+
+            void update(const void* pData, size_t size)
+            {
+                const uint8_t* p = (const uint8_t*)pData;
+                for (size_t i = 0; i < size; i++)
+                {
+                    lo = (lo ^ p[i]) * 0x100000001b3ull;
+                    hi = (hi ^ p[i]) * 0x100000001b3ull;
+                    hi ^= hi >> 29;
+                }
+            }
+
+            bool operator==(const Hash& other) const { return lo == other.lo && hi == other.hi; }
+            bool operator!=(const Hash& other) const { return !(*this == other); }
+
+            std::string toString() const
+            {
+                char str[33];
+                snprintf(str, sizeof(str), "%016llx%016llx", (unsigned long long)hi, (unsigned long long)lo);
+                return str;
+            }
+        };
+
+        /** A shader blob owning a copy of the cached code
+        */
+        class CachedBlob : public ISlangBlob
+        {
+        public:
+            CachedBlob(std::vector<uint8_t>&& data) : mData(std::move(data)) {}
+
+            SLANG_NO_THROW SlangResult SLANG_MCALL QueryInterface(SlangUUID const& uuid, void** outObject) override { return SLANG_E_NO_INTERFACE; }
+            SLANG_NO_THROW uint32_t SLANG_MCALL AddRef() override { return ++mRefCount; }
+            SLANG_NO_THROW uint32_t SLANG_MCALL Release() override
+            {
+                uint32_t count = --mRefCount;
+                if (count == 0) delete this;
+                return count;
+            }
+            SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return mData.data(); }
+            SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return mData.size(); }
+
+        private:
+            std::vector<uint8_t> mData;
+            std::atomic<uint32_t> mRefCount = 0;
+        };
+
+        struct IndexEntry
+        {
+            uint64_t size;
+            fs::file_time_type lastUse;
+        };
+
+        struct FileHash
+        {
+            time_t modifiedTime;
+            Hash hash;
+        };
+
+        struct
+        {
+            std::mutex mutex;                                       // Guards everything below, except for the file hashes
+            std::mutex hashMutex;                                   // Guards fileHashes. Files are read and hashed without holding any lock
+            std::atomic<uint32_t> tempFileCounter = 0;
+            bool enabled = true;
+            std::string directory;
+            uint64_t maxSize = 512ull * 1024 * 1024;
+            bool indexValid = false;
+            std::unordered_map<std::string, IndexEntry> index;     // Key -> entry info, for the LRU eviction
+            std::unordered_map<std::string, FileHash> fileHashes;   // Path -> content hash. Avoids re-reading the dependencies which are shared between programs
+            ShaderCache::Stats stats;
+        } gCache;
+
+        std::string getEntryPath(const std::string& key)
+        {
+            return gCache.directory + "/" + key + kEntryExt;
+        }
+
+        /** Get the content hash of a file. Returns false if the file can't be read. gCache.mutex must not be held, since hashing can be slow
+        */
+        bool getFileHash(const std::string& path, Hash& hash)
+        {
+            time_t modifiedTime = getFileModifiedTime(path);
+            {
+                std::lock_guard<std::mutex> lock(gCache.hashMutex);
+                auto it = gCache.fileHashes.find(path);
+                if (it != gCache.fileHashes.end() && it->second.modifiedTime == modifiedTime)
+                {
+                    hash = it->second.hash;
+                    return true;
+                }
+            }
+
+            std::ifstream f(path, std::ios::binary);
+            if (!f.good()) return false;
+            std::vector<char> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+            hash = Hash();
+            hash.update(data.data(), data.size());
+
+            std::lock_guard<std::mutex> lock(gCache.hashMutex);
+            gCache.fileHashes[path] = { modifiedTime, hash };
+            return true;
+        }
+
+        /** Initialize the directory and scan the existing entries. gCache.mutex must be held
+        */
+        void updateIndex()
+        {
+            if (gCache.indexValid) return;
+            if (gCache.directory.empty()) gCache.directory = getExecutableDirectory() + "/ShaderCache";
+
+            gCache.index.clear();
+            gCache.stats.sizeInBytes = 0;
+            std::error_code ec;
+            fs::create_directories(gCache.directory, ec);
+            for (const auto& e : fs::directory_iterator(gCache.directory, ec))
+            {
+                if (!e.is_regular_file() || e.path().extension() != kEntryExt) continue;
+                uint64_t size = e.file_size(ec);
+                gCache.index[e.path().stem().string()] = { size, e.last_write_time(ec) };
+                gCache.stats.sizeInBytes += size;
+            }
+            gCache.stats.entryCount = (uint32_t)gCache.index.size();
+            gCache.indexValid = true;
+        }
+
+        void removeEntry(const std::string& key)
+        {
+            auto it = gCache.index.find(key);
+            if (it == gCache.index.end()) return;
+            std::error_code ec;
+            fs::remove(getEntryPath(key), ec);
+            gCache.stats.sizeInBytes -= it->second.size;
+            gCache.index.erase(it);
+            gCache.stats.entryCount = (uint32_t)gCache.index.size();
+        }
+
+        /** Evict the least recently used entries until the cache fits into the size limit. gCache.mutex must be held
+        */
+        void evict()
+        {
+            if (gCache.stats.sizeInBytes <= gCache.maxSize) return;
+
+            std::vector<std::pair<fs::file_time_type, std::string>> entries;
+            entries.reserve(gCache.index.size());
+            for (const auto& e : gCache.index) entries.push_back({ e.second.lastUse, e.first });
+            std::sort(entries.begin(), entries.end());
+
+            for (const auto& e : entries)
+            {
+                if (gCache.stats.sizeInBytes <= gCache.maxSize) break;
+                removeEntry(e.second);
+                gCache.stats.evictions++;
+            }
+        }
+    }
+
+    void ShaderCache::setEnabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.enabled = enabled;
+    }
+
+    bool ShaderCache::isEnabled()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        return gCache.enabled;
+    }
+
+    void ShaderCache::setDirectory(const std::string& dir)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.directory = dir;
+        gCache.indexValid = false;
+    }
+
+    std::string ShaderCache::getDirectory()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        updateIndex();
+        return gCache.directory;
+    }
+
+    void ShaderCache::setMaxSize(uint64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.maxSize = bytes;
+        updateIndex();
+        evict();
+    }
+
+    uint64_t ShaderCache::getMaxSize()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        return gCache.maxSize;
+    }
+
+    ShaderCache::Stats ShaderCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        updateIndex();
+        return gCache.stats;
+    }
+
+    void ShaderCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        updateIndex();
+        while (gCache.index.size()) removeEntry(gCache.index.begin()->first);
+    }
+
+    std::string ShaderCache::createKey(const std::string& desc)
+    {
+        static const std::string kCompilerVersion = spGetBuildTagString();
+
+        Hash h;
+        h.update(&kVersion, sizeof(kVersion));
+        h.update(kCompilerVersion.data(), kCompilerVersion.size());
+        h.update(desc.data(), desc.size());
+        return h.toString();
+    }
+
+    bool ShaderCache::load(const std::string& key, Entry& entry)
+    {
+        auto miss = []()
+        {
+            std::lock_guard<std::mutex> lock(gCache.mutex);
+            gCache.stats.misses++;
+            return false;
+        };
+
+        // The entry is read without holding the lock, so that programs compiled in parallel don't wait for each other's dependencies to be hashed
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(gCache.mutex);
+            updateIndex();
+            if (gCache.index.find(key) == gCache.index.end())
+            {
+                gCache.stats.misses++;
+                return false;
+            }
+            path = getEntryPath(key);
+        }
+
+        BinaryFileStream stream(path, BinaryFileStream::Mode::Read);
+        uint32_t magic = 0, version = 0;
+        stream >> magic >> version;
+        if (!stream.isGood() || magic != kMagic || version != kVersion) return miss();
+
+        // The sizes come from the file. A corrupt or truncated entry must not cause huge allocations, so every size is checked against the bytes left in the file
+        auto fits = [&stream](uint64_t size) { return stream.isGood() && size <= stream.getRemainingStreamSize(); };
+
+        // Check that the dependencies didn't change. Every dependency takes at least its length and hash
+        const uint64_t kMinDependencySize = sizeof(uint32_t) + 2 * sizeof(uint64_t);
+        uint32_t depCount = 0;
+        stream >> depCount;
+        if (!fits(depCount * kMinDependencySize)) return miss();
+
+        entry = Entry();
+        for (uint32_t i = 0; i < depCount; i++)
+        {
+            uint32_t length = 0;
+            stream >> length;
+            if (!fits(length)) return miss();
+            std::string dep(length, '\0');
+            stream.read(&dep[0], length);
+            Hash stored, current;
+            stream >> stored.lo >> stored.hi;
+            if (!stream.isGood() || !getFileHash(dep, current) || current != stored) return miss();
+            entry.dependencies.push_back(dep);
+        }
+
+        uint32_t stageMask = 0;
+        stream >> stageMask;
+        for (uint32_t i = 0; i < kShaderCount; i++)
+        {
+            if ((stageMask & (1 << i)) == 0) continue;
+            uint64_t size = 0;
+            stream >> size;
+            if (!fits(size)) return miss();
+            std::vector<uint8_t> data((size_t)size);
+            stream.read(data.data(), data.size());
+            entry.blobs[i] = new CachedBlob(std::move(data));
+        }
+
+        uint64_t reflectionSize = 0;
+        stream >> reflectionSize;
+        if (!fits(reflectionSize)) return miss();
+        entry.reflection.resize((size_t)reflectionSize);
+        stream.read(entry.reflection.data(), entry.reflection.size());
+        if (stream.isFail()) return miss();
+        stream.close();
+
+        // Touch the file, so that the LRU order survives between runs. The entry may have been evicted in the meantime, in which case there's nothing to update
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        auto it = gCache.index.find(key);
+        if (it != gCache.index.end())
+        {
+            it->second.lastUse = fs::file_time_type::clock::now();
+            std::error_code ec;
+            fs::last_write_time(path, it->second.lastUse, ec);
+        }
+        gCache.stats.hits++;
+        return true;
+    }
+
+    void ShaderCache::store(const std::string& key, const Entry& entry)
+    {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(gCache.mutex);
+            updateIndex();
+            path = getEntryPath(key);
+        }
+
+        // Write to a temporary file first, so that other processes never see partial entries. The file is written without holding the lock, and the name is unique, since another thread may be storing the same key
+        std::string tempPath = path + "." + std::to_string(gCache.tempFileCounter++) + ".tmp";
+        {
+            BinaryFileStream stream(tempPath, BinaryFileStream::Mode::Write);
+            stream << kMagic << kVersion;
+            stream << (uint32_t)entry.dependencies.size();
+            for (const auto& dep : entry.dependencies)
+            {
+                Hash h;
+                if (!getFileHash(dep, h))
+                {
+                    stream.remove();
+                    return;
+                }
+                stream << (uint32_t)dep.size();
+                stream.write(dep.data(), dep.size());
+                stream << h.lo << h.hi;
+            }
+
+            uint32_t stageMask = 0;
+            for (uint32_t i = 0; i < kShaderCount; i++) stageMask |= entry.blobs[i] ? (1 << i) : 0;
+            stream << stageMask;
+            for (uint32_t i = 0; i < kShaderCount; i++)
+            {
+                if (!entry.blobs[i]) continue;
+                uint64_t size = entry.blobs[i]->getBufferSize();
+                stream << size;
+                stream.write(entry.blobs[i]->getBufferPointer(), (size_t)size);
+            }
+            stream << (uint64_t)entry.reflection.size();
+            stream.write(entry.reflection.data(), entry.reflection.size());
+
+            if (stream.isFail())
+            {
+                logWarning("Can't write shader cache entry `" + path + "`");
+                stream.remove();
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        removeEntry(key);
+        std::error_code ec;
+        fs::rename(tempPath, path, ec);
+        if (ec)
+        {
+            fs::remove(tempPath, ec);
+            return;
+        }
+
+        uint64_t size = fs::file_size(path, ec);
+        gCache.index[key] = { size, fs::file_time_type::clock::now() };
+        gCache.stats.sizeInBytes += size;
+        gCache.stats.entryCount = (uint32_t)gCache.index.size();
+        evict();
+    }
+}
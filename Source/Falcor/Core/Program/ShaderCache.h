@@ -0,0 +1,101 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Core/API/Shader.h"
+
+namespace Falcor
+{
+    /** Persistent on-disk cache of compiled shader code.
+        Entries are addressed by a hash of everything that affects code generation (sources, entry-points, defines, target, shader-model and compiler flags).
+        Each entry records the files the program depends on together with a hash of their content, and is only used if none of them changed.
+        The total size of the cache is bounded. When it grows above the limit, the least recently used entries are evicted.
+        All functions are thread-safe.
+    */
+    class dlldecl ShaderCache
+    {
+    public:
+        static const uint32_t kShaderCount = (uint32_t)ShaderType::Count;
+
+        struct Stats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            uint64_t sizeInBytes = 0;       ///< Current size of the cache on disk
+            uint32_t entryCount = 0;
+        };
+
+        /** The cached data of a program version
+        */
+        struct Entry
+        {
+            std::vector<std::string> dependencies;      ///< Full paths of the files the program depends on
+            Shader::Blob blobs[kShaderCount];           ///< Compiled code, per shader stage. Null for unused stages
+            std::vector<uint8_t> reflection;            ///< Serialized program reflection, see ProgramReflection::serialize(). Empty if not available
+        };
+
+        /** Enable or disable the cache. Enabled by default
+        */
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        /** Set the cache directory. The default is `ShaderCache` in the executable directory
+        */
+        static void setDirectory(const std::string& dir);
+        static std::string getDirectory();
+
+        /** Set the maximum size of the cache in bytes. Evicts entries if the cache is already larger than that
+        */
+        static void setMaxSize(uint64_t bytes);
+        static uint64_t getMaxSize();
+
+        /** Get the hit/miss statistics of the current run, and the state of the cache
+        */
+        static Stats getStats();
+
+        /** Delete all the entries
+        */
+        static void clear();
+
+        /** Create a key from a string which describes all the compilation inputs. The key also covers the Slang compiler version, so entries written by another compiler are never used
+            \return A hex string which can be used as an entry name
+        */
+        static std::string createKey(const std::string& desc);
+
+        /** Look up an entry.
+            \param[in] key The entry key, created by createKey()
+            \param[out] entry The cached data
+            \return true if the entry exists and all its dependencies are unchanged, otherwise false
+        */
+        static bool load(const std::string& key, Entry& entry);
+
+        /** Store an entry. Overwrites an existing entry with the same key
+        */
+        static void store(const std::string& key, const Entry& entry);
+    };
+}
@@ -33,6 +33,7 @@
 #include <sstream>
 #include <fstream>
 #include "Utils/Threading.h"
+#include "Utils/Image/AsyncImageWriter.h"
 #include "dear_imgui/imgui.h"
 
 namespace Falcor
@@ -155,6 +156,8 @@ namespace Falcor
         if (mVideoCapture.pVideoCapture) endVideoCapture();
 
         Clock::shutdown();
+        FileWatcher::shutdown();
+        AsyncImageWriter::shutdown();
         Threading::shutdown();
         Scripting::shutdown();
         RenderPassLibrary::instance().shutdown();
@@ -434,6 +437,8 @@ namespace Falcor
     {
         if (gpDevice && gpDevice->isWindowOccluded()) return;
 
+        FileWatcher::dispatchChanges();
+
         mClock.tick();
         mFrameRate.newFrame();
         if (mVideoCapture.fixedTimeDelta) { mClock.now(mVideoCapture.currentTime); }
@@ -545,6 +550,9 @@ namespace Falcor
         desc.width = pSwapChainFbo->getWidth();
         desc.bitrateMbps = mVideoCapture.pUI->getBitrate();
         desc.gopSize = mVideoCapture.pUI->getGopSize();
+        desc.bitDepth = mVideoCapture.pUI->getBitDepth();
+        desc.transfer = mVideoCapture.pUI->getTransfer();
+        desc.pqWhiteNits = mVideoCapture.pUI->getPqWhiteNits();
 
         mVideoCapture.pVideoCapture = VideoEncoder::create(desc);
 
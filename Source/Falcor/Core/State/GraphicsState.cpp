@@ -27,9 +27,13 @@
 ***************************************************************************/
 #include "stdafx.h"
 #include "GraphicsState.h"
+#include "GraphicsStateObjectCache.h"
 
 namespace Falcor
 {
+    // Number of state objects a state keeps alive. Bounded so that stale program versions, for example after a reload, are released
+    static const size_t kMaxUsedGsos = 8;
+
     static GraphicsStateObject::PrimitiveType topology2Type(Vao::Topology t)
     {
         switch (t)
@@ -60,8 +64,6 @@ namespace Falcor
         {
             setViewport(i, mViewports[i], true);
         }
-
-        mpGsoGraph = StateGraph::create();
     }
 
     GraphicsState::~GraphicsState() = default;
@@ -74,11 +76,10 @@ namespace Falcor
             mpVao->getVertexLayout()->addVertexAttribDclToProg(mpProgram.get());
         }
         auto pProgVersion = mpProgram ? mpProgram->getActiveVersion() : nullptr;
-        bool newProgVersion = pProgVersion.get() != mCachedData.pProgramVersion;
-        if (newProgVersion)
+        if (pProgVersion.get() != mCachedData.pProgramVersion)
         {
             mCachedData.pProgramVersion = pProgVersion.get();
-            mpGsoGraph->walk((void*)pProgVersion.get());
+            mGsoDirty = true;
         }
     
         RootSignature::SharedPtr pRoot = pVars ? pVars->getRootSignature() : RootSignature::getEmpty();
@@ -86,18 +87,17 @@ namespace Falcor
         if (mCachedData.pRootSig != pRoot.get())
         {
             mCachedData.pRootSig = pRoot.get();
-            mpGsoGraph->walk((void*)mCachedData.pRootSig);
+            mGsoDirty = true;
         }
 
         const Fbo::Desc* pFboDesc = mpFbo ? &mpFbo->getDesc() : nullptr;
         if(mCachedData.pFboDesc != pFboDesc)
         {
-            mpGsoGraph->walk((void*)pFboDesc);
             mCachedData.pFboDesc = pFboDesc;
+            mGsoDirty = true;
         }
 
-        GraphicsStateObject::SharedPtr pGso = mpGsoGraph->getCurrentNode();
-        if(pGso == nullptr)
+        if (mGsoDirty || mpGso == nullptr)
         {
             mDesc.setProgramVersion(pProgVersion);
             mDesc.setFboFormats(mpFbo ? mpFbo->getDesc() : Fbo::Desc());
@@ -109,23 +109,19 @@ namespace Falcor
             mDesc.setRootSignature(pRoot);
 
             mDesc.setSinglePassStereoEnable(mEnableSinglePassStereo);
-            
-            StateGraph::CompareFunc cmpFunc = [&desc = mDesc](GraphicsStateObject::SharedPtr pGso) -> bool
-            {
-                return pGso && (desc == pGso->getDesc());
-            };
 
-            if (mpGsoGraph->scanForMatchingNode(cmpFunc))
-            {
-                pGso = mpGsoGraph->getCurrentNode();
-            }
-            else
+            // The cache only holds weak references. Keep the state objects this state used recently alive, so switching back to them is a cache hit
+            mpGso = GraphicsStateObjectCache::get(mDesc);
+            if (mpGso)
             {
-                pGso = GraphicsStateObject::create(mDesc);
-                mpGsoGraph->setCurrentNodeData(pGso);
+                auto it = std::find(mUsedGsos.begin(), mUsedGsos.end(), mpGso);
+                if (it != mUsedGsos.end()) mUsedGsos.erase(it);
+                mUsedGsos.push_front(mpGso);
+                if (mUsedGsos.size() > kMaxUsedGsos) mUsedGsos.pop_back();
             }
+            mGsoDirty = false;
         }
-        return pGso;
+        return mpGso;
     }
 
     GraphicsState& GraphicsState::setFbo(const Fbo::SharedPtr& pFbo, bool setVp0Sc0)
@@ -169,7 +165,7 @@ namespace Falcor
             mDesc.setVao(pVao);
 #endif
 
-            mpGsoGraph->walk(pVao ? (void*)pVao->getVertexLayout().get() : nullptr);
+            mGsoDirty = true;
         }
         return *this;
     }
@@ -179,7 +175,7 @@ namespace Falcor
         if(mDesc.getBlendState() != pBlendState)
         {
             mDesc.setBlendState(pBlendState);
-            mpGsoGraph->walk((void*)pBlendState.get());
+            mGsoDirty = true;
         }
         return *this;
     }
@@ -189,7 +185,7 @@ namespace Falcor
         if(mDesc.getRasterizerState() != pRasterizerState)
         {
             mDesc.setRasterizerState(pRasterizerState);
-            mpGsoGraph->walk((void*)pRasterizerState.get());
+            mGsoDirty = true;
         }
         return *this;
     }
@@ -199,7 +195,7 @@ namespace Falcor
         if(mDesc.getSampleMask() != sampleMask)
         {
             mDesc.setSampleMask(sampleMask);
-            mpGsoGraph->walk((void*)(uint64_t)sampleMask);
+            mGsoDirty = true;
         }
         return *this; 
     }
@@ -209,7 +205,7 @@ namespace Falcor
         if(mDesc.getDepthStencilState() != pDepthStencilState)
         {
             mDesc.setDepthStencilState(pDepthStencilState);
-            mpGsoGraph->walk((void*)pDepthStencilState.get());
+            mGsoDirty = true;
         }
         return *this;
     }
@@ -274,7 +270,7 @@ namespace Falcor
     {
 #if _ENABLE_NVAPI
         mEnableSinglePassStereo = enable;
-        mpGsoGraph->walk((void*)enable);
+        mGsoDirty = true;
 #else
         if (enable)
         {
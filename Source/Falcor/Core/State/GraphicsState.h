@@ -27,10 +27,10 @@
 ***************************************************************************/
 #pragma once
 #include "Core/API/GraphicsStateObject.h"
-#include "StateGraph.h"
 #include "Core/API/FBO.h"
 #include "Core/Program/GraphicsProgram.h"
 #include "Core/Program/ProgramVars.h"
+#include <deque>
 
 namespace Falcor
 {
@@ -261,7 +261,8 @@ namespace Falcor
         };
         CachedData mCachedData;
 
-        using StateGraph = StateGraph<GraphicsStateObject::SharedPtr, void*>;
-        StateGraph::SharedPtr mpGsoGraph;
+        GraphicsStateObject::SharedPtr mpGso;   // The state object matching the current state, if mGsoDirty is false
+        bool mGsoDirty = true;
+        std::deque<GraphicsStateObject::SharedPtr> mUsedGsos;   // Recently used state objects, most recent first
     };
 }
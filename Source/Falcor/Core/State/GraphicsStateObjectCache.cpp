@@ -0,0 +1,147 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "GraphicsStateObjectCache.h"
+#include <mutex>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct
+        {
+            std::mutex mutex;
+            std::unordered_multimap<size_t, std::weak_ptr<GraphicsStateObject>> entries;
+            GraphicsStateObjectCache::Stats stats;
+            size_t sweepThreshold = 64;
+            bool recording = false;
+            std::vector<GraphicsStateObject::Desc> recordedDescs;
+        } gCache;
+
+        // Must be called with the mutex locked. Removes expired entries in the bucket of the hash while searching
+        GraphicsStateObject::SharedPtr find(size_t hash, const GraphicsStateObject::Desc& desc)
+        {
+            auto range = gCache.entries.equal_range(hash);
+            for (auto it = range.first; it != range.second;)
+            {
+                GraphicsStateObject::SharedPtr pGso = it->second.lock();
+                if (pGso == nullptr)
+                {
+                    it = gCache.entries.erase(it);
+                    continue;
+                }
+                if (desc == pGso->getDesc()) return pGso;
+                ++it;
+            }
+            return nullptr;
+        }
+
+        // Must be called with the mutex locked. Removes all the expired entries
+        void sweep()
+        {
+            for (auto it = gCache.entries.begin(); it != gCache.entries.end();)
+            {
+                if (it->second.expired()) it = gCache.entries.erase(it);
+                else ++it;
+            }
+            gCache.sweepThreshold = std::max<size_t>(64, gCache.entries.size() * 2);
+        }
+
+        GraphicsStateObject::SharedPtr findOrCreate(const GraphicsStateObject::Desc& desc, bool countStats)
+        {
+            size_t hash = desc.getHash();
+            {
+                std::lock_guard<std::mutex> lock(gCache.mutex);
+                GraphicsStateObject::SharedPtr pGso = find(hash, desc);
+                if (countStats)
+                {
+                    if (pGso) gCache.stats.hits++;
+                    else gCache.stats.misses++;
+                }
+                if (pGso) return pGso;
+            }
+
+            // Create the object without holding the lock, state object creation can take a while
+            GraphicsStateObject::SharedPtr pNew = GraphicsStateObject::create(desc);
+            if (pNew == nullptr) return nullptr;
+
+            std::lock_guard<std::mutex> lock(gCache.mutex);
+            gCache.stats.creations++;
+
+            // Another thread might have created the same object in the meantime. Use the one which is already in the cache
+            GraphicsStateObject::SharedPtr pGso = find(hash, desc);
+            if (pGso) return pGso;
+
+            gCache.entries.insert({ hash, pNew });
+            if (gCache.recording) gCache.recordedDescs.push_back(desc);
+            if (gCache.entries.size() >= gCache.sweepThreshold) sweep();
+            return pNew;
+        }
+    }
+
+    GraphicsStateObject::SharedPtr GraphicsStateObjectCache::get(const GraphicsStateObject::Desc& desc)
+    {
+        return findOrCreate(desc, true);
+    }
+
+    std::vector<GraphicsStateObject::SharedPtr> GraphicsStateObjectCache::prewarm(const std::vector<GraphicsStateObject::Desc>& descs)
+    {
+        std::vector<GraphicsStateObject::SharedPtr> gsos;
+        gsos.reserve(descs.size());
+        for (const auto& desc : descs) gsos.push_back(findOrCreate(desc, false));
+        return gsos;
+    }
+
+    void GraphicsStateObjectCache::setRecording(bool enable)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.recording = enable;
+        gCache.recordedDescs.clear();
+    }
+
+    std::vector<GraphicsStateObject::Desc> GraphicsStateObjectCache::getRecordedDescs()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        return gCache.recordedDescs;
+    }
+
+    GraphicsStateObjectCache::Stats GraphicsStateObjectCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        Stats stats = gCache.stats;
+        stats.entryCount = 0;
+        for (const auto& e : gCache.entries) stats.entryCount += e.second.expired() ? 0 : 1;
+        return stats;
+    }
+
+    void GraphicsStateObjectCache::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.stats = Stats();
+    }
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Core/API/GraphicsStateObject.h"
+
+namespace Falcor
+{
+    /** Global cache of graphics state objects, shared by all the GraphicsState objects.
+        Lookups are done by a hash of the complete GraphicsStateObject::Desc, so a state object is found regardless of the order in which the state was changed or which object the FBO formats came from.
+        The cache doesn't extend the lifetime of the state objects. Entries are removed once the last user of the state object released it.
+        All functions are thread-safe.
+    */
+    class dlldecl GraphicsStateObjectCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t creations = 0;         ///< Number of state objects created by the cache, including prewarming
+            uint32_t entryCount = 0;        ///< Number of live state objects in the cache
+        };
+
+        /** Find a state object matching the desc, or create a new one
+            \return The state object, or nullptr if the creation failed
+        */
+        static GraphicsStateObject::SharedPtr get(const GraphicsStateObject::Desc& desc);
+
+        /** Create the state objects for a list of descs ahead of time.
+            The cache only keeps weak references, so the caller needs to hold on to the returned objects for as long as they should stay cached.
+            \param[in] descs The descs to create state objects for, usually the output of getRecordedDescs()
+            \return The state objects. Entries are nullptr for descs which failed
+        */
+        static std::vector<GraphicsStateObject::SharedPtr> prewarm(const std::vector<GraphicsStateObject::Desc>& descs);
+
+        /** Enable/disable recording of the descs of all the state objects created by the cache. Clears the existing records.
+        */
+        static void setRecording(bool enable);
+
+        /** Get the descs recorded since recording was enabled
+        */
+        static std::vector<GraphicsStateObject::Desc> getRecordedDescs();
+
+        /** Get the hit/miss statistics
+        */
+        static Stats getStats();
+
+        /** Reset the hit/miss/creation counters
+        */
+        static void resetStats();
+    };
+}
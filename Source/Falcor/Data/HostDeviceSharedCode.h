@@ -189,7 +189,14 @@ struct MaterialData
     uint     pad0               DEFAULTS(0);
 
     float2   heightScaleOffset  DEFAULTS(float2(1, 0));
-    float2   pad1               DEFAULTS(float2(0));
+    // IDs of the textures in the scene's VirtualTextureSystem, or 0xffffffff if the texture comes from resources. See Material::setVirtualTexture().
+    uint     virtualOcclusionMap DEFAULTS(0xffffffff);
+    uint     virtualHeightMap   DEFAULTS(0xffffffff);
+
+    uint     virtualBaseColor   DEFAULTS(0xffffffff);
+    uint     virtualSpecular    DEFAULTS(0xffffffff);
+    uint     virtualEmissive    DEFAULTS(0xffffffff);
+    uint     virtualNormalMap   DEFAULTS(0xffffffff);
 
     MaterialResources resources;
 };
@@ -43,10 +43,10 @@ namespace Falcor
         const char kDefaultCbVar[] = "gEnvProbe";
     }
 
-    EnvProbe::SharedPtr EnvProbe::create(RenderContext* pRenderContext, const std::string& filename)
+    EnvProbe::SharedPtr EnvProbe::create(RenderContext* pRenderContext, const std::string& filename, const StreamingImageLoader::Options& options)
     {
         SharedPtr ptr = SharedPtr(new EnvProbe());
-        return ptr->init(pRenderContext, filename) ? ptr : nullptr;
+        return ptr->init(pRenderContext, filename, options) ? ptr : nullptr;
     }
 
     bool EnvProbe::setIntoParameterBlock(ParameterBlock* pBlock, const char varName[]) const
@@ -76,7 +76,7 @@ namespace Falcor
         return setIntoBlockCommon(pVars->getDefaultBlock().get(), pCB, cbVar + '.');
     }
 
-    bool EnvProbe::init(RenderContext* pRenderContext, const std::string& filename)
+    bool EnvProbe::init(RenderContext* pRenderContext, const std::string& filename, const StreamingImageLoader::Options& options)
     {
         // Create compute program for the setup phase.
         mpSetupPass = ComputePass::create(kShaderFilenameSetup, "main");
@@ -93,7 +93,7 @@ namespace Falcor
         mpImportanceSampler = Sampler::create(samplerDesc);
 
         // Load environment map from file. Set it to generate mips and use linear color.
-        mpEnvMap = Texture::createFromFile(filename, true, false);
+        mpEnvMap = StreamingImageLoader::createTextureFromFile(filename, options, true);
         if (!mpEnvMap)
         {
             logError("EnvProbe::init() - Failed to load texture " + filename);
@@ -26,6 +26,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include "Utils/Image/StreamingImageLoader.h"
 
 namespace Falcor
 {
@@ -45,8 +46,9 @@ namespace Falcor
         /** Create a new object
             \param[in] pRenderContext A render-context that will be used for processing
             \param[in] filename The env-map texture filename
+            \param[in] options Format and maximum size of HDR and EXR env-maps, which are streamed. Use maxWidth/maxHeight to downsample huge images while loading
         */
-        static SharedPtr create(RenderContext* pRenderContext, const std::string& filename);
+        static SharedPtr create(RenderContext* pRenderContext, const std::string& filename, const StreamingImageLoader::Options& options = StreamingImageLoader::getEnvMapOptions());
 
         /** Binds environment map probe into a ParameterBlock. This is the recommended way of binding it.
             \param[in] pBlock ParameterBlock to set data into.
@@ -70,7 +72,7 @@ namespace Falcor
     protected:
         EnvProbe() = default;
 
-        bool init(RenderContext* pRenderContext, const std::string& filename);
+        bool init(RenderContext* pRenderContext, const std::string& filename, const StreamingImageLoader::Options& options);
         bool createImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples);
         bool setIntoBlockCommon(ParameterBlock* pBlock, ConstantBuffer* pCB, const std::string& varName) const;
 
@@ -77,6 +77,7 @@
 #include "Core/BufferTypes/VariablesBufferUI.h"
 
 // Core/Platform
+#include "Core/Platform/FileWatcher.h"
 #include "Core/Platform/OS.h"
 #include "Core/Platform/ProgressBar.h"
 
@@ -88,11 +89,13 @@
 #include "Core/Program/ProgramReflection.h"
 #include "Core/Program/ProgramVars.h"
 #include "Core/Program/ProgramVersion.h"
+#include "Core/Program/ShaderCache.h"
 #include "Core/Program/ShaderLibrary.h"
 
 // Core/State
 #include "Core/State/ComputeState.h"
 #include "Core/State/GraphicsState.h"
+#include "Core/State/GraphicsStateObjectCache.h"
 
 // Effects
 #include "Effects/AmbientOcclusion/SSAOPass.h"
@@ -121,6 +124,8 @@
 // Scene
 #include "Scene/Scene.h"
 #include "Scene/Importers/SceneImporter.h"
+#include "Scene/TextureRegistry.h"
+#include "Scene/VirtualTexturing/VirtualTextureSystem.h"
 #include "Scene/Camera/Camera.h"
 #include "Scene/Camera/CameraController.h"
 #include "Scene/Lights/Light.h"
@@ -141,7 +146,12 @@
 #include "Utils/Algorithm/DirectedGraph.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
 #include "Utils/Algorithm/ParallelReduction.h"
+#include "Utils/Image/AsyncImageWriter.h"
 #include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ExrWriter.h"
+#include "Utils/Image/ImageCompare.h"
+#include "Utils/Image/MipGenerator.h"
+#include "Utils/Image/StreamingImageLoader.h"
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Scripting/Dictionary.h"
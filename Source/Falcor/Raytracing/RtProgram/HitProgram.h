@@ -50,6 +50,10 @@ namespace Falcor
 
         RtProgramVersion::SharedConstPtr getActiveVersion() const { return std::dynamic_pointer_cast<const RtProgramVersion>(Program::getActiveVersion()); }
 
+        /** Runtime defines are shared by all the shader groups of an RtProgram, since their values live in a single global constant buffer. Use RtProgram::addRuntimeDefine()
+        */
+        virtual void addRuntimeDefine(const std::string& name) override { logError("HitProgram::addRuntimeDefine() - runtime defines of ray-tracing programs must be added with RtProgram::addRuntimeDefine(). Ignoring call."); }
+
     private:
         HitProgram(uint32_t maxPayloadSize, uint32_t maxAttributeSize) : mMaxPayloadSize(maxPayloadSize), mMaxAttributeSize(maxAttributeSize) {}
         uint32_t mMaxPayloadSize;
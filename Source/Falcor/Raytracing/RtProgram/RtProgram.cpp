@@ -286,4 +286,51 @@ namespace Falcor
         if (changed) mReflectionDirty = true;
         return changed;
     }
+
+    void RtProgram::addRuntimeDefine(const std::string& name)
+    {
+        // The ray programs reject runtime defines which are added to them directly, so that all of them share the same constant buffer layout
+        if (std::find(mRuntimeDefineNames.begin(), mRuntimeDefineNames.end(), name) != mRuntimeDefineNames.end()) return;
+        mRuntimeDefineNames.push_back(name);
+
+        if (mpRayGenProgram) mpRayGenProgram->Program::addRuntimeDefine(name);
+        for (auto& pHit : mHitProgs)
+        {
+            if (pHit) pHit->Program::addRuntimeDefine(name);
+        }
+        for (auto& pMiss : mMissProgs)
+        {
+            if (pMiss) pMiss->Program::addRuntimeDefine(name);
+        }
+        mReflectionDirty = true;
+    }
+
+    void RtProgram::bindRuntimeDefines(ProgramVars* pGlobalVars) const
+    {
+        if (mpRayGenProgram == nullptr || mRuntimeDefineNames.empty()) return;
+
+        // All the shader groups read the same global constant buffer, so there is only one value per define.
+        // RtProgram::addDefine() sets it on every group. A value set on a single hit or miss program would be ignored, so report it
+        auto check = [this](const Program* pProgram, const char* kind, size_t index)
+        {
+            for (const auto& name : mRuntimeDefineNames)
+            {
+                if (pProgram->getRuntimeDefine(name) == mpRayGenProgram->getRuntimeDefine(name)) continue;
+                if (mReportedRuntimeDefines.insert(name).second)
+                {
+                    logError("RtProgram - runtime define '" + name + "' of " + kind + " " + std::to_string(index) + " differs from the ray-gen program. Runtime defines are shared by all shader groups, set them with RtProgram::addDefine(). Using the ray-gen value.");
+                }
+            }
+        };
+        for (size_t i = 0; i < mHitProgs.size(); i++)
+        {
+            if (mHitProgs[i]) check(mHitProgs[i].get(), "hit group", i);
+        }
+        for (size_t i = 0; i < mMissProgs.size(); i++)
+        {
+            if (mMissProgs[i]) check(mMissProgs[i].get(), "miss program", i);
+        }
+
+        mpRayGenProgram->bindRuntimeDefines(pGlobalVars);
+    }
 }
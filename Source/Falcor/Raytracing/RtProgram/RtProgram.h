@@ -108,6 +108,12 @@ namespace Falcor
         virtual bool removeDefines(size_t pos, size_t len, const std::string& str) override;
         virtual bool setDefines(const DefineList& dl) override;
         virtual const DefineList& getDefines() const override { assert(false); static DefineList dummy; return dummy; /* not well defined if the ray programs have mismatching set of defines */ }
+        virtual void addRuntimeDefine(const std::string& name) override;
+
+        /** Write the values of the runtime defines into the global vars. See Program::addRuntimeDefine().
+            All the shader groups read the values from the same global constant buffer. Values which were set on a single hit or miss program, instead of through the RtProgram, can't be honored and are reported as errors.
+        */
+        void bindRuntimeDefines(ProgramVars* pGlobalVars) const;
 
         const RootSignature::SharedPtr& getGlobalRootSignature() const { updateReflection(); return mpGlobalRootSignature; }
         const ProgramReflection::SharedPtr& getGlobalReflector() const { updateReflection(); return mpGlobalReflector; }
@@ -125,6 +131,8 @@ namespace Falcor
         RayGenProgram::SharedPtr mpRayGenProgram;
 
         mutable bool mReflectionDirty = true;
+        std::vector<std::string> mRuntimeDefineNames;
+        mutable std::set<std::string> mReportedRuntimeDefines;   // Mismatching runtime defines which were already reported
         mutable RootSignature::SharedPtr mpGlobalRootSignature;
         mutable ProgramReflection::SharedPtr mpGlobalReflector;
     };
@@ -122,6 +122,10 @@ namespace Falcor
         mpShaderTable = Buffer::create(numEntries * mRecordSize, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None);
         assert(mpShaderTable);
         mShaderTableData.resize(mpShaderTable->getSize());
+        mRecordVars.assign(numEntries, nullptr);
+        mRecordSource.resize(numEntries);
+        for (uint32_t i = 0; i < numEntries; i++) mRecordSource[i] = i;
+        mRecordUpdated.assign(numEntries, false);
 
         // Create the global variables
         mpGlobalVars = GraphicsVars::create(mpProgram->getGlobalReflector(), true, mpProgram->getGlobalRootSignature());
@@ -157,34 +161,108 @@ namespace Falcor
     }
 
     uint8_t* RtProgramVars::getHitRecordPtr(uint32_t hitId, uint32_t meshId)
-    {   
+    {
+        return mShaderTableData.data() + (getHitRecordIndex(hitId, meshId) * mRecordSize);
+    }
+
+    uint32_t RtProgramVars::getHitRecordIndex(uint32_t hitId, uint32_t meshId) const
+    {
         assert(hitId < mHitProgCount);
         uint32_t meshIndex = mFirstHitVarEntry + mHitProgCount * meshId;    // base record of the requested mesh
-        uint32_t recordIndex = meshIndex + hitId;
-        return mShaderTableData.data() + (recordIndex * mRecordSize);
+        return meshIndex + hitId;
     }
 
-    bool applyRtProgramVars(uint8_t* pRecord, const RtProgramVersion* pProgVersion, const RtStateObject* pRtso, ProgramVars* pVars, RtVarsContext* pContext)
+    bool applyRtProgramVars(uint8_t* pRecord, const RtProgramVersion* pProgVersion, const RtStateObject* pRtso, ProgramVars* pVars, RtVarsContext* pContext, bool forceUpdate, bool& recordChanged)
     {
         assert(pProgVersion);
-        MAKE_SMART_COM_PTR(ID3D12StateObjectProperties);
-        ID3D12StateObjectPropertiesPtr pRtsoPtr = pRtso->getApiHandle();
-        memcpy(pRecord, pRtsoPtr->GetShaderIdentifier(pProgVersion->getExportName().c_str()), D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES);
+        // The shader identifier only changes with the state object
+        if (forceUpdate)
+        {
+            MAKE_SMART_COM_PTR(ID3D12StateObjectProperties);
+            ID3D12StateObjectPropertiesPtr pRtsoPtr = pRtso->getApiHandle();
+            memcpy(pRecord, pRtsoPtr->GetShaderIdentifier(pProgVersion->getExportName().c_str()), D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES);
+        }
         pRecord += D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES;
-        pContext->getRtVarsCmdList()->setRootParams(pProgVersion->getLocalRootSignature(), pRecord);
-        return pVars->applyProgramVarsCommon<true>(pContext, true);
+
+        // Unless forced, only the root-sets which changed since the last call are written
+        RtVarsCmdList* pList = pContext->getRtVarsCmdList().get();
+        pList->setRootParams(pProgVersion->getLocalRootSignature(), pRecord);
+        if (!pVars->applyProgramVarsCommon<true>(pContext, forceUpdate)) return false;
+        recordChanged = forceUpdate || pList->areRootParamsWritten();
+        return true;
+    }
+
+    void RtProgramVars::markRecordUpdated(uint32_t recordIndex)
+    {
+        mRecordUpdated[recordIndex] = true;
+        mFirstDirtyRecord = std::min(mFirstDirtyRecord, recordIndex);
+        mEndDirtyRecord = std::max(mEndDirtyRecord, recordIndex + 1);
+    }
+
+    bool RtProgramVars::applyRecord(uint32_t recordIndex, const RtProgramVersion* pProgVersion, RtStateObject* pRtso, GraphicsVars* pVars, bool rtsoChanged)
+    {
+        // A record whose vars object was replaced must be written in full
+        bool forceUpdate = rtsoChanged || (mRecordVars[recordIndex] != pVars);
+        mRecordVars[recordIndex] = pVars;
+
+        bool recordChanged = false;
+        uint8_t* pRecord = mShaderTableData.data() + (recordIndex * mRecordSize);
+        if (!applyRtProgramVars(pRecord, pProgVersion, pRtso, pVars, mpRtVarsHelper.get(), forceUpdate, recordChanged)) return false;
+        if (recordChanged) markRecordUpdated(recordIndex);
+        return true;
+    }
+
+    void RtProgramVars::copyRecord(uint32_t dstIndex, uint32_t srcIndex)
+    {
+        memcpy(mShaderTableData.data() + (dstIndex * mRecordSize), mShaderTableData.data() + (srcIndex * mRecordSize), mRecordSize);
+        mRecordVars[dstIndex] = mRecordVars[srcIndex];
+        markRecordUpdated(dstIndex);
+    }
+
+    void RtProgramVars::updateHitRecordSources()
+    {
+        // Rebuilding the mapping needs a lookup per record, so only do it if some hit vars were replaced since the last call
+        bool varsReplaced = false;
+        for (uint32_t h = 0; h < mHitProgCount && !varsReplaced; h++)
+        {
+            for (uint32_t i = 0; i < (uint32_t)mHitVars[h].size(); i++)
+            {
+                if (mHitVars[h][i].get() != mRecordVars[getHitRecordIndex(h, i)])
+                {
+                    varsReplaced = true;
+                    break;
+                }
+            }
+        }
+        if (!varsReplaced) return;
+
+        // The first record using a vars object is its source. Records of the same hit program are ordered by mesh, so the source is always written before the records copied from it.
+        std::unordered_map<const GraphicsVars*, uint32_t> firstRecord;
+        for (uint32_t h = 0; h < mHitProgCount; h++)
+        {
+            firstRecord.clear();
+            for (uint32_t i = 0; i < (uint32_t)mHitVars[h].size(); i++)
+            {
+                uint32_t recordIndex = getHitRecordIndex(h, i);
+                mRecordSource[recordIndex] = firstRecord.emplace(mHitVars[h][i].get(), recordIndex).first->second;
+            }
+        }
     }
 
     bool RtProgramVars::updateSBT(RenderContext* pCtx, RtStateObject* pRtso)
     {
-        if (mpLastUsedRtpso == pRtso) return true;
+        // A new state object changes the shader identifiers, so every record is rewritten
+        bool rtsoChanged = (mpLastUsedRtpso != pRtso);
         mpLastUsedRtpso = pRtso;
 
+        mRecordUpdated.assign(mRecordUpdated.size(), false);
+        mFirstDirtyRecord = (uint32_t)mRecordUpdated.size();
+        mEndDirtyRecord = 0;
+
         {
             PROFILE("applyRayGen");
             // We always have a ray-gen program, apply it first
-            uint8_t* pRayGenRecord = getRayGenRecordPtr();
-            if (!applyRtProgramVars(pRayGenRecord, mpProgram->getRayGenProgram()->getActiveVersion().get(), pRtso, getRayGenVars().get(), mpRtVarsHelper.get()))
+            if (!applyRecord(kRayGenRecordIndex, mpProgram->getRayGenProgram()->getActiveVersion().get(), pRtso, getRayGenVars().get(), rtsoChanged))
             {
                 return false;
             }
@@ -192,19 +270,28 @@ namespace Falcor
 
         {
             PROFILE("applyHit");
+            updateHitRecordSources();
+
             // Loop over the rays
-            uint32_t hitCount = mpProgram->getHitProgramCount();
-            for (uint32_t h = 0; h < hitCount; h++)
+            for (uint32_t h = 0; h < mHitProgCount; h++)
             {
                 if (mpProgram->getHitProgram(h))
                 {
-                    uint32_t entriesPerRayType = mPerMeshHitEntry ? mpScene.lock()->getMeshCount() : 1;
-                    for (uint32_t i = 0; i < entriesPerRayType; i++)
+                    const RtProgramVersion* pProgVersion = mpProgram->getHitProgram(h)->getActiveVersion().get();
+                    for (uint32_t i = 0; i < (uint32_t)mHitVars[h].size(); i++)
                     {
-                        uint8_t* pHitRecord = getHitRecordPtr(h, i);
-                        if (!applyRtProgramVars(pHitRecord, mpProgram->getHitProgram(h)->getActiveVersion().get(), pRtso, getHitVars(h)[i].get(), mpRtVarsHelper.get()))
+                        uint32_t recordIndex = getHitRecordIndex(h, i);
+                        uint32_t sourceIndex = mRecordSource[recordIndex];
+                        if (sourceIndex == recordIndex)
+                        {
+                            if (!applyRecord(recordIndex, pProgVersion, pRtso, mHitVars[h][i].get(), rtsoChanged))
+                            {
+                                return false;
+                            }
+                        }
+                        else if (rtsoChanged || mRecordUpdated[sourceIndex] || mRecordVars[recordIndex] != mRecordVars[sourceIndex])
                         {
-                            return false;
+                            copyRecord(recordIndex, sourceIndex);
                         }
                     }
                 }
@@ -213,12 +300,11 @@ namespace Falcor
 
         {
             PROFILE("applyMiss");
-            for (uint32_t m = 0; m < mpProgram->getMissProgramCount(); m++)
+            for (uint32_t m = 0; m < mMissProgCount; m++)
             {
                 if (mpProgram->getMissProgram(m))
                 {
-                    uint8_t* pMissRecord = getMissRecordPtr(m);
-                    if (!applyRtProgramVars(pMissRecord, mpProgram->getMissProgram(m)->getActiveVersion().get(), pRtso, getMissVars(m).get(), mpRtVarsHelper.get()))
+                    if (!applyRecord(kFirstMissRecordIndex + m, mpProgram->getMissProgram(m)->getActiveVersion().get(), pRtso, getMissVars(m).get(), rtsoChanged))
                     {
                         return false;
                     }
@@ -226,9 +312,13 @@ namespace Falcor
             }
         }
 
+        // Upload the range of records that changed. In steady state nothing is uploaded.
+        if (mFirstDirtyRecord < mEndDirtyRecord)
         {
             PROFILE("updateSBT");
-            pCtx->updateBuffer(mpShaderTable.get(), mShaderTableData.data());
+            size_t offset = (size_t)mFirstDirtyRecord * mRecordSize;
+            size_t size = (size_t)(mEndDirtyRecord - mFirstDirtyRecord) * mRecordSize;
+            pCtx->updateBuffer(mpShaderTable.get(), mShaderTableData.data() + offset, offset, size);
         }
 
         return true;
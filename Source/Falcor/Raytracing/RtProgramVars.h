@@ -45,6 +45,9 @@ namespace Falcor
 
         static SharedPtr create(const RtProgram::SharedPtr& pProgram, const Scene::SharedPtr& pScene, bool perMeshHitEntry = true);
 
+        /** Get the hit vars of a ray type, one entry per mesh (or a single entry if the vars were created without per-mesh hit entries).
+            Entries may point to the same vars object. Meshes sharing a vars object share their bindings and their shader-table record is written once and copied.
+        */
         VarsVector& getHitVars(uint32_t rayID) { return mHitVars[rayID]; }
         const GraphicsVars::SharedPtr& getRayGenVars() { return mRayGenVars; }
         const GraphicsVars::SharedPtr& getMissVars(uint32_t rayID) { return mMissVars[rayID]; }
@@ -79,11 +82,23 @@ namespace Falcor
         uint8_t* getRayGenRecordPtr();
         uint8_t* getMissRecordPtr(uint32_t missId);
         uint8_t* getHitRecordPtr(uint32_t hitId, uint32_t meshId);
+        uint32_t getHitRecordIndex(uint32_t hitId, uint32_t meshId) const;
 
         bool init();
 
         bool updateSBT(RenderContext* pCtx, RtStateObject* pRtso);
+        bool applyRecord(uint32_t recordIndex, const RtProgramVersion* pProgVersion, RtStateObject* pRtso, GraphicsVars* pVars, bool rtsoChanged);
+        void copyRecord(uint32_t dstIndex, uint32_t srcIndex);
+        void markRecordUpdated(uint32_t recordIndex);
+        void updateHitRecordSources();
         const RtStateObject* mpLastUsedRtpso = nullptr;
+
+        // Shader-table dirty tracking. Only the records whose bindings changed are rewritten, and only the range of rewritten records is uploaded.
+        std::vector<const GraphicsVars*> mRecordVars;       ///< The vars last written into each record. Used to detect replaced vars.
+        std::vector<uint32_t> mRecordSource;                ///< For hit records, the record holding the same vars. Records sharing vars are written once and copied from the first one.
+        std::vector<bool> mRecordUpdated;                   ///< The records rewritten by the current updateSBT() call
+        uint32_t mFirstDirtyRecord = 0;
+        uint32_t mEndDirtyRecord = 0;
         GraphicsVars::SharedPtr mpGlobalVars;
         GraphicsVars::SharedPtr mRayGenVars;
         std::vector<VarsVector> mHitVars;
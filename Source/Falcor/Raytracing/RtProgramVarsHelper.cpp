@@ -102,6 +102,7 @@ namespace Falcor
 
     void RtVarsCmdList::SetGraphicsRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor)
     {
+        mRootParamsWritten = true;
         uint32_t rootOffset = mpRootSignature->getElementByteOffset(RootParameterIndex);
         *(uint64_t*)(mpRootBase + rootOffset) = BaseDescriptor.ptr;
     }
@@ -109,6 +110,7 @@ namespace Falcor
     void RtVarsCmdList::SetGraphicsRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues)
     {
         assert(DestOffsetIn32BitValues == 0);
+        mRootParamsWritten = true;
         uint32_t rootOffset = mpRootSignature->getElementByteOffset(RootParameterIndex);
         *(uint32_t*)(mpRootBase + rootOffset) = SrcData;
     }
@@ -120,6 +122,7 @@ namespace Falcor
 
     void RtVarsCmdList::SetGraphicsRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
     {
+        mRootParamsWritten = true;
         uint32_t rootOffset = mpRootSignature->getElementByteOffset(RootParameterIndex);
         assert((rootOffset % 8) == 0);
         *(D3D12_GPU_VIRTUAL_ADDRESS*)(mpRootBase + rootOffset) = BufferLocation;
@@ -127,6 +130,7 @@ namespace Falcor
 
     void RtVarsCmdList::SetGraphicsRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
     {
+        mRootParamsWritten = true;
         uint32_t rootOffset = mpRootSignature->getElementByteOffset(RootParameterIndex);
         assert((rootOffset % 8) == 0);
         *(D3D12_GPU_VIRTUAL_ADDRESS*)(mpRootBase + rootOffset) = BufferLocation;
@@ -134,6 +138,7 @@ namespace Falcor
 
     void RtVarsCmdList::SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
     {
+        mRootParamsWritten = true;
         uint32_t rootOffset = mpRootSignature->getElementByteOffset(RootParameterIndex);
         assert((rootOffset % 8) == 0);
         *(D3D12_GPU_VIRTUAL_ADDRESS*)(mpRootBase + rootOffset) = BufferLocation;
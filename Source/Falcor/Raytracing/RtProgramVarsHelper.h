@@ -45,7 +45,11 @@ namespace Falcor
         void SetGraphicsRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation);
         void SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation);
 
-        void setRootParams(RootSignature::SharedPtr pRoot, uint8_t* pBase) { mpRootBase = pBase; mpRootSignature = pRoot; }
+        void setRootParams(RootSignature::SharedPtr pRoot, uint8_t* pBase) { mpRootBase = pBase; mpRootSignature = pRoot; mRootParamsWritten = false; }
+
+        /** Check if any root parameter was written since the last call to setRootParams()
+        */
+        bool areRootParamsWritten() const { return mRootParamsWritten; }
 
         // The following functions should not be used
         HRESULT QueryInterface(REFIID riid, void **ppvObject);
@@ -132,6 +136,7 @@ namespace Falcor
         RtVarsCmdList() = default;
         uint8_t* mpRootBase;
         RootSignature::SharedPtr mpRootSignature;
+        bool mRootParamsWritten = false;
     };
 
     class dlldecl RtVarsContext : public CopyContext
@@ -408,6 +408,7 @@ namespace Falcor
         c.pGraphDictionary = mpPassDictionary;
         c.pRenderContext = pContext;
         c.profileGraph = mProfileGraph;
+        c.parallelRecording = mParallelRecording;
         c.defaultTexDims = mCompilerDeps.defaultResourceProps.dims;
         c.defaultTexFormat = mCompilerDeps.defaultResourceProps.format;
         mpExe->execute(c);
@@ -740,6 +741,8 @@ namespace Falcor
 
         widget.checkbox("Profile Passes", mProfileGraph);
         widget.tooltip("Profile the render-passes. The results will be shown in the profiler window. If you can't see it, click 'P'");
+        widget.checkbox("Parallel Recording", mParallelRecording);
+        widget.tooltip("Experimental. Record independent render-passes into separate command lists on worker threads. The passes must not share resources other than their inputs");
         if (mpExe) mpExe->renderUI(widget);
     }
 
@@ -765,6 +768,8 @@ namespace Falcor
         graphClass.func_("name", &RenderGraph::setName);
         graphClass.func_("name", &RenderGraph::getName);
         graphClass.func_("getPass", &RenderGraph::getPass);
+        graphClass.func_("parallelRecording", &RenderGraph::setParallelRecording);
+        graphClass.func_("parallelRecording", &RenderGraph::isParallelRecordingEnabled);
         auto printGraph = [](RenderGraph::SharedPtr pGraph) { pybind11::print(RenderGraphExporter::getIR(pGraph)); };
         graphClass.func_("print", printGraph);
         graphClass.func_("getOutput", ScriptBindings::overload_cast<const std::string&>(&RenderGraph::getOutput));
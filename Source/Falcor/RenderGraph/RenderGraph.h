@@ -171,6 +171,17 @@ namespace Falcor
         */
         void profileGraph(bool enabled) { mProfileGraph = enabled; }
 
+        /** Enable/disable parallel command list recording.
+            When enabled, passes without mutual dependencies are recorded into separate command lists on worker threads and submitted in execution order.
+            All the passes in the graph must be safe to execute concurrently with each other. Inputs shared by a level are transitioned on the main context before the level is recorded,
+            and scene rendering is serialized. Passes that change the state of resources other than their declared fields are not supported. Disabled by default.
+        */
+        void setParallelRecording(bool enabled) { mParallelRecording = enabled; }
+
+        /** Check if parallel command list recording is enabled
+        */
+        bool isParallelRecordingEnabled() const { return mParallelRecording; }
+
         /** Mouse event handler.
             Returns true if the event was handled by the object, false otherwise
         */
@@ -249,6 +260,7 @@ namespace Falcor
         bool isGraphOutput(const GraphOut& graphOut) const;
 
         bool mProfileGraph = true;
+        bool mParallelRecording = false;
         Dictionary::SharedPtr mpPassDictionary;
         RenderGraphExe::SharedPtr mpExe;
         bool mRecompile = false;
@@ -59,9 +59,20 @@ namespace Falcor
         auto pExe = RenderGraphExe::create();
         pExe->mExecutionList.reserve(c.mExecutionList.size());
 
+        // Assign each pass a dependency level. Passes only depend on passes from lower levels
+        std::unordered_map<uint32_t, uint32_t> nodeLevels;
         for (auto e : c.mExecutionList)
         {
-            pExe->insertPass(e.name, e.pPass);
+            uint32_t level = 0;
+            const DirectedGraph::Node* pNode = graph.mpGraph->getNode(e.index);
+            for (uint32_t i = 0; i < pNode->getIncomingEdgeCount(); i++)
+            {
+                uint32_t srcNode = graph.mpGraph->getEdge(pNode->getIncomingEdge(i))->getSourceNode();
+                auto it = nodeLevels.find(srcNode);
+                if (it != nodeLevels.end()) level = std::max(level, it->second + 1);
+            }
+            nodeLevels[e.index] = level;
+            pExe->insertPass(e.name, e.pPass, level, e.reflector);
         }
         c.restoreCompilationChanges();
         pExe->mpResourceCache = pResourcesCache;
@@ -30,22 +30,135 @@
 
 namespace Falcor
 {
+    namespace
+    {
+        Resource::State getInputState(const RenderPassReflection::Field& field)
+        {
+            ResourceBindFlags flags = field.getBindFlags();
+            if (is_set(flags, ResourceBindFlags::ShaderResource)) return Resource::State::ShaderResource;
+            if (is_set(flags, ResourceBindFlags::UnorderedAccess)) return Resource::State::UnorderedAccess;
+            if (is_set(flags, ResourceBindFlags::DepthStencil)) return Resource::State::DepthStencil;
+            if (is_set(flags, ResourceBindFlags::RenderTarget)) return Resource::State::RenderTarget;
+            return Resource::State::ShaderResource;
+        }
+    }
+
     void RenderGraphExe::execute(const Context& ctx)
     {
+        static const Profiler::EventId kExecuteEvent = Profiler::registerEvent("RenderGraphExe::execute()");
         bool profile = ctx.profileGraph && gProfileEnabled;
 
-        if (profile) Profiler::startEvent("RenderGraphExe::execute()");
+        if (profile) Profiler::startEvent(kExecuteEvent);
+
+        if (ctx.parallelRecording) executeParallel(ctx, profile);
+        else executeSerial(ctx, profile);
 
+        if (profile) Profiler::endEvent(kExecuteEvent);
+    }
+
+    void RenderGraphExe::executeSerial(const Context& ctx, bool profile)
+    {
         for (const auto& pass : mExecutionList)
         {
-            if (profile) Profiler::startEvent(pass.name);
+            if (profile) Profiler::startEvent(pass.profileId);
             RenderData renderData(pass.name, mpResourceCache, ctx.pGraphDictionary, ctx.defaultTexDims, ctx.defaultTexFormat);
             pass.pPass->execute(ctx.pRenderContext, renderData);
 
-            if (profile) Profiler::endEvent(pass.name);
+            if (profile) Profiler::endEvent(pass.profileId);
+        }
+    }
+
+    void RenderGraphExe::executeParallel(const Context& ctx, bool profile)
+    {
+        for (const auto& level : mLevels)
+        {
+            // Nothing to gain from a worker thread for a single pass.
+            // The same goes for levels where the passes read a shared resource in different states, since the workers would race on its state
+            if (level.passes.size() == 1 || transitionLevelInputs(ctx, level) == false)
+            {
+                for (uint32_t passIndex : level.passes)
+                {
+                    const auto& pass = mExecutionList[passIndex];
+                    if (profile) Profiler::startEvent(pass.profileId);
+                    RenderData renderData(pass.name, mpResourceCache, ctx.pGraphDictionary, ctx.defaultTexDims, ctx.defaultTexFormat);
+                    pass.pPass->execute(ctx.pRenderContext, renderData);
+                    if (profile) Profiler::endEvent(pass.profileId);
+                }
+                continue;
+            }
+
+            // Submit everything recorded so far, so that the worker command lists execute after it
+            ctx.pRenderContext->flush();
+
+            // The pass events of the workers nest under the same parent as in serial recording, so the reports match
+            uint32_t parentNode = profile ? Profiler::getCurrentNode() : 0;
+
+            // GPU time is only measured on the main thread, so the level is profiled as a whole. The workers only record the CPU time of each pass
+            if (profile) Profiler::startEvent(level.profileId);
+
+            std::vector<Threading::Task> tasks;
+            tasks.reserve(level.passes.size());
+            for (uint32_t i = 0; i < (uint32_t)level.passes.size(); i++)
+            {
+                const auto& pass = mExecutionList[level.passes[i]];
+                RenderContext* pWorkerCtx = getWorkerContext(i);
+                tasks.push_back(Threading::dispatchTask([&ctx, &pass, pWorkerCtx, profile, parentNode, this]()
+                {
+                    uint32_t prevNode = 0;
+                    if (profile)
+                    {
+                        prevNode = Profiler::setCurrentNode(parentNode);
+                        Profiler::startEvent(pass.profileId, Profiler::Flags::Internal);
+                    }
+                    RenderData renderData(pass.name, mpResourceCache, ctx.pGraphDictionary, ctx.defaultTexDims, ctx.defaultTexFormat);
+                    pass.pPass->execute(pWorkerCtx, renderData);
+                    if (profile)
+                    {
+                        Profiler::endEvent(pass.profileId, Profiler::Flags::Internal);
+                        Profiler::setCurrentNode(prevNode);
+                    }
+                }));
+            }
+
+            // Submit the command lists in execution order
+            for (uint32_t i = 0; i < (uint32_t)level.passes.size(); i++)
+            {
+                tasks[i].finish();
+                mpWorkerContexts[i]->flush();
+            }
+
+            if (profile) Profiler::endEvent(level.profileId);
         }
+    }
 
-        if (profile) Profiler::endEvent("RenderGraphExe::execute()");
+    bool RenderGraphExe::transitionLevelInputs(const Context& ctx, const Level& level)
+    {
+        // Resource state tracking isn't synchronized. The passes of a level only read their inputs, so once the inputs are in the right state the barriers the workers issue are no-ops and don't write the state
+        std::unordered_map<const Resource*, Resource::State> states;
+        for (uint32_t passIndex : level.passes)
+        {
+            for (const auto& input : mExecutionList[passIndex].inputs)
+            {
+                const Resource* pResource = mpResourceCache->getResource(input.name).get();
+                if (pResource == nullptr) continue;
+                auto it = states.emplace(pResource, input.state).first;
+                if (it->second != input.state) return false;
+            }
+        }
+
+        for (const auto& s : states) ctx.pRenderContext->resourceBarrier(s.first, s.second);
+        return true;
+    }
+
+    RenderContext* RenderGraphExe::getWorkerContext(uint32_t index)
+    {
+        while (mpWorkerContexts.size() <= index)
+        {
+            auto pCtx = RenderContext::create(gpDevice->getCommandQueueHandle(LowLevelContextData::CommandQueueType::Direct, 0));
+            pCtx->bindDescriptorHeaps();
+            mpWorkerContexts.push_back(pCtx);
+        }
+        return mpWorkerContexts[index].get();
     }
 
     void RenderGraphExe::renderUI(Gui::Widgets& widget)
@@ -89,9 +202,25 @@ namespace Falcor
         return b;
     }
 
-    void RenderGraphExe::insertPass(const std::string& name, const RenderPass::SharedPtr& pPass)
+    void RenderGraphExe::insertPass(const std::string& name, const RenderPass::SharedPtr& pPass, uint32_t level, const RenderPassReflection& reflection)
     {
-        mExecutionList.push_back(Pass(name, pPass));
+        if (mLevels.size() <= level) mLevels.resize(level + 1);
+        auto& l = mLevels[level];
+        l.passes.push_back((uint32_t)mExecutionList.size());
+        mExecutionList.push_back(Pass(name, pPass, level));
+
+        // Input/output fields are written by the pass, so other passes of the level can't access them
+        for (uint32_t i = 0; i < reflection.getFieldCount(); i++)
+        {
+            const auto& f = *reflection.getField(i);
+            if (f.getVisibility() != RenderPassReflection::Field::Visibility::Input) continue;
+            mExecutionList.back().inputs.push_back({ name + '.' + f.getName(), getInputState(f) });
+        }
+
+        // The level event is named after the passes it contains
+        std::string levelName;
+        for (uint32_t i : l.passes) levelName += (levelName.empty() ? "" : "|") + mExecutionList[i].name;
+        l.profileId = Profiler::registerEvent(levelName);
     }
 
     Resource::SharedPtr RenderGraphExe::getResource(const std::string& name) const
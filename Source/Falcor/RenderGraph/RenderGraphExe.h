@@ -43,6 +43,7 @@ namespace Falcor
             RenderContext* pRenderContext;
             Dictionary::SharedPtr pGraphDictionary;
             bool profileGraph;
+            bool parallelRecording;     ///< Record passes without mutual dependencies into separate command lists on worker threads
             uvec2 defaultTexDims;
             ResourceFormat defaultTexFormat;
         };
@@ -80,18 +81,46 @@ namespace Falcor
         static SharedPtr create() { return SharedPtr(new RenderGraphExe); }
         RenderGraphExe() = default;
 
-        void insertPass(const std::string& name, const RenderPass::SharedPtr& pPass);
+        /** Append a pass to the execution list
+            \param[in] name The pass name
+            \param[in] pPass The pass
+            \param[in] level The dependency level of the pass. A pass only depends on passes with a lower level, so passes that share a level can be recorded concurrently
+            \param[in] reflection The pass reflection. Used to find the inputs that are transitioned before recording the level in parallel
+        */
+        void insertPass(const std::string& name, const RenderPass::SharedPtr& pPass, uint32_t level, const RenderPassReflection& reflection);
+
+        struct Input
+        {
+            std::string name;                   // Full field name, `renderPassName.fieldName`
+            Resource::State state;              // The state the pass reads the resource in
+        };
 
         struct Pass
         {
             std::string name;
             RenderPass::SharedPtr pPass;
+            uint32_t level;
+            Profiler::EventId profileId;
+            std::vector<Input> inputs;          // Read-only inputs. Shared between the passes of a level
         private:
             friend class RenderGraphExe; // Force RenderGraphCompiler to use insertPass() by hiding this Ctor from it
-            Pass(const std::string& name_, const RenderPass::SharedPtr& pPass_) : name(name_), pPass(pPass_) {}
+            Pass(const std::string& name_, const RenderPass::SharedPtr& pPass_, uint32_t level_) : name(name_), pPass(pPass_), level(level_), profileId(Profiler::registerEvent(name_)) {}
         };
 
+        struct Level
+        {
+            std::vector<uint32_t> passes;       // Indices into mExecutionList
+            Profiler::EventId profileId;
+        };
+
+        void executeSerial(const Context& ctx, bool profile);
+        void executeParallel(const Context& ctx, bool profile);
+        bool transitionLevelInputs(const Context& ctx, const Level& level);
+        RenderContext* getWorkerContext(uint32_t index);
+
         std::vector<Pass> mExecutionList;
+        std::vector<Level> mLevels;                         // The passes, bucketed by dependency level
+        std::vector<RenderContext::SharedPtr> mpWorkerContexts;
         ResourceCache::SharedPtr mpResourceCache;
     };
 }
@@ -39,7 +39,8 @@ namespace Falcor
     }
 
     AnimationController::AnimationController(Scene* pScene, const StaticVertexVector& staticVertexData, const DynamicVertexVector& dynamicVertexData) :
-        mpScene(pScene), mLocalMatrices(pScene->mSceneGraph.size()), mInvTransposeGlobalMatrices(pScene->mSceneGraph.size()), mMatricesChanged(pScene->mSceneGraph.size())
+        mpScene(pScene), mLocalMatrices(pScene->mSceneGraph.size()), mInvTransposeGlobalMatrices(pScene->mSceneGraph.size()), mMatricesChanged(pScene->mSceneGraph.size()),
+        mWorldMatricesHandle(kWorldMatricesBufferName), mPrevWorldMatricesHandle(kPreviousWorldMatrices), mInvTransposeWorldMatricesHandle(kInverseTransposeWorldMatrices)
     {
         size_t l2wBufSize = mLocalMatrices.size() * 4;
         assert(l2wBufSize <= UINT32_MAX);
@@ -197,9 +198,9 @@ namespace Falcor
     void AnimationController::bindBuffers()
     {
         ParameterBlock* pBlock = mpScene->mpSceneBlock.get();
-        pBlock->setTypedBuffer(kWorldMatricesBufferName, mpWorldMatricesBuffer);
-        pBlock->setTypedBuffer(kPreviousWorldMatrices, mpPrevWorldMatricesBuffer);
-        pBlock->setTypedBuffer(kInverseTransposeWorldMatrices, mpInvTransposeWorldMatricesBuffer);
+        pBlock->setTypedBuffer(mWorldMatricesHandle, mpWorldMatricesBuffer);
+        pBlock->setTypedBuffer(mPrevWorldMatricesHandle, mpPrevWorldMatricesBuffer);
+        pBlock->setTypedBuffer(mInvTransposeWorldMatricesHandle, mpInvTransposeWorldMatricesBuffer);
     }
 
     void AnimationController::allocatePrevWorldMatrixBuffer()
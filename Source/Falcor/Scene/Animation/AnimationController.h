@@ -137,6 +137,9 @@ namespace Falcor
         TypedBuffer<float4>::SharedPtr mpWorldMatricesBuffer;
         TypedBuffer<float4>::SharedPtr mpPrevWorldMatricesBuffer;
         TypedBuffer<float4>::SharedPtr mpInvTransposeWorldMatricesBuffer;
+        ParameterBlock::BindingHandle mWorldMatricesHandle;
+        ParameterBlock::BindingHandle mPrevWorldMatricesHandle;
+        ParameterBlock::BindingHandle mInvTransposeWorldMatricesHandle;
 
         // Skinning
         ComputePass::SharedPtr mpSkinningPass;
@@ -34,6 +34,7 @@
 #include "Utils/StringUtils.h"
 #include "Core/API/Device.h"
 #include "Scene/SceneBuilder.h"
+#include "Scene/TextureRegistry.h"
 
 namespace Falcor
 {
@@ -106,6 +107,36 @@ namespace Falcor
             }
         }
 
+        /** Get the material slot a texture is sampled from when it's a virtual texture. Matches setTexture()
+        */
+        bool getVirtualTextureSlot(aiTextureType type, ImportMode importMode, Material::VirtualTextureSlot& slot)
+        {
+            switch (type)
+            {
+            case aiTextureType_DIFFUSE:
+                slot = Material::VirtualTextureSlot::BaseColor;
+                return true;
+            case aiTextureType_SPECULAR:
+                slot = Material::VirtualTextureSlot::Specular;
+                return true;
+            case aiTextureType_EMISSIVE:
+                slot = Material::VirtualTextureSlot::Emissive;
+                return true;
+            case aiTextureType_HEIGHT:
+            case aiTextureType_DISPLACEMENT:
+                slot = importMode == ImportMode::OBJ ? Material::VirtualTextureSlot::NormalMap : Material::VirtualTextureSlot::HeightMap;
+                return true;
+            case aiTextureType_NORMALS:
+                slot = Material::VirtualTextureSlot::NormalMap;
+                return true;
+            case aiTextureType_AMBIENT:
+                slot = Material::VirtualTextureSlot::OcclusionMap;
+                return true;
+            default:
+                return false;
+            }
+        }
+
         bool isSrgbRequired(aiTextureType aiType, bool isSrgbRequested, uint32_t shadingModel)
         {
             if (isSrgbRequested == false)
@@ -145,7 +176,6 @@ namespace Falcor
             SceneBuilder& builder;
             std::map<uint32_t, Material::SharedPtr> materialMap;
             std::map<uint32_t, size_t> meshMap;
-            std::map<const std::string, Texture::SharedPtr> textureCache;
             const SceneBuilder::InstanceMatrices& modelInstances;
             std::map<std::string, mat4> localToBindPoseMatrices;
 
@@ -696,24 +726,26 @@ namespace Falcor
                         continue;
                     }
 
-                    // Check if the texture was already loaded
-                    const auto& a = data.textureCache.find(s);
-                    if (a != data.textureCache.end())
-                    {
-                        pTex = a->second;
-                    }
-                    else
+                    std::string fullpath = folder + '/' + s;
+                    fullpath = replaceSubstring(fullpath, "\\", "/");
+                    bool srgb = isSrgbRequired(aiType, useSrgb, pMaterial->getShadingModel());
+
+                    // Virtual textures are only registered, their tiles are streamed once the shaders need them. Images which can't be virtualized are loaded as textures
+                    Material::VirtualTextureSlot slot;
+                    if (is_set(data.builder.getFlags(), SceneBuilder::Flags::UseVirtualTextures) && getVirtualTextureSlot(aiType, importMode, slot))
                     {
-                        // create a new texture
-                        std::string fullpath = folder + '/' + s;
-                        fullpath = replaceSubstring(fullpath, "\\", "/");
-                        pTex = Texture::createFromFile(fullpath, true, isSrgbRequired(aiType, useSrgb, pMaterial->getShadingModel()));
-                        if (pTex)
+                        ResourceFormat format;
+                        uint32_t id = data.builder.addVirtualTexture(fullpath, srgb, format);
+                        if (id != VirtualTextureCache::kInvalidTexture)
                         {
-                            data.textureCache[s] = pTex;
+                            pMaterial->setVirtualTexture(slot, id, format);
+                            continue;
                         }
                     }
 
+                    // The registry returns the existing texture if the same image was already loaded, by this or any other import
+                    pTex = TextureRegistry::load(fullpath, true, srgb);
+
                     assert(pTex != nullptr);
                     setTexture(aiType, importMode, pMaterial, pTex);
                 }
@@ -30,6 +30,8 @@
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include "Core/API/Device.h"
+#include "Scene/TextureRegistry.h"
+#include "Utils/Image/StreamingImageLoader.h"
 #include "glm/gtx/euler_angles.hpp"
 #include "glm/gtx/transform.hpp"
 #include <filesystem>
@@ -754,7 +756,8 @@ namespace Falcor
                 }
             }
 
-            LightProbe::SharedPtr pLightProbe = LightProbe::create(gpDevice->getRenderContext(), actualPath, true, ResourceFormat::RGBA16Float, diffuseSamples, specSamples);
+            LightProbe::SharedPtr pLightProbe = LightProbe::create(gpDevice->getRenderContext(), actualPath, true, ResourceFormat::RGBA16Float, diffuseSamples, specSamples,
+                LightProbe::kDefaultDiffSize, LightProbe::kDefaultSpecSize, ResourceFormat::RGBA16Float, mBuilder.getEnvMapOptions());
             pLightProbe->setPosW(position);
             pLightProbe->setIntensity(intensity);
             mBuilder.setLightProbe(pLightProbe);
@@ -1007,7 +1010,10 @@ namespace Falcor
             }
         }
 
-        auto pTex = Texture::createFromFile(filename, false, true);
+        // HDR images are streamed, so huge environment maps are never held as a full-size RGBA32Float copy. Other images are shared through the registry
+        Texture::SharedPtr pTex;
+        if (StreamingImageLoader::canStream(filename)) pTex = StreamingImageLoader::createTexture(filename, mBuilder.getEnvMapOptions(), false);
+        else pTex = TextureRegistry::load(filename, false, true);
         mBuilder.setEnvironmentMap(pTex);
         return true;
     }
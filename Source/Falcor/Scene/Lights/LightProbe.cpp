@@ -31,6 +31,7 @@
 #include "Utils/UI/Gui.h"
 #include "Core/API/RenderContext.h"
 #include "Core/API/Device.h"
+#include "Scene/TextureRegistry.h"
 
 namespace Falcor
 {
@@ -155,10 +156,17 @@ namespace Falcor
         }
     }
 
-    LightProbe::SharedPtr LightProbe::create(RenderContext* pContext, const std::string& filename, bool loadAsSrgb, ResourceFormat overrideFormat, uint32_t diffSampleCount, uint32_t specSampleCount, uint32_t diffSize, uint32_t specSize, ResourceFormat preFilteredFormat)
+    LightProbe::SharedPtr LightProbe::create(RenderContext* pContext, const std::string& filename, bool loadAsSrgb, ResourceFormat overrideFormat, uint32_t diffSampleCount, uint32_t specSampleCount, uint32_t diffSize, uint32_t specSize, ResourceFormat preFilteredFormat, const StreamingImageLoader::Options& streamingOptions)
     {
         Texture::SharedPtr pTexture;
-        if (overrideFormat != ResourceFormat::Unknown)
+        if (StreamingImageLoader::canStream(filename) && (overrideFormat == ResourceFormat::Unknown || StreamingImageLoader::isFormatSupported(overrideFormat)))
+        {
+            // HDR images are decoded straight into the final format, without a full-size copy in the original format
+            StreamingImageLoader::Options options = streamingOptions;
+            if (overrideFormat != ResourceFormat::Unknown) options.format = overrideFormat;
+            pTexture = StreamingImageLoader::createTexture(filename, options, true);
+        }
+        else if (overrideFormat != ResourceFormat::Unknown)
         {
             Texture::SharedPtr pOrigTex = Texture::createFromFile(filename, false, loadAsSrgb);
             pTexture = Texture::create2D(pOrigTex->getWidth(), pOrigTex->getHeight(), overrideFormat, 1, Texture::kMaxPossible, nullptr, Resource::BindFlags::RenderTarget | Resource::BindFlags::ShaderResource);
@@ -168,7 +176,7 @@ namespace Falcor
         }
         else
         {
-            pTexture = Texture::createFromFile(filename, true, loadAsSrgb);
+            pTexture = TextureRegistry::load(filename, true, loadAsSrgb);
         }
 
         return create(pContext, pTexture, diffSampleCount, specSampleCount, diffSize, specSize, preFilteredFormat);
@@ -29,6 +29,7 @@
 #include "Data/HostDeviceData.h"
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
+#include "Utils/Image/StreamingImageLoader.h"
 
 namespace Falcor
 {
@@ -60,8 +61,9 @@ namespace Falcor
             \param[in] diffSize The width and height of the pre-filtered diffuse texture. We always create a square texture.
             \param[in] specSize The width and height of the pre-filtered specular texture. We always create a square texture.
             \param[in] preFilteredFormat The format of the pre-filtered texture
+            \param[in] streamingOptions Format and maximum size of HDR and EXR files, which are streamed. overrideFormat replaces the format if the streaming loader supports it
         */
-        static SharedPtr create(RenderContext* pContext, const std::string& filename, bool loadAsSrgb, ResourceFormat overrideFormat = ResourceFormat::Unknown, uint32_t diffSampleCount = kDefaultDiffSamples, uint32_t specSampleCount = kDefaultSpecSamples, uint32_t diffSize = kDefaultDiffSize, uint32_t specSize = kDefaultSpecSize, ResourceFormat preFilteredFormat = ResourceFormat::RGBA16Float);
+        static SharedPtr create(RenderContext* pContext, const std::string& filename, bool loadAsSrgb, ResourceFormat overrideFormat = ResourceFormat::Unknown, uint32_t diffSampleCount = kDefaultDiffSamples, uint32_t specSampleCount = kDefaultSpecSamples, uint32_t diffSize = kDefaultDiffSize, uint32_t specSize = kDefaultSpecSize, ResourceFormat preFilteredFormat = ResourceFormat::RGBA16Float, const StreamingImageLoader::Options& streamingOptions = StreamingImageLoader::getEnvMapOptions());
 
         /** Create a light-probe from a texture
             \param[in] pContext The current render context to be used for pre-integration.
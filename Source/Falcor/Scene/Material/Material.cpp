@@ -29,6 +29,7 @@
 #include "Material.h"
 #include "Core/Program/GraphicsProgram.h"
 #include "Core/Program/ProgramVars.h"
+#include "Scene/VirtualTexturing/VirtualTextureData.h"
 
 namespace Falcor
 {
@@ -158,17 +159,17 @@ namespace Falcor
 
     void Material::updateBaseColorType()
     {
-        mData.flags = PACK_DIFFUSE_TYPE(mData.flags, getChannelMode(mData.resources.baseColor != nullptr, mData.baseColor));
+        mData.flags = PACK_DIFFUSE_TYPE(mData.flags, getChannelMode(mData.resources.baseColor != nullptr || mData.virtualBaseColor != kVirtualTextureInvalidId, mData.baseColor));
     }
 
     void Material::updateSpecularType()
     {
-        mData.flags = PACK_SPECULAR_TYPE(mData.flags, getChannelMode(mData.resources.specular != nullptr, mData.specular));
+        mData.flags = PACK_SPECULAR_TYPE(mData.flags, getChannelMode(mData.resources.specular != nullptr || mData.virtualSpecular != kVirtualTextureInvalidId, mData.specular));
     }
 
     void Material::updateEmissiveType()
     {
-        mData.flags = PACK_EMISSIVE_TYPE(mData.flags, getChannelMode(mData.resources.emissive != nullptr, mData.emissive * mData.emissiveFactor));
+        mData.flags = PACK_EMISSIVE_TYPE(mData.flags, getChannelMode(mData.resources.emissive != nullptr || mData.virtualEmissive != kVirtualTextureInvalidId, mData.emissive * mData.emissiveFactor));
     }
 
     void Material::updateOcclusionFlag()
@@ -177,10 +178,10 @@ namespace Falcor
         switch (EXTRACT_SHADING_MODEL(mData.flags))
         {
         case ShadingModelMetalRough:
-            hasMap = (mData.resources.specular != nullptr);
+            hasMap = (mData.resources.specular != nullptr || mData.virtualSpecular != kVirtualTextureInvalidId);
             break;
         case ShadingModelSpecGloss:
-            hasMap = (mData.resources.occlusionMap != nullptr);
+            hasMap = (mData.resources.occlusionMap != nullptr || mData.virtualOcclusionMap != kVirtualTextureInvalidId);
             break;
         default:
             should_not_get_here();
@@ -193,10 +194,15 @@ namespace Falcor
     {
         mParamBlockDirty = mParamBlockDirty || (mData.resources.normalMap != pNormalMap);
         mData.resources.normalMap = pNormalMap;
+        updateNormalMapType(pNormalMap ? pNormalMap->getFormat() : ResourceFormat::Unknown);
+    }
+
+    void Material::updateNormalMapType(ResourceFormat format)
+    {
         uint32_t normalMode = NormalMapUnused;
-        if (pNormalMap)
+        if (format != ResourceFormat::Unknown)
         {
-            switch(getFormatChannelCount(pNormalMap->getFormat()))
+            switch(getFormatChannelCount(format))
             {
             case 2:
                 normalMode = NormalMapRG;
@@ -233,8 +239,93 @@ namespace Falcor
     {
         mParamBlockDirty = mParamBlockDirty || (mData.resources.heightMap != pHeightMap);
         mData.resources.heightMap = pHeightMap;
-        mData.flags = PACK_HEIGHT_MAP(mData.flags, pHeightMap ? 1 : 0);
+        updateHeightMapFlag();
+        mParamBlockDirty = true;
+    }
+
+    void Material::updateHeightMapFlag()
+    {
+        bool hasMap = (mData.resources.heightMap != nullptr || mData.virtualHeightMap != kVirtualTextureInvalidId);
+        mData.flags = PACK_HEIGHT_MAP(mData.flags, hasMap ? 1 : 0);
+    }
+
+    void Material::setVirtualTexture(VirtualTextureSlot slot, uint32_t id, ResourceFormat format)
+    {
+        bool isVirtual = (id != kVirtualTextureInvalidId);
         mParamBlockDirty = true;
+        switch (slot)
+        {
+        case VirtualTextureSlot::BaseColor:
+            mData.virtualBaseColor = id;
+            if (isVirtual)
+            {
+                mData.resources.baseColor = nullptr;
+                setAlphaMode(doesFormatHasAlpha(format) ? AlphaModeMask : AlphaModeOpaque);
+            }
+            updateBaseColorType();
+            break;
+        case VirtualTextureSlot::Specular:
+            mData.virtualSpecular = id;
+            if (isVirtual) mData.resources.specular = nullptr;
+            updateSpecularType();
+            updateOcclusionFlag();
+            break;
+        case VirtualTextureSlot::Emissive:
+            mData.virtualEmissive = id;
+            if (isVirtual) mData.resources.emissive = nullptr;
+            updateEmissiveType();
+            break;
+        case VirtualTextureSlot::NormalMap:
+            mData.virtualNormalMap = id;
+            if (isVirtual) mData.resources.normalMap = nullptr;
+            else format = mData.resources.normalMap ? mData.resources.normalMap->getFormat() : ResourceFormat::Unknown;
+            updateNormalMapType(format);
+            break;
+        case VirtualTextureSlot::OcclusionMap:
+            mData.virtualOcclusionMap = id;
+            if (isVirtual) mData.resources.occlusionMap = nullptr;
+            updateOcclusionFlag();
+            break;
+        case VirtualTextureSlot::HeightMap:
+            mData.virtualHeightMap = id;
+            if (isVirtual) mData.resources.heightMap = nullptr;
+            updateHeightMapFlag();
+            break;
+        default:
+            should_not_get_here();
+        }
+    }
+
+    uint32_t Material::getVirtualTexture(VirtualTextureSlot slot) const
+    {
+        switch (slot)
+        {
+        case VirtualTextureSlot::BaseColor: return mData.virtualBaseColor;
+        case VirtualTextureSlot::Specular: return mData.virtualSpecular;
+        case VirtualTextureSlot::Emissive: return mData.virtualEmissive;
+        case VirtualTextureSlot::NormalMap: return mData.virtualNormalMap;
+        case VirtualTextureSlot::OcclusionMap: return mData.virtualOcclusionMap;
+        case VirtualTextureSlot::HeightMap: return mData.virtualHeightMap;
+        default:
+            should_not_get_here();
+            return kVirtualTextureInvalidId;
+        }
+    }
+
+    Texture::SharedPtr Material::getTexture(VirtualTextureSlot slot) const
+    {
+        switch (slot)
+        {
+        case VirtualTextureSlot::BaseColor: return mData.resources.baseColor;
+        case VirtualTextureSlot::Specular: return mData.resources.specular;
+        case VirtualTextureSlot::Emissive: return mData.resources.emissive;
+        case VirtualTextureSlot::NormalMap: return mData.resources.normalMap;
+        case VirtualTextureSlot::OcclusionMap: return mData.resources.occlusionMap;
+        case VirtualTextureSlot::HeightMap: return mData.resources.heightMap;
+        default:
+            should_not_get_here();
+            return nullptr;
+        }
     }
 
     bool Material::operator==(const Material& other) const 
@@ -248,6 +339,12 @@ namespace Falcor
         compare_field(IoR);
         compare_field(flags);
         compare_field(heightScaleOffset);
+        compare_field(virtualBaseColor);
+        compare_field(virtualSpecular);
+        compare_field(virtualEmissive);
+        compare_field(virtualNormalMap);
+        compare_field(virtualOcclusionMap);
+        compare_field(virtualHeightMap);
 #undef compare_field
 
 #define compare_texture(_a) if (mData.resources._a != other.mData.resources._a) return false
@@ -67,6 +67,19 @@ namespace Falcor
         using ConstSharedPtrRef = const SharedPtr&;
         using SharedConstPtr = std::shared_ptr<const Material>;
 
+        /** Texture slots which can be sampled from a virtual texture. The light map isn't sampled by the shading code, so it's not included
+        */
+        enum class VirtualTextureSlot
+        {
+            BaseColor,
+            Specular,
+            Emissive,
+            NormalMap,
+            OcclusionMap,
+            HeightMap,
+            Count
+        };
+
         /** Create a new material.
             \param[in] name The material name
         */
@@ -146,6 +159,21 @@ namespace Falcor
         */
         Texture::SharedPtr getHeightMap() const { return mData.resources.heightMap; }
 
+        /** Set the virtual texture a slot is sampled from. It replaces the texture of the slot, which is released
+            \param[in] slot The texture slot
+            \param[in] id The texture ID in the scene's VirtualTextureSystem, or kVirtualTextureInvalidId to use the texture of the slot
+            \param[in] format The format of the virtual texture. Like the format of a texture, it selects the alpha mode of a base color and the mode of a normal map
+        */
+        void setVirtualTexture(VirtualTextureSlot slot, uint32_t id, ResourceFormat format);
+
+        /** Get the virtual texture ID of a slot, or kVirtualTextureInvalidId if the slot doesn't use one
+        */
+        uint32_t getVirtualTexture(VirtualTextureSlot slot) const;
+
+        /** Get the texture of a slot
+        */
+        Texture::SharedPtr getTexture(VirtualTextureSlot slot) const;
+
         /** Set the base color
         */
         void setBaseColor(const vec4& color);
@@ -264,6 +292,8 @@ namespace Falcor
         void updateSpecularType();
         void updateEmissiveType();
         void updateOcclusionFlag();
+        void updateNormalMapType(ResourceFormat format);
+        void updateHeightMapFlag();
         
         Material(const std::string& name);
         std::string mName;
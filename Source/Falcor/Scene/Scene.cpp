@@ -29,6 +29,7 @@
 #include "Scene.h"
 #include "Raytracing/RtState.h"
 #include "Raytracing/RtProgramVars.h"
+#include "TextureRegistry.h"
 
 namespace Falcor
 {
@@ -47,6 +48,7 @@ namespace Falcor
         const std::string kVertexBufferName = "vertices";
         const std::string kLightsBufferName = "lights";
         const std::string kCameraVarName = "camera";
+        const char kVirtualTexturesVarName[] = "virtualTextures";
     }
 
     const FileDialogFilterVec Scene::kFileExtensionFilters =
@@ -107,12 +109,14 @@ namespace Falcor
     {
         Shader::DefineList defines;
         defines.add("MATERIAL_COUNT", std::to_string(mMaterials.size()));
+        if (mpVirtualTextures) defines.add("_VIRTUAL_TEXTURES");
         return defines;
     }
 
     void Scene::render(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, RenderFlags flags)
     {
         PROFILE("renderScene");
+        std::lock_guard<std::mutex> lock(mRenderMutex);
 
         pState->setVao(mpVao);
         pVars->setParameterBlock("gScene", mpSceneBlock);
@@ -143,6 +147,8 @@ namespace Falcor
 
     void Scene::raytrace(RenderContext* pContext, const std::shared_ptr<RtState>& pState, const std::shared_ptr<RtProgramVars>& pRtVars, uvec3 dispatchDims)
     {
+        std::lock_guard<std::mutex> lock(mRenderMutex);
+
         // On first execution, create BLAS for each mesh
         if (mBlasData.empty())
         {
@@ -172,8 +178,10 @@ namespace Falcor
 
         {
             PROFILE("applyRtVars");
-            // Bind Scene Param Block
             const GraphicsVars::SharedPtr& pGlobalVars = pRtVars->getGlobalVars();
+            pState->getProgram()->bindRuntimeDefines(pGlobalVars.get());
+
+            // Bind Scene Param Block
             mCamera.pObject->setIntoConstantBuffer(mpSceneBlock->getDefaultConstantBuffer().get(), kCameraVarName);
             pGlobalVars->setParameterBlock("gScene", mpSceneBlock);
 
@@ -325,6 +333,7 @@ namespace Falcor
         updateCamera(true);
         updateLights(true);
         uploadResources(); // Upload data after initialization is complete
+        if (mpVirtualTextures) updateVirtualTextures(gpDevice->getRenderContext());
 
         if (mpAnimationController->getMeshAnimationCount(0)) mpAnimationController->setActiveAnimation(0, 0);
     }
@@ -432,6 +441,7 @@ namespace Falcor
 
         mUpdates |= updateCamera(false);
         mUpdates |= updateLights(false);
+        if (mpVirtualTextures) updateVirtualTextures(pContext);
         pContext->flush();
         if (is_set(mUpdates, UpdateFlags::MeshesMoved))
         {
@@ -449,6 +459,19 @@ namespace Falcor
         return mUpdates;
     }
 
+    void Scene::endFrame(RenderContext* pContext)
+    {
+        if (mpVirtualTextures) mpVirtualTextures->endFrame(pContext);
+    }
+
+    void Scene::updateVirtualTextures(RenderContext* pContext)
+    {
+        PROFILE("updateVirtualTextures");
+        mpVirtualTextures->update(pContext);
+        // The frame index changes every frame, and the buffers when textures are added
+        mpVirtualTextures->setIntoParameterBlock(mpSceneBlock.get(), kVirtualTexturesVarName);
+    }
+
     void Scene::renderUI(Gui::Widgets& widget)
     {
         mpAnimationController->renderUI(widget);
@@ -487,10 +510,55 @@ namespace Falcor
             lightsGroup.release();
         }
 
+        if (mpVirtualTextures)
+        {
+            auto virtualTexturesGroup = Gui::Group(widget, "Virtual Textures");
+            if (virtualTexturesGroup.open())
+            {
+                mpVirtualTextures->renderUI(virtualTexturesGroup);
+                virtualTexturesGroup.release();
+            }
+        }
+
+        auto texturesGroup = Gui::Group(widget, "Textures");
+        if (texturesGroup.open())
+        {
+            std::vector<Texture::SharedPtr> textures = getTextures();
+            std::vector<const Texture*> texturePtrs;
+            texturePtrs.reserve(textures.size());
+            for (const auto& pTexture : textures) texturePtrs.push_back(pTexture.get());
+
+            uint64_t generation = TextureRegistry::getGeneration();
+            if (mTextureReport.empty() || generation != mTextureReportGeneration || texturePtrs != mTextureReportTextures)
+            {
+                mTextureReport = TextureRegistry::getReport(textures);
+                mTextureReportTextures = std::move(texturePtrs);
+                mTextureReportGeneration = generation;
+            }
+            texturesGroup.text(mTextureReport);
+            texturesGroup.release();
+        }
+
         // Filtering mode
         // Camera controller
     }
 
+    std::vector<Texture::SharedPtr> Scene::getTextures() const
+    {
+        std::vector<Texture::SharedPtr> textures;
+        for (const auto& pMaterial : mMaterials)
+        {
+            for (const auto& pTexture : { pMaterial->getBaseColorTexture(), pMaterial->getSpecularTexture(), pMaterial->getEmissiveTexture(), pMaterial->getNormalMap(),
+                pMaterial->getOcclusionMap(), pMaterial->getLightMap(), pMaterial->getHeightMap() })
+            {
+                if (pTexture) textures.push_back(pTexture);
+            }
+        }
+        if (mpLightProbe && mpLightProbe->getOrigTexture()) textures.push_back(mpLightProbe->getOrigTexture());
+        if (mpEnvMap) textures.push_back(mpEnvMap);
+        return textures;
+    }
+
     void Scene::resetCamera(bool resetDepthRange)
     {
         float radius = length(mSceneBB.extent);
@@ -873,17 +941,27 @@ namespace Falcor
 
     void Scene::setGeometryIndexIntoRtVars(const std::shared_ptr<RtProgramVars>& pRtVars)
     {
-        // Set BLAS geometry index as constant buffer data
+        // Set BLAS geometry index as constant buffer data.
+        // The geometry index is the only per-mesh data, so meshes with the same geometry index share their vars. RtProgramVars writes a single shader-table record for them and copies it.
         for (uint32_t ray = 0; ray < pRtVars->getHitProgramsCount(); ray++)
         {
             RtProgramVars::VarsVector& rayVars = pRtVars->getHitVars(ray);
+            RtProgramVars::VarsVector sharedVars;
 
             uint32_t blasIndex = 0;
             uint32_t geometryIndex = 0;
             for (uint32_t i = 0; i < rayVars.size(); i++)
             {
-                auto& pVar = rayVars[i];
-                pVar["DxrPerGeometry"]["geometryIndex"] = geometryIndex++;
+                if (geometryIndex < sharedVars.size())
+                {
+                    rayVars[i] = sharedVars[geometryIndex];
+                }
+                else
+                {
+                    rayVars[i]["DxrPerGeometry"]["geometryIndex"] = geometryIndex;
+                    sharedVars.push_back(rayVars[i]);
+                }
+                geometryIndex++;
 
                 // If at the end of this BLAS, reset counters and start checking next BLAS
                 uint32_t geomCount = (uint32_t)mBlasData[blasIndex].meshList.size();
@@ -36,6 +36,7 @@
 #include "Utils/Math/AABB.h"
 #include "Animation/AnimationController.h"
 #include "Camera/CameraController.h"
+#include "VirtualTexturing/VirtualTextureSystem.h"
 
 namespace Falcor
 {
@@ -216,6 +217,10 @@ namespace Falcor
         */
         UpdateFlags update(RenderContext* pContext, double currentTime);
 
+        /** Finish the frame. Call this once per frame after the last pass which renders the scene, so the virtual texture feedback is read back
+        */
+        void endFrame(RenderContext* pContext);
+
         /** Get the changes that happened during the last update
             The flags only change during an `update()` call, if something changed between calling `update()` and `getUpdates()`, the returned result will not reflect it
         */
@@ -249,6 +254,11 @@ namespace Falcor
         */
         Texture::ConstSharedPtrRef getEnvironmentMap() const { return mpEnvMap; }
 
+        /** Get the virtual texture system which streams the textures of the materials, or nullptr if the scene wasn't built with SceneBuilder::Flags::UseVirtualTextures.
+            Passes which write virtual texture feedback should set the frame size with VirtualTextureSystem::setFrameSize()
+        */
+        const VirtualTextureSystem::SharedPtr& getVirtualTextureSystem() const { return mpVirtualTextures; }
+
         /** Handle mouse events
         */
         bool onMouseEvent(const MouseEvent& mouseEvent);
@@ -296,6 +306,14 @@ namespace Falcor
         */
         void updateBounds();
 
+        /** Stream the virtual textures the last frames needed and bind them into the parameter block
+        */
+        void updateVirtualTextures(RenderContext* pContext);
+
+        /** Get the textures used by the materials, the light probe and the environment map
+        */
+        std::vector<Texture::SharedPtr> getTextures() const;
+
         /** Update mesh instance flags
         */
         void updateMeshInstanceFlags();
@@ -387,6 +405,12 @@ namespace Falcor
         std::vector<AnimatedObject<Light>> mLights;         ///< Bound to parameter block
         LightProbe::SharedPtr mpLightProbe;                 ///< Bound to parameter block
         Texture::SharedPtr mpEnvMap;                        ///< Not bound to anything, not rendered automatically. Can be used to render a skybox
+        VirtualTextureSystem::SharedPtr mpVirtualTextures;  ///< Bound to parameter block. Only created with SceneBuilder::Flags::UseVirtualTextures
+
+        // Texture report shown in the UI. Only rebuilt when the registry or the scene's textures change
+        std::string mTextureReport;
+        std::vector<const Texture*> mTextureReportTextures;      ///< Not owned, only compared against
+        uint64_t mTextureReportGeneration = 0;
 
         // Scene Metadata (CPU Only)
         std::vector<BoundingBox> mMeshBBs;                          ///< Bounding boxes for meshes (not instances)
@@ -399,6 +423,7 @@ namespace Falcor
         StructuredBuffer::SharedPtr mpMeshInstancesBuffer;
         StructuredBuffer::SharedPtr mpLightsBuffer;
         ParameterBlock::SharedPtr mpSceneBlock;
+        std::mutex mRenderMutex;                                    ///< Serializes render() and raytrace(). Passes of a render graph level may be recorded on several threads
 
         // Camera
         CameraControllerType mCamCtrlType = CameraControllerType::FirstPerson;
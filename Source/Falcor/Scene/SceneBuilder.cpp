@@ -404,6 +404,7 @@ namespace Falcor
         pScene->mpVao = createVao(drawCount);
         calculateMeshBoundingBoxes(pScene.get());
         createAnimationController(pScene.get());
+        if (is_set(mFlags, Flags::UseVirtualTextures)) createVirtualTextures(pScene.get());
         pScene->finalize();
 
         return pScene;
@@ -448,4 +449,45 @@ namespace Falcor
             }
         }
     }
+
+    uint32_t SceneBuilder::addVirtualTexture(const std::string& filename, bool loadAsSrgb, ResourceFormat& format)
+    {
+        if (!mpVirtualTextures) mpVirtualTextures = VirtualTextureSystem::create(mVirtualTextureDesc);
+        uint32_t id = mpVirtualTextures->addTexture(filename, loadAsSrgb);
+        format = mpVirtualTextures->getTextureFormat(id);
+        return id;
+    }
+
+    void SceneBuilder::createVirtualTextures(Scene* pScene)
+    {
+        if (!mpVirtualTextures) mpVirtualTextures = VirtualTextureSystem::create(mVirtualTextureDesc);
+        pScene->mpVirtualTextures = mpVirtualTextures;
+
+        // The importers register the textures they load. Convert the textures of the materials which were created with full textures, e.g. from scripts
+        for (const auto& pMaterial : pScene->mMaterials)
+        {
+            // The alpha mode may have been set explicitly, so it's kept
+            uint32_t alphaMode = pMaterial->getAlphaMode();
+            for (uint32_t i = 0; i < (uint32_t)Material::VirtualTextureSlot::Count; i++)
+            {
+                auto slot = (Material::VirtualTextureSlot)i;
+                Texture::SharedPtr pTexture = pMaterial->getTexture(slot);
+                if (!pTexture || pTexture->getSourceFilename().empty()) continue;
+
+                // Textures which can't be virtualized keep the full texture
+                uint32_t id = mpVirtualTextures->addTexture(pTexture->getSourceFilename(), isSrgbFormat(pTexture->getFormat()));
+                if (id == VirtualTextureCache::kInvalidTexture) continue;
+                pMaterial->setVirtualTexture(slot, id, mpVirtualTextures->getTextureFormat(id));
+            }
+            pMaterial->setAlphaMode(alphaMode);
+        }
+    }
+
+    SCRIPT_BINDING(SceneBuilder)
+    {
+        auto flags = m.enum_<SceneBuilder::Flags>("SceneBuilderFlags");
+        flags.regEnumVal(SceneBuilder::Flags::None).regEnumVal(SceneBuilder::Flags::RemoveDuplicateMaterials).regEnumVal(SceneBuilder::Flags::UseOriginalTangentSpace);
+        flags.regEnumVal(SceneBuilder::Flags::AssumeLinearSpaceTextures).regEnumVal(SceneBuilder::Flags::DontMergeMeshes).regEnumVal(SceneBuilder::Flags::BuffersAsShaderResource);
+        flags.regEnumVal(SceneBuilder::Flags::UseSpecGlossMaterials).regEnumVal(SceneBuilder::Flags::UseMetalRoughMaterials).regEnumVal(SceneBuilder::Flags::UseVirtualTextures);
+    }
 }
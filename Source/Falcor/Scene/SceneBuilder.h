@@ -48,6 +48,7 @@ namespace Falcor
             BuffersAsShaderResource     = 0x10,   ///< Generate the VBs and IB with the shader-resource-view bind flag
             UseSpecGlossMaterials       = 0x20,   ///< Set materials to use Spec-Gloss shading model. Otherwise default is Spec-Gloss for OBJ, Metal-Rough for everything else
             UseMetalRoughMaterials      = 0x40,   ///< Set materials to use Metal-Rough shading model. Otherwise default is Spec-Gloss for OBJ, Metal-Rough for everything else
+            UseVirtualTextures          = 0x80,   ///< Stream the material textures through a VirtualTextureSystem, so only the tiles the GBuffer raster pass needs are resident. Importers register the images without loading them. Light maps are still loaded as textures
 
             Default = RemoveDuplicateMaterials
         };
@@ -145,6 +146,14 @@ namespace Falcor
         */
         void setEnvironmentMap(Texture::ConstSharedPtrRef pEnvMap) { mpEnvMap = pEnvMap; }
 
+        /** Set the format and maximum size of the environment map and light probe when they are streamed from HDR or EXR files. Call it before import()
+        */
+        void setEnvMapOptions(const StreamingImageLoader::Options& options) { mEnvMapOptions = options; }
+
+        /** Get the format and maximum size of streamed environment maps and light probes
+        */
+        const StreamingImageLoader::Options& getEnvMapOptions() const { return mEnvMapOptions; }
+
         /** Set the camera
         */
         void setCamera(const Camera::SharedPtr& pCamera, size_t nodeID = kInvalidNode);
@@ -167,6 +176,19 @@ namespace Falcor
         /** Check if a camera exists
         */
         bool hasCamera() const { return mCamera.pObject != nullptr; }
+
+        /** Set the memory budget and streaming options of the virtual textures. Only used with Flags::UseVirtualTextures.
+            Must be called before the first virtual texture is added, which the importers do while loading the scene
+        */
+        void setVirtualTextureDesc(const VirtualTextureSystem::Desc& desc) { mVirtualTextureDesc = desc; }
+
+        /** Add an image to the virtual textures of the scene, without loading it as a texture. Used by the importers with Flags::UseVirtualTextures
+            \param[in] filename Image file
+            \param[in] loadAsSrgb Interpret the color channels as sRGB
+            \param[out] format The format of the virtual texture
+            \return The virtual texture ID to pass to Material::setVirtualTexture(), or kVirtualTextureInvalidId if the image can't be added
+        */
+        uint32_t addVirtualTexture(const std::string& filename, bool loadAsSrgb, ResourceFormat& format);
     private:
         struct InternalNode : Node
         {
@@ -214,7 +236,10 @@ namespace Falcor
         std::vector<Scene::AnimatedObject<Light>> mLights;
         LightProbe::SharedPtr mpLightProbe;
         Texture::SharedPtr mpEnvMap;
+        StreamingImageLoader::Options mEnvMapOptions = StreamingImageLoader::getEnvMapOptions();
         float mCameraSpeed = 1.0f;
+        VirtualTextureSystem::Desc mVirtualTextureDesc;
+        VirtualTextureSystem::SharedPtr mpVirtualTextures;
 
         uint32_t addMaterial(const Material::SharedPtr& pMaterial, bool forceNew);
         Vao::SharedPtr createVao(uint16_t drawCount);
@@ -223,8 +248,30 @@ namespace Falcor
         void createGlobalMatricesBuffer(Scene* pScene);
         void calculateMeshBoundingBoxes(Scene* pScene);
         void createAnimationController(Scene* pScene);
+        void createVirtualTextures(Scene* pScene);
         std::string mFilename;
 };
 
     enum_class_operators(SceneBuilder::Flags);
+
+#define flag2str(f_) case SceneBuilder::Flags::f_: return #f_
+    inline std::string to_string(SceneBuilder::Flags f)
+    {
+        switch (f)
+        {
+            flag2str(None);
+            flag2str(RemoveDuplicateMaterials);
+            flag2str(UseOriginalTangentSpace);
+            flag2str(AssumeLinearSpaceTextures);
+            flag2str(DontMergeMeshes);
+            flag2str(BuffersAsShaderResource);
+            flag2str(UseSpecGlossMaterials);
+            flag2str(UseMetalRoughMaterials);
+            flag2str(UseVirtualTextures);
+        default:
+            should_not_get_here();
+            return "";
+        }
+    }
+#undef flag2str
 }
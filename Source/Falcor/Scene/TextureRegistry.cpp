@@ -0,0 +1,407 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "TextureRegistry.h"
+#include <filesystem>
+#include <unordered_set>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+        const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+        const uint64_t kPrime3 = 0x165667B19E3779F9ull;
+        const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+        const uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+        inline uint64_t rotl(uint64_t x, uint32_t r) { return (x << r) | (x >> (64 - r)); }
+        inline uint64_t read64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+        inline uint32_t read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+        inline uint64_t hashRound(uint64_t acc, uint64_t input)
+        {
+            acc += input * kPrime2;
+            return rotl(acc, 31) * kPrime1;
+        }
+
+        inline uint64_t hashMerge(uint64_t acc, uint64_t v)
+        {
+            acc ^= hashRound(0, v);
+            return acc * kPrime1 + kPrime4;
+        }
+
+        struct Key
+        {
+            uint64_t contentHash;
+            bool generateMipLevels;
+            bool loadAsSrgb;
+            Texture::BindFlags bindFlags;
+
+            bool operator==(const Key& other) const
+            {
+                return contentHash == other.contentHash && generateMipLevels == other.generateMipLevels && loadAsSrgb == other.loadAsSrgb && bindFlags == other.bindFlags;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& k) const
+            {
+                return (size_t)(k.contentHash ^ ((uint64_t)k.bindFlags << 2) ^ ((uint64_t)k.generateMipLevels << 1) ^ (uint64_t)k.loadAsSrgb);
+            }
+        };
+
+        struct Entry
+        {
+            std::weak_ptr<Texture> pTexture;
+            std::string filename;
+            uint32_t loadCount = 0;
+            uint64_t sizeInBytes = 0;
+        };
+
+        /** Content hash of a file, remembered so a file is only hashed again if it changed
+        */
+        struct FileHash
+        {
+            time_t modifiedTime;
+            size_t size;
+            uint64_t hash;
+        };
+
+        struct
+        {
+            std::mutex mutex;
+            std::condition_variable loadedCV;                       // Signaled when a load finishes
+            std::unordered_map<Key, Entry, KeyHash> entries;
+            std::unordered_set<Key, KeyHash> loading;               // Keys which are being loaded. Other threads wait for the load instead of loading the same texture
+            std::unordered_map<std::string, FileHash> fileHashes;   // Full path -> content hash
+            TextureRegistry::Stats stats;
+            uint64_t generation = 0;                                // Incremented when the entries or the statistics change
+        } gRegistry;
+
+        /** Get the content hash of a file. Returns false if the file can't be read. The file is hashed without holding gRegistry.mutex
+        */
+        bool getFileHash(const std::string& fullpath, uint64_t& hash)
+        {
+            time_t modifiedTime = getFileModifiedTime(fullpath);
+            std::error_code ec;
+            size_t fileSize = (size_t)std::filesystem::file_size(fullpath, ec);
+            if (ec) return false;
+
+            {
+                std::lock_guard<std::mutex> lock(gRegistry.mutex);
+                auto it = gRegistry.fileHashes.find(fullpath);
+                if (it != gRegistry.fileHashes.end() && it->second.modifiedTime == modifiedTime && it->second.size == fileSize)
+                {
+                    hash = it->second.hash;
+                    return true;
+                }
+            }
+
+            size_t size = 0;
+            const void* pData = mapFile(fullpath, size);
+            if (!pData) return false;
+            hash = TextureRegistry::hash(pData, size);
+            unmapFile(pData, size);
+
+            std::lock_guard<std::mutex> lock(gRegistry.mutex);
+            gRegistry.fileHashes[fullpath] = { modifiedTime, size, hash };
+            return true;
+        }
+
+        /** Drop the entries whose texture was released. gRegistry.mutex must be held
+        */
+        void removeExpiredEntries()
+        {
+            for (auto it = gRegistry.entries.begin(); it != gRegistry.entries.end();)
+            {
+                if (it->second.pTexture.expired())
+                {
+                    it = gRegistry.entries.erase(it);
+                    gRegistry.generation++;
+                }
+                else ++it;
+            }
+        }
+
+        /** Get the live textures, largest first. If pFilter isn't null, only the textures in it are returned. gRegistry.mutex must be held
+        */
+        std::vector<TextureRegistry::TextureInfo> collectTextures(const std::unordered_set<const Texture*>* pFilter)
+        {
+            removeExpiredEntries();
+
+            std::vector<TextureRegistry::TextureInfo> textures;
+            textures.reserve(pFilter ? pFilter->size() : gRegistry.entries.size());
+            for (const auto& e : gRegistry.entries)
+            {
+                if (pFilter)
+                {
+                    Texture::SharedPtr pTexture = e.second.pTexture.lock();
+                    if (pFilter->count(pTexture.get()) == 0) continue;
+                }
+
+                TextureRegistry::TextureInfo info;
+                info.filename = e.second.filename;
+                info.contentHash = e.first.contentHash;
+                info.refCount = (uint32_t)e.second.pTexture.use_count();
+                info.loadCount = e.second.loadCount;
+                info.sizeInBytes = e.second.sizeInBytes;
+                textures.push_back(info);
+            }
+            std::sort(textures.begin(), textures.end(), [](const TextureRegistry::TextureInfo& a, const TextureRegistry::TextureInfo& b) { return a.sizeInBytes > b.sizeInBytes; });
+            return textures;
+        }
+
+        std::string formatBytes(uint64_t bytes)
+        {
+            char str[32];
+            snprintf(str, sizeof(str), "%.2f MB", bytes / (1024.0 * 1024.0));
+            return str;
+        }
+    }
+
+    Texture::SharedPtr TextureRegistry::load(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            // Let the texture loader report the error
+            return Texture::createFromFile(filename, generateMipLevels, loadAsSrgb, bindFlags);
+        }
+        fullpath = canonicalizeFilename(fullpath);
+
+        Key key;
+        if (!getFileHash(fullpath, key.contentHash))
+        {
+            {
+                std::lock_guard<std::mutex> lock(gRegistry.mutex);
+                gRegistry.stats.loadCount++;
+                gRegistry.generation++;
+            }
+            return Texture::createFromFile(fullpath, generateMipLevels, loadAsSrgb, bindFlags);
+        }
+        key.generateMipLevels = generateMipLevels;
+        key.loadAsSrgb = loadAsSrgb;
+        key.bindFlags = bindFlags;
+
+        {
+            std::unique_lock<std::mutex> lock(gRegistry.mutex);
+            gRegistry.stats.loadCount++;
+            gRegistry.generation++;
+
+            // The lock is only held for the lookup. If another thread is loading the same texture, wait for it instead of loading it again
+            gRegistry.loadedCV.wait(lock, [&key]() { return gRegistry.loading.count(key) == 0; });
+            auto it = gRegistry.entries.find(key);
+            if (it != gRegistry.entries.end())
+            {
+                Texture::SharedPtr pTexture = it->second.pTexture.lock();
+                if (pTexture)
+                {
+                    it->second.loadCount++;
+                    gRegistry.stats.hitCount++;
+                    gRegistry.stats.bytesSaved += it->second.sizeInBytes;
+                    return pTexture;
+                }
+            }
+            gRegistry.loading.insert(key);
+        }
+
+        // The key must leave the loading set even if the load throws, or the threads waiting for it would block forever
+        struct LoadingGuard
+        {
+            const Key& key;
+            ~LoadingGuard()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(gRegistry.mutex);
+                    gRegistry.loading.erase(key);
+                }
+                gRegistry.loadedCV.notify_all();
+            }
+        } loadingGuard{ key };
+
+        // Decoding, mip generation and the upload run without the lock, so loads of different images don't serialize
+        Texture::SharedPtr pTexture = Texture::createFromFile(fullpath, generateMipLevels, loadAsSrgb, bindFlags);
+
+        if (pTexture)
+        {
+            std::lock_guard<std::mutex> lock(gRegistry.mutex);
+            removeExpiredEntries();
+            Entry& entry = gRegistry.entries[key];
+            entry.pTexture = pTexture;
+            entry.filename = fullpath;
+            entry.loadCount = 1;
+            entry.sizeInBytes = getTextureSize(pTexture.get());
+            gRegistry.generation++;
+        }
+        return pTexture;
+    }
+
+    std::vector<TextureRegistry::TextureInfo> TextureRegistry::getTextures()
+    {
+        std::lock_guard<std::mutex> lock(gRegistry.mutex);
+        return collectTextures(nullptr);
+    }
+
+    TextureRegistry::Stats TextureRegistry::getStats()
+    {
+        std::lock_guard<std::mutex> lock(gRegistry.mutex);
+        removeExpiredEntries();
+
+        Stats stats = gRegistry.stats;
+        stats.textureCount = (uint32_t)gRegistry.entries.size();
+        stats.sizeInBytes = 0;
+        for (const auto& e : gRegistry.entries) stats.sizeInBytes += e.second.sizeInBytes;
+        return stats;
+    }
+
+    std::string TextureRegistry::getReport()
+    {
+        Stats stats = getStats();
+        std::string report = "Textures: " + std::to_string(stats.textureCount) + ", " + formatBytes(stats.sizeInBytes) + "\n";
+        report += "Loads: " + std::to_string(stats.loadCount) + ", shared: " + std::to_string(stats.hitCount) + ", saved " + formatBytes(stats.bytesSaved) + "\n";
+        for (const auto& t : getTextures())
+        {
+            report += "  " + formatBytes(t.sizeInBytes) + "  refs " + std::to_string(t.refCount) + "  loads " + std::to_string(t.loadCount) + "  " + t.filename + "\n";
+        }
+        return report;
+    }
+
+    std::string TextureRegistry::getReport(const std::vector<Texture::SharedPtr>& textures)
+    {
+        std::unordered_set<const Texture*> filter;
+        for (const auto& pTexture : textures)
+        {
+            if (pTexture) filter.insert(pTexture.get());
+        }
+
+        std::vector<TextureInfo> infos;
+        {
+            std::lock_guard<std::mutex> lock(gRegistry.mutex);
+            infos = collectTextures(&filter);
+        }
+
+        uint64_t sizeInBytes = 0;
+        for (const auto& t : infos) sizeInBytes += t.sizeInBytes;
+        std::string report = "Textures: " + std::to_string(infos.size()) + ", " + formatBytes(sizeInBytes) + "\n";
+        for (const auto& t : infos)
+        {
+            report += "  " + formatBytes(t.sizeInBytes) + "  refs " + std::to_string(t.refCount) + "  loads " + std::to_string(t.loadCount) + "  " + t.filename + "\n";
+        }
+        return report;
+    }
+
+    void TextureRegistry::clear()
+    {
+        std::lock_guard<std::mutex> lock(gRegistry.mutex);
+        gRegistry.entries.clear();
+        gRegistry.fileHashes.clear();
+        gRegistry.stats = Stats();
+        gRegistry.generation++;
+    }
+
+    uint64_t TextureRegistry::getGeneration()
+    {
+        std::lock_guard<std::mutex> lock(gRegistry.mutex);
+        removeExpiredEntries();
+        return gRegistry.generation;
+    }
+
+    uint64_t TextureRegistry::getTextureSize(const Texture* pTexture)
+    {
+        ResourceFormat format = pTexture->getFormat();
+        uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+        uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+        uint64_t sliceCount = pTexture->getArraySize() * (pTexture->getType() == Texture::Type::TextureCube ? 6 : 1);
+
+        uint64_t size = 0;
+        for (uint32_t mip = 0; mip < pTexture->getMipCount(); mip++)
+        {
+            uint64_t blocks = (uint64_t)div_round_up(pTexture->getWidth(mip), blockWidth) * div_round_up(pTexture->getHeight(mip), blockHeight) * pTexture->getDepth(mip);
+            size += blocks * getFormatBytesPerBlock(format);
+        }
+        return size * sliceCount * pTexture->getSampleCount();
+    }
+
+    uint64_t TextureRegistry::hash(const void* pData, size_t size, uint64_t seed)
+    {
+        const uint8_t* p = (const uint8_t*)pData;
+        const uint8_t* pEnd = p + size;
+        uint64_t h;
+
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + kPrime1 + kPrime2;
+            uint64_t v2 = seed + kPrime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - kPrime1;
+            for (; p + 32 <= pEnd; p += 32)
+            {
+                v1 = hashRound(v1, read64(p));
+                v2 = hashRound(v2, read64(p + 8));
+                v3 = hashRound(v3, read64(p + 16));
+                v4 = hashRound(v4, read64(p + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = hashMerge(h, v1);
+            h = hashMerge(h, v2);
+            h = hashMerge(h, v3);
+            h = hashMerge(h, v4);
+        }
+        else
+        {
+            h = seed + kPrime5;
+        }
+
+        h += size;
+        for (; p + 8 <= pEnd; p += 8)
+        {
+            h ^= hashRound(0, read64(p));
+            h = rotl(h, 27) * kPrime1 + kPrime4;
+        }
+        if (p + 4 <= pEnd)
+        {
+            h ^= read32(p) * kPrime1;
+            h = rotl(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        for (; p < pEnd; p++)
+        {
+            h ^= (*p) * kPrime5;
+            h = rotl(h, 11) * kPrime1;
+        }
+
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+}
@@ -0,0 +1,98 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Core/API/Texture.h"
+
+namespace Falcor
+{
+    /** Global registry of the textures loaded from files, shared by all the materials, importers and scenes.
+        Textures are identified by a hash of the file content and the load flags. An image referenced through different paths, or copied
+        under different names, is decoded and uploaded once.
+        The registry doesn't own the textures. An entry is dropped once the last user of its texture releases it.
+        All functions are thread-safe.
+    */
+    class dlldecl TextureRegistry
+    {
+    public:
+        struct Stats
+        {
+            uint64_t loadCount = 0;         ///< Number of load() calls
+            uint64_t hitCount = 0;          ///< Number of loads which returned an existing texture
+            uint64_t bytesSaved = 0;        ///< Size of the textures which were shared instead of loaded again
+            uint32_t textureCount = 0;      ///< Number of live textures
+            uint64_t sizeInBytes = 0;       ///< Size of the live textures
+        };
+
+        struct TextureInfo
+        {
+            std::string filename;           ///< The file the texture was first loaded from
+            uint64_t contentHash = 0;       ///< Hash of the file content
+            uint32_t refCount = 0;          ///< Number of owners of the texture
+            uint32_t loadCount = 0;         ///< Number of load() calls which returned the texture
+            uint64_t sizeInBytes = 0;       ///< Approximate GPU memory of the texture
+        };
+
+        /** Load a texture, or return the existing texture with the same content and flags.
+            The arguments are the same as Texture::createFromFile().
+            \return The texture, or nullptr if the file can't be loaded
+        */
+        static Texture::SharedPtr load(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
+
+        /** Get the live textures, largest first
+        */
+        static std::vector<TextureInfo> getTextures();
+
+        /** Get the load statistics and the memory used by the live textures
+        */
+        static Stats getStats();
+
+        /** Get a human-readable report of the statistics and the live textures
+        */
+        static std::string getReport();
+
+        /** Get a human-readable report of the given textures. Textures which weren't loaded through the registry are skipped
+        */
+        static std::string getReport(const std::vector<Texture::SharedPtr>& textures);
+
+        /** Forget all the entries and reset the statistics. Textures which are still used are not affected, but aren't shared with later loads
+        */
+        static void clear();
+
+        /** Get a counter which changes whenever a texture is loaded or released, or the registry is cleared. Can be used to only rebuild a report when it's out of date
+        */
+        static uint64_t getGeneration();
+
+        /** Get the approximate GPU memory of a texture, including all its mips and array slices
+        */
+        static uint64_t getTextureSize(const Texture* pTexture);
+
+        /** 64-bit hash of a block of memory (xxHash64)
+        */
+        static uint64_t hash(const void* pData, size_t size, uint64_t seed = 0);
+    };
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "TiledTextureFile.h"
+#include "VirtualTextureCache.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMagic = 0x31545646; // 'FVT1'
+        const uint32_t kVersion = 1;
+    }
+
+    TiledTextureFile::~TiledTextureFile()
+    {
+        if (mpData) unmapFile(mpData, mSize);
+    }
+
+    bool TiledTextureFile::isFormatSupported(ResourceFormat format)
+    {
+        return format != ResourceFormat::Unknown && !isCompressedFormat(format) && !isDepthStencilFormat(format) && getFormatPixelsPerBlock(format) == 1;
+    }
+
+    bool TiledTextureFile::write(const std::string& filename, const MipGenerator::MipChain& chain)
+    {
+        if (!isFormatSupported(chain.format) || chain.mipCount == 0 || chain.mipCount > kVirtualTextureMaxMips)
+        {
+            logError("TiledTextureFile::write() - Can't store a " + to_string(chain.format) + " texture with " + std::to_string(chain.mipCount) + " mips");
+            return false;
+        }
+
+        std::ofstream f(filename, std::ios::binary);
+        if (!f.good())
+        {
+            logError("TiledTextureFile::write() - Can't create file '" + filename + "'");
+            return false;
+        }
+
+        Header header = { kMagic, kVersion, chain.width, chain.height, chain.mipCount, (uint32_t)chain.format, kVirtualTextureTileSize, kVirtualTextureTileBorder };
+        f.write((const char*)&header, sizeof(header));
+
+        const uint32_t texelSize = getFormatBytesPerBlock(chain.format);
+        const uint32_t storedSize = getStoredTileSize();
+        std::vector<uint8_t> tile(storedSize * storedSize * texelSize);
+
+        const uint8_t* pMip = chain.data.data();
+        for (uint32_t mip = 0; mip < chain.mipCount; mip++)
+        {
+            uint32_t w = std::max(1u, chain.width >> mip);
+            uint32_t h = std::max(1u, chain.height >> mip);
+            uvec2 tileCount = VirtualTextureCache::getTileCount(chain.width, chain.height, mip);
+
+            for (uint32_t ty = 0; ty < tileCount.y; ty++)
+            {
+                for (uint32_t tx = 0; tx < tileCount.x; tx++)
+                {
+                    // Texels outside the mip, in the borders and in the unused part of tiles at the edges, wrap around
+                    for (uint32_t y = 0; y < storedSize; y++)
+                    {
+                        uint32_t srcY = (ty * kVirtualTextureTileSize + y + h * kVirtualTextureTileBorder - kVirtualTextureTileBorder) % h;
+                        for (uint32_t x = 0; x < storedSize; x++)
+                        {
+                            uint32_t srcX = (tx * kVirtualTextureTileSize + x + w * kVirtualTextureTileBorder - kVirtualTextureTileBorder) % w;
+                            std::memcpy(&tile[(y * storedSize + x) * texelSize], pMip + ((size_t)srcY * w + srcX) * texelSize, texelSize);
+                        }
+                    }
+                    f.write((const char*)tile.data(), tile.size());
+                }
+            }
+            pMip += (size_t)w * h * texelSize;
+        }
+
+        if (f.fail())
+        {
+            logError("TiledTextureFile::write() - Failed to write '" + filename + "'");
+            return false;
+        }
+        return true;
+    }
+
+    TiledTextureFile::SharedPtr TiledTextureFile::open(const std::string& filename)
+    {
+        SharedPtr pFile = SharedPtr(new TiledTextureFile());
+        pFile->mpData = (const uint8_t*)mapFile(filename, pFile->mSize);
+        if (!pFile->mpData) return nullptr;
+
+        Header& header = pFile->mHeader;
+        if (pFile->mSize < sizeof(Header)) return nullptr;
+        std::memcpy(&header, pFile->mpData, sizeof(Header));
+        if (header.magic != kMagic || header.version != kVersion || header.tileSize != kVirtualTextureTileSize || header.tileBorder != kVirtualTextureTileBorder ||
+            header.mipCount == 0 || header.mipCount > kVirtualTextureMaxMips || !isFormatSupported((ResourceFormat)header.format))
+        {
+            return nullptr;
+        }
+
+        uint64_t tileCount = 0;
+        for (uint32_t mip = 0; mip < header.mipCount; mip++)
+        {
+            uvec2 count = VirtualTextureCache::getTileCount(header.width, header.height, mip);
+            pFile->mMipTileOffsets.push_back(tileCount);
+            tileCount += count.x * count.y;
+        }
+
+        pFile->mTileDataSize = getStoredTileSize() * getStoredTileSize() * getFormatBytesPerBlock((ResourceFormat)header.format);
+        if (pFile->mSize != sizeof(Header) + tileCount * pFile->mTileDataSize)
+        {
+            logWarning("TiledTextureFile::open() - '" + filename + "' is truncated");
+            return nullptr;
+        }
+        return pFile;
+    }
+
+    const uint8_t* TiledTextureFile::getTileData(uint32_t mip, uint32_t x, uint32_t y) const
+    {
+        assert(mip < mHeader.mipCount);
+        uvec2 count = VirtualTextureCache::getTileCount(mHeader.width, mHeader.height, mip);
+        assert(x < count.x && y < count.y);
+        uint64_t index = mMipTileOffsets[mip] + y * count.x + x;
+        return mpData + sizeof(Header) + index * mTileDataSize;
+    }
+}
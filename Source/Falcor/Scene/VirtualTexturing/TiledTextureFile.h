@@ -0,0 +1,97 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "VirtualTextureData.h"
+#include "Utils/Image/MipGenerator.h"
+
+namespace Falcor
+{
+    /** On-disk format of virtual textures.
+        The file holds the mip chain of a texture split into tiles of kVirtualTextureTileSize texels, each stored with a border of
+        kVirtualTextureTileBorder texels on every side (wrapped around the edges of the mip). Tiles are stored uncompressed, mip by mip, each
+        mip in row-major order, so every tile can be uploaded to the physical atlas straight from the file mapping.
+    */
+    class dlldecl TiledTextureFile
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TiledTextureFile>;
+        ~TiledTextureFile();
+
+        /** Check if a format can be stored. Block-compressed formats are not supported
+        */
+        static bool isFormatSupported(ResourceFormat format);
+
+        /** Write a mip chain to a file
+            \return false if the format isn't supported or the file can't be written
+        */
+        static bool write(const std::string& filename, const MipGenerator::MipChain& chain);
+
+        /** Open a file. The file is mapped into memory, nothing is read until tiles are accessed
+            \return The file, or nullptr if it can't be opened or is not a valid tiled texture
+        */
+        static SharedPtr open(const std::string& filename);
+
+        uint32_t getWidth() const { return mHeader.width; }
+        uint32_t getHeight() const { return mHeader.height; }
+        uint32_t getMipCount() const { return mHeader.mipCount; }
+        ResourceFormat getFormat() const { return (ResourceFormat)mHeader.format; }
+
+        /** Get the size of a stored tile in texels, including the borders
+        */
+        static uint32_t getStoredTileSize() { return kVirtualTextureTileSize + 2 * kVirtualTextureTileBorder; }
+
+        /** Get the size of a stored tile in bytes
+        */
+        uint32_t getTileDataSize() const { return mTileDataSize; }
+
+        /** Get the texels of a tile, including the borders, in row-major order
+        */
+        const uint8_t* getTileData(uint32_t mip, uint32_t x, uint32_t y) const;
+
+    private:
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t width;
+            uint32_t height;
+            uint32_t mipCount;
+            uint32_t format;
+            uint32_t tileSize;
+            uint32_t tileBorder;
+        };
+
+        TiledTextureFile() = default;
+
+        Header mHeader = {};
+        const uint8_t* mpData = nullptr;
+        size_t mSize = 0;
+        uint32_t mTileDataSize = 0;
+        std::vector<uint64_t> mMipTileOffsets;      // Index of the first tile of each mip
+    };
+}
@@ -0,0 +1,253 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "VirtualTextureCache.h"
+
+namespace Falcor
+{
+    uvec2 VirtualTextureCache::getTileCount(uint32_t width, uint32_t height, uint32_t mip)
+    {
+        uint32_t w = std::max(1u, width >> mip);
+        uint32_t h = std::max(1u, height >> mip);
+        return uvec2(div_round_up(w, kVirtualTextureTileSize), div_round_up(h, kVirtualTextureTileSize));
+    }
+
+    uint32_t VirtualTextureCache::addPool(uint32_t slotCount)
+    {
+        assert(slotCount > 0 && slotCount <= kVirtualTextureMaxSlots);
+        Pool pool;
+        pool.slots.resize(slotCount);
+        pool.freeSlots.resize(slotCount);
+        // Hand out the slots in order
+        for (uint32_t i = 0; i < slotCount; i++) pool.freeSlots[i] = slotCount - 1 - i;
+        mPools.push_back(std::move(pool));
+        return (uint32_t)mPools.size() - 1;
+    }
+
+    uint32_t VirtualTextureCache::addTexture(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t poolIndex)
+    {
+        assert(poolIndex < mPools.size());
+        if (mTextures.size() >= kVirtualTextureMaxTextures || mipCount == 0 || mipCount > kVirtualTextureMaxMips) return kInvalidTexture;
+
+        uvec2 tileCount = getTileCount(width, height, 0);
+        if (tileCount.x > kVirtualTextureMaxTilesPerAxis || tileCount.y > kVirtualTextureMaxTilesPerAxis) return kInvalidTexture;
+
+        TextureData texture = {};
+        texture.width = width;
+        texture.height = height;
+        texture.mipCount = mipCount;
+        texture.poolIndex = poolIndex;
+        texture.pageTableOffset = (uint32_t)mPageTable.size();
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            uvec2 count = getTileCount(width, height, mip);
+            texture.mipOffsets[mip] = texture.pageTableSize;
+            texture.pageTableSize += count.x * count.y;
+        }
+        texture.dirty = true;
+
+        mPageTable.resize(mPageTable.size() + texture.pageTableSize, 0);
+        mTextures.push_back(texture);
+        return (uint32_t)mTextures.size() - 1;
+    }
+
+    bool VirtualTextureCache::isValidTile(const VirtualTileId& tile) const
+    {
+        if (tile.textureId >= mTextures.size()) return false;
+        const TextureData& texture = mTextures[tile.textureId];
+        if (tile.mip >= texture.mipCount) return false;
+        uvec2 count = getTileCount(texture.width, texture.height, tile.mip);
+        return tile.x < count.x && tile.y < count.y;
+    }
+
+    VirtualTileId VirtualTextureCache::getParent(const VirtualTileId& tile) const
+    {
+        // With odd mip sizes, the last tile of a row can map past the end of the next mip
+        const TextureData& texture = mTextures[tile.textureId];
+        assert(tile.mip + 1 < texture.mipCount);
+        uvec2 count = getTileCount(texture.width, texture.height, tile.mip + 1);
+        return { tile.textureId, tile.mip + 1, std::min(tile.x / 2, count.x - 1), std::min(tile.y / 2, count.y - 1) };
+    }
+
+    uint32_t VirtualTextureCache::getPageTableEntry(const VirtualTileId& tile) const
+    {
+        assert(isValidTile(tile));
+        const TextureData& texture = mTextures[tile.textureId];
+        uvec2 count = getTileCount(texture.width, texture.height, tile.mip);
+        return mPageTable[texture.pageTableOffset + texture.mipOffsets[tile.mip] + tile.y * count.x + tile.x];
+    }
+
+    uint32_t VirtualTextureCache::getSlot(const VirtualTileId& tile) const
+    {
+        auto it = mResidentTiles.find(tile.pack());
+        return it != mResidentTiles.end() ? it->second : kInvalidSlot;
+    }
+
+    void VirtualTextureCache::touch(uint32_t poolIndex, uint32_t slot)
+    {
+        Pool& pool = mPools[poolIndex];
+        Slot& s = pool.slots[slot];
+        s.lastUse = mFrame;
+        if (!s.pinned) pool.lru.splice(pool.lru.end(), pool.lru, s.lruIt);
+    }
+
+    std::vector<VirtualTextureCache::Request> VirtualTextureCache::processFeedback(const uint32_t* pFeedback, size_t count)
+    {
+        // Count the samples of each tile
+        std::unordered_map<uint32_t, uint32_t> priorities;
+        uint64_t sampleCount = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (pFeedback[i] == kVirtualTextureInvalidTile) continue;
+            VirtualTileId tile = VirtualTileId::unpack(pFeedback[i]);
+            if (!isValidTile(tile)) continue;
+            priorities[pFeedback[i]]++;
+            sampleCount++;
+        }
+
+        // Add the samples of each tile to its ancestors, finest mip first. The ancestors are the fallback while the tile is loading, and
+        // a coarse tile which covers many sampled tiles improves more pixels than any one of them
+        for (uint32_t mip = 0; mip + 1 < kVirtualTextureMaxMips; mip++)
+        {
+            std::vector<std::pair<uint32_t, uint32_t>> level;
+            for (const auto& p : priorities)
+            {
+                if (VirtualTileId::unpack(p.first).mip == mip) level.push_back(p);
+            }
+            for (const auto& p : level)
+            {
+                VirtualTileId tile = VirtualTileId::unpack(p.first);
+                if (tile.mip + 1 < mTextures[tile.textureId].mipCount) priorities[getParent(tile).pack()] += p.second;
+            }
+        }
+
+        std::vector<Request> requests;
+        for (const auto& p : priorities)
+        {
+            VirtualTileId tile = VirtualTileId::unpack(p.first);
+            uint32_t slot = getSlot(tile);
+            if (slot != kInvalidSlot) touch(mTextures[tile.textureId].poolIndex, slot);
+            else requests.push_back({ tile, p.second });
+        }
+
+        // Highest priority first. Ties go to the coarser tile, then to the lower ID so the order is deterministic
+        std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b)
+        {
+            if (a.priority != b.priority) return a.priority > b.priority;
+            if (a.tile.mip != b.tile.mip) return a.tile.mip > b.tile.mip;
+            return a.tile.pack() < b.tile.pack();
+        });
+
+        mStats.feedbackSamples = sampleCount;
+        mStats.requestedTiles = (uint32_t)priorities.size();
+        mStats.missingTiles = (uint32_t)requests.size();
+        return requests;
+    }
+
+    uint32_t VirtualTextureCache::allocateTile(const VirtualTileId& tile, bool pinned)
+    {
+        assert(isValidTile(tile));
+        uint32_t poolIndex = mTextures[tile.textureId].poolIndex;
+        Pool& pool = mPools[poolIndex];
+
+        uint32_t slot = getSlot(tile);
+        if (slot != kInvalidSlot)
+        {
+            touch(poolIndex, slot);
+            return slot;
+        }
+
+        if (pool.freeSlots.size())
+        {
+            slot = pool.freeSlots.back();
+            pool.freeSlots.pop_back();
+        }
+        else
+        {
+            if (pool.lru.empty()) return kInvalidSlot;
+            slot = pool.lru.front();
+            Slot& victim = pool.slots[slot];
+            if (victim.lastUse >= mFrame) return kInvalidSlot;
+
+            pool.lru.pop_front();
+            mResidentTiles.erase(victim.tile.pack());
+            mTextures[victim.tile.textureId].dirty = true;
+            mStats.evictions++;
+        }
+
+        Slot& s = pool.slots[slot];
+        s.tile = tile;
+        s.lastUse = mFrame;
+        s.pinned = pinned;
+        if (!pinned) s.lruIt = pool.lru.insert(pool.lru.end(), slot);
+
+        mResidentTiles[tile.pack()] = slot;
+        mTextures[tile.textureId].dirty = true;
+        mStats.allocations++;
+        return slot;
+    }
+
+    std::vector<uint32_t> VirtualTextureCache::updatePageTable()
+    {
+        std::vector<uint32_t> updated;
+        for (uint32_t id = 0; id < (uint32_t)mTextures.size(); id++)
+        {
+            TextureData& texture = mTextures[id];
+            if (!texture.dirty) continue;
+
+            // Coarsest mip first, so the entries of the parents are up to date
+            uint32_t* pEntries = mPageTable.data() + texture.pageTableOffset;
+            for (int mip = (int)texture.mipCount - 1; mip >= 0; mip--)
+            {
+                uvec2 count = getTileCount(texture.width, texture.height, mip);
+                for (uint32_t y = 0; y < count.y; y++)
+                {
+                    for (uint32_t x = 0; x < count.x; x++)
+                    {
+                        uint32_t slot = getSlot({ id, (uint32_t)mip, x, y });
+                        uint32_t& entry = pEntries[texture.mipOffsets[mip] + y * count.x + x];
+                        if (slot != kInvalidSlot) entry = kVirtualTexturePageValid | (mip << 16) | slot;
+                        else if (mip + 1 < (int)texture.mipCount) entry = getPageTableEntry(getParent({ id, (uint32_t)mip, x, y }));
+                        else entry = 0;
+                    }
+                }
+            }
+
+            texture.dirty = false;
+            updated.push_back(id);
+        }
+        return updated;
+    }
+
+    VirtualTextureCache::Stats VirtualTextureCache::getStats() const
+    {
+        Stats stats = mStats;
+        stats.residentTiles = (uint32_t)mResidentTiles.size();
+        return stats;
+    }
+}
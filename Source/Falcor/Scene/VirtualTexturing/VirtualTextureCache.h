@@ -0,0 +1,187 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "VirtualTextureData.h"
+#include <list>
+
+namespace Falcor
+{
+    /** Identifies a tile of a virtual texture
+    */
+    struct VirtualTileId
+    {
+        uint32_t textureId = 0;
+        uint32_t mip = 0;
+        uint32_t x = 0;
+        uint32_t y = 0;
+
+        /** Pack into the 32-bit representation used by the shaders. See VirtualTextureData.h
+        */
+        uint32_t pack() const { return x | (y << 9) | (mip << 18) | (textureId << 22); }
+        static VirtualTileId unpack(uint32_t packed) { return { packed >> 22, (packed >> 18) & 0xf, packed & 0x1ff, (packed >> 9) & 0x1ff }; }
+
+        bool operator==(const VirtualTileId& other) const { return pack() == other.pack(); }
+        bool operator!=(const VirtualTileId& other) const { return pack() != other.pack(); }
+    };
+
+    /** CPU side of the virtual texture system. It doesn't use the GPU, so it can be tested on its own.
+        - Keeps track of which tiles are resident in the physical pools. Each pool has a fixed number of slots. When a pool is full, the least
+          recently used tile is evicted. Tiles used in the current frame and pinned tiles are never evicted.
+        - Analyzes the feedback written by the shaders, and turns it into a list of tile requests sorted by priority.
+        - Maintains the page table. Entries of tiles which are not resident point to their closest resident ancestor.
+    */
+    class dlldecl VirtualTextureCache
+    {
+    public:
+        static const uint32_t kInvalidSlot = 0xffffffff;
+        static const uint32_t kInvalidTexture = kVirtualTextureInvalidId;
+
+        struct Request
+        {
+            VirtualTileId tile;
+            uint32_t priority = 0;          ///< Number of feedback samples which wanted the tile or one of its descendants
+        };
+
+        struct Stats
+        {
+            uint64_t feedbackSamples = 0;   ///< Valid samples in the last processed feedback
+            uint32_t requestedTiles = 0;    ///< Distinct tiles needed by the last processed feedback, including the ancestors of the sampled tiles
+            uint32_t missingTiles = 0;      ///< Needed tiles which were not resident
+            uint32_t residentTiles = 0;
+            uint64_t allocations = 0;
+            uint64_t evictions = 0;
+        };
+
+        /** Get the number of tiles of a mip level
+        */
+        static uvec2 getTileCount(uint32_t width, uint32_t height, uint32_t mip);
+
+        /** Add a physical pool
+            \param[in] slotCount Number of tiles the pool can hold
+            \return The pool index
+        */
+        uint32_t addPool(uint32_t slotCount);
+
+        /** Add a virtual texture
+            \param[in] width, height Size of the first mip
+            \param[in] mipCount Number of mips
+            \param[in] poolIndex The pool which holds the tiles of the texture
+            \return The texture ID, or kInvalidTexture if the texture is too large or there are too many textures
+        */
+        uint32_t addTexture(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t poolIndex);
+
+        uint32_t getTextureCount() const { return (uint32_t)mTextures.size(); }
+        uint32_t getPoolCount() const { return (uint32_t)mPools.size(); }
+        uint32_t getPoolIndex(uint32_t textureId) const { return mTextures[textureId].poolIndex; }
+        uint32_t getMipCount(uint32_t textureId) const { return mTextures[textureId].mipCount; }
+        uvec2 getTileCount(uint32_t textureId, uint32_t mip) const { return getTileCount(mTextures[textureId].width, mTextures[textureId].height, mip); }
+
+        /** Get the offset of the entries of a texture in the page table. The mips are stored in order, each in row-major order
+        */
+        uint32_t getPageTableOffset(uint32_t textureId) const { return mTextures[textureId].pageTableOffset; }
+        uint32_t getPageTableSize(uint32_t textureId) const { return mTextures[textureId].pageTableSize; }
+        const std::vector<uint32_t>& getPageTable() const { return mPageTable; }
+
+        /** Get the tile of the next coarser mip which covers a tile. The tile must not be in the last mip
+        */
+        VirtualTileId getParent(const VirtualTileId& tile) const;
+
+        /** Get the page table entry of a tile
+        */
+        uint32_t getPageTableEntry(const VirtualTileId& tile) const;
+
+        /** Start a new frame
+        */
+        void beginFrame() { mFrame++; }
+
+        /** Analyze the feedback of a frame. The resident tiles which were used, directly or as a fallback, are marked as used in the current frame.
+            \param[in] pFeedback Packed tile IDs. kVirtualTextureInvalidTile and invalid IDs are ignored
+            \param[in] count Number of values
+            \return The tiles which are needed but not resident, highest priority first
+        */
+        std::vector<Request> processFeedback(const uint32_t* pFeedback, size_t count);
+
+        /** Make a tile resident. If the pool is full, the least recently used tile is evicted.
+            \param[in] tile The tile
+            \param[in] pinned Pinned tiles are never evicted
+            \return The slot of the tile in its pool, or kInvalidSlot if all the slots are pinned or used in the current frame
+        */
+        uint32_t allocateTile(const VirtualTileId& tile, bool pinned = false);
+
+        /** Get the slot of a resident tile
+            \return The slot, or kInvalidSlot if the tile is not resident
+        */
+        uint32_t getSlot(const VirtualTileId& tile) const;
+        bool isResident(const VirtualTileId& tile) const { return getSlot(tile) != kInvalidSlot; }
+
+        /** Update the page table entries of the textures whose residency changed
+            \return The IDs of the updated textures
+        */
+        std::vector<uint32_t> updatePageTable();
+
+        Stats getStats() const;
+
+    private:
+        struct TextureData
+        {
+            uint32_t width;
+            uint32_t height;
+            uint32_t mipCount;
+            uint32_t poolIndex;
+            uint32_t pageTableOffset;
+            uint32_t pageTableSize;
+            uint32_t mipOffsets[kVirtualTextureMaxMips];    // Relative to pageTableOffset
+            bool dirty;
+        };
+
+        struct Slot
+        {
+            VirtualTileId tile;
+            uint64_t lastUse = 0;
+            bool pinned = false;
+            std::list<uint32_t>::iterator lruIt;
+        };
+
+        struct Pool
+        {
+            std::vector<Slot> slots;
+            std::vector<uint32_t> freeSlots;
+            std::list<uint32_t> lru;        // Unpinned used slots, least recently used first
+        };
+
+        bool isValidTile(const VirtualTileId& tile) const;
+        void touch(uint32_t poolIndex, uint32_t slot);
+
+        std::vector<TextureData> mTextures;
+        std::vector<Pool> mPools;
+        std::vector<uint32_t> mPageTable;
+        std::unordered_map<uint32_t, uint32_t> mResidentTiles;     // Packed tile ID -> slot
+        uint64_t mFrame = 1;
+        Stats mStats;
+    };
+}
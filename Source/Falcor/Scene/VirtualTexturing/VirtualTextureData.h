@@ -0,0 +1,55 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Data/HostDeviceData.h"
+
+BEGIN_NAMESPACE_FALCOR
+
+/** Layout of virtual textures. Shared between the CPU and the GPU.
+
+    A virtual texture is split into square tiles of kVirtualTextureTileSize texels at every mip level. Mips smaller than a tile fit in a single tile.
+    Resident tiles are stored, with a border of kVirtualTextureTileBorder texels on each side for bilinear filtering, in a physical atlas.
+
+    A tile is identified by a 32-bit value: x (bits 0-8), y (bits 9-17), mip (bits 18-21) and texture ID (bits 22-31).
+    The feedback buffer holds the IDs of the tiles the shaders wanted to sample, or kVirtualTextureInvalidTile.
+
+    The page table holds one entry per tile of every mip of every texture: the atlas slot (bits 0-15) and mip (bits 16-19) of the tile, or of its
+    closest resident ancestor, and a valid flag (bit 31).
+*/
+static const uint kVirtualTextureTileSize = 128;
+static const uint kVirtualTextureTileBorder = 4;
+static const uint kVirtualTextureMaxTextures = 1023;
+static const uint kVirtualTextureMaxMips = 16;
+static const uint kVirtualTextureMaxTilesPerAxis = 512;
+static const uint kVirtualTextureMaxSlots = 0xffff;
+static const uint kVirtualTextureMaxPools = 4;
+static const uint kVirtualTextureInvalidTile = 0xffffffff;
+static const uint kVirtualTextureInvalidId = 0xffffffff;
+static const uint kVirtualTexturePageValid = 0x80000000;
+
+END_NAMESPACE_FALCOR
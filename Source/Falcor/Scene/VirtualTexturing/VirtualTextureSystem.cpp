@@ -0,0 +1,378 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "VirtualTextureSystem.h"
+#include "Core/API/Device.h"
+#include "Core/Program/ShaderCache.h"
+#include "Utils/Image/Bitmap.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kDefaultCbVar[] = "gVirtualTextures";
+        const char kFileExt[] = ".fvt";
+        const uint32_t kTiledFileVersion = 1;
+        const uint32_t kReadbackLatency = 3;        // Frames between writing the feedback and reading it
+        const uint32_t kMaxAtlasSize = 16384;
+    }
+
+    VirtualTextureSystem::SharedPtr VirtualTextureSystem::create(const Desc& desc)
+    {
+        return SharedPtr(new VirtualTextureSystem(desc));
+    }
+
+    VirtualTextureSystem::VirtualTextureSystem(const Desc& desc) : mDesc(desc)
+    {
+        if (mDesc.cacheDirectory.empty()) mDesc.cacheDirectory = getExecutableDirectory() + "/VirtualTextureCache";
+        mDesc.feedbackScale = std::max(1u, mDesc.feedbackScale);
+
+        Sampler::Desc samplerDesc;
+        samplerDesc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Point);
+        samplerDesc.setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp);
+        mpAtlasSampler = Sampler::create(samplerDesc);
+
+        mpFence = GpuFence::create();
+        mReadbacks.resize(kReadbackLatency);
+
+        // An empty feedback buffer, so the system can be bound before the frame size is known
+        setFrameSize(0, 0);
+    }
+
+    VirtualTextureSystem::~VirtualTextureSystem() = default;
+
+    uint32_t VirtualTextureSystem::getPool(ResourceFormat format)
+    {
+        for (uint32_t i = 0; i < (uint32_t)mPools.size(); i++)
+        {
+            if (mPools[i].format == format) return i;
+        }
+        if (mPools.size() >= kVirtualTextureMaxPools) return VirtualTextureCache::kInvalidTexture;
+
+        // Square-ish atlas within the budget and the maximum texture size
+        const uint32_t storedSize = TiledTextureFile::getStoredTileSize();
+        uint64_t tileBytes = (uint64_t)storedSize * storedSize * getFormatBytesPerBlock(format);
+        uint32_t maxColumns = kMaxAtlasSize / storedSize;
+        uint32_t slotCount = (uint32_t)std::min<uint64_t>({ mDesc.poolSizeInBytes / tileBytes, (uint64_t)maxColumns * maxColumns, kVirtualTextureMaxSlots });
+        slotCount = std::max(slotCount, 1u);
+
+        Pool pool;
+        pool.format = format;
+        pool.columns = std::min(maxColumns, (uint32_t)std::ceil(std::sqrt((double)slotCount)));
+        uint32_t rows = div_round_up(slotCount, pool.columns);
+        pool.pAtlas = Texture::create2D(pool.columns * storedSize, rows * storedSize, format, 1, 1, nullptr, Resource::BindFlags::ShaderResource);
+        if (!pool.pAtlas) return VirtualTextureCache::kInvalidTexture;
+        pool.pAtlas->setName("VirtualTextureSystem atlas " + to_string(format));
+
+        uint32_t index = mCache.addPool(slotCount);
+        assert(index == mPools.size());
+        mPools.push_back(pool);
+        mStats.physicalMemory += (uint64_t)pool.pAtlas->getWidth() * pool.pAtlas->getHeight() * getFormatBytesPerBlock(format);
+        return index;
+    }
+
+    uint32_t VirtualTextureSystem::addTexture(const std::string& filename, bool loadAsSrgb)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logError("VirtualTextureSystem::addTexture() - Can't find image file " + filename);
+            return VirtualTextureCache::kInvalidTexture;
+        }
+        fullpath = canonicalizeFilename(fullpath);
+
+        // Materials often share images, they share the virtual texture too
+        std::string key = fullpath + "|" + std::to_string(loadAsSrgb);
+        auto it = mTextureIds.find(key);
+        if (it != mTextureIds.end()) return it->second;
+
+        // The tiled file is addressed by the source file and its modification time, so it's converted again when the image changes
+        std::string desc = fullpath + "|" + std::to_string(getFileModifiedTime(fullpath)) + "|" + std::to_string(loadAsSrgb) + "|" + std::to_string(kTiledFileVersion);
+        std::string tiledPath = mDesc.cacheDirectory + "/" + ShaderCache::createKey(desc) + kFileExt;
+
+        TiledTextureFile::SharedPtr pFile = TiledTextureFile::open(tiledPath);
+        if (!pFile)
+        {
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullpath, true);
+            if (!pBitmap) return VirtualTextureCache::kInvalidTexture;
+
+            ResourceFormat format = loadAsSrgb ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+            MipGenerator::MipChain chain;
+            if (!TiledTextureFile::isFormatSupported(format) || !MipGenerator::generate(pBitmap->getData(), pBitmap->getWidth(), pBitmap->getHeight(), format, {}, chain))
+            {
+                logError("VirtualTextureSystem::addTexture() - " + to_string(format) + " is not supported, can't load " + filename);
+                return VirtualTextureCache::kInvalidTexture;
+            }
+
+            // Write to a temporary file first, so that other processes never see partial files
+            std::error_code ec;
+            fs::create_directories(mDesc.cacheDirectory, ec);
+            std::string tempPath = tiledPath + ".tmp";
+            if (TiledTextureFile::write(tempPath, chain))
+            {
+                fs::rename(tempPath, tiledPath, ec);
+                if (ec) fs::remove(tempPath, ec);
+            }
+            pFile = TiledTextureFile::open(tiledPath);
+            if (!pFile)
+            {
+                logError("VirtualTextureSystem::addTexture() - Can't create tiled file for " + filename);
+                return VirtualTextureCache::kInvalidTexture;
+            }
+        }
+
+        uint32_t poolIndex = getPool(pFile->getFormat());
+        if (poolIndex == VirtualTextureCache::kInvalidTexture)
+        {
+            logError("VirtualTextureSystem::addTexture() - Too many texture formats, can't add " + filename);
+            return VirtualTextureCache::kInvalidTexture;
+        }
+
+        uint32_t id = mCache.addTexture(pFile->getWidth(), pFile->getHeight(), pFile->getMipCount(), poolIndex);
+        if (id == VirtualTextureCache::kInvalidTexture)
+        {
+            logError("VirtualTextureSystem::addTexture() - Texture is too large or there are too many textures, can't add " + filename);
+            return id;
+        }
+        mTextures.push_back({ fullpath, pFile });
+        mTextureIds[key] = id;
+        mDescsDirty = true;
+
+        // The coarsest mip is always resident, so every lookup has a fallback
+        uint32_t lastMip = pFile->getMipCount() - 1;
+        uvec2 tileCount = mCache.getTileCount(id, lastMip);
+        for (uint32_t y = 0; y < tileCount.y; y++)
+        {
+            for (uint32_t x = 0; x < tileCount.x; x++)
+            {
+                if (!uploadTile(gpDevice->getRenderContext(), { id, lastMip, x, y }, true))
+                {
+                    logWarning("VirtualTextureSystem::addTexture() - The pool is too small to hold the coarsest mip of " + filename);
+                }
+            }
+        }
+
+        mStats.textureCount = (uint32_t)mTextures.size();
+        for (uint32_t mip = 0; mip < pFile->getMipCount(); mip++)
+        {
+            mStats.virtualMemory += (uint64_t)std::max(1u, pFile->getWidth() >> mip) * std::max(1u, pFile->getHeight() >> mip) * getFormatBytesPerBlock(pFile->getFormat());
+        }
+        return id;
+    }
+
+    ResourceFormat VirtualTextureSystem::getTextureFormat(uint32_t id) const
+    {
+        return id < mTextures.size() ? mTextures[id].pFile->getFormat() : ResourceFormat::Unknown;
+    }
+
+    bool VirtualTextureSystem::uploadTile(RenderContext* pRenderContext, const VirtualTileId& tile, bool pinned)
+    {
+        uint32_t slot = mCache.allocateTile(tile, pinned);
+        if (slot == VirtualTextureCache::kInvalidSlot) return false;
+
+        const Pool& pool = mPools[mCache.getPoolIndex(tile.textureId)];
+        const TiledTextureFile* pFile = mTextures[tile.textureId].pFile.get();
+        const uint32_t storedSize = TiledTextureFile::getStoredTileSize();
+        uvec3 origin((slot % pool.columns) * storedSize, (slot / pool.columns) * storedSize, 0);
+        pRenderContext->updateSubresourceData(pool.pAtlas.get(), 0, pFile->getTileData(tile.mip, tile.x, tile.y), origin, uvec3(storedSize, storedSize, 1));
+        mStats.uploadedBytes += pFile->getTileDataSize();
+        return true;
+    }
+
+    void VirtualTextureSystem::setFrameSize(uint32_t width, uint32_t height)
+    {
+        uvec2 dim(div_round_up(width, mDesc.feedbackScale), div_round_up(height, mDesc.feedbackScale));
+        if (dim == mFeedbackDim && mpFeedback) return;
+        mFeedbackDim = dim;
+
+        uint32_t count = std::max(1u, dim.x * dim.y);
+        mpFeedback = TypedBuffer<uint32_t>::create(count, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+        mpFeedback->setName("VirtualTextureSystem feedback");
+        gpDevice->getRenderContext()->clearUAV(mpFeedback->getUAV().get(), uvec4(kVirtualTextureInvalidTile));
+
+        // Feedback in flight has the old layout
+        for (auto& r : mReadbacks)
+        {
+            r.pBuffer = Buffer::create(count * sizeof(uint32_t), Resource::BindFlags::None, Buffer::CpuAccess::Read);
+            r.pending = false;
+        }
+    }
+
+    void VirtualTextureSystem::update(RenderContext* pRenderContext)
+    {
+        mCache.beginFrame();
+
+        // Analyze the oldest feedback the GPU is done with
+        std::vector<VirtualTextureCache::Request> requests;
+        for (uint32_t i = 0; i < kReadbackLatency; i++)
+        {
+            Readback& r = mReadbacks[(mReadbackIndex + i) % kReadbackLatency];
+            if (!r.pending || mpFence->getGpuValue() < r.fenceValue) continue;
+
+            const uint32_t* pFeedback = (const uint32_t*)r.pBuffer->map(Buffer::MapType::Read);
+            requests = mCache.processFeedback(pFeedback, r.pBuffer->getSize() / sizeof(uint32_t));
+            r.pBuffer->unmap();
+            r.pending = false;
+            break;
+        }
+
+        // Stream the most needed tiles. Requests which don't fit in their pool this frame are dropped, the feedback asks again
+        uint32_t uploads = 0;
+        for (const auto& request : requests)
+        {
+            if (uploads >= mDesc.maxUploadsPerFrame) break;
+            if (uploadTile(pRenderContext, request.tile, false)) uploads++;
+        }
+        mStats.uploadsLastFrame = uploads;
+        mStats.pendingRequests = (uint32_t)requests.size() - uploads;
+
+        // Upload the page table entries which changed, or everything if textures were added
+        std::vector<uint32_t> updated = mCache.updatePageTable();
+        const auto& pageTable = mCache.getPageTable();
+        if (mDescsDirty)
+        {
+            uint32_t textureCount = mCache.getTextureCount();
+            std::vector<uvec4> descs(textureCount);
+            for (uint32_t id = 0; id < textureCount; id++)
+            {
+                const TiledTextureFile* pFile = mTextures[id].pFile.get();
+                descs[id] = uvec4(pFile->getWidth(), pFile->getHeight(), mCache.getPageTableOffset(id), pFile->getMipCount() | (mCache.getPoolIndex(id) << 8));
+            }
+            mpTextureDescs = TypedBuffer<uvec4>::create(std::max(1u, textureCount), Resource::BindFlags::ShaderResource);
+            mpTextureDescs->setName("VirtualTextureSystem textures");
+            pRenderContext->updateBuffer(mpTextureDescs.get(), descs.data(), 0, descs.size() * sizeof(uvec4));
+
+            mpPageTable = TypedBuffer<uint32_t>::create(std::max(1u, (uint32_t)pageTable.size()), Resource::BindFlags::ShaderResource);
+            mpPageTable->setName("VirtualTextureSystem page table");
+            pRenderContext->updateBuffer(mpPageTable.get(), pageTable.data(), 0, pageTable.size() * sizeof(uint32_t));
+            mDescsDirty = false;
+        }
+        else
+        {
+            for (uint32_t id : updated)
+            {
+                uint32_t offset = mCache.getPageTableOffset(id);
+                pRenderContext->updateBuffer(mpPageTable.get(), pageTable.data() + offset, offset * sizeof(uint32_t), mCache.getPageTableSize(id) * sizeof(uint32_t));
+            }
+        }
+
+        mStats.cache = mCache.getStats();
+    }
+
+    void VirtualTextureSystem::endFrame(RenderContext* pRenderContext)
+    {
+        mFrameIndex++;
+        if (!mpFeedback) return;
+
+        // If the feedback of this slot was never analyzed, it's replaced by the newer one
+        Readback& r = mReadbacks[mReadbackIndex];
+        pRenderContext->copyBufferRegion(r.pBuffer.get(), 0, mpFeedback.get(), 0, r.pBuffer->getSize());
+        pRenderContext->flush(false);
+        r.fenceValue = mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+        r.pending = true;
+        mReadbackIndex = (mReadbackIndex + 1) % kReadbackLatency;
+
+        pRenderContext->clearUAV(mpFeedback->getUAV().get(), uvec4(kVirtualTextureInvalidTile));
+    }
+
+    bool VirtualTextureSystem::setIntoParameterBlock(ParameterBlock* pBlock, const char varName[]) const
+    {
+        // Get the implicit CB for the block.
+        // Note that the default parameter block doesn't have an implicit CB. Return if that happens.
+        ConstantBuffer* pCB = pBlock->getDefaultConstantBuffer().get();
+        if (!pCB) return false;
+
+        std::string prefix = std::string(varName).empty() ? "" : std::string(varName) + '.';
+        return setIntoBlockCommon(pBlock, pCB, prefix);
+    }
+
+    bool VirtualTextureSystem::setIntoConstantBuffer(ProgramVars* pVars, ConstantBuffer* pCB, const char varName[]) const
+    {
+        assert(pVars);
+        assert(pCB);
+
+        // Check that the struct exists.
+        std::string cbVar = std::string(varName).empty() ? kDefaultCbVar : varName;
+        if (pCB->getVariableOffset(cbVar) == ConstantBuffer::kInvalidOffset)
+        {
+            logError("VirtualTextureSystem::setIntoConstantBuffer() - Variable " + cbVar + " not found in constant buffer");
+            return false;
+        }
+
+        return setIntoBlockCommon(pVars->getDefaultBlock().get(), pCB, cbVar + '.');
+    }
+
+    bool VirtualTextureSystem::setIntoBlockCommon(ParameterBlock* pBlock, ConstantBuffer* pCB, const std::string& varName) const
+    {
+        assert(pBlock);
+        assert(pCB);
+
+        if (!mpTextureDescs)
+        {
+            logError("VirtualTextureSystem - update() must be called before binding");
+            return false;
+        }
+
+        if (!pCB->setVariable(varName + "feedbackDim", mFeedbackDim) ||
+            !pCB->setVariable(varName + "feedbackScale", mDesc.feedbackScale) ||
+            !pCB->setVariable(varName + "frameIndex", mFrameIndex))
+        {
+            return false;
+        }
+
+        if (!pBlock->setTypedBuffer(varName + "textures", mpTextureDescs) ||
+            !pBlock->setTypedBuffer(varName + "pageTable", mpPageTable) ||
+            !pBlock->setTypedBuffer(varName + "feedback", mpFeedback) ||
+            !pBlock->setSampler(varName + "atlasSampler", mpAtlasSampler))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < (uint32_t)mPools.size(); i++)
+        {
+            if (!pBlock->setTexture(varName + "atlases[" + std::to_string(i) + "]", mPools[i].pAtlas)) return false;
+        }
+        return true;
+    }
+
+    void VirtualTextureSystem::renderUI(Gui::Widgets& widget)
+    {
+        auto toMB = [](uint64_t bytes) { return std::to_string(bytes / (1024 * 1024)) + " MB"; };
+        std::string text;
+        text += "Textures: " + std::to_string(mStats.textureCount) + ", " + toMB(mStats.virtualMemory) + " virtual, " + toMB(mStats.physicalMemory) + " physical\n";
+        text += "Resident tiles: " + std::to_string(mStats.cache.residentTiles) + "\n";
+        text += "Needed tiles: " + std::to_string(mStats.cache.requestedTiles) + ", missing " + std::to_string(mStats.cache.missingTiles) + "\n";
+        text += "Uploads: " + std::to_string(mStats.uploadsLastFrame) + " this frame, " + std::to_string(mStats.pendingRequests) + " pending, " + toMB(mStats.uploadedBytes) + " total\n";
+        text += "Evictions: " + std::to_string(mStats.cache.evictions);
+        widget.text(text);
+        widget.var("Max uploads per frame", mDesc.maxUploadsPerFrame, 1u, 4096u);
+    }
+}
@@ -0,0 +1,167 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "VirtualTextureCache.h"
+#include "TiledTextureFile.h"
+
+namespace Falcor
+{
+    class ParameterBlock;
+
+    /** Virtual texturing. Textures are split into tiles, and only the tiles the shaders need are kept in video memory.
+
+        Images are converted once to tiled files (see TiledTextureFile) in a cache directory, and tiles are uploaded from the file mappings into
+        a physical atlas per texture format. Each atlas has a fixed memory budget, so the texture memory is bounded regardless of the size of the
+        textures. The coarsest mip of every texture is always resident.
+
+        Shaders sample through VirtualTexture.slang and write feedback with the tiles they need. The feedback is read back a few frames later
+        and analyzed by VirtualTextureCache, which decides what to load and what to evict.
+
+        Per frame: call update() before the passes which use virtual textures, and endFrame() after the last one.
+        Scenes built with SceneBuilder::Flags::UseVirtualTextures own a system for the textures of their materials, see Scene::getVirtualTextureSystem().
+    */
+    class dlldecl VirtualTextureSystem
+    {
+    public:
+        using SharedPtr = std::shared_ptr<VirtualTextureSystem>;
+
+        struct Desc
+        {
+            uint64_t poolSizeInBytes = 256ull * 1024 * 1024;    ///< Memory budget of the physical atlas of each texture format
+            uint32_t maxUploadsPerFrame = 64;                   ///< Maximum number of tiles uploaded in a frame
+            uint32_t feedbackScale = 8;                         ///< Pixels per side of a feedback block. Each block writes one tile ID per frame
+            std::string cacheDirectory;                         ///< Where the tiled files are stored. Empty selects `VirtualTextureCache` in the executable directory
+        };
+
+        struct Stats
+        {
+            VirtualTextureCache::Stats cache;
+            uint32_t textureCount = 0;
+            uint32_t uploadsLastFrame = 0;          ///< Tiles uploaded by the last update()
+            uint32_t pendingRequests = 0;           ///< Missing tiles which were not uploaded by the last update()
+            uint64_t uploadedBytes = 0;             ///< Total tile data uploaded
+            uint64_t physicalMemory = 0;            ///< Size of the atlases
+            uint64_t virtualMemory = 0;             ///< Size of all the mips of all the textures
+        };
+
+        static SharedPtr create(const Desc& desc = Desc());
+        ~VirtualTextureSystem();
+
+        /** Add a texture. The first time an image is added, it's decoded, its mips generated and it's stored as a tiled file in the cache directory.
+            Adding the same image with the same color space again returns the existing ID.
+            \param[in] filename Image file
+            \param[in] loadAsSrgb Interpret the color channels as sRGB
+            \return The texture ID to pass to the shaders, or VirtualTextureCache::kInvalidTexture if the texture can't be loaded
+        */
+        uint32_t addTexture(const std::string& filename, bool loadAsSrgb);
+
+        /** Get the format of a texture, or ResourceFormat::Unknown if the ID is invalid
+        */
+        ResourceFormat getTextureFormat(uint32_t id) const;
+
+        /** Set the size of the frame the feedback is written for. No feedback is written until it's set
+        */
+        void setFrameSize(uint32_t width, uint32_t height);
+
+        /** Process the feedback of an earlier frame, upload the most needed missing tiles and update the page table
+        */
+        void update(RenderContext* pRenderContext);
+
+        /** Queue the readback of the feedback written in this frame and clear the feedback buffer
+        */
+        void endFrame(RenderContext* pRenderContext);
+
+        /** Bind the virtual textures into a ParameterBlock
+            \param[in] pBlock ParameterBlock to set data into.
+            \param[in] varName The name of the VirtualTextures struct within the block, or empty if VirtualTextures is the block.
+            \return false if there was an error, true otherwise.
+        */
+        bool setIntoParameterBlock(ParameterBlock* pBlock, const char varName[]) const;
+
+        /** Bind the virtual textures into a constant buffer.
+            \param[in] pVars ProgramVars of the program to set data into.
+            \param[in] pCB The constant buffer to set the parameters into.
+            \param[in] varName The name of the VirtualTextures member in the buffer (default 'gVirtualTextures').
+            \return false if there was an error, true otherwise.
+        */
+        bool setIntoConstantBuffer(ProgramVars* pVars, ConstantBuffer* pCB, const char varName[] = "") const;
+
+        const Stats& getStats() const { return mStats; }
+        const VirtualTextureCache& getCache() const { return mCache; }
+
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        VirtualTextureSystem(const Desc& desc);
+
+        struct Pool
+        {
+            ResourceFormat format;
+            uint32_t columns;               // Tiles per row of the atlas
+            Texture::SharedPtr pAtlas;
+        };
+
+        struct VirtualTexture
+        {
+            std::string filename;
+            TiledTextureFile::SharedPtr pFile;
+        };
+
+        /** Feedback copied to a staging buffer, read once the GPU is done with it
+        */
+        struct Readback
+        {
+            Buffer::SharedPtr pBuffer;
+            uint64_t fenceValue = 0;
+            bool pending = false;
+        };
+
+        uint32_t getPool(ResourceFormat format);
+        bool uploadTile(RenderContext* pRenderContext, const VirtualTileId& tile, bool pinned);
+        bool setIntoBlockCommon(ParameterBlock* pBlock, ConstantBuffer* pCB, const std::string& varName) const;
+
+        Desc mDesc;
+        VirtualTextureCache mCache;
+        std::vector<Pool> mPools;
+        std::vector<VirtualTexture> mTextures;
+        std::unordered_map<std::string, uint32_t> mTextureIds;     // Texture ID per canonical path and color space
+
+        TypedBuffer<uvec4>::SharedPtr mpTextureDescs;
+        TypedBuffer<uint32_t>::SharedPtr mpPageTable;
+        TypedBuffer<uint32_t>::SharedPtr mpFeedback;
+        Sampler::SharedPtr mpAtlasSampler;
+        std::vector<Readback> mReadbacks;
+        uint32_t mReadbackIndex = 0;
+        GpuFence::SharedPtr mpFence;
+
+        uvec2 mFeedbackDim = uvec2(0);
+        uint32_t mFrameIndex = 0;
+        bool mDescsDirty = false;
+        Stats mStats;
+    };
+}
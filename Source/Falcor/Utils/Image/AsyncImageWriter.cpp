@@ -0,0 +1,243 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "AsyncImageWriter.h"
+#include "Core/API/Device.h"
+#include "Core/API/Texture.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // Readback tasks own GPU resources and must be released on the main thread.
+        // Workers only report which ones are done, the main thread releases them in collect().
+        struct
+        {
+            std::mutex mutex;
+            std::condition_variable cv;
+            size_t budget = size_t(1) << 30;
+            size_t bytesInFlight = 0;
+            uint64_t nextId = 0;
+            std::unordered_map<uint64_t, std::vector<CopyContext::ReadTextureTask::SharedPtr>> pending;       // Main thread only
+            std::vector<uint64_t> done;
+            AsyncImageWriter::Stats stats;
+            bool started = false;
+            CpuTimer::TimePoint firstWrite;
+        } gWriter;
+
+        // Must be called with the lock held
+        void collect()
+        {
+            for (auto id : gWriter.done) gWriter.pending.erase(id);
+            gWriter.done.clear();
+        }
+
+        /** Wait until the budget has room for a new image, and register it
+            \return The ID of the image
+        */
+        uint64_t beginImage(size_t footprint)
+        {
+            std::unique_lock<std::mutex> lock(gWriter.mutex);
+            collect();
+            if (gWriter.bytesInFlight > 0 && gWriter.bytesInFlight + footprint > gWriter.budget)
+            {
+                auto start = CpuTimer::getCurrentTimePoint();
+                gWriter.cv.wait(lock, [footprint]() { return gWriter.bytesInFlight == 0 || gWriter.bytesInFlight + footprint <= gWriter.budget; });
+                gWriter.stats.budgetStalls++;
+                gWriter.stats.stallTime += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+                collect();
+            }
+
+            if (!gWriter.started)
+            {
+                gWriter.started = true;
+                gWriter.firstWrite = CpuTimer::getCurrentTimePoint();
+            }
+            gWriter.bytesInFlight += footprint;
+            gWriter.stats.peakBytesInFlight = std::max(gWriter.stats.peakBytesInFlight, gWriter.bytesInFlight);
+            return gWriter.nextId++;
+        }
+
+        /** Called from the workers when an image was written, or failed to be written, in which case imageSize is 0
+        */
+        void endImage(uint64_t id, size_t footprint, size_t imageSize)
+        {
+            {
+                std::lock_guard<std::mutex> lock(gWriter.mutex);
+                gWriter.done.push_back(id);
+                gWriter.bytesInFlight -= footprint;
+                if (imageSize)
+                {
+                    gWriter.stats.imagesWritten++;
+                    gWriter.stats.bytesWritten += imageSize;
+                }
+                gWriter.stats.elapsedTime = CpuTimer::calcDuration(gWriter.firstWrite, CpuTimer::getCurrentTimePoint());
+            }
+            gWriter.cv.notify_all();
+        }
+    }
+
+    void AsyncImageWriter::write(const Texture* pTexture, uint32_t mipLevel, uint32_t arraySlice, const std::string& filename, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags)
+    {
+        uint32_t width = pTexture->getWidth(mipLevel);
+        uint32_t height = pTexture->getHeight(mipLevel);
+        ResourceFormat format = pTexture->getFormat();
+        size_t imageSize = size_t(width) * height * getFormatBytesPerBlock(format);
+        // The readback buffer and the CPU copy
+        size_t footprint = 2 * imageSize;
+        uint64_t id = beginImage(footprint);
+
+        CopyContext::ReadTextureTask::SharedPtr pTask = gpDevice->getRenderContext()->asyncReadTextureSubresource(pTexture, pTexture->getSubresourceIndex(arraySlice, mipLevel));
+        CopyContext::ReadTextureTask* pRawTask = pTask.get();
+        {
+            std::lock_guard<std::mutex> lock(gWriter.mutex);
+            gWriter.pending[id] = { pTask };
+        }
+
+        auto func = [=]()
+        {
+            // The image must always be ended, otherwise its footprint is never returned and flush() waits forever
+            try
+            {
+                // Waits for the GPU, the copy was submitted by asyncReadTextureSubresource()
+                std::vector<uint8_t> data = pRawTask->getData();
+                Bitmap::saveImage(filename, width, height, fileFormat, exportFlags, format, true, data.data());
+                endImage(id, footprint, imageSize);
+            }
+            catch (const std::exception& e)
+            {
+                logError("AsyncImageWriter - Failed to write '" + filename + "': " + e.what(), Logger::MsgBox::Nope);
+                endImage(id, footprint, 0);
+            }
+        };
+
+        Threading::dispatchTask(func);
+    }
+
+    void AsyncImageWriter::writeExr(const std::vector<ExrLayer>& layers, const std::string& filename, const ExrWriter::Options& options)
+    {
+        if (layers.empty()) return;
+        uint32_t width = layers[0].pTexture->getWidth();
+        uint32_t height = layers[0].pTexture->getHeight();
+
+        std::vector<ExrWriter::Layer> exrLayers;
+        size_t imageSize = 0;
+        for (const auto& layer : layers)
+        {
+            const Texture* pTexture = layer.pTexture;
+            if (pTexture->getWidth() != width || pTexture->getHeight() != height || !ExrWriter::isFormatSupported(pTexture->getFormat()))
+            {
+                logError("AsyncImageWriter::writeExr() - Layer '" + layer.name + "' has a different size or an unsupported format. Skipping " + filename);
+                return;
+            }
+            exrLayers.push_back({ layer.name, pTexture->getFormat(), nullptr, layer.precision });
+            imageSize += size_t(width) * height * getFormatBytesPerBlock(pTexture->getFormat());
+        }
+
+        size_t footprint = 2 * imageSize;
+        uint64_t id = beginImage(footprint);
+
+        std::vector<CopyContext::ReadTextureTask::SharedPtr> tasks;
+        for (const auto& layer : layers)
+        {
+            tasks.push_back(gpDevice->getRenderContext()->asyncReadTextureSubresource(layer.pTexture, 0));
+        }
+        std::vector<CopyContext::ReadTextureTask*> rawTasks;
+        for (const auto& pTask : tasks) rawTasks.push_back(pTask.get());
+        {
+            std::lock_guard<std::mutex> lock(gWriter.mutex);
+            gWriter.pending[id] = std::move(tasks);
+        }
+
+        auto func = [=]() mutable
+        {
+            try
+            {
+                std::vector<std::vector<uint8_t>> data(rawTasks.size());
+                for (size_t i = 0; i < rawTasks.size(); i++)
+                {
+                    data[i] = rawTasks[i]->getData();
+                    exrLayers[i].pData = data[i].data();
+                }
+                ExrWriter::write(filename, width, height, exrLayers, options);
+                endImage(id, footprint, imageSize);
+            }
+            catch (const std::exception& e)
+            {
+                logError("AsyncImageWriter - Failed to write '" + filename + "': " + e.what(), Logger::MsgBox::Nope);
+                endImage(id, footprint, 0);
+            }
+        };
+
+        Threading::dispatchTask(func);
+    }
+
+    void AsyncImageWriter::flush()
+    {
+        std::unique_lock<std::mutex> lock(gWriter.mutex);
+        if (gWriter.bytesInFlight)
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            gWriter.cv.wait(lock, []() { return gWriter.bytesInFlight == 0; });
+            gWriter.stats.stallTime += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        }
+        collect();
+    }
+
+    void AsyncImageWriter::shutdown()
+    {
+        flush();
+        std::lock_guard<std::mutex> lock(gWriter.mutex);
+        gWriter.pending.clear();
+    }
+
+    void AsyncImageWriter::setMemoryBudget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(gWriter.mutex);
+        gWriter.budget = bytes;
+    }
+
+    size_t AsyncImageWriter::getMemoryBudget()
+    {
+        std::lock_guard<std::mutex> lock(gWriter.mutex);
+        return gWriter.budget;
+    }
+
+    AsyncImageWriter::Stats AsyncImageWriter::getStats()
+    {
+        std::lock_guard<std::mutex> lock(gWriter.mutex);
+        return gWriter.stats;
+    }
+
+    void AsyncImageWriter::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(gWriter.mutex);
+        gWriter.stats = Stats();
+        gWriter.started = false;
+    }
+}
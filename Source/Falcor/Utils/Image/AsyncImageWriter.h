@@ -0,0 +1,96 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ExrWriter.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Falcor
+{
+    class Texture;
+
+    /** Writes textures to image files in the background.
+        The texture is read back asynchronously and the image is encoded on the thread pool, so the render thread doesn't wait for the GPU or the encoder.
+        The memory held by pending images is bounded. write() blocks while the budget is exceeded.
+        All functions must be called from the main thread.
+    */
+    class dlldecl AsyncImageWriter
+    {
+    public:
+        struct Stats
+        {
+            uint64_t imagesWritten = 0;      // Image files, a multi-layer OpenEXR file counts once
+            uint64_t bytesWritten = 0;      // Uncompressed image bytes
+            uint64_t budgetStalls = 0;      // Number of write() calls which waited for the memory budget
+            double stallTime = 0;           // Milliseconds write() and flush() waited for pending images
+            double elapsedTime = 0;         // Milliseconds from the first write() since the statistics were reset to the completion of the last image
+            size_t peakBytesInFlight = 0;
+        };
+
+        /** Write a texture subresource to an image file. The texture must be in a format that Bitmap::saveImage() supports.
+            \param[in] pTexture The texture. Can be released after the call returns.
+            \param[in] mipLevel Requested mip-level
+            \param[in] arraySlice Requested array-slice
+            \param[in] filename Name of the file to save
+            \param[in] fileFormat Destination image file format
+            \param[in] exportFlags Save flags, see Bitmap::ExportFlags
+        */
+        static void write(const Texture* pTexture, uint32_t mipLevel, uint32_t arraySlice, const std::string& filename, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags);
+
+        struct ExrLayer
+        {
+            std::string name;                   ///< Layer name, see ExrWriter::Layer
+            const Texture* pTexture = nullptr;  ///< The first mip-level and array-slice is written
+            ExrWriter::Precision precision = ExrWriter::Precision::Half;
+        };
+
+        /** Write textures as the layers of one OpenEXR file. The file is encoded with ExrWriter.
+            \param[in] layers The layers. The textures must have the same size and formats that ExrWriter supports. They can be released after the call returns.
+            \param[in] filename Name of the file to save
+            \param[in] options File options
+        */
+        static void writeExr(const std::vector<ExrLayer>& layers, const std::string& filename, const ExrWriter::Options& options);
+
+        /** Block until all the pending images were written
+        */
+        static void flush();
+
+        /** Flush and release all resources. Called before the device is destroyed.
+        */
+        static void shutdown();
+
+        /** Set the maximum number of bytes held by pending images. This includes the readback buffer and the CPU copy of each image.
+            A single image larger than the budget is still written, but only once nothing else is pending.
+        */
+        static void setMemoryBudget(size_t bytes);
+        static size_t getMemoryBudget();
+
+        static Stats getStats();
+        static void resetStats();
+    };
+}
@@ -114,7 +114,9 @@ namespace Falcor
             DdsHeader header;
             DdsHeaderDX10 dx10Header;
             bool hasDX10Header;
-            std::vector<uint8_t> data;
+            const uint8_t* pData = nullptr;     // Texel data
+            size_t dataSize = 0;
+            std::shared_ptr<const void> pStorage;  // Owns the memory pData points into, usually the file mapping
         };
     }
 }
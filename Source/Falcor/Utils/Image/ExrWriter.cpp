@@ -0,0 +1,505 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "ExrWriter.h"
+#include "FreeImage.h"
+#include "Utils/Threading.h"
+#include "glm/gtc/packing.hpp"
+#include <fstream>
+#include <set>
+
+namespace Falcor
+{
+    namespace
+    {
+        const int32_t kMagic = 20000630;
+        const int32_t kVersion = 2;
+        const int32_t kLongNamesFlag = 0x400;
+        const int32_t kMultiPartFlag = 0x1000;
+        const size_t kMaxShortNameLength = 31;
+        const char kDefaultPartName[] = "rgba";
+
+        const int32_t kPixelTypeHalf = 1;
+        const int32_t kPixelTypeFloat = 2;
+
+        struct SourceDesc
+        {
+            uint32_t channelCount = 0;      // Channels written to the file
+            uint32_t bytesPerChannel = 0;   // 0 for packed formats
+            FormatType type = FormatType::Unknown;
+            bool bgr = false;
+        };
+
+        bool getSourceDesc(ResourceFormat format, SourceDesc& desc)
+        {
+            switch (format)
+            {
+            case ResourceFormat::R11G11B10Float:
+            case ResourceFormat::RGB9E5Float:       desc = { 3, 0, FormatType::Float, false }; return true;
+            case ResourceFormat::RGB10A2Unorm:      desc = { 4, 0, FormatType::Unorm, false }; return true;
+            case ResourceFormat::R32FloatX32:       desc = { 1, 4, FormatType::Float, false }; return true;
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRA8UnormSrgb:    desc = { 4, 1, getFormatType(format), true }; return true;
+            case ResourceFormat::BGRX8Unorm:
+            case ResourceFormat::BGRX8UnormSrgb:    desc = { 3, 1, getFormatType(format), true }; return true;
+            default: break;
+            }
+
+            if (format == ResourceFormat::Unknown || isCompressedFormat(format) || isStencilFormat(format)) return false;
+
+            // The remaining formats must have channels of the same size
+            uint32_t channelCount = getFormatChannelCount(format);
+            uint32_t bits = getNumChannelBits(format, 0);
+            for (uint32_t c = 1; c < channelCount; c++)
+            {
+                if (getNumChannelBits(format, c) != bits) return false;
+            }
+            if ((bits != 8 && bits != 16 && bits != 32) || getFormatBytesPerBlock(format) != channelCount * bits / 8) return false;
+
+            FormatType type = getFormatType(format);
+            switch (type)
+            {
+            case FormatType::Float: if (bits == 8) return false; break;
+            case FormatType::Unorm:
+            case FormatType::Snorm: if (bits == 32) return false; break;
+            case FormatType::UnormSrgb: if (bits != 8) return false; break;
+            case FormatType::Uint:
+            case FormatType::Sint: break;
+            default: return false;
+            }
+
+            desc = { channelCount, bits / 8, type, false };
+            return true;
+        }
+
+        const float* getSrgbTable()
+        {
+            static const std::vector<float> table = []()
+            {
+                std::vector<float> t(256);
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    float c = i / 255.f;
+                    t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                return t;
+            }();
+            return table.data();
+        }
+
+        /** Convert a row of source texels to float4. sRGB data is converted to linear
+        */
+        void decodeRow(const uint8_t* pSrc, ResourceFormat format, const SourceDesc& desc, uint32_t width, float4* pDst)
+        {
+            if (desc.bytesPerChannel == 0)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint32_t packed;
+                    std::memcpy(&packed, pSrc + x * 4, 4);
+                    switch (format)
+                    {
+                    case ResourceFormat::R11G11B10Float:    pDst[x] = float4(glm::unpackF2x11_1x10(packed), 1.f); break;
+                    case ResourceFormat::RGB9E5Float:       pDst[x] = float4(glm::unpackF3x9_E1x5(packed), 1.f); break;
+                    case ResourceFormat::RGB10A2Unorm:      pDst[x] = glm::unpackUnorm3x10_1x2(packed); break;
+                    default: should_not_get_here();
+                    }
+                }
+                return;
+            }
+
+            const float* pSrgb = getSrgbTable();
+            const uint32_t stride = getFormatBytesPerBlock(format);
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t* pTexel = pSrc + x * stride;
+                float4 v(0, 0, 0, 1);
+                for (uint32_t c = 0; c < desc.channelCount; c++)
+                {
+                    const uint8_t* p = pTexel + c * desc.bytesPerChannel;
+                    switch (desc.type)
+                    {
+                    case FormatType::Float:
+                        if (desc.bytesPerChannel == 2) { uint16_t h; std::memcpy(&h, p, 2); v[c] = glm::unpackHalf1x16(h); }
+                        else std::memcpy(&v[c], p, 4);
+                        break;
+                    case FormatType::Unorm:
+                        if (desc.bytesPerChannel == 1) v[c] = p[0] / 255.f;
+                        else { uint16_t u; std::memcpy(&u, p, 2); v[c] = u / 65535.f; }
+                        break;
+                    case FormatType::UnormSrgb:
+                        v[c] = c < 3 ? pSrgb[p[0]] : p[0] / 255.f;
+                        break;
+                    case FormatType::Snorm:
+                        if (desc.bytesPerChannel == 1) v[c] = std::max((int8_t)p[0] / 127.f, -1.f);
+                        else { int16_t s; std::memcpy(&s, p, 2); v[c] = std::max(s / 32767.f, -1.f); }
+                        break;
+                    case FormatType::Uint:
+                        if (desc.bytesPerChannel == 1) v[c] = (float)p[0];
+                        else if (desc.bytesPerChannel == 2) { uint16_t u; std::memcpy(&u, p, 2); v[c] = (float)u; }
+                        else { uint32_t u; std::memcpy(&u, p, 4); v[c] = (float)u; }
+                        break;
+                    case FormatType::Sint:
+                        if (desc.bytesPerChannel == 1) v[c] = (float)(int8_t)p[0];
+                        else if (desc.bytesPerChannel == 2) { int16_t s; std::memcpy(&s, p, 2); v[c] = (float)s; }
+                        else { int32_t s; std::memcpy(&s, p, 4); v[c] = (float)s; }
+                        break;
+                    default:
+                        should_not_get_here();
+                    }
+                }
+                if (desc.bgr) std::swap(v.x, v.z);
+                pDst[x] = v;
+            }
+        }
+
+        std::vector<std::string> getChannelNames(ResourceFormat format, uint32_t channelCount)
+        {
+            if (isDepthFormat(format)) return { "Z" };
+            switch (channelCount)
+            {
+            case 1: return { "Y" };
+            case 2: return { "R", "G" };
+            case 3: return { "R", "G", "B" };
+            default: return { "R", "G", "B", "A" };
+            }
+        }
+
+        struct Channel
+        {
+            std::string name;
+            uint32_t layer;
+            uint32_t component;
+            int32_t pixelType;
+        };
+
+        struct Part
+        {
+            std::string name;                   // Only used in multi-part files
+            std::vector<uint32_t> layers;
+            std::vector<Channel> channels;      // Sorted by name, as the file format requires
+            size_t bytesPerLine = 0;
+        };
+
+        class HeaderWriter
+        {
+        public:
+            void add(const std::string& name, const std::string& type, const void* pValue, size_t size)
+            {
+                int32_t size32 = (int32_t)size;
+                append(name.c_str(), name.size() + 1);
+                append(type.c_str(), type.size() + 1);
+                append(&size32, sizeof(size32));
+                append(pValue, size);
+            }
+
+            template<typename T>
+            void add(const std::string& name, const std::string& type, const T& value) { add(name, type, &value, sizeof(T)); }
+
+            void append(const void* pData, size_t size)
+            {
+                const uint8_t* pBytes = (const uint8_t*)pData;
+                mData.insert(mData.end(), pBytes, pBytes + size);
+            }
+
+            const std::vector<uint8_t>& getData() const { return mData; }
+
+        private:
+            std::vector<uint8_t> mData;
+        };
+
+        void writeHeader(HeaderWriter& h, const Part& part, uint32_t width, uint32_t height, ExrWriter::Compression compression, bool multiPart, uint32_t chunkCount)
+        {
+            std::vector<uint8_t> chlist;
+            for (const auto& c : part.channels)
+            {
+                chlist.insert(chlist.end(), c.name.begin(), c.name.end());
+                chlist.push_back(0);
+                int32_t desc[4] = { c.pixelType, 0, 1, 1 };     // Pixel type, not perceptually linear, no subsampling
+                chlist.insert(chlist.end(), (const uint8_t*)desc, (const uint8_t*)desc + sizeof(desc));
+            }
+            chlist.push_back(0);
+
+            int32_t window[4] = { 0, 0, (int32_t)width - 1, (int32_t)height - 1 };
+            float windowCenter[2] = { 0, 0 };
+
+            // Attributes in alphabetical order, as the OpenEXR library writes them
+            h.add("channels", "chlist", chlist.data(), chlist.size());
+            if (multiPart) h.add("chunkCount", "int", (int32_t)chunkCount);
+            h.add("compression", "compression", (uint8_t)compression);
+            h.add("dataWindow", "box2i", window);
+            h.add("displayWindow", "box2i", window);
+            h.add("lineOrder", "lineOrder", (uint8_t)0);     // Increasing y
+            if (multiPart) h.add("name", "string", part.name.data(), part.name.size());
+            h.add("pixelAspectRatio", "float", 1.f);
+            h.add("screenWindowCenter", "v2f", windowCenter);
+            h.add("screenWindowWidth", "float", 1.f);
+            if (multiPart) h.add("type", "string", "scanlineimage", 13);
+            h.append("", 1);
+        }
+
+        uint32_t getLinesPerChunk(ExrWriter::Compression compression)
+        {
+            return compression == ExrWriter::Compression::ZIP ? 16 : 1;
+        }
+
+        /** Reorder the bytes and apply the delta predictor, as ZIP and RLE compression expect.
+            The first half holds the even bytes, the second half the odd ones. Each byte is then replaced by its difference to the previous one.
+        */
+        void predict(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst)
+        {
+            dst.resize(src.size());
+            size_t half = (src.size() + 1) / 2;
+            for (size_t i = 0; i < src.size(); i++) dst[(i & 1) ? half + i / 2 : i / 2] = src[i];
+
+            uint8_t prev = dst.empty() ? 0 : dst[0];
+            for (size_t i = 1; i < dst.size(); i++)
+            {
+                uint8_t cur = dst[i];
+                dst[i] = (uint8_t)(cur - prev + 128);
+                prev = cur;
+            }
+        }
+
+        /** Run-length encode. Runs of 3 to 128 equal bytes are written as (length - 1, byte), everything else as (-length, bytes...)
+        */
+        void compressRle(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst)
+        {
+            const size_t kMinRun = 3, kMaxRun = 127;
+            dst.clear();
+            size_t start = 0, end = 1;
+            const size_t n = src.size();
+            while (start < n)
+            {
+                while (end < n && src[start] == src[end] && end - start - 1 < kMaxRun) end++;
+                if (end - start >= kMinRun)
+                {
+                    dst.push_back((uint8_t)(end - start - 1));
+                    dst.push_back(src[start]);
+                    start = end;
+                }
+                else
+                {
+                    // Extend the literal run until the next run of 3 equal bytes
+                    while (end < n && ((end + 1 >= n || src[end] != src[end + 1]) || (end + 2 >= n || src[end + 1] != src[end + 2])) && end - start < kMaxRun) end++;
+                    dst.push_back((uint8_t)(int8_t)-(int32_t)(end - start));
+                    dst.insert(dst.end(), src.begin() + start, src.begin() + end);
+                    start = end;
+                }
+                end++;
+            }
+        }
+
+        /** Compress a chunk. Chunks which don't get smaller are stored uncompressed, which readers detect by the size
+        */
+        void compressChunk(ExrWriter::Compression compression, std::vector<uint8_t>& raw, std::vector<uint8_t>& packed)
+        {
+            if (compression != ExrWriter::Compression::None)
+            {
+                std::vector<uint8_t> predicted;
+                predict(raw, predicted);
+                if (compression == ExrWriter::Compression::RLE)
+                {
+                    compressRle(predicted, packed);
+                }
+                else
+                {
+                    packed.resize(predicted.size() + predicted.size() / 100 + 64);
+                    DWORD size = FreeImage_ZLibCompress(packed.data(), (DWORD)packed.size(), predicted.data(), (DWORD)predicted.size());
+                    packed.resize(size == 0 ? packed.size() : size);
+                }
+                if (packed.size() < raw.size()) return;
+            }
+            packed.swap(raw);
+        }
+    }
+
+    bool ExrWriter::isFormatSupported(ResourceFormat format)
+    {
+        SourceDesc desc;
+        return getSourceDesc(format, desc);
+    }
+
+    ExrWriter::Precision ExrWriter::getDefaultPrecision(ResourceFormat format)
+    {
+        // Half has an 11-bit mantissa, which holds 8-bit and 10-bit normalized values and 16-bit floats exactly
+        SourceDesc desc;
+        if (!getSourceDesc(format, desc)) return Precision::Half;
+        if (desc.bytesPerChannel == 4 || (desc.bytesPerChannel == 2 && desc.type != FormatType::Float)) return Precision::Float;
+        return Precision::Half;
+    }
+
+    bool ExrWriter::write(const std::string& filename, uint32_t width, uint32_t height, const std::vector<Layer>& layers, const Options& options)
+    {
+        if (width == 0 || height == 0 || layers.empty())
+        {
+            logError("ExrWriter::write() - Nothing to write to " + filename);
+            return false;
+        }
+
+        std::vector<SourceDesc> sources(layers.size());
+        std::set<std::string> names;
+        for (size_t i = 0; i < layers.size(); i++)
+        {
+            const Layer& layer = layers[i];
+            if (!getSourceDesc(layer.format, sources[i]))
+            {
+                logError("ExrWriter::write() - Layer '" + layer.name + "' has unsupported format " + to_string(layer.format));
+                return false;
+            }
+            // Parts can't have empty names
+            std::string name = (options.multiPart && layer.name.empty()) ? kDefaultPartName : layer.name;
+            if (!layer.pData || names.insert(name).second == false)
+            {
+                logError("ExrWriter::write() - Layer '" + layer.name + "' has no data or is not unique");
+                return false;
+            }
+        }
+
+        // Single-part files hold all the layers. Multi-part files hold one layer per part
+        std::vector<Part> parts(options.multiPart ? layers.size() : 1);
+        for (uint32_t i = 0; i < (uint32_t)layers.size(); i++)
+        {
+            Part& part = parts[options.multiPart ? i : 0];
+            part.name = layers[i].name.empty() ? kDefaultPartName : layers[i].name;
+            part.layers.push_back(i);
+
+            std::string prefix = (options.multiPart || layers[i].name.empty()) ? "" : layers[i].name + ".";
+            int32_t pixelType = layers[i].precision == Precision::Float ? kPixelTypeFloat : kPixelTypeHalf;
+            auto channelNames = getChannelNames(layers[i].format, sources[i].channelCount);
+            for (uint32_t c = 0; c < (uint32_t)channelNames.size(); c++)
+            {
+                part.channels.push_back({ prefix + channelNames[c], i, c, pixelType });
+                part.bytesPerLine += (size_t)width * (pixelType == kPixelTypeFloat ? 4 : 2);
+            }
+        }
+
+        int32_t version = kVersion | (options.multiPart ? kMultiPartFlag : 0);
+        for (auto& part : parts)
+        {
+            std::sort(part.channels.begin(), part.channels.end(), [](const Channel& a, const Channel& b) { return a.name < b.name; });
+            for (const auto& c : part.channels)
+            {
+                if (c.name.size() > kMaxShortNameLength) version |= kLongNamesFlag;
+            }
+        }
+
+        // Convert and compress all the chunks
+        const uint32_t linesPerChunk = getLinesPerChunk(options.compression);
+        const uint32_t chunksPerPart = div_round_up(height, linesPerChunk);
+        std::vector<std::vector<uint8_t>> chunks(parts.size() * chunksPerPart);
+
+        auto encodeChunk = [&](uint32_t index)
+        {
+            const Part& part = parts[index / chunksPerPart];
+            uint32_t firstLine = (index % chunksPerPart) * linesPerChunk;
+            uint32_t lineCount = std::min(linesPerChunk, height - firstLine);
+
+            std::vector<uint8_t> raw(part.bytesPerLine * lineCount);
+            std::vector<std::vector<float4>> rows(layers.size());
+            uint8_t* pDst = raw.data();
+            for (uint32_t y = firstLine; y < firstLine + lineCount; y++)
+            {
+                for (uint32_t l : part.layers)
+                {
+                    rows[l].resize(width);
+                    const uint8_t* pSrc = (const uint8_t*)layers[l].pData + (size_t)y * width * getFormatBytesPerBlock(layers[l].format);
+                    decodeRow(pSrc, layers[l].format, sources[l], width, rows[l].data());
+                }
+
+                for (const auto& c : part.channels)
+                {
+                    const float4* pRow = rows[c.layer].data();
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        float v = pRow[x][c.component];
+                        if (c.pixelType == kPixelTypeFloat)
+                        {
+                            std::memcpy(pDst, &v, 4);
+                            pDst += 4;
+                        }
+                        else
+                        {
+                            uint16_t h = glm::packHalf1x16(v);
+                            std::memcpy(pDst, &h, 2);
+                            pDst += 2;
+                        }
+                    }
+                }
+            }
+            compressChunk(options.compression, raw, chunks[index]);
+        };
+        Threading::parallelFor((uint32_t)chunks.size(), encodeChunk);
+
+        // Headers, the offset tables and the chunks
+        HeaderWriter header;
+        header.append(&kMagic, sizeof(kMagic));
+        header.append(&version, sizeof(version));
+        for (const auto& part : parts) writeHeader(header, part, width, height, options.compression, options.multiPart, chunksPerPart);
+        if (options.multiPart) header.append("", 1);
+
+        const size_t chunkHeaderSize = options.multiPart ? 12 : 8;      // Part number, y and size
+        std::vector<uint64_t> offsets(chunks.size());
+        uint64_t offset = header.getData().size() + offsets.size() * sizeof(uint64_t);
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            offsets[i] = offset;
+            offset += chunkHeaderSize + chunks[i].size();
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            logError("ExrWriter::write() - Can't open " + filename);
+            return false;
+        }
+        file.write((const char*)header.getData().data(), header.getData().size());
+        file.write((const char*)offsets.data(), offsets.size() * sizeof(uint64_t));
+        for (uint32_t i = 0; i < (uint32_t)chunks.size(); i++)
+        {
+            int32_t chunkHeader[3] = { (int32_t)(i / chunksPerPart), (int32_t)((i % chunksPerPart) * linesPerChunk), (int32_t)chunks[i].size() };
+            const int32_t* pChunkHeader = options.multiPart ? chunkHeader : chunkHeader + 1;
+            file.write((const char*)pChunkHeader, chunkHeaderSize);
+            file.write((const char*)chunks[i].data(), chunks[i].size());
+        }
+
+        if (!file)
+        {
+            logError("ExrWriter::write() - Failed to write " + filename);
+            return false;
+        }
+        return true;
+    }
+
+    SCRIPT_BINDING(ExrWriter)
+    {
+        // Saved scripts name the enum after the C++ type (see Scripting::getArgString()), so it's bound under the same name
+        auto compression = m.enum_<ExrWriter::Compression>("Compression");
+        compression.regEnumVal(ExrWriter::Compression::None).regEnumVal(ExrWriter::Compression::RLE).regEnumVal(ExrWriter::Compression::ZIPS).regEnumVal(ExrWriter::Compression::ZIP);
+    }
+}
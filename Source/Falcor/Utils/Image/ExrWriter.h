@@ -0,0 +1,106 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+
+namespace Falcor
+{
+    /** Writes several images of the same size into one OpenEXR file.
+        Each image is a layer. In a single-part file the channels of a layer are named `<layer>.R`, `<layer>.G` etc. (a layer with an empty name writes `R`, `G`, ... which viewers show by default).
+        In a multi-part file each layer is a separate part named after the layer, which readers can load without decoding the other layers.
+        Scanline chunks are compressed on the thread pool.
+        Supported source formats are 8/16-bit unorm and snorm formats (including sRGB and BGRA/BGRX, which are converted to linear), 16/32-bit float formats, 8/16/32-bit integer formats, R11G11B10Float and RGB10A2Unorm, with 1 to 4 channels.
+        Depth formats without stencil are written as a single `Z` channel.
+    */
+    class dlldecl ExrWriter
+    {
+    public:
+        /** The compression of the scanline chunks. The values match the file format
+        */
+        enum class Compression
+        {
+            None = 0,
+            RLE = 1,        ///< Run-length encoding. Fast, only helps with flat areas
+            ZIPS = 2,       ///< Zlib, one scanline per chunk
+            ZIP = 3,        ///< Zlib, 16 scanlines per chunk. Best ratio of the supported methods
+        };
+
+        enum class Precision
+        {
+            Half,           ///< 16-bit float
+            Float,          ///< 32-bit float
+        };
+
+        struct Layer
+        {
+            std::string name;                           ///< Layer name. Must be unique in the file, only one layer can have an empty name
+            ResourceFormat format = ResourceFormat::Unknown;
+            const void* pData = nullptr;                ///< Tightly packed rows, top row first
+            Precision precision = Precision::Half;      ///< Precision the channels are stored with
+        };
+
+        struct Options
+        {
+            Compression compression = Compression::ZIP;
+            bool multiPart = false;                     ///< Write each layer as a separate part. Requires OpenEXR 2.0 readers
+        };
+
+        /** Check if a format is supported as a layer format
+        */
+        static bool isFormatSupported(ResourceFormat format);
+
+        /** Get the default precision for a format: Float for 32-bit formats, Half otherwise
+        */
+        static Precision getDefaultPrecision(ResourceFormat format);
+
+        /** Write an OpenEXR file
+            \param[in] filename The file to write
+            \param[in] width Width of all the layers
+            \param[in] height Height of all the layers
+            \param[in] layers The layers. Their formats must be supported, see isFormatSupported()
+            \param[in] options File options
+            \return false if the layers are invalid or the file can't be written, otherwise true
+        */
+        static bool write(const std::string& filename, uint32_t width, uint32_t height, const std::vector<Layer>& layers, const Options& options = Options());
+    };
+
+    inline std::string to_string(ExrWriter::Compression c)
+    {
+#define c2s(c_) case ExrWriter::Compression::c_: return #c_
+        switch (c)
+        {
+            c2s(None);
+            c2s(RLE);
+            c2s(ZIPS);
+            c2s(ZIP);
+        default:
+            should_not_get_here();
+            return "";
+        }
+#undef c2s
+    }
+}
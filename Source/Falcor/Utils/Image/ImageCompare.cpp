@@ -0,0 +1,555 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "ImageCompare.h"
+#include "Bitmap.h"
+#include "Utils/Threading.h"
+#include "Utils/Color/ColorUtils.h"
+#include "Data/HostDeviceData.h"
+#include "glm/gtc/packing.hpp"
+#include <xmmintrin.h>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kRowsPerJob = 16;
+        const float3 kLuminanceWeights(0.2126f, 0.7152f, 0.0722f);
+        const float kRelMseEpsilon = 0.01f;
+
+        // SSIM, from Wang et al. 2004, "Image Quality Assessment: From Error Visibility to Structural Similarity"
+        const float kSsimSigma = 1.5f;
+        const int32_t kSsimRadius = 5;
+        const float kSsimC1 = 0.01f * 0.01f;
+        const float kSsimC2 = 0.03f * 0.03f;
+
+        // LDR-FLIP, from Andersson et al. 2020, "FLIP: A Difference Evaluator for Alternating Images"
+        const float kFlipQc = 0.7f;
+        const float kFlipQf = 0.5f;
+        const float kFlipPc = 0.4f;
+        const float kFlipPt = 0.95f;
+        const float kFlipFeatureWidth = 0.082f;
+
+        // Contrast sensitivity functions of the opponent channels, as sums of Gaussians a * sqrt(pi / b) * exp(-pi^2 * x^2 / b).
+        // The blue-yellow channel has two terms, the others one.
+        const float kCsfA[] = { 1.f, 0.0047f };
+        const float kCsfRg[] = { 1.f, 0.0053f };
+        const float kCsfBy1[] = { 34.1f, 0.04f };
+        const float kCsfBy2[] = { 13.5f, 0.025f };
+        const float kCsfMaxB = 0.04f;
+
+        using Plane = std::vector<float4>;
+
+        /** Separable filter kernel with a weight per SIMD lane, so a single pass can apply a different filter to each channel
+        */
+        struct Kernel
+        {
+            int32_t radius = 0;
+            std::vector<float4> weights;    ///< 2 * radius + 1 taps
+        };
+
+        double mean(const std::vector<float>& map, uint32_t width, uint32_t height)
+        {
+            // Sum per row, then add the rows in order so the result doesn't depend on the scheduling
+            std::vector<double> rowSums(height);
+            Threading::parallelFor(height, [&](uint32_t y)
+            {
+                double sum = 0;
+                for (uint32_t x = 0; x < width; x++) sum += map[y * width + x];
+                rowSums[y] = sum;
+            }, kRowsPerJob);
+            double sum = 0;
+            for (double s : rowSums) sum += s;
+            return sum / ((double)width * height);
+        }
+
+        /** Convolve a plane with a separable kernel, clamping to the edges
+        */
+        void convolve(const Plane& src, uint32_t width, uint32_t height, const Kernel& kx, const Kernel& ky, Plane& dst)
+        {
+            assert(&src != &dst);
+            Plane tmp(src.size());
+            Threading::parallelFor(height, [&](uint32_t y)
+            {
+                const float4* pSrc = &src[y * width];
+                float4* pTmp = &tmp[y * width];
+                for (int32_t x = 0; x < (int32_t)width; x++)
+                {
+                    __m128 sum = _mm_setzero_ps();
+                    for (int32_t t = -kx.radius; t <= kx.radius; t++)
+                    {
+                        int32_t sx = glm::clamp(x + t, 0, (int32_t)width - 1);
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&pSrc[sx].x), _mm_loadu_ps(&kx.weights[t + kx.radius].x)));
+                    }
+                    _mm_storeu_ps(&pTmp[x].x, sum);
+                }
+            }, kRowsPerJob);
+
+            // Vertical pass, accumulating whole rows to walk memory in order
+            dst.assign(src.size(), float4(0));
+            Threading::parallelFor(height, [&](uint32_t y)
+            {
+                float4* pDst = &dst[y * width];
+                for (int32_t t = -ky.radius; t <= ky.radius; t++)
+                {
+                    int32_t sy = glm::clamp((int32_t)y + t, 0, (int32_t)height - 1);
+                    const float4* pRow = &tmp[sy * width];
+                    __m128 weight = _mm_loadu_ps(&ky.weights[t + ky.radius].x);
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        _mm_storeu_ps(&pDst[x].x, _mm_add_ps(_mm_loadu_ps(&pDst[x].x), _mm_mul_ps(_mm_loadu_ps(&pRow[x].x), weight)));
+                    }
+                }
+            }, kRowsPerJob);
+        }
+
+        /** Create a kernel from a weight function per lane
+        */
+        Kernel createKernel(int32_t radius, const std::function<float4(float)>& weight)
+        {
+            Kernel k;
+            k.radius = radius;
+            for (int32_t t = -radius; t <= radius; t++) k.weights.push_back(weight((float)t));
+            return k;
+        }
+
+        /** Scale each lane of a kernel. Positive and negative weights are scaled separately
+        */
+        void normalize(Kernel& k, float4 positiveSum, float4 negativeSum)
+        {
+            for (auto& w : k.weights)
+            {
+                for (uint32_t i = 0; i < 4; i++) w[i] /= w[i] >= 0.f ? positiveSum[i] : negativeSum[i];
+            }
+        }
+
+        void getWeightSums(const Kernel& k, float4& positiveSum, float4& negativeSum)
+        {
+            positiveSum = float4(0);
+            negativeSum = float4(0);
+            for (const auto& w : k.weights)
+            {
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    if (w[i] >= 0.f) positiveSum[i] += w[i];
+                    else negativeSum[i] -= w[i];
+                }
+            }
+        }
+
+        void computeSsim(const ImageCompare::Image& test, const ImageCompare::Image& reference, std::vector<float>& ssimMap)
+        {
+            const uint32_t width = test.width;
+            const uint32_t height = test.height;
+
+            // First and second moments of the luminance. The cross term gets its own plane
+            Plane moments(test.data.size());
+            Plane cross(test.data.size());
+            Threading::parallelFor(height, [&](uint32_t y)
+            {
+                for (uint32_t i = y * width; i < (y + 1) * width; i++)
+                {
+                    float a = glm::dot(float3(test.data[i]), kLuminanceWeights);
+                    float b = glm::dot(float3(reference.data[i]), kLuminanceWeights);
+                    moments[i] = float4(a, b, a * a, b * b);
+                    cross[i] = float4(a * b, 0.f, 0.f, 0.f);
+                }
+            }, kRowsPerJob);
+
+            Kernel gauss = createKernel(kSsimRadius, [](float x) { return float4(std::exp(-x * x / (2.f * kSsimSigma * kSsimSigma))); });
+            float4 sum, unused;
+            getWeightSums(gauss, sum, unused);
+            normalize(gauss, sum, sum);
+
+            Plane meanMoments, meanCross;
+            convolve(moments, width, height, gauss, gauss, meanMoments);
+            convolve(cross, width, height, gauss, gauss, meanCross);
+
+            ssimMap.resize(test.data.size());
+            Threading::parallelFor(height, [&](uint32_t y)
+            {
+                for (uint32_t i = y * width; i < (y + 1) * width; i++)
+                {
+                    const float4& m = meanMoments[i];
+                    float varA = m.z - m.x * m.x;
+                    float varB = m.w - m.y * m.y;
+                    float covar = meanCross[i].x - m.x * m.y;
+                    ssimMap[i] = ((2.f * m.x * m.y + kSsimC1) * (2.f * covar + kSsimC2)) / ((m.x * m.x + m.y * m.y + kSsimC1) * (varA + varB + kSsimC2));
+                }
+            }, kRowsPerJob);
+        }
+
+        struct FlipColorSpace
+        {
+            float3 whitePoint = kColorTransform_RGBtoXYZ_Rec709 * float3(1.f);
+
+            float3 rgbToYCxCz(float3 rgb) const
+            {
+                float3 xyz = kColorTransform_RGBtoXYZ_Rec709 * rgb / whitePoint;
+                return float3(116.f * xyz.y - 16.f, 500.f * (xyz.x - xyz.y), 200.f * (xyz.y - xyz.z));
+            }
+
+            float3 yCxCzToRgb(float3 c) const
+            {
+                float y = (c.x + 16.f) / 116.f;
+                float3 xyz = float3(c.y / 500.f + y, y, y - c.z / 200.f) * whitePoint;
+                return kColorTransform_XYZtoRGB_Rec709 * xyz;
+            }
+
+            /** Linear RGB to CIELAB, followed by the Hunt adjustment of the chroma
+            */
+            float3 rgbToHuntLab(float3 rgb) const
+            {
+                auto f = [](float t)
+                {
+                    const float delta = 6.f / 29.f;
+                    return t > delta * delta * delta ? std::cbrt(t) : t / (3.f * delta * delta) + 4.f / 29.f;
+                };
+                float3 xyz = kColorTransform_RGBtoXYZ_Rec709 * rgb / whitePoint;
+                float3 fxyz(f(xyz.x), f(xyz.y), f(xyz.z));
+                float l = 116.f * fxyz.y - 16.f;
+                float a = 500.f * (fxyz.x - fxyz.y);
+                float b = 200.f * (fxyz.y - fxyz.z);
+                return float3(l, 0.01f * l * a, 0.01f * l * b);
+            }
+        };
+
+        float hyab(float3 a, float3 b)
+        {
+            float3 d = a - b;
+            return std::abs(d.x) + std::sqrt(d.y * d.y + d.z * d.z);
+        }
+
+        void computeFlip(const ImageCompare::Image& test, const ImageCompare::Image& reference, float pixelsPerDegree, std::vector<float>& flipMap)
+        {
+            const uint32_t width = test.width;
+            const uint32_t height = test.height;
+            const FlipColorSpace cs;
+
+            // The opponent colors are (Y, Cx, Cz, Cz) so the two terms of the blue-yellow filter run side by side.
+            // The feature planes hold the luminance in all lanes, filtered with edge and point detectors in each direction.
+            const ImageCompare::Image* pImages[] = { &test, &reference };
+            Plane color[2], features[2];
+            for (uint32_t j = 0; j < 2; j++)
+            {
+                const ImageCompare::Image& image = *pImages[j];
+                color[j].resize(image.data.size());
+                features[j].resize(image.data.size());
+                Threading::parallelFor(height, [&](uint32_t y)
+                {
+                    for (uint32_t i = y * width; i < (y + 1) * width; i++)
+                    {
+                        float3 rgb = float3(image.data[i]);
+                        rgb = image.srgb ? sRGBToLinear(glm::clamp(rgb, 0.f, 1.f)) : glm::clamp(rgb, 0.f, 1.f);
+                        float3 c = cs.rgbToYCxCz(rgb);
+                        color[j][i] = float4(c, c.z);
+                        features[j][i] = float4((c.x + 16.f) / 116.f);
+                    }
+                }, kRowsPerJob);
+            }
+
+            // Contrast sensitivity filters. The 2D kernel of each channel is normalized, which for the two blue-yellow terms means normalizing their sum afterwards
+            const float dx = 1.f / pixelsPerDegree;
+            auto gauss = [dx](const float* csf, float x) { return std::exp(-glm::pi<float>() * glm::pi<float>() * (x * dx) * (x * dx) / csf[1]); };
+            int32_t csfRadius = (int32_t)std::ceil(3.f * std::sqrt(kCsfMaxB / (2.f * glm::pi<float>() * glm::pi<float>())) * pixelsPerDegree);
+            Kernel csf = createKernel(csfRadius, [&](float x) { return float4(gauss(kCsfA, x), gauss(kCsfRg, x), gauss(kCsfBy1, x), gauss(kCsfBy2, x)); });
+            float4 csfSum, unused;
+            getWeightSums(csf, csfSum, unused);
+            normalize(csf, float4(csfSum.x, csfSum.y, 1.f, 1.f), float4(1.f));
+            auto amplitude = [](const float* csf) { return csf[0] * std::sqrt(glm::pi<float>() / csf[1]); };
+            float by1 = amplitude(kCsfBy1);
+            float by2 = amplitude(kCsfBy2);
+            float byNorm = by1 * csfSum.z * csfSum.z + by2 * csfSum.w * csfSum.w;
+
+            // Feature detectors: first derivative of a Gaussian for edges, second derivative for points.
+            // Horizontal lanes are (edge, gauss, point, gauss) and vertical lanes (gauss, edge, gauss, point).
+            const float sigma = 0.5f * kFlipFeatureWidth * pixelsPerDegree;
+            int32_t featureRadius = (int32_t)std::ceil(3.f * sigma);
+            auto g = [sigma](float x) { return std::exp(-x * x / (2.f * sigma * sigma)); };
+            Kernel featureX = createKernel(featureRadius, [&](float x) { return float4(-x * g(x), g(x), (x * x / (sigma * sigma) - 1.f) * g(x), g(x)); });
+            float4 positiveSum, negativeSum;
+            getWeightSums(featureX, positiveSum, negativeSum);
+            normalize(featureX, positiveSum, negativeSum);
+            Kernel featureY = featureX;
+            for (auto& w : featureY.weights) w = float4(w.y, w.x, w.w, w.z);
+
+            Plane filteredColor[2], filteredFeatures[2];
+            for (uint32_t j = 0; j < 2; j++)
+            {
+                convolve(color[j], width, height, csf, csf, filteredColor[j]);
+                convolve(features[j], width, height, featureX, featureY, filteredFeatures[j]);
+            }
+
+            const float cmax = std::pow(hyab(cs.rgbToHuntLab(float3(0.f, 1.f, 0.f)), cs.rgbToHuntLab(float3(0.f, 0.f, 1.f))), kFlipQc);
+            const float pccmax = kFlipPc * cmax;
+
+            flipMap.resize(test.data.size());
+            Threading::parallelFor(height, [&](uint32_t y)
+            {
+                for (uint32_t i = y * width; i < (y + 1) * width; i++)
+                {
+                    float3 lab[2];
+                    float edge[2], point[2];
+                    for (uint32_t j = 0; j < 2; j++)
+                    {
+                        const float4& c = filteredColor[j][i];
+                        float3 rgb = cs.yCxCzToRgb(float3(c.x, c.y, (by1 * c.z + by2 * c.w) / byNorm));
+                        lab[j] = cs.rgbToHuntLab(glm::clamp(rgb, 0.f, 1.f));
+                        const float4& f = filteredFeatures[j][i];
+                        edge[j] = std::sqrt(f.x * f.x + f.y * f.y);
+                        point[j] = std::sqrt(f.z * f.z + f.w * f.w);
+                    }
+
+                    // Color error, compressing the large differences
+                    float deltaC = std::pow(hyab(lab[0], lab[1]), kFlipQc);
+                    deltaC = deltaC < pccmax ? (kFlipPt / pccmax) * deltaC : kFlipPt + (deltaC - pccmax) / (cmax - pccmax) * (1.f - kFlipPt);
+
+                    // Feature error
+                    float deltaF = std::pow(std::max(std::abs(edge[0] - edge[1]), std::abs(point[0] - point[1])) / std::sqrt(2.f), kFlipQf);
+                    flipMap[i] = std::pow(deltaC, 1.f - deltaF);
+                }
+            }, kRowsPerJob);
+        }
+    }
+
+    double ImageCompare::Result::get(Metric metric) const
+    {
+        switch (metric)
+        {
+        case Metric::MSE: return mse;
+        case Metric::RMSE: return rmse;
+        case Metric::RelMSE: return relMse;
+        case Metric::PSNR: return psnr;
+        case Metric::SSIM: return ssim;
+        case Metric::FLIP: return flip;
+        default:
+            should_not_get_here();
+            return 0;
+        }
+    }
+
+    bool ImageCompare::loadImage(const std::string& filename, Image& image)
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, true);
+        if (!pBitmap) return false;
+
+        image.width = pBitmap->getWidth();
+        image.height = pBitmap->getHeight();
+        image.data.resize((size_t)image.width * image.height);
+        image.srgb = false;
+
+        const uint8_t* pData = pBitmap->getData();
+        const size_t count = image.data.size();
+        switch (pBitmap->getFormat())
+        {
+        case ResourceFormat::RGBA32Float:
+            std::memcpy(image.data.data(), pData, count * sizeof(float4));
+            break;
+        case ResourceFormat::RGB32Float:
+            for (size_t i = 0; i < count; i++) image.data[i] = float4(((const float3*)pData)[i], 1.f);
+            break;
+        case ResourceFormat::RGBA16Float:
+        case ResourceFormat::RGB16Float:
+        {
+            const uint32_t channels = pBitmap->getFormat() == ResourceFormat::RGBA16Float ? 4 : 3;
+            const uint16_t* pHalf = (const uint16_t*)pData;
+            for (size_t i = 0; i < count; i++)
+            {
+                float4 v(1.f);
+                for (uint32_t c = 0; c < channels; c++) v[c] = glm::unpackHalf1x16(pHalf[i * channels + c]);
+                image.data[i] = v;
+            }
+            break;
+        }
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRX8Unorm:
+        {
+            const bool hasAlpha = pBitmap->getFormat() == ResourceFormat::BGRA8Unorm;
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint8_t* p = pData + i * 4;
+                image.data[i] = float4(p[2], p[1], p[0], hasAlpha ? p[3] : 255) / 255.f;
+            }
+            image.srgb = true;
+            break;
+        }
+        case ResourceFormat::R8Unorm:
+            for (size_t i = 0; i < count; i++) image.data[i] = float4(float3(pData[i] / 255.f), 1.f);
+            image.srgb = true;
+            break;
+        default:
+            logError("ImageCompare::loadImage() - '" + filename + "' has an unsupported format (" + to_string(pBitmap->getFormat()) + ")");
+            return false;
+        }
+        return true;
+    }
+
+    bool ImageCompare::compare(const Image& test, const Image& reference, const Options& options, Result& result, std::vector<float>* pErrorMap)
+    {
+        if (test.width != reference.width || test.height != reference.height)
+        {
+            logError("ImageCompare::compare() - The image sizes don't match (" + std::to_string(test.width) + "x" + std::to_string(test.height) + " and " +
+                std::to_string(reference.width) + "x" + std::to_string(reference.height) + ")");
+            return false;
+        }
+
+        const uint32_t width = test.width;
+        const uint32_t height = test.height;
+        if (width == 0 || height == 0)
+        {
+            result = Result();
+            result.psnr = std::numeric_limits<double>::infinity();
+            if (pErrorMap) pErrorMap->clear();
+            return true;
+        }
+
+        std::vector<float> mseMap(test.data.size()), relMseMap(test.data.size());
+        Threading::parallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t i = y * width; i < (y + 1) * width; i++)
+            {
+                float3 t = float3(test.data[i]);
+                float3 r = float3(reference.data[i]);
+                float3 d2 = (t - r) * (t - r);
+                mseMap[i] = (d2.x + d2.y + d2.z) / 3.f;
+                float3 rel = d2 / (r * r + kRelMseEpsilon);
+                relMseMap[i] = (rel.x + rel.y + rel.z) / 3.f;
+            }
+        }, kRowsPerJob);
+
+        std::vector<float> ssimMap, flipMap;
+        computeSsim(test, reference, ssimMap);
+        computeFlip(test, reference, options.pixelsPerDegree, flipMap);
+
+        result.mse = mean(mseMap, width, height);
+        result.rmse = std::sqrt(result.mse);
+        result.relMse = mean(relMseMap, width, height);
+        result.psnr = result.mse > 0 ? 10.0 * std::log10(1.0 / result.mse) : std::numeric_limits<double>::infinity();
+        result.ssim = mean(ssimMap, width, height);
+        result.flip = mean(flipMap, width, height);
+
+        if (pErrorMap)
+        {
+            switch (options.errorMapMetric)
+            {
+            case Metric::MSE:
+            case Metric::PSNR:
+                *pErrorMap = std::move(mseMap);
+                break;
+            case Metric::RMSE:
+                *pErrorMap = std::move(mseMap);
+                for (auto& v : *pErrorMap) v = std::sqrt(v);
+                break;
+            case Metric::RelMSE:
+                *pErrorMap = std::move(relMseMap);
+                break;
+            case Metric::SSIM:
+                *pErrorMap = std::move(ssimMap);
+                for (auto& v : *pErrorMap) v = 1.f - v;
+                break;
+            case Metric::FLIP:
+                *pErrorMap = std::move(flipMap);
+                break;
+            default:
+                should_not_get_here();
+            }
+        }
+        return true;
+    }
+
+    bool ImageCompare::passes(Metric metric, double value, double threshold)
+    {
+        return isHigherBetter(metric) ? value >= threshold : value <= threshold;
+    }
+
+    float3 ImageCompare::applyColorMap(ColorMap colorMap, float x)
+    {
+        x = glm::clamp(x, 0.f, 1.f);
+        switch (colorMap)
+        {
+        case ColorMap::Gray:
+            return float3(x);
+        case ColorMap::Jet:
+            return glm::clamp(1.5f - glm::abs(4.f * x - float3(3.f, 2.f, 1.f)), 0.f, 1.f);
+        default:
+            should_not_get_here();
+            return float3(0.f);
+        }
+    }
+
+    bool ImageCompare::saveHeatmap(const std::string& filename, uint32_t width, uint32_t height, const std::vector<float>& errorMap, ColorMap colorMap, float maxValue)
+    {
+        assert(errorMap.size() == (size_t)width * height);
+        auto fileFormat = Bitmap::getFormatFromFileExtension(getExtensionFromFile(filename));
+        if (fileFormat != Bitmap::FileFormat::PngFile && fileFormat != Bitmap::FileFormat::JpegFile && fileFormat != Bitmap::FileFormat::TgaFile && fileFormat != Bitmap::FileFormat::BmpFile)
+        {
+            logError("ImageCompare::saveHeatmap() - '" + filename + "' isn't a PNG, JPEG, TGA or BMP file");
+            return false;
+        }
+
+        if (maxValue <= 0.f)
+        {
+            maxValue = 0.f;
+            for (float v : errorMap) maxValue = std::max(maxValue, v);
+            if (maxValue == 0.f) maxValue = 1.f;
+        }
+
+        std::vector<uint8_t> data(errorMap.size() * 4);
+        Threading::parallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t i = y * width; i < (y + 1) * width; i++)
+            {
+                float3 c = applyColorMap(colorMap, errorMap[i] / maxValue);
+                data[i * 4 + 0] = (uint8_t)(c.r * 255.f + 0.5f);
+                data[i * 4 + 1] = (uint8_t)(c.g * 255.f + 0.5f);
+                data[i * 4 + 2] = (uint8_t)(c.b * 255.f + 0.5f);
+                data[i * 4 + 3] = 255;
+            }
+        }, kRowsPerJob);
+
+        Bitmap::saveImage(filename, width, height, fileFormat, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, data.data());
+        return true;
+    }
+
+    bool ImageCompare::parseMetric(const std::string& name, Metric& metric)
+    {
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        for (Metric m : { Metric::MSE, Metric::RMSE, Metric::RelMSE, Metric::PSNR, Metric::SSIM, Metric::FLIP })
+        {
+            std::string s = to_string(m);
+            std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+            if (s == lower)
+            {
+                metric = m;
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,145 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+
+namespace Falcor
+{
+    /** Compares images on the CPU. It doesn't use the GPU, so it works on machines without one.
+        Error metrics are computed on the RGB channels as they are stored in the file, except for FLIP which works in linear RGB.
+        Filtering is vectorized with SSE and runs on the thread pool.
+    */
+    class dlldecl ImageCompare
+    {
+    public:
+        enum class Metric
+        {
+            MSE,        ///< Mean squared error, averaged over the RGB channels
+            RMSE,       ///< Square root of the MSE
+            RelMSE,     ///< Relative MSE, the squared error divided by the squared reference value plus 0.01
+            PSNR,       ///< Peak signal-to-noise ratio in dB, for a peak value of 1. Higher is better
+            SSIM,       ///< Mean structural similarity of the luminance, with an 11x11 Gaussian window. 1 for identical images, higher is better
+            FLIP,       ///< Mean LDR-FLIP perceptual error, between 0 and 1. Inputs are clamped to [0, 1]
+        };
+
+        /** Color maps for heatmaps. They match the functions of Utils/Color/ColorMap.slang
+        */
+        enum class ColorMap
+        {
+            Gray,       ///< colormapGray()
+            Jet,        ///< colormapJet()
+        };
+
+        struct Image
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float4> data;       ///< Tightly packed rows, top row first
+            bool srgb = false;              ///< Whether the values are sRGB-encoded. True for 8-bit images
+        };
+
+        struct Options
+        {
+            float pixelsPerDegree = 67.f;           ///< Viewing condition of FLIP. The default is a 0.7m wide 4K display seen from 0.7m
+            Metric errorMapMetric = Metric::FLIP;   ///< The metric of the per-pixel error map. PSNR gives the MSE map, SSIM gives 1 - SSIM
+        };
+
+        struct Result
+        {
+            double mse = 0;
+            double rmse = 0;
+            double relMse = 0;
+            double psnr = 0;                ///< Infinity for identical images
+            double ssim = 1;
+            double flip = 0;
+
+            double get(Metric metric) const;
+        };
+
+        /** Load an image file with Bitmap. Single-channel images are expanded to gray, missing alpha is 1.
+            \param[in] filename The image file. Searched in the data directories
+            \param[out] image The image
+            \return false if the file can't be loaded or has an unsupported format, otherwise true
+        */
+        static bool loadImage(const std::string& filename, Image& image);
+
+        /** Compute all the metrics
+            \param[in] test The image to test
+            \param[in] reference The reference image. Must have the same size as the test image
+            \param[in] options Comparison options
+            \param[out] result The metrics
+            \param[out] pErrorMap If not null, receives the per-pixel error of options.errorMapMetric, in row-major order
+            \return false if the image sizes don't match, otherwise true
+        */
+        static bool compare(const Image& test, const Image& reference, const Options& options, Result& result, std::vector<float>* pErrorMap = nullptr);
+
+        /** Check a metric against a threshold. The value passes if it's at most the threshold, or at least the threshold for metrics where higher is better
+        */
+        static bool passes(Metric metric, double value, double threshold);
+
+        /** Check whether higher values of a metric mean more similar images
+        */
+        static bool isHigherBetter(Metric metric) { return metric == Metric::PSNR || metric == Metric::SSIM; }
+
+        /** Map a scalar to a color. Values outside [0, 1] are clamped
+        */
+        static float3 applyColorMap(ColorMap colorMap, float x);
+
+        /** Write an error map as a color-mapped 8-bit image
+            \param[in] filename The image file. The extension selects the format, which must be PNG, JPEG, TGA or BMP
+            \param[in] width Width of the error map
+            \param[in] height Height of the error map
+            \param[in] errorMap The per-pixel error, in row-major order
+            \param[in] colorMap The color map
+            \param[in] maxValue The error which maps to the end of the color map. If zero or less, the largest error in the map is used
+            \return false if the extension isn't an 8-bit image format, otherwise true
+        */
+        static bool saveHeatmap(const std::string& filename, uint32_t width, uint32_t height, const std::vector<float>& errorMap, ColorMap colorMap, float maxValue);
+
+        /** Parse a metric name, as returned by to_string(Metric). Case insensitive
+        */
+        static bool parseMetric(const std::string& name, Metric& metric);
+    };
+
+    inline std::string to_string(ImageCompare::Metric m)
+    {
+#define m2s(m_) case ImageCompare::Metric::m_: return #m_
+        switch (m)
+        {
+            m2s(MSE);
+            m2s(RMSE);
+            m2s(RelMSE);
+            m2s(PSNR);
+            m2s(SSIM);
+            m2s(FLIP);
+        default:
+            should_not_get_here();
+            return "";
+        }
+#undef m2s
+    }
+}
@@ -0,0 +1,590 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "MipGenerator.h"
+#include "Core/Program/ShaderCache.h"
+#include "Utils/BinaryFileStream.h"
+#include "Utils/Threading.h"
+#include "glm/gtc/constants.hpp"
+#include "glm/gtc/packing.hpp"
+#include <xmmintrin.h>
+#include <filesystem>
+#include <array>
+
+namespace fs = std::filesystem;
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kCacheMagic = 0x3143504d; // 'MPC1'
+        const uint32_t kCacheVersion = 1;
+        const std::string kCacheEntryExt = ".mip";
+        const uint32_t kRowsPerJob = 16;
+
+        struct
+        {
+            std::mutex mutex;
+            bool enabled = false;
+            std::string directory;
+            uint64_t maxSize = 2ull * 1024 * 1024 * 1024;
+            bool sizeKnown = false;     // True once totalSize was initialized from the directory
+            uint64_t totalSize = 0;     // Running total of the entry sizes, so that the directory is only scanned when the cache is over budget
+        } gCache;
+
+        struct FormatDesc
+        {
+            uint32_t channels;
+            uint32_t bytesPerChannel;
+            bool srgb;
+            bool hasAlpha;
+        };
+
+        bool getFormatDesc(ResourceFormat format, FormatDesc& desc)
+        {
+            switch (format)
+            {
+            case ResourceFormat::R8Unorm:           desc = { 1, 1, false, false }; return true;
+            case ResourceFormat::RG8Unorm:          desc = { 2, 1, false, false }; return true;
+            case ResourceFormat::RGBA8Unorm:
+            case ResourceFormat::BGRA8Unorm:        desc = { 4, 1, false, true }; return true;
+            case ResourceFormat::RGBA8UnormSrgb:
+            case ResourceFormat::BGRA8UnormSrgb:    desc = { 4, 1, true, true }; return true;
+            case ResourceFormat::BGRX8Unorm:        desc = { 4, 1, false, false }; return true;
+            case ResourceFormat::BGRX8UnormSrgb:    desc = { 4, 1, true, false }; return true;
+            case ResourceFormat::R16Float:          desc = { 1, 2, false, false }; return true;
+            case ResourceFormat::RG16Float:         desc = { 2, 2, false, false }; return true;
+            case ResourceFormat::RGB16Float:        desc = { 3, 2, false, false }; return true;
+            case ResourceFormat::RGBA16Float:       desc = { 4, 2, false, true }; return true;
+            case ResourceFormat::R32Float:          desc = { 1, 4, false, false }; return true;
+            case ResourceFormat::RG32Float:         desc = { 2, 4, false, false }; return true;
+            case ResourceFormat::RGB32Float:        desc = { 3, 4, false, false }; return true;
+            case ResourceFormat::RGBA32Float:       desc = { 4, 4, false, true }; return true;
+            default: return false;
+            }
+        }
+
+        float srgbToLinear(float c)
+        {
+            return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgb(float c)
+        {
+            return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+        }
+
+        const float* getSrgbTable()
+        {
+            static const auto table = []()
+            {
+                std::array<float, 256> t;
+                for (uint32_t i = 0; i < 256; i++) t[i] = srgbToLinear(i / 255.f);
+                return t;
+            }();
+            return table.data();
+        }
+
+        /** Converts rows between the storage format and the float4 representation the filter works on
+        */
+        struct Codec
+        {
+            FormatDesc desc;
+            bool normalMap;
+
+            void decode(const uint8_t* pSrc, uint32_t width, float4* pDst) const
+            {
+                const float* pSrgb = getSrgbTable();
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float4 v(0, 0, 0, 1);
+                    for (uint32_t c = 0; c < desc.channels; c++)
+                    {
+                        uint32_t i = x * desc.channels + c;
+                        switch (desc.bytesPerChannel)
+                        {
+                        case 1: v[c] = (desc.srgb && c < 3) ? pSrgb[pSrc[i]] : pSrc[i] / 255.f; break;
+                        case 2: v[c] = glm::unpackHalf1x16(((const uint16_t*)pSrc)[i]); break;
+                        default: v[c] = ((const float*)pSrc)[i]; break;
+                        }
+                    }
+                    if (normalMap && desc.bytesPerChannel == 1) v = float4(float3(v) * 2.f - 1.f, v.w);
+                    pDst[x] = v;
+                }
+            }
+
+            void encode(const float4* pSrc, uint32_t width, float alphaScale, uint8_t* pDst) const
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float4 v = pSrc[x];
+                    if (normalMap && desc.bytesPerChannel == 1) v = float4(float3(v) * 0.5f + 0.5f, v.w);
+                    v.w *= alphaScale;
+                    for (uint32_t c = 0; c < desc.channels; c++)
+                    {
+                        uint32_t i = x * desc.channels + c;
+                        switch (desc.bytesPerChannel)
+                        {
+                        case 1:
+                        {
+                            float f = glm::clamp(v[c], 0.f, 1.f);
+                            if (desc.srgb && c < 3) f = linearToSrgb(f);
+                            pDst[i] = (uint8_t)(f * 255.f + 0.5f);
+                            break;
+                        }
+                        case 2: ((uint16_t*)pDst)[i] = glm::packHalf1x16(v[c]); break;
+                        default: ((float*)pDst)[i] = v[c]; break;
+                        }
+                    }
+                }
+            }
+        };
+
+        float sinc(float x)
+        {
+            if (std::abs(x) < 1e-6f) return 1.f;
+            x *= glm::pi<float>();
+            return std::sin(x) / x;
+        }
+
+        float besselI0(float x)
+        {
+            float sum = 1.f;
+            float term = 1.f;
+            float halfX = x * 0.5f;
+            for (uint32_t k = 1; k < 32; k++)
+            {
+                term *= halfX / k;
+                float t2 = term * term;
+                sum += t2;
+                if (t2 < sum * 1e-8f) break;
+            }
+            return sum;
+        }
+
+        const float kFilterRadius[] = { 0.5f, 3.f, 3.f };
+
+        /** Evaluate a filter. x is the distance from the destination texel center, in destination texels
+        */
+        float evalFilter(MipGenerator::Filter filter, float x)
+        {
+            switch (filter)
+            {
+            case MipGenerator::Filter::Box:
+                return (x >= -0.5f && x < 0.5f) ? 1.f : 0.f;
+            case MipGenerator::Filter::Kaiser:
+            {
+                const float kAlpha = 4.f;
+                float t = x / kFilterRadius[(uint32_t)filter];
+                if (t * t >= 1.f) return 0.f;
+                return sinc(x) * besselI0(kAlpha * std::sqrt(1.f - t * t)) / besselI0(kAlpha);
+            }
+            case MipGenerator::Filter::Lanczos:
+            {
+                float radius = kFilterRadius[(uint32_t)filter];
+                if (std::abs(x) >= radius) return 0.f;
+                return sinc(x) * sinc(x / radius);
+            }
+            default:
+                should_not_get_here();
+                return 0.f;
+            }
+        }
+
+        /** The source texels and weights contributing to each destination texel along one axis
+        */
+        struct Taps
+        {
+            std::vector<uint32_t> first;    // Per destination texel, the first entry in index/weight. Has an extra element at the end
+            std::vector<uint32_t> index;    // Source texel, clamped to the edge
+            std::vector<float> weight;
+
+            Taps(uint32_t srcSize, uint32_t dstSize, MipGenerator::Filter filter)
+            {
+                float scale = float(srcSize) / dstSize;
+                float radius = kFilterRadius[(uint32_t)filter] * scale;
+                first.reserve(dstSize + 1);
+                for (uint32_t d = 0; d < dstSize; d++)
+                {
+                    first.push_back((uint32_t)index.size());
+                    float center = (d + 0.5f) * scale;
+                    int32_t begin = (int32_t)std::floor(center - radius);
+                    int32_t end = (int32_t)std::ceil(center + radius);
+                    float sum = 0;
+                    for (int32_t s = begin; s <= end; s++)
+                    {
+                        float w = evalFilter(filter, (s + 0.5f - center) / scale);
+                        if (w == 0.f) continue;
+                        index.push_back((uint32_t)glm::clamp(s, 0, (int32_t)srcSize - 1));
+                        weight.push_back(w);
+                        sum += w;
+                    }
+
+                    if (sum == 0.f)
+                    {
+                        index.push_back(glm::min((uint32_t)center, srcSize - 1));
+                        weight.push_back(1.f);
+                    }
+                    else
+                    {
+                        for (size_t i = first.back(); i < weight.size(); i++) weight[i] /= sum;
+                    }
+                }
+                first.push_back((uint32_t)index.size());
+            }
+        };
+
+        /** Horizontal pass. Filters one row of the source into one row of the intermediate image
+        */
+        void filterRow(const float4* pSrc, const Taps& taps, uint32_t dstWidth, float4* pDst)
+        {
+            for (uint32_t x = 0; x < dstWidth; x++)
+            {
+                __m128 acc = _mm_setzero_ps();
+                for (uint32_t t = taps.first[x]; t < taps.first[x + 1]; t++)
+                {
+                    __m128 s = _mm_loadu_ps(&pSrc[taps.index[t]].x);
+                    acc = _mm_add_ps(acc, _mm_mul_ps(s, _mm_set1_ps(taps.weight[t])));
+                }
+                _mm_storeu_ps(&pDst[x].x, acc);
+            }
+        }
+
+        /** Vertical pass. Accumulates whole source rows, which keeps the memory accesses sequential
+        */
+        void filterColumn(const float4* pSrc, const Taps& taps, uint32_t y, uint32_t width, float4* pDst)
+        {
+            for (uint32_t x = 0; x < width; x++) _mm_storeu_ps(&pDst[x].x, _mm_setzero_ps());
+
+            for (uint32_t t = taps.first[y]; t < taps.first[y + 1]; t++)
+            {
+                const float4* pRow = pSrc + (size_t)taps.index[t] * width;
+                __m128 w = _mm_set1_ps(taps.weight[t]);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    __m128 acc = _mm_loadu_ps(&pDst[x].x);
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&pRow[x].x), w));
+                    _mm_storeu_ps(&pDst[x].x, acc);
+                }
+            }
+        }
+
+        float getAlphaCoverage(const std::vector<float4>& texels, float ref, float scale)
+        {
+            size_t covered = 0;
+            for (const auto& t : texels) covered += (t.w * scale > ref) ? 1 : 0;
+            return float(covered) / texels.size();
+        }
+
+        /** Find the smallest alpha scale that brings the coverage of a level to the target, by bisection
+        */
+        float findAlphaScale(const std::vector<float4>& texels, float ref, float targetCoverage)
+        {
+            float lo = 0.f;
+            float hi = 4.f;
+            for (uint32_t i = 0; i < 12; i++)
+            {
+                float mid = (lo + hi) * 0.5f;
+                if (getAlphaCoverage(texels, ref, mid) < targetCoverage) lo = mid;
+                else hi = mid;
+            }
+            return hi;
+        }
+
+        /** Get the size of a tightly packed mip chain. Returns 0 if the format isn't supported
+        */
+        uint64_t getMipChainSize(uint32_t width, uint32_t height, uint32_t mipCount, ResourceFormat format)
+        {
+            FormatDesc desc;
+            if (!getFormatDesc(format, desc)) return 0;
+            uint64_t texelSize = desc.channels * desc.bytesPerChannel;
+            uint64_t size = 0;
+            for (uint32_t m = 0; m < mipCount; m++) size += (uint64_t)std::max(width >> m, 1u) * std::max(height >> m, 1u) * texelSize;
+            return size;
+        }
+
+        /** Get the path of a cache entry. gCache.mutex must be held
+        */
+        std::string getCacheEntryPath(const std::string& filename, bool srgb, const MipGenerator::Options& options)
+        {
+            std::string desc = canonicalizeFilename(filename);
+            desc += "|" + std::to_string(getFileModifiedTime(filename));
+            desc += "|" + std::to_string(srgb) + "|" + std::to_string((uint32_t)options.filter) + "|" + std::to_string(options.normalMap) + "|" + std::to_string(options.alphaCoverageRef);
+            desc += "|" + std::to_string(kCacheVersion);
+
+            if (gCache.directory.empty()) gCache.directory = getExecutableDirectory() + "/MipCache";
+            return gCache.directory + "/" + ShaderCache::createKey(desc) + kCacheEntryExt;
+        }
+
+        /** Scan the cache directory, and delete the least recently used entries until the cache fits in its budget. Updates the running total. gCache.mutex must be held
+        */
+        void evictCacheEntries()
+        {
+            struct Entry
+            {
+                fs::path path;
+                uint64_t size;
+                fs::file_time_type lastUse;
+            };
+
+            std::error_code ec;
+            std::vector<Entry> entries;
+            uint64_t totalSize = 0;
+            for (const auto& e : fs::directory_iterator(gCache.directory, ec))
+            {
+                if (e.path().extension() != kCacheEntryExt) continue;
+                Entry entry = { e.path(), e.file_size(ec), e.last_write_time(ec) };
+                totalSize += entry.size;
+                entries.push_back(entry);
+            }
+
+            if (totalSize > gCache.maxSize)
+            {
+                std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+                for (const auto& e : entries)
+                {
+                    if (totalSize <= gCache.maxSize) break;
+                    if (fs::remove(e.path, ec)) totalSize -= e.size;
+                }
+            }
+            gCache.totalSize = totalSize;
+            gCache.sizeKnown = true;
+        }
+    }
+
+    bool MipGenerator::isFormatSupported(ResourceFormat format)
+    {
+        FormatDesc desc;
+        return getFormatDesc(format, desc);
+    }
+
+    uint32_t MipGenerator::getMipCount(uint32_t width, uint32_t height)
+    {
+        return bitScanReverse(std::max(width, height)) + 1;
+    }
+
+    bool MipGenerator::generate(const void* pData, uint32_t width, uint32_t height, ResourceFormat format, const Options& options, MipChain& chain)
+    {
+        Codec codec;
+        if (!getFormatDesc(format, codec.desc)) return false;
+        codec.normalMap = options.normalMap;
+
+        chain.width = width;
+        chain.height = height;
+        chain.format = format;
+        chain.mipCount = getMipCount(width, height);
+
+        uint32_t texelSize = codec.desc.channels * codec.desc.bytesPerChannel;
+        chain.data.resize((size_t)getMipChainSize(width, height, chain.mipCount, format));
+
+        // The first level is copied as is
+        size_t levelSize = (size_t)width * height * texelSize;
+        std::memcpy(chain.data.data(), pData, levelSize);
+        uint8_t* pDst = chain.data.data() + levelSize;
+
+        std::vector<float4> src((size_t)width * height);
+        Threading::parallelFor(height, [&](uint32_t y) { codec.decode((const uint8_t*)pData + (size_t)y * width * texelSize, width, src.data() + (size_t)y * width); }, kRowsPerJob);
+
+        bool preserveCoverage = options.alphaCoverageRef > 0.f && codec.desc.hasAlpha;
+        float targetCoverage = preserveCoverage ? getAlphaCoverage(src, options.alphaCoverageRef, 1.f) : 0.f;
+
+        // Each level is filtered from the previous one in float, so the quantization error doesn't accumulate along the chain
+        std::vector<float4> temp;
+        std::vector<float4> dst;
+        uint32_t srcWidth = width;
+        uint32_t srcHeight = height;
+        for (uint32_t m = 1; m < chain.mipCount; m++)
+        {
+            uint32_t dstWidth = std::max(srcWidth >> 1, 1u);
+            uint32_t dstHeight = std::max(srcHeight >> 1, 1u);
+            Taps hTaps(srcWidth, dstWidth, options.filter);
+            Taps vTaps(srcHeight, dstHeight, options.filter);
+
+            temp.resize((size_t)dstWidth * srcHeight);
+            Threading::parallelFor(srcHeight, [&](uint32_t y) { filterRow(src.data() + (size_t)y * srcWidth, hTaps, dstWidth, temp.data() + (size_t)y * dstWidth); }, kRowsPerJob);
+
+            dst.resize((size_t)dstWidth * dstHeight);
+            Threading::parallelFor(dstHeight, [&](uint32_t y)
+            {
+                float4* pRow = dst.data() + (size_t)y * dstWidth;
+                filterColumn(temp.data(), vTaps, y, dstWidth, pRow);
+                if (options.normalMap)
+                {
+                    for (uint32_t x = 0; x < dstWidth; x++)
+                    {
+                        float3 n(pRow[x]);
+                        float length = glm::length(n);
+                        pRow[x] = float4(length > 0.f ? n / length : float3(0, 0, 1), pRow[x].w);
+                    }
+                }
+            }, kRowsPerJob);
+
+            // The alpha scale is only applied to the stored level. The next level is filtered from the unscaled data
+            float alphaScale = preserveCoverage ? findAlphaScale(dst, options.alphaCoverageRef, targetCoverage) : 1.f;
+            size_t rowSize = (size_t)dstWidth * texelSize;
+            Threading::parallelFor(dstHeight, [&](uint32_t y) { codec.encode(dst.data() + (size_t)y * dstWidth, dstWidth, alphaScale, pDst + y * rowSize); }, kRowsPerJob);
+            pDst += rowSize * dstHeight;
+
+            src.swap(dst);
+            srcWidth = dstWidth;
+            srcHeight = dstHeight;
+        }
+
+        assert(pDst == chain.data.data() + chain.data.size());
+        return true;
+    }
+
+    void MipGenerator::setCacheEnabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.enabled = enabled;
+    }
+
+    bool MipGenerator::isCacheEnabled()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        return gCache.enabled;
+    }
+
+    void MipGenerator::setCacheDirectory(const std::string& dir)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.directory = dir;
+        gCache.sizeKnown = false;
+    }
+
+    std::string MipGenerator::getCacheDirectory()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        if (gCache.directory.empty()) gCache.directory = getExecutableDirectory() + "/MipCache";
+        return gCache.directory;
+    }
+
+    void MipGenerator::setCacheMaxSize(uint64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.maxSize = bytes;
+        evictCacheEntries();
+    }
+
+    uint64_t MipGenerator::getCacheMaxSize()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        return gCache.maxSize;
+    }
+
+    bool MipGenerator::loadFromCache(const std::string& filename, bool srgb, const Options& options, MipChain& chain)
+    {
+        // Entries are replaced atomically by storeInCache(), so they can be read without the lock
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(gCache.mutex);
+            if (!gCache.enabled) return false;
+            path = getCacheEntryPath(filename, srgb, options);
+        }
+        if (!doesFileExist(path)) return false;
+
+        BinaryFileStream stream(path, BinaryFileStream::Mode::Read);
+        uint32_t magic = 0, version = 0, format = 0;
+        uint64_t size = 0;
+        stream >> magic >> version;
+        if (!stream.isGood() || magic != kCacheMagic || version != kCacheVersion) return false;
+        stream >> chain.width >> chain.height >> chain.mipCount >> format >> size;
+        if (!stream.isGood()) return false;
+        chain.format = (ResourceFormat)format;
+
+        // A stale or corrupt entry is a cache miss. The texture is created from the data, so its size must match the description
+        const uint32_t kMaxDimension = 65536;
+        bool valid = chain.width > 0 && chain.height > 0 && chain.width <= kMaxDimension && chain.height <= kMaxDimension;
+        valid = valid && chain.mipCount >= 1 && chain.mipCount <= getMipCount(chain.width, chain.height);
+        if (!valid || size == 0 || size != getMipChainSize(chain.width, chain.height, chain.mipCount, chain.format))
+        {
+            logWarning("Ignoring invalid mip cache entry `" + path + "`");
+            return false;
+        }
+        chain.data.resize((size_t)size);
+        stream.read(chain.data.data(), chain.data.size());
+        if (stream.isFail()) return false;
+        stream.close();
+
+        // The write time orders the entries for the eviction
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        return true;
+    }
+
+    void MipGenerator::storeInCache(const std::string& filename, bool srgb, const Options& options, const MipChain& chain)
+    {
+        std::string path;
+        std::string directory;
+        {
+            std::lock_guard<std::mutex> lock(gCache.mutex);
+            if (!gCache.enabled) return;
+            path = getCacheEntryPath(filename, srgb, options);
+            directory = gCache.directory;
+        }
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        uint64_t replacedSize = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+        if (ec) replacedSize = 0;
+
+        // Write to a temporary file first, so that readers never see partial entries. The name is unique per thread, since the same entry may be stored concurrently
+        std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            BinaryFileStream stream(tempPath, BinaryFileStream::Mode::Write);
+            stream << kCacheMagic << kCacheVersion;
+            stream << chain.width << chain.height << chain.mipCount << (uint32_t)chain.format << (uint64_t)chain.data.size();
+            stream.write(chain.data.data(), chain.data.size());
+            if (stream.isFail())
+            {
+                logWarning("Can't write mip cache entry `" + path + "`");
+                stream.remove();
+                return;
+            }
+        }
+
+        uint64_t size = fs::file_size(tempPath, ec);
+        fs::rename(tempPath, path, ec);
+        if (ec)
+        {
+            fs::remove(tempPath, ec);
+            return;
+        }
+
+        // The directory is scanned once to initialize the running total, and afterwards only when the cache grows over budget.
+        // Entries replaced concurrently by another thread may be counted twice, which at worst triggers an early scan that corrects the total
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        if (!gCache.sizeKnown || directory != gCache.directory)
+        {
+            evictCacheEntries();
+            return;
+        }
+        gCache.totalSize = gCache.totalSize + size - std::min(replacedSize, gCache.totalSize);
+        if (gCache.totalSize > gCache.maxSize) evictCacheEntries();
+    }
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+
+namespace Falcor
+{
+    /** Generates mip chains on the CPU.
+        Levels are filtered in floating-point from the previous level, in linear space for sRGB formats. The filter is separable and runs on the thread pool.
+        Optionally preserves the alpha-test coverage of the first level, and renormalizes normal maps.
+        Supported formats are 8-bit unorm formats with 1, 2 or 4 channels (including sRGB and BGRA/BGRX), and 16/32-bit float formats with 1 to 4 channels.
+    */
+    class dlldecl MipGenerator
+    {
+    public:
+        enum class Filter
+        {
+            Box,        ///< Average of the source texels covered by the destination texel
+            Kaiser,     ///< Kaiser-windowed sinc, 3 texel radius. Sharper than Box with little ringing
+            Lanczos,    ///< Lanczos-3. Sharpest, rings more on high-contrast edges
+        };
+
+        struct Options
+        {
+            Filter filter = Filter::Kaiser;
+            bool normalMap = false;         ///< Renormalize the xyz channels of each level. Unorm data is expected to be encoded as n * 0.5 + 0.5
+            float alphaCoverageRef = 0;     ///< If non-zero, the alpha of each level is scaled so that the fraction of texels with alpha above the reference matches the first level
+        };
+
+        struct MipChain
+        {
+            uint32_t width = 0;             ///< Size of the first level
+            uint32_t height = 0;
+            uint32_t mipCount = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+            std::vector<uint8_t> data;      ///< All the levels, tightly packed, starting with the most detailed one. Can be passed to Texture::create2D() as is
+        };
+
+        /** Check if a format is supported
+        */
+        static bool isFormatSupported(ResourceFormat format);
+
+        /** Get the number of levels in a full mip chain
+        */
+        static uint32_t getMipCount(uint32_t width, uint32_t height);
+
+        /** Generate a full mip chain
+            \param[in] pData The first level, tightly packed
+            \param[in] width The width of the first level
+            \param[in] height The height of the first level
+            \param[in] format The format of the data. Must be supported, see isFormatSupported()
+            \param[in] options Filtering options
+            \param[out] chain The mip chain, including a copy of the first level
+            \return false if the format is not supported, otherwise true
+        */
+        static bool generate(const void* pData, uint32_t width, uint32_t height, ResourceFormat format, const Options& options, MipChain& chain);
+
+        /** Enable or disable the on-disk cache of mip chains generated from image files. Disabled by default, since the cache can grow up to getCacheMaxSize() on disk
+        */
+        static void setCacheEnabled(bool enabled);
+        static bool isCacheEnabled();
+
+        /** Set the cache directory. The default is `MipCache` in the executable directory
+        */
+        static void setCacheDirectory(const std::string& dir);
+        static std::string getCacheDirectory();
+
+        /** Set the maximum size of the cache in bytes. The least recently used entries are evicted when the cache grows above it
+        */
+        static void setCacheMaxSize(uint64_t bytes);
+        static uint64_t getCacheMaxSize();
+
+        /** Look up the mip chain of an image file. The entry is only used if the file didn't change since it was stored.
+            \param[in] filename The full path of the image file
+            \param[in] srgb Whether the image is loaded as sRGB
+            \param[in] options The options the chain was generated with
+            \param[out] chain The cached chain
+            \return true if a valid entry was found, otherwise false
+        */
+        static bool loadFromCache(const std::string& filename, bool srgb, const Options& options, MipChain& chain);
+
+        /** Store the mip chain of an image file
+        */
+        static void storeInCache(const std::string& filename, bool srgb, const Options& options, const MipChain& chain);
+    };
+}
@@ -0,0 +1,656 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "StreamingImageLoader.h"
+#include "FreeImage.h"
+#include "Utils/StringUtils.h"
+#include "glm/gtc/packing.hpp"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kReadBufferSize = 1 << 20;
+        const uint32_t kMaxDimension = 1 << 16;     // Larger headers are treated as corrupt, rather than trying to allocate the image
+
+        /** Sequential file reader with a fixed-size buffer
+        */
+        class FileReader
+        {
+        public:
+            bool open(const std::string& path)
+            {
+                mFile.open(path, std::ios::binary | std::ios::ate);
+                if (!mFile.good()) return false;
+                mSize = (uint64_t)mFile.tellg();
+                mFile.seekg(0);
+                mBuffer.resize(kReadBufferSize);
+                return mFile.good();
+            }
+
+            uint64_t getSize() const { return mSize; }
+
+            bool seek(uint64_t offset)
+            {
+                mFile.clear();
+                mFile.seekg(offset);
+                mPos = mEnd = 0;
+                return mFile.good();
+            }
+
+            int getByte()
+            {
+                if (mPos == mEnd && !refill()) return -1;
+                return mBuffer[mPos++];
+            }
+
+            bool read(void* pData, size_t size)
+            {
+                uint8_t* pDst = (uint8_t*)pData;
+                while (size)
+                {
+                    if (mPos == mEnd && !refill()) return false;
+                    size_t count = std::min(size, mEnd - mPos);
+                    std::memcpy(pDst, mBuffer.data() + mPos, count);
+                    mPos += count;
+                    pDst += count;
+                    size -= count;
+                }
+                return true;
+            }
+
+            template<typename T>
+            bool read(T& val) { return read(&val, sizeof(T)); }
+
+            /** Read a line, without the newline
+            */
+            bool readLine(std::string& line, size_t maxLength = 1024)
+            {
+                line.clear();
+                int c;
+                while ((c = getByte()) >= 0 && c != '\n')
+                {
+                    if (line.size() == maxLength) return false;
+                    line += (char)c;
+                }
+                return c == '\n';
+            }
+
+            /** Read a null-terminated string
+            */
+            bool readString(std::string& str, size_t maxLength = 256)
+            {
+                str.clear();
+                int c;
+                while ((c = getByte()) > 0)
+                {
+                    if (str.size() == maxLength) return false;
+                    str += (char)c;
+                }
+                return c == 0;
+            }
+
+        private:
+            bool refill()
+            {
+                mFile.read((char*)mBuffer.data(), mBuffer.size());
+                mPos = 0;
+                mEnd = (size_t)mFile.gcount();
+                return mEnd > 0;
+            }
+
+            std::ifstream mFile;
+            std::vector<uint8_t> mBuffer;
+            uint64_t mSize = 0;
+            size_t mPos = 0;
+            size_t mEnd = 0;
+        };
+
+        /** Decodes an image into float RGBA rows, one block at a time
+        */
+        class ScanlineSource
+        {
+        public:
+            virtual ~ScanlineSource() = default;
+
+            /** Open the file and read the header
+            */
+            virtual bool open(const std::string& path) = 0;
+
+            /** Decode the next block of rows
+                \param[out] rows The decoded rows, width texels each
+                \param[out] firstRow Index of the first decoded row in the image, counted from the top
+                \return The number of decoded rows. 0 at the end of the image or on error
+            */
+            virtual uint32_t readRows(std::vector<float4>& rows, uint32_t& firstRow) = 0;
+
+            /** Check whether all the rows were decoded successfully
+            */
+            virtual bool isComplete() const = 0;
+
+            uint32_t width = 0;
+            uint32_t height = 0;
+            bool isHalf = false;
+        };
+
+        /** Radiance RGBE images, flat or run-length encoded
+        */
+        class HdrSource : public ScanlineSource
+        {
+        public:
+            bool open(const std::string& path) override
+            {
+                if (!mReader.open(path)) return false;
+
+                std::string line;
+                if (!mReader.readLine(line) || line.compare(0, 2, "#?") != 0) return false;
+                while (true)
+                {
+                    if (!mReader.readLine(line)) return false;
+                    if (line.empty()) break;
+                    if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe") return false;
+                }
+
+                // Only the standard orientations are supported. The X axis must go left to right
+                if (!mReader.readLine(line)) return false;
+                char yAxis[3] = {}, xAxis[3] = {};
+                if (sscanf(line.c_str(), "%2s %u %2s %u", yAxis, &height, xAxis, &width) != 4) return false;
+                if (std::string(xAxis) != "+X" || width == 0 || height == 0) return false;
+                // Every scanline takes at least 4 bytes
+                if (width > kMaxDimension || height > kMaxDimension || (uint64_t)height * 4 > mReader.getSize()) return false;
+                if (std::string(yAxis) == "+Y") mBottomUp = true;
+                else if (std::string(yAxis) != "-Y") return false;
+
+                mScanline.resize(width * 4);
+                return true;
+            }
+
+            uint32_t readRows(std::vector<float4>& rows, uint32_t& firstRow) override
+            {
+                if (mRow == height || !readScanline()) return 0;
+                rows.resize(width);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const uint8_t* p = &mScanline[x * 4];
+                    float f = p[3] ? std::ldexp(1.f, (int)p[3] - (128 + 8)) : 0.f;
+                    rows[x] = float4(p[0] * f, p[1] * f, p[2] * f, 1.f);
+                }
+                firstRow = mBottomUp ? height - 1 - mRow : mRow;
+                mRow++;
+                return 1;
+            }
+
+            bool isComplete() const override { return mRow == height; }
+
+        private:
+            bool readScanline()
+            {
+                if (width < 8 || width > 0x7fff) return readFlat(0);
+
+                uint8_t rgbe[4];
+                if (!mReader.read(rgbe, 4)) return false;
+                if (rgbe[0] != 2 || rgbe[1] != 2 || (rgbe[2] & 0x80))
+                {
+                    std::memcpy(&mScanline[0], rgbe, 4);
+                    return readFlat(1);
+                }
+                if (((uint32_t)rgbe[2] << 8 | rgbe[3]) != width) return false;
+
+                // Each channel is run-length encoded separately
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    uint32_t x = 0;
+                    while (x < width)
+                    {
+                        int count = mReader.getByte();
+                        if (count <= 0) return false;
+                        if (count > 128)
+                        {
+                            count -= 128;
+                            int value = mReader.getByte();
+                            if (value < 0 || x + count > width) return false;
+                            for (int i = 0; i < count; i++) mScanline[(x++) * 4 + c] = (uint8_t)value;
+                        }
+                        else
+                        {
+                            if (x + count > width) return false;
+                            for (int i = 0; i < count; i++)
+                            {
+                                int value = mReader.getByte();
+                                if (value < 0) return false;
+                                mScanline[(x++) * 4 + c] = (uint8_t)value;
+                            }
+                        }
+                    }
+                }
+                return true;
+            }
+
+            /** Flat pixels, with the old-style run-length encoding
+            */
+            bool readFlat(uint32_t x)
+            {
+                uint32_t shift = 0;
+                while (x < width)
+                {
+                    uint8_t* p = &mScanline[x * 4];
+                    if (!mReader.read(p, 4)) return false;
+                    if (p[0] == 1 && p[1] == 1 && p[2] == 1)
+                    {
+                        if (x == 0) return false;
+                        uint32_t count = (uint32_t)p[3] << shift;
+                        if (x + count > width) return false;
+                        for (uint32_t i = 0; i < count; i++, x++) std::memcpy(&mScanline[x * 4], &mScanline[(x - 1) * 4], 4);
+                        shift += 8;
+                    }
+                    else
+                    {
+                        x++;
+                        shift = 0;
+                    }
+                }
+                return true;
+            }
+
+            FileReader mReader;
+            std::vector<uint8_t> mScanline;
+            uint32_t mRow = 0;
+            bool mBottomUp = false;
+        };
+
+        /** Single-part scanline OpenEXR images
+        */
+        class ExrSource : public ScanlineSource
+        {
+        public:
+            bool open(const std::string& path) override
+            {
+                if (!mReader.open(path)) return false;
+
+                uint32_t magic, version;
+                if (!mReader.read(magic) || !mReader.read(version) || magic != 20000630) return false;
+                // Reject tiled, deep and multi-part files
+                if ((version & 0xff) != 2 || (version & 0x1a00)) return false;
+
+                int32_t dataWindow[4] = {};
+                bool hasChannels = false, hasDataWindow = false;
+                while (true)
+                {
+                    std::string name, type;
+                    if (!mReader.readString(name)) return false;
+                    if (name.empty()) break;
+                    int32_t size;
+                    if (!mReader.readString(type) || !mReader.read(size) || size < 0) return false;
+
+                    std::vector<uint8_t> value(size);
+                    if (!mReader.read(value.data(), value.size())) return false;
+
+                    if (name == "channels" && type == "chlist") hasChannels = parseChannels(value);
+                    else if (name == "compression" && type == "compression" && size == 1) mCompression = value[0];
+                    else if (name == "dataWindow" && type == "box2i" && size == 16)
+                    {
+                        std::memcpy(dataWindow, value.data(), 16);
+                        hasDataWindow = true;
+                    }
+                }
+
+                if (!hasChannels || !hasDataWindow) return false;
+                switch (mCompression)
+                {
+                case 0: mLinesPerChunk = 1; break;      // None
+                case 1: mLinesPerChunk = 1; break;      // RLE
+                case 2: mLinesPerChunk = 1; break;      // ZIPS
+                case 3: mLinesPerChunk = 16; break;     // ZIP
+                default: return false;
+                }
+
+                if (dataWindow[2] < dataWindow[0] || dataWindow[3] < dataWindow[1]) return false;
+                int64_t windowWidth = (int64_t)dataWindow[2] - dataWindow[0] + 1;
+                int64_t windowHeight = (int64_t)dataWindow[3] - dataWindow[1] + 1;
+                if (windowWidth > kMaxDimension || windowHeight > kMaxDimension) return false;
+                width = (uint32_t)windowWidth;
+                height = (uint32_t)windowHeight;
+                mMinY = dataWindow[1];
+
+                // A chunk has to fit in a 32-bit size, both packed and unpacked
+                uint64_t bytesPerLine = 0;
+                for (const auto& c : mChannels) bytesPerLine += (uint64_t)width * c.bytes;
+                if (bytesPerLine * mLinesPerChunk > INT32_MAX) return false;
+                mBytesPerLine = (uint32_t)bytesPerLine;
+
+                // The offsets are ordered by y, whatever order the chunks are stored in
+                size_t chunkCount = (height + mLinesPerChunk - 1) / mLinesPerChunk;
+                if (chunkCount * sizeof(uint64_t) > mReader.getSize()) return false;
+                mOffsets.resize(chunkCount);
+                return mReader.read(mOffsets.data(), mOffsets.size() * sizeof(uint64_t));
+            }
+
+            uint32_t readRows(std::vector<float4>& rows, uint32_t& firstRow) override
+            {
+                if (mChunk == mOffsets.size()) return 0;
+
+                int32_t y, size;
+                if (!mReader.seek(mOffsets[mChunk]) || !mReader.read(y) || !mReader.read(size) || size <= 0) return 0;
+                if ((uint64_t)size > mReader.getSize()) return 0;
+                firstRow = (uint32_t)(y - mMinY);
+                if (firstRow != mChunk * mLinesPerChunk) return 0;
+                uint32_t lineCount = std::min(mLinesPerChunk, height - firstRow);
+                size_t rawSize = (size_t)mBytesPerLine * lineCount;
+
+                mPacked.resize(size);
+                if (!mReader.read(mPacked.data(), mPacked.size())) return 0;
+                const uint8_t* pData = mPacked.data();
+                // Chunks which don't get smaller are stored uncompressed
+                if (mCompression != 0 && (size_t)size < rawSize)
+                {
+                    if (!decompress(rawSize)) return 0;
+                    pData = mRaw.data();
+                }
+                else if ((size_t)size != rawSize) return 0;
+
+                rows.assign((size_t)width * lineCount, float4(0, 0, 0, 1));
+                for (uint32_t line = 0; line < lineCount; line++)
+                {
+                    float4* pRow = rows.data() + (size_t)line * width;
+                    for (const auto& c : mChannels)
+                    {
+                        if (c.slot >= 0)
+                        {
+                            for (uint32_t x = 0; x < width; x++)
+                            {
+                                float v;
+                                switch (c.type)
+                                {
+                                case 0: { uint32_t u; std::memcpy(&u, pData + x * 4, 4); v = (float)u; break; }
+                                case 1: { uint16_t h; std::memcpy(&h, pData + x * 2, 2); v = glm::unpackHalf1x16(h); break; }
+                                default: std::memcpy(&v, pData + x * 4, 4); break;
+                                }
+                                if (c.slot == 4) pRow[x] = float4(v, v, v, pRow[x].w);     // Luminance
+                                else pRow[x][c.slot] = v;
+                            }
+                        }
+                        pData += width * c.bytes;
+                    }
+                }
+
+                mChunk++;
+                return lineCount;
+            }
+
+            bool isComplete() const override { return mChunk == mOffsets.size(); }
+
+        private:
+            struct Channel
+            {
+                int32_t type;       // 0 = uint, 1 = half, 2 = float
+                uint32_t bytes;
+                int32_t slot;       // Destination channel, 4 for luminance, -1 if unused
+            };
+
+            bool parseChannels(const std::vector<uint8_t>& value)
+            {
+                const char kSlots[] = "RGBAY";
+                size_t offset = 0;
+                bool allHalf = true;
+                bool found = false;
+                while (offset < value.size() && value[offset] != 0)
+                {
+                    std::string name((const char*)value.data() + offset);
+                    offset += name.size() + 1;
+                    if (offset + 16 > value.size()) return false;
+                    int32_t type, xSampling, ySampling;
+                    std::memcpy(&type, &value[offset], 4);
+                    std::memcpy(&xSampling, &value[offset + 8], 4);
+                    std::memcpy(&ySampling, &value[offset + 12], 4);
+                    offset += 16;
+
+                    if (type < 0 || type > 2 || xSampling != 1 || ySampling != 1) return false;
+                    Channel c;
+                    c.type = type;
+                    c.bytes = type == 1 ? 2 : 4;
+                    c.slot = -1;
+                    if (name.size() == 1 && std::strchr(kSlots, name[0]))
+                    {
+                        c.slot = (int32_t)(std::strchr(kSlots, name[0]) - kSlots);
+                        allHalf = allHalf && type == 1;
+                        found = true;
+                    }
+                    mChannels.push_back(c);
+                }
+                isHalf = found && allHalf;
+                return found;
+            }
+
+            bool decompress(size_t rawSize)
+            {
+                mRaw.resize(rawSize);
+                mTemp.resize(rawSize);
+                if (mCompression == 1)
+                {
+                    if (!decodeRle(rawSize)) return false;
+                }
+                else
+                {
+                    DWORD size = FreeImage_ZLibUncompress(mTemp.data(), (DWORD)rawSize, mPacked.data(), (DWORD)mPacked.size());
+                    if (size != rawSize) return false;
+                }
+
+                // Undo the delta predictor
+                for (size_t i = 1; i < rawSize; i++) mTemp[i] = (uint8_t)(mTemp[i - 1] + mTemp[i] - 128);
+
+                // The first half holds the even bytes, the second half the odd ones
+                const uint8_t* pEven = mTemp.data();
+                const uint8_t* pOdd = mTemp.data() + (rawSize + 1) / 2;
+                for (size_t i = 0; i < rawSize; i++) mRaw[i] = (i & 1) ? *pOdd++ : *pEven++;
+                return true;
+            }
+
+            /** Decode runs into mTemp. A negative count is followed by that many literal bytes, a count n >= 0 by a byte repeated n + 1 times
+            */
+            bool decodeRle(size_t rawSize)
+            {
+                size_t in = 0, out = 0;
+                while (in < mPacked.size())
+                {
+                    int32_t count = (int8_t)mPacked[in++];
+                    if (count < 0)
+                    {
+                        if (in + (size_t)-count > mPacked.size() || out + (size_t)-count > rawSize) return false;
+                        std::memcpy(mTemp.data() + out, mPacked.data() + in, -count);
+                        in += -count;
+                        out += -count;
+                    }
+                    else
+                    {
+                        if (in >= mPacked.size() || out + count + 1 > rawSize) return false;
+                        std::memset(mTemp.data() + out, mPacked[in++], count + 1);
+                        out += count + 1;
+                    }
+                }
+                return out == rawSize;
+            }
+
+            FileReader mReader;
+            std::vector<Channel> mChannels;
+            std::vector<uint64_t> mOffsets;
+            std::vector<uint8_t> mPacked;
+            std::vector<uint8_t> mTemp;
+            std::vector<uint8_t> mRaw;
+            uint32_t mCompression = 0;
+            uint32_t mLinesPerChunk = 1;
+            uint32_t mBytesPerLine = 0;
+            int32_t mMinY = 0;
+            uint32_t mChunk = 0;
+        };
+
+        std::unique_ptr<ScanlineSource> openSource(const std::string& filename)
+        {
+            std::string fullpath;
+            if (findFileInDataDirectories(filename, fullpath) == false) return nullptr;
+
+            std::unique_ptr<ScanlineSource> pSource;
+            if (hasSuffix(filename, ".hdr", false)) pSource = std::make_unique<HdrSource>();
+            else if (hasSuffix(filename, ".exr", false)) pSource = std::make_unique<ExrSource>();
+            else return nullptr;
+
+            return pSource->open(fullpath) ? std::move(pSource) : nullptr;
+        }
+
+        void encodeRow(const float4* pSrc, uint32_t width, ResourceFormat format, uint8_t* pDst)
+        {
+            switch (format)
+            {
+            case ResourceFormat::RGBA32Float:
+                std::memcpy(pDst, pSrc, width * sizeof(float4));
+                break;
+            case ResourceFormat::RGBA16Float:
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint16_t* p = (uint16_t*)pDst + x * 4;
+                    for (uint32_t c = 0; c < 4; c++) p[c] = glm::packHalf1x16(pSrc[x][c]);
+                }
+                break;
+            case ResourceFormat::RGB9E5Float:
+                for (uint32_t x = 0; x < width; x++) ((uint32_t*)pDst)[x] = glm::packF3x9_E1x5(float3(pSrc[x]));
+                break;
+            default:
+                should_not_get_here();
+            }
+        }
+    }
+
+    bool StreamingImageLoader::isFormatSupported(ResourceFormat format)
+    {
+        return format == ResourceFormat::RGBA32Float || format == ResourceFormat::RGBA16Float || format == ResourceFormat::RGB9E5Float;
+    }
+
+    bool StreamingImageLoader::canStream(const std::string& filename)
+    {
+        return openSource(filename) != nullptr;
+    }
+
+    bool StreamingImageLoader::load(const std::string& filename, const Options& options, Image& image)
+    {
+        auto pSource = openSource(filename);
+        if (!pSource) return false;
+
+        ResourceFormat format = options.format;
+        if (format == ResourceFormat::Unknown) format = pSource->isHalf ? ResourceFormat::RGBA16Float : ResourceFormat::RGBA32Float;
+        if (!isFormatSupported(format))
+        {
+            logError("StreamingImageLoader can't load images to " + to_string(format));
+            return false;
+        }
+
+        // Box filter by an integer factor. Partial blocks at the right and bottom edges are averaged over the texels they cover
+        const uint32_t srcWidth = pSource->width;
+        const uint32_t srcHeight = pSource->height;
+        uint32_t factor = 1;
+        if (options.maxWidth) factor = std::max(factor, (srcWidth + options.maxWidth - 1) / options.maxWidth);
+        if (options.maxHeight) factor = std::max(factor, (srcHeight + options.maxHeight - 1) / options.maxHeight);
+
+        image.width = (srcWidth + factor - 1) / factor;
+        image.height = (srcHeight + factor - 1) / factor;
+        image.format = format;
+        size_t rowPitch = (size_t)image.width * getFormatBytesPerBlock(format);
+        image.data.resize(rowPitch * image.height);
+
+        std::vector<float4> rows;
+        std::vector<float4> accum(image.width);
+        uint32_t accumRow = UINT32_MAX;
+        uint32_t accumCount = 0;
+
+        auto flush = [&]()
+        {
+            if (accumRow == UINT32_MAX) return;
+            for (uint32_t x = 0; x < image.width; x++)
+            {
+                uint32_t columns = std::min(factor, srcWidth - x * factor);
+                accum[x] /= float(columns * accumCount);
+            }
+            encodeRow(accum.data(), image.width, format, image.data.data() + rowPitch * accumRow);
+            std::fill(accum.begin(), accum.end(), float4(0));
+            accumCount = 0;
+        };
+
+        uint32_t firstRow;
+        uint32_t rowCount;
+        while ((rowCount = pSource->readRows(rows, firstRow)) != 0)
+        {
+            for (uint32_t i = 0; i < rowCount; i++)
+            {
+                const float4* pRow = rows.data() + (size_t)i * srcWidth;
+                if (factor == 1)
+                {
+                    encodeRow(pRow, srcWidth, format, image.data.data() + rowPitch * (firstRow + i));
+                    continue;
+                }
+
+                uint32_t dstRow = (firstRow + i) / factor;
+                if (dstRow != accumRow)
+                {
+                    flush();
+                    accumRow = dstRow;
+                }
+                for (uint32_t x = 0; x < srcWidth; x++) accum[x / factor] += pRow[x];
+                accumCount++;
+            }
+        }
+        flush();
+
+        if (!pSource->isComplete())
+        {
+            logError("Error when loading image file " + filename + ". The file is corrupt.");
+            return false;
+        }
+        return true;
+    }
+
+    Texture::SharedPtr StreamingImageLoader::createTexture(const std::string& filename, const Options& options, bool generateMips, Texture::BindFlags bindFlags)
+    {
+        Image image;
+        if (!load(filename, options, image)) return nullptr;
+
+        if (generateMips && image.format == ResourceFormat::RGB9E5Float)
+        {
+            logWarning("StreamingImageLoader::createTexture() - Can't generate mips for RGB9E5Float textures. Loading '" + filename + "' without mips");
+            generateMips = false;
+        }
+
+        Texture::SharedPtr pTex = Texture::create2D(image.width, image.height, image.format, 1, generateMips ? Texture::kMaxPossible : 1, image.data.data(), bindFlags);
+        if (pTex) pTex->setSourceFilename(stripDataDirectories(filename));
+        return pTex;
+    }
+
+    Texture::SharedPtr StreamingImageLoader::createTextureFromFile(const std::string& filename, const Options& options, bool generateMips, Texture::BindFlags bindFlags)
+    {
+        if (canStream(filename)) return createTexture(filename, options, generateMips, bindFlags);
+        return Texture::createFromFile(filename, generateMips, false, bindFlags);
+    }
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Core/API/Texture.h"
+
+namespace Falcor
+{
+    /** Loads large HDR images without keeping a full-size intermediate copy.
+        Radiance (.hdr) files and scanline OpenEXR (.exr) files that are uncompressed or use RLE, ZIPS or ZIP compression are read one block of scanlines at a time.
+        Each block is converted straight into the destination format. It can also be downsampled on the fly.
+        Other files can't be streamed and should be loaded with Bitmap.
+    */
+    class dlldecl StreamingImageLoader
+    {
+    public:
+        struct Options
+        {
+            ResourceFormat format = ResourceFormat::Unknown;    ///< RGBA32Float, RGBA16Float or RGB9E5Float. Unknown selects RGBA16Float for half-float sources and RGBA32Float otherwise
+            uint32_t maxWidth = 0;                              ///< If non-zero, the image is box-filtered down by an integer factor until it fits
+            uint32_t maxHeight = 0;
+        };
+
+        struct Image
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+            std::vector<uint8_t> data;                          ///< Tightly packed, top-down rows
+        };
+
+        /** Options of environment maps. Half floats hold the range of HDR images at half the size of RGBA32Float, and support mip generation
+        */
+        static Options getEnvMapOptions() { Options options; options.format = ResourceFormat::RGBA16Float; return options; }
+
+        /** Check if images can be loaded to a format
+        */
+        static bool isFormatSupported(ResourceFormat format);
+
+        /** Check if a file can be streamed. Only the header is read.
+            \param[in] filename The image file. Searched in the data directories
+        */
+        static bool canStream(const std::string& filename);
+
+        /** Load an image
+            \param[in] filename The image file. Searched in the data directories
+            \param[in] options Destination format and size
+            \param[out] image The decoded image
+            \return false if the file can't be streamed or is corrupt, otherwise true
+        */
+        static bool load(const std::string& filename, const Options& options, Image& image);
+
+        /** Load an image into a 2D texture
+            \param[in] filename The image file. Searched in the data directories
+            \param[in] options Destination format and size
+            \param[in] generateMips Whether to generate mips on the GPU. Not supported for RGB9E5Float, which can't be rendered to
+            \param[in] bindFlags The bind flags of the texture
+            \return The texture, or nullptr if the file couldn't be loaded
+        */
+        static Texture::SharedPtr createTexture(const std::string& filename, const Options& options, bool generateMips, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
+
+        /** Load a texture, streaming the file if possible. Other files are loaded by Texture::createFromFile() in linear color space, and the options are ignored
+            \param[in] filename The image file. Searched in the data directories
+            \param[in] options Destination format and size of files which are streamed
+            \param[in] generateMips Whether to generate mips
+            \param[in] bindFlags The bind flags of the texture
+            \return The texture, or nullptr if the file couldn't be loaded
+        */
+        static Texture::SharedPtr createTextureFromFile(const std::string& filename, const Options& options, bool generateMips, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
+    };
+}
@@ -27,14 +27,226 @@
 ***************************************************************************/
 #include "stdafx.h"
 #include "Logger.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+#include <iomanip>
+#include <sstream>
 
 namespace Falcor
 {
+    const char* getLogLevelString(Logger::Level L);
+
     namespace
     {
+        const size_t kQueueCapacity = 4096;         // Must be a power of 2
+        const auto kWriterWakeInterval = std::chrono::milliseconds(10);
+
+        /** Bounded multi-producer single-consumer queue. Each slot carries a sequence number which tells the producers and the consumer who owns it.
+        */
+        class MessageQueue
+        {
+        public:
+            MessageQueue()
+            {
+                for (size_t i = 0; i < kQueueCapacity; i++) mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            /** Push a message. Returns false if the queue is full. Thread-safe
+            */
+            bool push(Logger::Message& msg)
+            {
+                size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+                Slot* pSlot;
+                while (true)
+                {
+                    pSlot = &mSlots[pos & (kQueueCapacity - 1)];
+                    size_t seq = pSlot->sequence.load(std::memory_order_acquire);
+                    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                    if (diff == 0)
+                    {
+                        if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = mEnqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+                pSlot->msg = std::move(msg);
+                pSlot->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            /** Pop a message. Returns false if the queue is empty, or the next message wasn't completely pushed yet. Must only be called from the logger thread
+            */
+            bool pop(Logger::Message& msg)
+            {
+                Slot& slot = mSlots[mDequeuePos & (kQueueCapacity - 1)];
+                if (slot.sequence.load(std::memory_order_acquire) != mDequeuePos + 1) return false;
+                msg = std::move(slot.msg);
+                slot.sequence.store(mDequeuePos + kQueueCapacity, std::memory_order_release);
+                mDequeuePos++;
+                return true;
+            }
+
+            /** Get the number of messages which were pushed, or are being pushed
+            */
+            size_t getEnqueuedCount() const { return mEnqueuePos.load(std::memory_order_acquire); }
+
+        private:
+            struct Slot
+            {
+                std::atomic<size_t> sequence;
+                Logger::Message msg;
+            };
+            Slot mSlots[kQueueCapacity];
+            alignas(64) std::atomic<size_t> mEnqueuePos = 0;
+            alignas(64) size_t mDequeuePos = 0;
+        };
+
+        std::string formatLine(const Logger::Message& msg)
+        {
+            return getLogLevelString(msg.level) + std::string("\t") + msg.text + "\n";
+        }
+
+        class FileSink : public Logger::Sink
+        {
+        public:
+            FileSink(FILE* pFile) : mpFile(pFile) {}
+            ~FileSink() { fclose(mpFile); }
+            void write(const Logger::Message& msg) override { std::fputs(formatLine(msg).c_str(), mpFile); }
+            void flush() override { std::fflush(mpFile); }
+        private:
+            FILE* mpFile;
+        };
+
+        class StdoutSink : public Logger::Sink
+        {
+        public:
+            void write(const Logger::Message& msg) override { std::fputs(formatLine(msg).c_str(), stdout); }
+            void flush() override { std::fflush(stdout); }
+        };
+
+        class DebugWindowSink : public Logger::Sink
+        {
+        public:
+            void write(const Logger::Message& msg) override { printToDebugWindow(formatLine(msg)); }
+        };
+
+        class JsonLinesSink : public Logger::Sink
+        {
+        public:
+            JsonLinesSink(FILE* pFile) : mpFile(pFile) {}
+            ~JsonLinesSink() { fclose(mpFile); }
+
+            void write(const Logger::Message& msg) override
+            {
+                std::time_t t = std::chrono::system_clock::to_time_t(msg.time);
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(msg.time.time_since_epoch()).count() % 1000;
+                std::tm tm;
+                gmtime_s(&tm, &t);
+
+                std::ostringstream s;
+                s << "{\"time\":\"" << std::put_time(&tm, "%Y-%m-%dT%H:%M:%S") << "." << std::setw(3) << std::setfill('0') << ms << "Z\"";
+                s << ",\"level\":\"" << getLevelName(msg.level) << "\",\"thread\":" << msg.threadIndex << ",\"msg\":\"" << escape(msg.text) << "\"}\n";
+                std::fputs(s.str().c_str(), mpFile);
+            }
+
+            void flush() override { std::fflush(mpFile); }
+
+        private:
+            static const char* getLevelName(Logger::Level level)
+            {
+                switch (level)
+                {
+                case Logger::Level::Info: return "info";
+                case Logger::Level::Warning: return "warning";
+                case Logger::Level::Error: return "error";
+                case Logger::Level::Fatal: return "fatal";
+                default: should_not_get_here(); return "";
+                }
+            }
+
+            static std::string escape(const std::string& str)
+            {
+                std::string res;
+                res.reserve(str.size());
+                for (char c : str)
+                {
+                    switch (c)
+                    {
+                    case '"': res += "\\\""; break;
+                    case '\\': res += "\\\\"; break;
+                    case '\n': res += "\\n"; break;
+                    case '\r': res += "\\r"; break;
+                    case '\t': res += "\\t"; break;
+                    default:
+                        if ((unsigned char)c < 0x20)
+                        {
+                            char buf[8];
+                            snprintf(buf, sizeof(buf), "\\u%04x", c);
+                            res += buf;
+                        }
+                        else res += c;
+                    }
+                }
+                return res;
+            }
+
+            FILE* mpFile;
+        };
+
+        /** The logger thread and its state
+        */
+        struct LoggerState
+        {
+            MessageQueue queue;
+            std::atomic<uint64_t> droppedMessages = 0;
+            std::atomic<size_t> writtenCount = 0;       // Number of queue positions which were written to the sinks
+            std::atomic<uint32_t> threadCount = 0;
+            std::atomic<uint32_t> rateLimit = 0;     // Off by default, see Logger::setRateLimit()
+            std::atomic<int64_t> rateLimitWindowMs = 1000;
+
+            std::thread thread;
+            std::mutex mutex;                           // Protects the sinks and the wake-up flags
+            std::condition_variable writerCV;           // Wakes the logger thread
+            std::condition_variable flushCV;            // Signaled when a batch was written
+            std::atomic<bool> writerSleeping = false;
+            bool terminate = false;
+            bool running = false;
+            std::vector<Logger::Sink::SharedPtr> sinks;
+
+            // Rate limiting. Only touched by the logger thread
+            struct RepeatInfo
+            {
+                std::chrono::steady_clock::time_point windowStart;
+                uint32_t count = 0;
+                uint64_t suppressed = 0;
+                Logger::Message lastMsg;
+            };
+            using RepeatMap = std::unordered_map<std::string, RepeatInfo>;
+            RepeatMap repeats;
+            std::chrono::steady_clock::time_point lastSweep;
+        };
+
+        LoggerState& getState()
+        {
+            // Allocated on first use so that it can be used during static initialization. Never released, since the logger thread may still be running when the process exits
+            static LoggerState* pState = new LoggerState;
+            return *pState;
+        }
+
         bool sShowErrorBox = true;
-        FILE* sLogFile = nullptr;
         Logger::Level sVerbosity = Logger::Level::Warning;
+        std::atomic<bool> sInit = false;
+        thread_local uint32_t tThreadIndex = uint32_t(-1);
+        thread_local bool tIsWriterThread = false;      // Sinks run on the logger thread and may log themselves. That thread must never wait for itself
 
         FILE* openLogFile()
         {
@@ -61,28 +273,158 @@ namespace Falcor
             return pFile;
         }
 
-        bool init()
+        void writeToSinks(const Logger::Message& msg)
+        {
+            for (auto& pSink : getState().sinks) pSink->write(msg);
+        }
+
+        void writeSuppressedSummary(const LoggerState::RepeatMap::value_type& entry)
+        {
+            Logger::Message msg = entry.second.lastMsg;
+            msg.text = "(Suppressed " + std::to_string(entry.second.suppressed) + " repeats of) " + msg.text;
+            writeToSinks(msg);
+        }
+
+        std::chrono::milliseconds getRateLimitWindow()
+        {
+            return std::chrono::milliseconds(getState().rateLimitWindowMs.load(std::memory_order_relaxed));
+        }
+
+        /** Check if a message passes the rate limiter. Errors are never suppressed
+        */
+        bool checkRateLimit(const Logger::Message& msg, std::chrono::steady_clock::time_point now)
         {
-            bool b = false;
+            LoggerState& state = getState();
+            uint32_t limit = state.rateLimit.load(std::memory_order_relaxed);
+            if (limit == 0 || msg.level >= Logger::Level::Error) return true;
+
+            auto& info = state.repeats[msg.text];
+            if (now - info.windowStart >= getRateLimitWindow())
+            {
+                info.windowStart = now;
+                info.count = 0;
+            }
+            info.lastMsg = msg;
+            if (++info.count <= limit) return true;
+
+            if (info.suppressed == 0)
+            {
+                Logger::Message note = msg;
+                note.text = "(Repeated too often, further repeats will be suppressed) " + msg.text;
+                writeToSinks(note);
+            }
+            info.suppressed++;
+            return false;
+        }
+
+        /** Write summaries of the suppressed messages whose rate-limit window expired, and forget quiet messages
+        */
+        void sweepRepeats(std::chrono::steady_clock::time_point now, bool force)
+        {
+            LoggerState& state = getState();
+            const auto window = getRateLimitWindow();
+            for (auto it = state.repeats.begin(); it != state.repeats.end();)
+            {
+                if (force || now - it->second.windowStart >= window)
+                {
+                    if (it->second.suppressed) writeSuppressedSummary(*it);
+                    it = state.repeats.erase(it);
+                }
+                else ++it;
+            }
+            state.lastSweep = now;
+        }
+
+        void writerThread()
+        {
+            tIsWriterThread = true;
+            LoggerState& state = getState();
+            Logger::Message msg;
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    size_t written = state.writtenCount.load(std::memory_order_relaxed);
+                    auto now = std::chrono::steady_clock::now();
+                    while (state.queue.pop(msg))
+                    {
+                        if (checkRateLimit(msg, now)) writeToSinks(msg);
+                        written++;
+                    }
+
+                    if (written != state.writtenCount.load(std::memory_order_relaxed) || now - state.lastSweep >= getRateLimitWindow())
+                    {
+                        sweepRepeats(now, false);
+                        for (auto& pSink : state.sinks) pSink->flush();
+                        state.writtenCount.store(written, std::memory_order_release);
+                        state.flushCV.notify_all();
+                    }
+                }
+
+                std::unique_lock<std::mutex> lock(state.mutex);
+                if (state.terminate && state.writtenCount.load() >= state.queue.getEnqueuedCount()) break;
+
+                // Producers don't take the lock, so a wake-up can be missed. The timeout bounds the latency in that case
+                state.writerSleeping = true;
+                state.writerCV.wait_for(lock, kWriterWakeInterval);
+                state.writerSleeping = false;
+            }
+
+            std::lock_guard<std::mutex> lock(state.mutex);
+            sweepRepeats(std::chrono::steady_clock::now(), true);
+            for (auto& pSink : state.sinks) pSink->flush();
+            state.sinks.clear();
+            state.running = false;
+            state.flushCV.notify_all();
+        }
+
+        void wakeWriter()
+        {
+            LoggerState& state = getState();
+            if (state.writerSleeping.load(std::memory_order_relaxed)) state.writerCV.notify_one();
+        }
+
+        void startLogger()
+        {
+            static std::once_flag once;
+            std::call_once(once, []()
+            {
 #if _LOG_ENABLED
-            sLogFile = openLogFile();
-            b = sLogFile != nullptr;
-            assert(b);
+                LoggerState& state = getState();
+                FILE* pFile = openLogFile();
+                if (pFile) state.sinks.push_back(std::make_shared<FileSink>(pFile));
+                if (isDebuggerPresent()) state.sinks.push_back(std::make_shared<DebugWindowSink>());
+                state.running = true;
+                state.thread = std::thread(writerThread);
+                sInit = true;
 #endif
-            return b;
+            });
         }
 
-        bool sInit = init();
+        /** Block until the messages pushed before the call were written
+        */
+        void waitForWriter()
+        {
+            LoggerState& state = getState();
+            size_t target = state.queue.getEnqueuedCount();
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.writerCV.notify_one();
+            state.flushCV.wait(lock, [&state, target]() { return state.writtenCount.load() >= target || state.running == false; });
+        }
     }
 
     void Logger::shutdown()
     {
 #if _LOG_ENABLED
-        if(sLogFile)
+        if(sInit.exchange(false))
         {
-            fclose(sLogFile);
-            sLogFile = nullptr;
-            sInit = false;
+            LoggerState& state = getState();
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.terminate = true;
+                state.writerCV.notify_one();
+            }
+            state.thread.join();
         }
 #endif
     }
@@ -96,6 +438,7 @@ namespace Falcor
             create_level_case(Logger::Level::Info);
             create_level_case(Logger::Level::Warning);
             create_level_case(Logger::Level::Error);
+            create_level_case(Logger::Level::Fatal);
         default:
             should_not_get_here();
         }
@@ -106,15 +449,39 @@ namespace Falcor
     void Logger::log(Level L, const std::string& msg, MsgBox mbox)
     {
 #if _LOG_ENABLED
+        startLogger();
         if(sInit)
         {
             if(L >= sVerbosity)
             {
-                std::string s = getLogLevelString(L) + std::string("\t") + msg + "\n";
-                std::fprintf(sLogFile, "%s", s.c_str());
-                if (isDebuggerPresent())
+                LoggerState& state = getState();
+                if (tThreadIndex == uint32_t(-1)) tThreadIndex = state.threadCount++;
+
+                Message m;
+                m.level = L;
+                m.text = msg;
+                m.time = std::chrono::system_clock::now();
+                m.threadIndex = tThreadIndex;
+
+                if (tIsWriterThread)
+                {
+                    // Logged by a sink. The message is written on the next iteration of the logger thread
+                    if (state.queue.push(m) == false) state.droppedMessages++;
+                }
+                else if (L >= Level::Error)
+                {
+                    // Errors are never dropped. Wait for the logger thread to make room, and make sure the message is written before continuing, in case the application is about to crash
+                    while (state.queue.push(m) == false)
+                    {
+                        state.writerCV.notify_one();
+                        std::this_thread::yield();
+                    }
+                    waitForWriter();
+                }
+                else
                 {
-                    printToDebugWindow(s);
+                    if (state.queue.push(m)) wakeWriter();
+                    else state.droppedMessages++;
                 }
             }
         }
@@ -155,12 +522,61 @@ namespace Falcor
                 }
             }
 
-            if (quit) exit(1); // Don't post quit message. It will cause execution of the current frame to resume, which might crash the app
+            if (quit)
+            {
+                shutdown();
+                exit(1); // Don't post quit message. It will cause execution of the current frame to resume, which might crash the app
+            }
         }
 
         if (L >= Level::Fatal) assert(false);   // Assert on errors even without debugger attached
     }
 
+    Logger::Sink::SharedPtr Logger::createFileSink(const std::string& filename)
+    {
+        FILE* pFile = std::fopen(filename.c_str(), "w");
+        return pFile ? std::make_shared<FileSink>(pFile) : nullptr;
+    }
+
+    Logger::Sink::SharedPtr Logger::createStdoutSink()
+    {
+        return std::make_shared<StdoutSink>();
+    }
+
+    Logger::Sink::SharedPtr Logger::createJsonLinesSink(const std::string& filename)
+    {
+        FILE* pFile = std::fopen(filename.c_str(), "w");
+        return pFile ? std::make_shared<JsonLinesSink>(pFile) : nullptr;
+    }
+
+    void Logger::addSink(const Sink::SharedPtr& pSink)
+    {
+        LoggerState& state = getState();
+        if (pSink == nullptr) return;
+        startLogger();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.sinks.push_back(pSink);
+    }
+
+    void Logger::removeSink(const Sink::SharedPtr& pSink)
+    {
+        LoggerState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.sinks.erase(std::remove(state.sinks.begin(), state.sinks.end(), pSink), state.sinks.end());
+    }
+
+    void Logger::flush()
+    {
+        if (sInit && !tIsWriterThread) waitForWriter();
+    }
+
+    void Logger::setRateLimit(uint32_t maxRepeats, std::chrono::milliseconds window)
+    {
+        getState().rateLimit = maxRepeats;
+        getState().rateLimitWindowMs = window.count();
+    }
+
+    uint64_t Logger::getDroppedMessageCount() { return getState().droppedMessages; }
     void Logger::showBoxOnError(bool showBox) { sShowErrorBox = showBox; }
     bool Logger::isBoxShownOnError() { return sShowErrorBox; }
     void Logger::setVerbosity(Level level) { sVerbosity = level; }
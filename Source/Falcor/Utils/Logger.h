@@ -26,12 +26,16 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include <chrono>
+#include <memory>
 
 namespace Falcor
 {
     /** Container class for logging messages. 
     *   To enable log messages, make sure _LOG_ENABLED is set to true in FalcorConfig.h.
     *   Messages are printed to a log file in the application directory. Using Logger#ShowBoxOnError() you can control if a message box will be shown as well.
+    *   Logging is asynchronous. Messages are pushed into a lock-free queue and written to the sinks by a background thread. Errors are flushed before the call returns.
+    *   Repeated messages can be rate-limited, see Logger#setRateLimit(). Rate limiting is off by default.
     */
     class dlldecl Logger
     {
@@ -56,7 +60,70 @@ namespace Falcor
             Nope    ///< Don't show a message box
         };
 
-        /** Shutdown the logger and close the log file.
+        /** A log message, as passed to the sinks
+        */
+        struct Message
+        {
+            Level level = Level::Info;
+            std::string text;
+            std::chrono::system_clock::time_point time;
+            uint32_t threadIndex = 0;   ///< Index of the thread which logged the message, in order of the threads' first log call
+        };
+
+        /** Log output interface. Sinks are only called from the logger thread.
+        */
+        class dlldecl Sink
+        {
+        public:
+            using SharedPtr = std::shared_ptr<Sink>;
+            virtual ~Sink() = default;
+
+            /** Write a message
+            */
+            virtual void write(const Message& msg) = 0;
+
+            /** Flush pending output. Called when the message queue is empty, and on Logger#flush().
+            */
+            virtual void flush() {}
+        };
+
+        /** Create a sink which writes text lines into a file.
+            \return A new sink, or nullptr if the file can't be opened
+        */
+        static Sink::SharedPtr createFileSink(const std::string& filename);
+
+        /** Create a sink which writes text lines to stdout
+        */
+        static Sink::SharedPtr createStdoutSink();
+
+        /** Create a sink which writes a JSON object per line into a file. Each object has the fields `time`, `level`, `thread` and `msg`.
+            \return A new sink, or nullptr if the file can't be opened
+        */
+        static Sink::SharedPtr createJsonLinesSink(const std::string& filename);
+
+        /** Add a sink. By default, the logger writes into a log file in the application directory, and to the debug window when a debugger is attached.
+        */
+        static void addSink(const Sink::SharedPtr& pSink);
+
+        /** Remove a sink. Messages which are still in the queue will not be written to it.
+        */
+        static void removeSink(const Sink::SharedPtr& pSink);
+
+        /** Block until all the messages logged before the call were written to the sinks.
+        */
+        static void flush();
+
+        /** Set the maximum number of times the same info/warning message is written per time window. Excess messages are counted and summarized once the message becomes quiet.
+            \param[in] maxRepeats The number of repeats per window. 0 disables rate limiting, which is the default.
+            \param[in] window The length of the window.
+        */
+        static void setRateLimit(uint32_t maxRepeats, std::chrono::milliseconds window = std::chrono::seconds(1));
+
+        /** Get the number of info/warning messages which were dropped because the message queue was full
+        */
+        static uint64_t getDroppedMessageCount();
+
+        /** Shutdown the logger. Flushes the message queue, stops the logger thread and closes the log file.
         */
         static void shutdown();
 
@@ -27,6 +27,8 @@
 ***************************************************************************/
 #include "stdafx.h"
 #include "Threading.h"
+#include <deque>
+#include <atomic>
 
 namespace Falcor
 {
@@ -35,26 +37,72 @@ namespace Falcor
         struct ThreadingData
         {
             bool initialized = false;
+            bool stop = false;
             std::vector<std::thread> threads;
-            uint32_t current;
+            std::deque<std::function<void(void)>> jobs;
+            std::mutex mutex;
+            std::condition_variable cv;
         } gData;
+
+        // Pool thread i uses slot i + 1, every other thread uses slot 0
+        thread_local uint32_t tThreadSlot = 0;
+
+        void workerLoop(uint32_t slot)
+        {
+            tThreadSlot = slot;
+            while (true)
+            {
+                std::function<void(void)> job;
+                {
+                    std::unique_lock<std::mutex> lock(gData.mutex);
+                    gData.cv.wait(lock, [] { return gData.stop || !gData.jobs.empty(); });
+                    if (gData.jobs.empty()) return; // Only happens when stopping
+                    job = std::move(gData.jobs.front());
+                    gData.jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+        bool runQueuedJob()
+        {
+            std::function<void(void)> job;
+            {
+                std::lock_guard<std::mutex> lock(gData.mutex);
+                if (gData.jobs.empty()) return false;
+                job = std::move(gData.jobs.front());
+                gData.jobs.pop_front();
+            }
+            job();
+            return true;
+        }
     }
 
     void Threading::start(uint32_t threadCount)
     {
         if (gData.initialized) return;
 
-        gData.threads.resize(threadCount);
+        gData.stop = false;
+        gData.threads.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; i++) gData.threads.push_back(std::thread(workerLoop, i + 1));
         gData.initialized = true;
     }
 
     void Threading::shutdown()
     {
+        {
+            std::lock_guard<std::mutex> lock(gData.mutex);
+            gData.stop = true;
+        }
+        gData.cv.notify_all();
+
+        // Workers drain the queue before exiting
         for (auto& t : gData.threads)
         {
             if (t.joinable()) t.join();
         }
 
+        gData.threads.clear();
         gData.initialized = false;
     }
 
@@ -62,26 +110,129 @@ namespace Falcor
     {
         assert(gData.initialized);
 
-        std::thread& t = gData.threads[gData.current];
-        if (t.joinable()) t.join();
-        t = std::thread(func);
-        gData.current = (gData.current + 1) % gData.threads.size();
+        Task task;
+        auto pState = task.mpState;
+        pState->func = func;
+        {
+            std::lock_guard<std::mutex> lock(gData.mutex);
+            gData.jobs.push_back([pState]() { pState->run(); });
+        }
+        gData.cv.notify_one();
 
-        return Task();
+        return task;
     }
 
-    Threading::Task::Task()
+    void Threading::parallelFor(uint32_t count, const std::function<void(uint32_t)>& func, uint32_t grainSize)
+    {
+        grainSize = std::max(grainSize, 1u);
+        uint32_t jobCount = (count + grainSize - 1) / grainSize;
+        if (jobCount <= 1)
+        {
+            for (uint32_t i = 0; i < count; i++) func(i);
+            return;
+        }
+
+        // The helper tasks may start after this call returned, so the state they use is reference counted
+        struct State
+        {
+            std::function<void(uint32_t)> func;
+            std::atomic<uint32_t> next = 0;
+            std::atomic<uint32_t> done = 0;
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::exception_ptr exception;
+        };
+        auto pState = std::make_shared<State>();
+        pState->func = func;
+
+        auto work = [pState, jobCount, count, grainSize]()
+        {
+            uint32_t job;
+            while ((job = pState->next++) < jobCount)
+            {
+                uint32_t end = std::min(count, (job + 1) * grainSize);
+                try
+                {
+                    for (uint32_t i = job * grainSize; i < end; i++) pState->func(i);
+                }
+                catch (...)
+                {
+                    // The batch still counts as done, otherwise the caller would wait forever. The first exception is rethrown to the caller
+                    std::lock_guard<std::mutex> lock(pState->mutex);
+                    if (!pState->exception) pState->exception = std::current_exception();
+                }
+                if (++pState->done == jobCount)
+                {
+                    { std::lock_guard<std::mutex> lock(pState->mutex); }
+                    pState->cv.notify_all();
+                }
+            }
+        };
+
+        uint32_t helpers = std::min(jobCount - 1, getLogicalThreadCount());
+        for (uint32_t i = 0; i < helpers; i++) dispatchTask(work);
+        work();
+
+        std::unique_lock<std::mutex> lock(pState->mutex);
+        pState->cv.wait(lock, [&]() { return pState->done == jobCount; });
+        if (pState->exception) std::rethrow_exception(pState->exception);
+    }
+
+    uint32_t Threading::getThreadSlotCount()
+    {
+        return (uint32_t)gData.threads.size() + 1;
+    }
+
+    uint32_t Threading::getCurrentThreadSlot()
+    {
+        return tThreadSlot;
+    }
+
+    void Threading::Task::State::run()
+    {
+        // A task runs exactly once, either from the queue or inline from finish()
+        if (claimed.exchange(true)) return;
+
+        std::exception_ptr e;
+        try
+        {
+            func();
+        }
+        catch (...)
+        {
+            e = std::current_exception();
+        }
+        func = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            exception = e;
+            done = true;
+        }
+        cv.notify_all();
+    }
+
+    Threading::Task::Task() : mpState(std::make_shared<State>())
     {
     }
 
     bool Threading::Task::isRunning()
     {
-        logError("Threading::Task::isRunning() not implemented");
-        return true;
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        return !mpState->done;
     }
 
     void Threading::Task::finish()
     {
-        logError("Threading::Task::finish() not implemented");
+        if (tThreadSlot != 0)
+        {
+            // Blocking a pool thread on a task that is still queued can deadlock the pool. Run it here, and help with other queued work while it runs elsewhere
+            mpState->run();
+            while (isRunning() && runQueuedJob()) {}
+        }
+
+        std::unique_lock<std::mutex> lock(mpState->mutex);
+        mpState->cv.wait(lock, [this] { return mpState->done; });
+        if (mpState->exception) std::rethrow_exception(mpState->exception);
     }
 }
@@ -27,6 +27,11 @@
 ***************************************************************************/
 #pragma once
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
 
 namespace Falcor
 {
@@ -36,23 +41,35 @@ namespace Falcor
         const static uint32_t kDefaultThreadCount = 16;
 
         /** Handle to a dispatched task
-
-            TODO: Implementation
         */
-        class Task
+        class dlldecl Task
         {
         public:
             /** Check if task is still executing
             */
             bool isRunning();
 
-            /** Wait for task to finish executing
+            /** Wait for task to finish executing. If the task threw an exception, it is rethrown here.
+                When called from a pool thread, a task which didn't start yet is executed inline, and other queued tasks are executed while waiting, so this doesn't deadlock the pool.
             */
             void finish();
 
         private:
+            struct State
+            {
+                std::mutex mutex;
+                std::condition_variable cv;
+                std::function<void(void)> func;
+                std::atomic<bool> claimed = false;
+                bool done = false;
+                std::exception_ptr exception;
+
+                void run();
+            };
+
             Task();
             friend class Threading;
+            std::shared_ptr<State> mpState;
         };
 
         /** Initializes the global thread pool
@@ -68,9 +85,26 @@ namespace Falcor
         */
         static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
 
-        /** Starts a task on an available thread.
+        /** Returns the number of thread slots, which is the number of pool threads plus one. See getCurrentThreadSlot()
+        */
+        static uint32_t getThreadSlotCount();
+
+        /** Returns a stable slot index for the calling thread, in [0, getThreadSlotCount()).
+            Pool thread i uses slot i + 1. All other threads share slot 0, so per-slot data must still be protected by a lock if used outside the pool.
+        */
+        static uint32_t getCurrentThreadSlot();
+
+        /** Queues a task for execution on the thread pool. Tasks are started in the order they were dispatched.
             \return Handle to the task
         */
         static Task dispatchTask(const std::function<void(void)>& func);
+
+        /** Run func(i) for every i in [0, count) on the thread pool, and wait for all of them to finish.
+            The calling thread takes part in the work and only waits for indices which are being processed, so this is safe to call from a pool thread.
+            \param[in] count Number of indices
+            \param[in] func The function to call for each index. Called concurrently from several threads
+            \param[in] grainSize Number of consecutive indices a thread processes at a time. Use larger values when func is cheap
+        */
+        static void parallelFor(uint32_t count, const std::function<void(uint32_t)>& func, uint32_t grainSize = 1);
     };
 }
@@ -31,6 +31,11 @@
 #include "Core/API/FencedPool.h"
 #include <sstream>
 #include <fstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <array>
+#include <deque>
 #define USE_PIX
 #include "WinPixEventRuntime/Include/WinPixEventRuntime/pix3.h"
 
@@ -40,97 +45,384 @@ namespace Falcor
 
     std::unordered_map<std::string, Profiler::EventData*> Profiler::sProfilerEvents;
     std::vector<Profiler::EventData*> Profiler::sRegisteredEvents;
-    std::string curEventName = "";
-    uint32_t Profiler::sCurrentLevel = 0;
+    std::vector<Profiler::FrameEventTime> Profiler::sLastFrameTimes;
     uint32_t Profiler::sGpuTimerIndex = 0;
 
-    void Profiler::initNewEvent(EventData *pEvent, const std::string& name)
+    namespace
     {
-        pEvent->name = name;
-        sProfilerEvents[curEventName] = pEvent;
+        const uint32_t kRootNode = 0;
+        const uint32_t kMaxEventNodes = 16 * 1024;
+
+        // The DLL is loaded by the main thread. That's the thread which owns the render-context, so it's the only thread which records GPU timers
+        const std::thread::id gMainThreadId = std::this_thread::get_id();
+
+        struct EventRecord
+        {
+            CpuTimer::TimePoint time;
+            uint32_t node;
+            bool isBegin;
+            bool showInMsg;
+        };
+
+        /** Fixed-capacity event record ring-buffer.
+            There's a single producer (the thread which owns the buffer) and a single consumer (the thread calling Profiler::endFrame()), so no locks are required.
+        */
+        class EventBuffer
+        {
+        public:
+            static const uint32_t kCapacity = 4096;
+
+            uint32_t getFreeCount() const { return kCapacity - (mHead.load(std::memory_order_relaxed) - mTail.load(std::memory_order_acquire)); }
+
+            void push(const EventRecord& record)
+            {
+                uint32_t head = mHead.load(std::memory_order_relaxed);
+                mRecords[head % kCapacity] = record;
+                mHead.store(head + 1, std::memory_order_release);
+            }
+
+            template<typename FuncType>
+            void drain(FuncType func)
+            {
+                uint32_t tail = mTail.load(std::memory_order_relaxed);
+                uint32_t head = mHead.load(std::memory_order_acquire);
+                for (; tail != head; tail++) func(mRecords[tail % kCapacity]);
+                mTail.store(tail, std::memory_order_release);
+            }
+
+            struct OpenEvent
+            {
+                uint32_t node;
+                CpuTimer::TimePoint start;
+            };
+            std::vector<OpenEvent> openEvents; // Consumer-side stack of events which began but didn't end yet
+            uint32_t threadIndex = 0;
+            bool isMainThread = false;
+
+        private:
+            std::array<EventRecord, kCapacity> mRecords;
+            std::atomic<uint32_t> mHead = 0;
+            std::atomic<uint32_t> mTail = 0;
+        };
+
+        struct
+        {
+            std::mutex mutex;                                           // Guards everything below, except for the event table entries, which are immutable once created
+            std::deque<std::string> eventNames;                         // EventId -> name. A deque, so references stay valid while new names are added
+            std::unordered_map<std::string, Profiler::EventId> eventIds;
+            std::unordered_map<uint64_t, uint32_t> nodeLookup;          // (parent node, EventId) -> node
+            std::array<Profiler::EventData*, kMaxEventNodes> nodes = {};
+            uint32_t nodeCount = 0;
+            std::vector<std::shared_ptr<EventBuffer>> buffers;
+            std::atomic<uint32_t> generation = 0;                       // Incremented by Profiler::clearEvents(). Invalidates the thread-local caches
+            std::atomic<uint64_t> droppedRecords = 0;
+            uint32_t threadCount = 0;                                   // Number of threads which recorded events. Used to assign a unique index to each thread
+        } gData;
+
+        /** Timeline capture state. Touched only by the main thread
+        */
+        struct CaptureEvent
+        {
+            uint32_t node;
+            uint32_t track;         // The thread index for CPU events, kGpuTrack for GPU events
+            CpuTimer::TimePoint start;
+            CpuTimer::TimePoint end;
+        };
+
+        const uint32_t kGpuTrack = uint32_t(-1);
+
+        struct
+        {
+            enum class State
+            {
+                Idle,
+                Pending,            // Waiting for the current frame to end
+                Active
+            } state = State::Idle;
+
+            std::string filename;
+            uint32_t frameCount = 0;
+            uint32_t cpuFramesLeft = 0;             // Frames left for which to capture CPU events
+            bool capturedPrevFrame = false;         // True if the CPU events of the previous frame were captured. GPU results lag one frame behind
+            std::vector<CaptureEvent> events;
+            CpuTimer::TimePoint origin;
+            bool calibrated = false;
+            uint64_t gpuCalibrationTicks = 0;
+            CpuTimer::TimePoint cpuCalibrationTime;
+        } gCapture;
+
+        /** Per-thread profiler state. Touched only by the owning thread
+        */
+        struct ThreadState
+        {
+            uint32_t currentNode = kRootNode;
+            uint32_t openCount = 0;         // Number of events recorded into the buffer which didn't end yet
+            uint32_t droppedDepth = 0;      // Number of nested events dropped because the buffer was full
+            uint32_t generation = 0;
+            std::unordered_map<uint64_t, uint32_t> childCache;
+            std::shared_ptr<EventBuffer> pBuffer;
+        };
+        thread_local ThreadState tState;
+
+        uint64_t nodeKey(uint32_t parent, Profiler::EventId id)
+        {
+            return (uint64_t(parent) << 32) | id;
+        }
+
+        uint32_t createNode(uint32_t parent, Profiler::EventId id)
+        {
+            // gData.mutex must be held
+            if (gData.nodeCount == 0)
+            {
+                // Create the root
+                Profiler::EventData* pRoot = new Profiler::EventData;
+                pRoot->parent = kRootNode;
+                pRoot->level = uint32_t(-1);
+                gData.nodes[gData.nodeCount++] = pRoot;
+            }
+
+            auto it = gData.nodeLookup.find(nodeKey(parent, id));
+            if (it != gData.nodeLookup.end()) return it->second;
+
+            if (gData.nodeCount == kMaxEventNodes)
+            {
+                logError("Profiler event hierarchy is full. Ignoring event `" + gData.eventNames[id] + "`");
+                return kRootNode;
+            }
+
+            const Profiler::EventData* pParent = gData.nodes[parent];
+            Profiler::EventData* pData = new Profiler::EventData;
+            pData->name = pParent->name + "#" + gData.eventNames[id];
+            pData->eventId = id;
+            pData->parent = parent;
+            pData->level = pParent->level + 1;
+
+            uint32_t node = gData.nodeCount++;
+            gData.nodes[node] = pData;
+            gData.nodeLookup[nodeKey(parent, id)] = node;
+            Profiler::sProfilerEvents[pData->name] = pData;
+            return node;
+        }
+
+        ThreadState& getThreadState()
+        {
+            ThreadState& state = tState;
+            if (state.pBuffer == nullptr)
+            {
+                state.pBuffer = std::make_shared<EventBuffer>();
+                state.pBuffer->isMainThread = (std::this_thread::get_id() == gMainThreadId);
+                std::lock_guard<std::mutex> lock(gData.mutex);
+                state.pBuffer->threadIndex = gData.threadCount++;
+                gData.buffers.push_back(state.pBuffer);
+                state.generation = gData.generation;
+            }
+
+            if (state.generation != gData.generation.load(std::memory_order_acquire))
+            {
+                state.childCache.clear();
+                state.currentNode = kRootNode;
+                state.openCount = 0;
+                state.droppedDepth = 0;
+                state.generation = gData.generation;
+            }
+            return state;
+        }
+
+        uint32_t getChildNode(ThreadState& state, Profiler::EventId id)
+        {
+            uint64_t key = nodeKey(state.currentNode, id);
+            auto it = state.childCache.find(key);
+            if (it != state.childCache.end()) return it->second;
+
+            std::lock_guard<std::mutex> lock(gData.mutex);
+            uint32_t node = createNode(state.currentNode, id);
+            state.childCache[key] = node;
+            return node;
+        }
     }
 
-    Profiler::EventData* Profiler::createNewEvent(const std::string& name)
+    Profiler::EventId Profiler::registerEvent(const std::string& name)
     {
-        EventData *pData = new EventData;
-        initNewEvent(pData, name);
-        return pData;
+        // Event IDs are never released, so the thread-local table never goes stale
+        thread_local std::unordered_map<std::string, EventId> tEventIds;
+        auto cached = tEventIds.find(name);
+        if (cached != tEventIds.end()) return cached->second;
+
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        EventId id;
+        auto it = gData.eventIds.find(name);
+        if (it != gData.eventIds.end())
+        {
+            id = it->second;
+        }
+        else
+        {
+            id = (EventId)gData.eventNames.size();
+            gData.eventNames.push_back(name);
+            gData.eventIds[name] = id;
+        }
+        tEventIds[name] = id;
+        return id;
+    }
+
+    const std::string& Profiler::getEventName(EventId id)
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        assert(id < gData.eventNames.size());
+        return gData.eventNames[id];
     }
 
     Profiler::EventData* Profiler::isEventRegistered(const std::string& name)
     {
+        std::lock_guard<std::mutex> lock(gData.mutex);
         auto event = sProfilerEvents.find(name);
         return (event == sProfilerEvents.end()) ? nullptr : event->second;
     }
 
     Profiler::EventData* Profiler::getEvent(const std::string& name)
     {
-        auto event = isEventRegistered(name);
-        return event ? event : createNewEvent(name);
+        return isEventRegistered(name);
+    }
+
+    uint32_t Profiler::getCurrentNode()
+    {
+        return getThreadState().currentNode;
+    }
+
+    uint32_t Profiler::setCurrentNode(uint32_t node)
+    {
+        ThreadState& state = getThreadState();
+        assert(state.openCount == 0 && state.droppedDepth == 0);
+        uint32_t prevNode = state.currentNode;
+        state.currentNode = node;
+        return prevNode;
     }
 
-    void Profiler::startEvent(const std::string& name, Flags flags, bool showInMsg)
+    void Profiler::startEvent(EventId id, Flags flags, bool showInMsg)
     {
         if (is_set(flags, Flags::Internal))
         {
-            curEventName = curEventName + "#" + name;
-            EventData* pData = getEvent(curEventName);
-            pData->triggered++;
-            if (pData->triggered > 1)
+            ThreadState& state = getThreadState();
+
+            // Every open event needs a slot for its end record, so make sure the buffer has space for both records of this event and for all the pending end records
+            uint32_t node = kRootNode;
+            if (state.droppedDepth == 0 && state.pBuffer->getFreeCount() >= state.openCount + 2)
             {
-                logWarning("Profiler event `" + name + "` was triggered while it is already running. Nesting profiler events with the same name is disallowed and you should probably fix that. Ignoring the new call");
-                return;
+                node = getChildNode(state, id);
             }
 
-            pData->showInMsg = showInMsg;
-            pData->level = sCurrentLevel;
-            pData->cpuStart = CpuTimer::getCurrentTimePoint();
-            EventData::FrameData& frame = pData->frameData[sGpuTimerIndex];
-            if (frame.currentTimer >= frame.pTimers.size())
+            if (node == kRootNode)
             {
-                frame.pTimers.push_back(GpuTimer::create());
+                state.droppedDepth++;
+                gData.droppedRecords++;
             }
-            frame.pTimers[frame.currentTimer]->begin();
-            pData->callStack.push(frame.currentTimer);
-            frame.currentTimer++;
-            sCurrentLevel++;
-
-            if (!pData->registered)
+            else
             {
-                sRegisteredEvents.push_back(pData);
-                pData->registered = true;
+                state.currentNode = node;
+                state.openCount++;
+                state.pBuffer->push({ CpuTimer::getCurrentTimePoint(), node, true, showInMsg });
+
+                if (std::this_thread::get_id() == gMainThreadId)
+                {
+                    EventData* pData = gData.nodes[node];
+                    pData->triggered++;
+                    if (pData->triggered > 1)
+                    {
+                        logWarning("Profiler event `" + pData->name + "` was triggered while it is already running. Nesting profiler events with the same name is disallowed and you should probably fix that.");
+                    }
+                    EventData::FrameData& frame = pData->frameData[sGpuTimerIndex];
+                    if (frame.currentTimer >= frame.pTimers.size())
+                    {
+                        frame.pTimers.push_back(GpuTimer::create());
+                    }
+                    frame.pTimers[frame.currentTimer]->begin();
+                    pData->callStack.push(frame.currentTimer);
+                    frame.currentTimer++;
+                }
             }
         }
-        if (is_set(flags, Flags::Pix))
+        if (is_set(flags, Flags::Pix) && std::this_thread::get_id() == gMainThreadId)
         {
-            PIXBeginEvent((ID3D12GraphicsCommandList*)gpDevice->getRenderContext()->getLowLevelData()->getCommandList(), PIX_COLOR(0, 0, 0), name.c_str());
+            PIXBeginEvent((ID3D12GraphicsCommandList*)gpDevice->getRenderContext()->getLowLevelData()->getCommandList(), PIX_COLOR(0, 0, 0), getEventName(id).c_str());
         }
     }
 
-    void Profiler::endEvent(const std::string& name, Flags flags)
+    void Profiler::endEvent(EventId id, Flags flags)
     {
         if (is_set(flags, Flags::Internal))
         {
-            assert(isEventRegistered(curEventName));
-            EventData* pData = getEvent(curEventName);
-            pData->triggered--;
-            if (pData->triggered != 0) return;
-
-            pData->cpuEnd = CpuTimer::getCurrentTimePoint();
-            pData->cpuTotal += CpuTimer::calcDuration(pData->cpuStart, pData->cpuEnd);
-
-            pData->frameData[sGpuTimerIndex].pTimers[pData->callStack.top()]->end();
-            pData->callStack.pop();
+            ThreadState& state = getThreadState();
+            if (state.droppedDepth)
+            {
+                state.droppedDepth--;
+                gData.droppedRecords++;
+            }
+            else if (state.openCount && gData.nodes[state.currentNode]->eventId == id) // Ignore unbalanced calls
+            {
+                uint32_t node = state.currentNode;
+                EventData* pData = gData.nodes[node];
+                state.pBuffer->push({ CpuTimer::getCurrentTimePoint(), node, false, false });
+                state.currentNode = pData->parent;
+                state.openCount--;
 
-            sCurrentLevel--;
-            curEventName.erase(curEventName.find_last_of("#"));
+                if (std::this_thread::get_id() == gMainThreadId)
+                {
+                    pData->triggered--;
+                    pData->frameData[sGpuTimerIndex].pTimers[pData->callStack.top()]->end();
+                    pData->callStack.pop();
+                }
+            }
         }
-        if (is_set(flags, Flags::Pix))
+        if (is_set(flags, Flags::Pix) && std::this_thread::get_id() == gMainThreadId)
         {
             PIXEndEvent((ID3D12GraphicsCommandList*)gpDevice->getRenderContext()->getLowLevelData()->getCommandList());
         }
     }
 
+    void Profiler::collectEvents()
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        for (auto& pBuffer : gData.buffers)
+        {
+            auto& openEvents = pBuffer->openEvents;
+            uint32_t threadIndex = pBuffer->threadIndex;
+            pBuffer->drain([&openEvents, threadIndex](const EventRecord& record)
+            {
+                EventData* pData = gData.nodes[record.node];
+                if (record.isBegin)
+                {
+                    openEvents.push_back({ record.node, record.time });
+                    pData->showInMsg = record.showInMsg;
+                    if (!pData->registered)
+                    {
+                        sRegisteredEvents.push_back(pData);
+                        pData->registered = true;
+                    }
+                }
+                else
+                {
+                    // Pop until we find the matching begin record
+                    while (openEvents.size())
+                    {
+                        EventBuffer::OpenEvent e = openEvents.back();
+                        openEvents.pop_back();
+                        if (e.node == record.node)
+                        {
+                            pData->cpuTotal += CpuTimer::calcDuration(e.start, record.time);
+                            if (gCapture.cpuFramesLeft) gCapture.events.push_back({ record.node, threadIndex, e.start, record.time });
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    uint64_t Profiler::getDroppedRecordCount()
+    {
+        return gData.droppedRecords;
+    }
+
     double Profiler::getEventGpuTime(const std::string& name)
     {
         const auto& pEvent = getEvent(name);
@@ -139,6 +431,7 @@ namespace Falcor
 
     double Profiler::getEventCpuTime(const std::string& name)
     {
+        collectEvents();
         const auto& pEvent = getEvent(name);
         return pEvent ? getCpuTime(pEvent) : 0;
     }
@@ -160,15 +453,14 @@ namespace Falcor
 
     std::string Profiler::getEventsString()
     {
+        collectEvents();
         std::string results("Name\t\t\t\t\tCPU time(ms)\t\t  GPU time(ms)\n");
 
         for (EventData* pData : sRegisteredEvents)
         {
-            assert(pData->triggered == 0);
             if (pData->showInMsg == false) continue;
 
             double gpuTime = getGpuTime(pData);
-            assert(pData->callStack.empty());
 
             char event[1000];
             uint32_t nameIndent = pData->level * 2 + 1;
@@ -201,11 +493,16 @@ namespace Falcor
 
     void Profiler::endFrame()
     {
+        collectEvents();
+        const bool captureGpu = gCapture.capturedPrevFrame;
+        sLastFrameTimes.clear();
         for (EventData* pData : sRegisteredEvents)
         {
             // Update CPU/GPU time running averages.
             const double cpuTime = getCpuTime(pData);
             const double gpuTime = getGpuTime(pData);
+            if (captureGpu) captureGpuEvents(pData);
+            sLastFrameTimes.push_back({ pData, cpuTime, gpuTime });
             // With sigma = 0.98, then after 100 frames, a given value's contribution is down to ~1.7% of
             // the running average, which seems to provide a reasonable trade-off of temporal smoothing
             // versus setting in to a new value when something has changed.
@@ -217,12 +514,146 @@ namespace Falcor
 
             pData->showInMsg = false;
             pData->cpuTotal = 0;
-            pData->triggered = 0;
             pData->frameData[1 - sGpuTimerIndex].currentTimer = 0;
             pData->registered = false;
         }
         sRegisteredEvents.clear();
         sGpuTimerIndex = 1 - sGpuTimerIndex;
+        updateCapture();
+    }
+
+    void Profiler::startCapture(const std::string& filename, uint32_t frameCount)
+    {
+        if (gCapture.state != decltype(gCapture)::State::Idle)
+        {
+            logWarning("Profiler::startCapture() - a capture is already in progress. Ignoring call");
+            return;
+        }
+        if (frameCount == 0) return;
+
+        gCapture.filename = filename;
+        gCapture.frameCount = frameCount;
+        gCapture.events.clear();
+        gCapture.state = decltype(gCapture)::State::Pending;
+    }
+
+    bool Profiler::isCapturing()
+    {
+        return gCapture.state != decltype(gCapture)::State::Idle;
+    }
+
+    void Profiler::captureGpuEvents(const EventData* pData)
+    {
+        if (pData->level == uint32_t(-1)) return;
+        const auto& frame = pData->frameData[1 - sGpuTimerIndex];
+        const double msPerTick = gpDevice->getGpuTimestampFrequency();
+        uint32_t node;
+        {
+            std::lock_guard<std::mutex> lock(gData.mutex);
+            node = gData.nodeLookup.at(nodeKey(pData->parent, pData->eventId));
+        }
+
+        for (size_t i = 0; i < frame.currentTimer; i++)
+        {
+            uint64_t start, end;
+            frame.pTimers[i]->getTimestamps(start, end);
+
+            if (!gCapture.calibrated)
+            {
+                // No calibration support. Align the first GPU event with the CPU start of the same event
+                auto it = std::find_if(gCapture.events.begin(), gCapture.events.end(), [node](const CaptureEvent& e) { return e.node == node && e.track != kGpuTrack; });
+                if (it == gCapture.events.end()) continue;
+                gCapture.gpuCalibrationTicks = start;
+                gCapture.cpuCalibrationTime = it->start;
+                gCapture.calibrated = true;
+            }
+
+            auto toCpuTime = [msPerTick](uint64_t ticks)
+            {
+                double ms = (double)((int64_t)ticks - (int64_t)gCapture.gpuCalibrationTicks) * msPerTick;
+                return gCapture.cpuCalibrationTime + std::chrono::duration_cast<CpuTimer::TimePoint::duration>(std::chrono::duration<double, std::milli>(ms));
+            };
+            gCapture.events.push_back({ node, kGpuTrack, toCpuTime(start), toCpuTime(end) });
+        }
+    }
+
+    void Profiler::updateCapture()
+    {
+        using State = decltype(gCapture)::State;
+        switch (gCapture.state)
+        {
+        case State::Pending:
+            gCapture.state = State::Active;
+            gCapture.cpuFramesLeft = gCapture.frameCount;
+            gCapture.capturedPrevFrame = false;
+            gCapture.origin = CpuTimer::getCurrentTimePoint();
+            gCapture.calibrated = GpuTimer::getClockCalibration(gCapture.gpuCalibrationTicks, gCapture.cpuCalibrationTime);
+            break;
+        case State::Active:
+            gCapture.capturedPrevFrame = gCapture.cpuFramesLeft > 0;
+            if (gCapture.cpuFramesLeft)
+            {
+                gCapture.cpuFramesLeft--;
+            }
+            else
+            {
+                // The GPU results of the last frame were just collected
+                writeCapture();
+                gCapture.events.clear();
+                gCapture.state = State::Idle;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void Profiler::writeCapture()
+    {
+        std::ofstream out(gCapture.filename);
+        if (!out.good())
+        {
+            logError("Profiler::writeCapture() - can't open `" + gCapture.filename + "` for writing");
+            return;
+        }
+
+        auto escape = [](const std::string& str)
+        {
+            std::string res;
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\') res += '\\';
+                res += c;
+            }
+            return res;
+        };
+
+        auto toUs = [](CpuTimer::TimePoint t) { return CpuTimer::calcDuration(gCapture.origin, t) * 1000.0; };
+
+        // Chrome Trace Event format. CPU threads are in process 0, the GPU is in process 1
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+        {
+            std::lock_guard<std::mutex> lock(gData.mutex);
+            for (const auto& pBuffer : gData.buffers)
+            {
+                std::string name = pBuffer->isMainThread ? "Main thread" : "Thread " + std::to_string(pBuffer->threadIndex);
+                out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << pBuffer->threadIndex << ",\"args\":{\"name\":\"" << name << "\"}}";
+            }
+
+            for (const auto& e : gCapture.events)
+            {
+                const EventData* pData = gData.nodes[e.node];
+                bool isGpu = (e.track == kGpuTrack);
+                out << ",\n{\"name\":\"" << escape(gData.eventNames[pData->eventId]) << "\",\"cat\":\"" << (isGpu ? "gpu" : "cpu") << "\",\"ph\":\"X\"";
+                out << ",\"pid\":" << (isGpu ? 1 : 0) << ",\"tid\":" << (isGpu ? 0 : e.track);
+                out << ",\"ts\":" << toUs(e.start) << ",\"dur\":" << toUs(e.end) - toUs(e.start);
+                out << ",\"args\":{\"path\":\"" << escape(pData->name) << "\"}}";
+            }
+        }
+        out << "\n]}\n";
+        logInfo("Profiler capture written to `" + gCapture.filename + "`");
     }
 
 #if _PROFILING_LOG == 1
@@ -246,14 +677,34 @@ namespace Falcor
 
     void Profiler::clearEvents()
     {
-        for (EventData* pData : sRegisteredEvents)
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        for (uint32_t i = 0; i < gData.nodeCount; i++)
+        {
+            safe_delete(gData.nodes[i]);
+        }
+        gData.nodeCount = 0;
+        gData.nodeLookup.clear();
+        for (auto& pBuffer : gData.buffers)
         {
-            delete pData;
+            pBuffer->drain([](const EventRecord&) {});
+            pBuffer->openEvents.clear();
         }
+        // Release the buffers of threads which exited
+        gData.buffers.erase(std::remove_if(gData.buffers.begin(), gData.buffers.end(), [](const auto& pBuffer) { return pBuffer.use_count() == 1; }), gData.buffers.end());
+        gData.generation++;
+
         sProfilerEvents.clear();
         sRegisteredEvents.clear();
-        sCurrentLevel = 0;
+        sLastFrameTimes.clear();
         sGpuTimerIndex = 0;
-        curEventName = "";
+
+        // The captured events reference the event hierarchy, so the capture can't continue
+        if (gCapture.state != decltype(gCapture)::State::Idle)
+        {
+            logWarning("Profiler::clearEvents() - aborting the profiler capture");
+            gCapture.events.clear();
+            gCapture.state = decltype(gCapture)::State::Idle;
+            gCapture.cpuFramesLeft = 0;
+        }
     }
 }
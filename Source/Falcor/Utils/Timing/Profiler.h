@@ -41,10 +41,14 @@ namespace Falcor
         This class uses the most accurately available CPU and GPU timers to profile given events. It automatically creates event hierarchies based on the order of the calls made.
         This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
         ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+
+        Event names are interned into EventIds. Starting and ending an event only appends a begin/end record into a fixed-capacity buffer owned by the calling thread,
+        so events can be emitted from any thread. The records are aggregated when the frame ends. GPU time is only measured for events emitted from the main thread.
     */
     class dlldecl Profiler
     {
     public:
+        using EventId = uint32_t;
 
 #if _PROFILING_LOG == 1
         static void flushLog();
@@ -62,7 +66,9 @@ namespace Falcor
         struct EventData
         {
             virtual ~EventData() {}
-            std::string name;
+            std::string name;       // The full event path, in the format `#parent#child`
+            EventId eventId;
+            uint32_t parent;        // The index of the parent event in the event hierarchy
             struct FrameData
             {
                 std::vector<GpuTimer::SharedPtr> pTimers;
@@ -71,8 +77,6 @@ namespace Falcor
             FrameData frameData[2]; // Double-buffering, to avoid GPU flushes
             bool showInMsg;
             std::stack<size_t> callStack;
-            CpuTimer::TimePoint cpuStart;
-            CpuTimer::TimePoint cpuEnd;
             double cpuTotal = 0;
             double cpuRunningAverageMS = -1.f;   // Negative value to signify invalid
             double gpuRunningAverageMS = -1.f;
@@ -87,15 +91,45 @@ namespace Falcor
 #endif
         };
 
+        /** Get the ID of an event name. Returns the same ID for every call with the same name. Thread-safe.
+            Names the calling thread already looked up are found in a thread-local table without locking. Still, prefer to call it once and cache the result (the PROFILE() macro does that).
+        */
+        static EventId registerEvent(const std::string& name);
+
+        /** Get the name of an event ID
+        */
+        static const std::string& getEventName(EventId id);
+
+        /** Start profiling a new event and update the events hierarchies.
+            \param[in] id The event ID, returned from registerEvent().
+        */
+        static void startEvent(EventId id, Flags flags = Flags::Default, bool showInMsg = true);
+
+        /** Finish profiling a new event and update the events hierarchies.
+            \param[in] id The event ID, returned from registerEvent().
+        */
+        static void endEvent(EventId id, Flags flags = Flags::Default);
+
+        /** Get the calling thread's current position in the event hierarchy.
+            Pass the result to setCurrentNode() on a worker thread, so the events the worker emits nest under the event which was open when the work was dispatched.
+        */
+        static uint32_t getCurrentNode();
+
+        /** Set the calling thread's current position in the event hierarchy. The calling thread must not have any open events.
+            \param[in] node A node returned from getCurrentNode().
+            \return The previous node, which should be restored when the thread is done.
+        */
+        static uint32_t setCurrentNode(uint32_t node);
+
         /** Start profiling a new event and update the events hierarchies.
             \param[in] name The event name.
         */
-        static void startEvent(const std::string& name, Flags flags = Flags::Default, bool showInMsg = true);
+        static void startEvent(const std::string& name, Flags flags = Flags::Default, bool showInMsg = true) { startEvent(registerEvent(name), flags, showInMsg); }
 
         /** Finish profiling a new event and update the events hierarchies.
             \param[in] name The event name.
         */
-        static void endEvent(const std::string& name, Flags flags = Flags::Default);
+        static void endEvent(const std::string& name, Flags flags = Flags::Default) { endEvent(registerEvent(name), flags); }
 
         /** Finish profiling for the entire frame.
             Due to the double-buffering nature of the profiler, the results returned are for the previous frame.
@@ -107,30 +141,18 @@ namespace Falcor
         */
         static std::string getEventsString();
 
-        /** Create a new event and register and initialize it using \ref initNewEvent.
-            \param[in] name The event name.
-        */
-        static EventData* createNewEvent(const std::string& name);
-
-        /** Initialize a previously generated event.
-            Used to do the default initialization without creating the actual event instance, to support derived event types. See \ref Cuda::Profiler::EventData.
-            \param[out] pEvent Event to initialize
-            \param[in] name New event name
-        */
-        static void initNewEvent(EventData *pEvent, const std::string& name);
-
-        /** Get the event, or create a new one if the event does not yet exist.
-            This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled region.
+        /** Get an event by its full path.
+            \return The event, or nullptr if the event was never triggered.
         */
         static EventData* getEvent(const std::string& name);
 
-        /** Get the event, or create a new one if the event does not yet exist.
-        This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled region.
+        /** Get the CPU time of an event in the current frame.
+            \param[in] name The full event path.
         */
         static double getEventCpuTime(const std::string& name);
 
-        /** Get the event, or create a new one if the event does not yet exist.
-        This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled region.
+        /** Get the GPU time of an event in the previous frame.
+            \param[in] name The full event path.
         */
         static double getEventGpuTime(const std::string& name);
 
@@ -139,6 +161,33 @@ namespace Falcor
         */
         static EventData* isEventRegistered(const std::string& name);
 
+        /** Start capturing a timeline of every CPU and GPU event. The capture starts with the next frame.
+            CPU events are recorded per thread. GPU events are mapped onto the CPU timeline. Since GPU results are double-buffered, the file is written one frame after the last captured frame ends.
+            The timeline is written as a Chrome Trace Event JSON file, which can be opened with chrome://tracing or https://ui.perfetto.dev.
+            \param[in] filename The output filename
+            \param[in] frameCount Number of frames to capture
+        */
+        static void startCapture(const std::string& filename, uint32_t frameCount);
+
+        /** Check if a capture is pending or in progress
+        */
+        static bool isCapturing();
+
+        /** Get the number of event records dropped because a thread's event buffer was full
+        */
+        static uint64_t getDroppedRecordCount();
+
+        struct FrameEventTime
+        {
+            const EventData* pEvent;
+            double cpuTime;         // In milliseconds
+            double gpuTime;         // In milliseconds. Since the GPU timers are double-buffered, this is the GPU time of the frame before
+        };
+
+        /** Get the times of all the events which were recorded in the last frame that ended. Valid until the next call to endFrame() or clearEvents().
+        */
+        static const std::vector<FrameEventTime>& getLastFrameTimes() { return sLastFrameTimes; }
+
         /** Clears all the events.
             Useful if you want to start profiling a different technique with different events.
         */
@@ -147,10 +196,14 @@ namespace Falcor
     private:
         static double getGpuTime(const EventData* pData);
         static double getCpuTime(const EventData* pData);
+        static void collectEvents();
+        static void captureGpuEvents(const EventData* pData);
+        static void updateCapture();
+        static void writeCapture();
 
         static std::unordered_map<std::string, EventData*> sProfilerEvents;
         static std::vector<EventData*> sRegisteredEvents;
-        static uint32_t sCurrentLevel;
+        static std::vector<FrameEventTime> sLastFrameTimes;
         static uint32_t sGpuTimerIndex;
     };
 
@@ -163,19 +216,28 @@ namespace Falcor
     public:
         /** C'tor
         */
-        ProfilerEvent(const std::string& name, Profiler::Flags flags = Profiler::Flags::Default) : mName(name), mFlags(flags) { if (gProfileEnabled) { Profiler::startEvent(name, flags); } }
+        ProfilerEvent(Profiler::EventId id, Profiler::Flags flags = Profiler::Flags::Default) : mId(id), mFlags(flags), mStarted(gProfileEnabled) { if (mStarted) { Profiler::startEvent(id, flags); } }
+
+        /** C'tor
+        */
+        ProfilerEvent(const std::string& name, Profiler::Flags flags = Profiler::Flags::Default) : ProfilerEvent(Profiler::registerEvent(name), flags) {}
+
         /** D'tor
         */
-        ~ProfilerEvent() { if (gProfileEnabled) { Profiler::endEvent(mName, mFlags); } }
+        ~ProfilerEvent() { if (mStarted) { Profiler::endEvent(mId, mFlags); } }
 
     private:
-        const std::string mName;
+        const Profiler::EventId mId;
         Profiler::Flags mFlags;
+        bool mStarted;
     };
 
 #if _PROFILING_ENABLED
-#define PROFILE_ALL_FLAGS(_name) Falcor::ProfilerEvent _profileEvent##__LINE__(_name)
-#define PROFILE_SOME_FLAGS(_name, _flags) Falcor::ProfilerEvent _profileEvent##__LINE__(_name, _flags)
+// The event name is interned once per call-site
+#define PROFILE_ALL_FLAGS(_name) static const Falcor::Profiler::EventId concat_strings(_profileEventId, __LINE__) = Falcor::Profiler::registerEvent(_name); \
+    Falcor::ProfilerEvent concat_strings(_profileEvent, __LINE__)(concat_strings(_profileEventId, __LINE__))
+#define PROFILE_SOME_FLAGS(_name, _flags) static const Falcor::Profiler::EventId concat_strings(_profileEventId, __LINE__) = Falcor::Profiler::registerEvent(_name); \
+    Falcor::ProfilerEvent concat_strings(_profileEvent, __LINE__)(concat_strings(_profileEventId, __LINE__), _flags)
 
 #define GET_PROFILE(_1, _2, NAME, ...) NAME
 #define PROFILE(...) GET_PROFILE(__VA_ARGS__, PROFILE_SOME_FLAGS, PROFILE_ALL_FLAGS)(__VA_ARGS__)
@@ -31,43 +31,55 @@
 extern "C"
 {
 #include "libavformat/avformat.h"
-#include "libswscale/swscale.h"
 }
 
 namespace Falcor
 {
     namespace
     {
-        AVPixelFormat getPictureFormatFromCodec(AVCodecID codec)
+        /** Get the pixel format of a codec. Returns AV_PIX_FMT_NONE if the codec doesn't support the bit depth
+        */
+        AVPixelFormat getPictureFormatFromCodec(AVCodecID codec, uint32_t bitDepth)
         {
+            const bool tenBit = bitDepth == 10;
             switch (codec)
             {
             case AV_CODEC_ID_RAWVIDEO:
-                return AV_PIX_FMT_BGR24;
+                return tenBit ? AV_PIX_FMT_NONE : AV_PIX_FMT_BGR24;
             case AV_CODEC_ID_H264:
-            case AV_CODEC_ID_HEVC:
             case AV_CODEC_ID_MPEG2VIDEO:
-                return AV_PIX_FMT_YUV422P;
+                return tenBit ? AV_PIX_FMT_NONE : AV_PIX_FMT_YUV422P;
+            case AV_CODEC_ID_HEVC:
+                // Main10 is 4:2:0 only
+                return tenBit ? AV_PIX_FMT_YUV420P10LE : AV_PIX_FMT_YUV422P;
             case AV_CODEC_ID_MPEG4:
-                return AV_PIX_FMT_YUV420P;
+                return tenBit ? AV_PIX_FMT_NONE : AV_PIX_FMT_YUV420P;
+            case AV_CODEC_ID_FFV1:
+                // RGB planes, so lossless capture doesn't go through YUV
+                return tenBit ? AV_PIX_FMT_GBRP10LE : AV_PIX_FMT_GBRP;
             default:
                 should_not_get_here();
                 return AV_PIX_FMT_NONE;
             }
         }
 
-        AVPixelFormat getPictureFormatFromFalcorFormat(ResourceFormat format)
+        VideoFrameConverter::Layout getLayout(AVPixelFormat format)
         {
             switch (format)
             {
-            case ResourceFormat::RGBA8Unorm:
-            case ResourceFormat::RGBA8UnormSrgb:
-                return AV_PIX_FMT_RGBA;
-            case ResourceFormat::BGRA8Unorm:
-            case ResourceFormat::BGRA8UnormSrgb:
-                return AV_PIX_FMT_BGRA;
+            case AV_PIX_FMT_BGR24:
+                return VideoFrameConverter::Layout::BGR;
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUV420P10LE:
+                return VideoFrameConverter::Layout::YUV420;
+            case AV_PIX_FMT_YUV422P:
+                return VideoFrameConverter::Layout::YUV422;
+            case AV_PIX_FMT_GBRP:
+            case AV_PIX_FMT_GBRP10LE:
+                return VideoFrameConverter::Layout::GBR;
             default:
-                return AV_PIX_FMT_NONE;
+                should_not_get_here();
+                return VideoFrameConverter::Layout::YUV420;
             }
         }
 
@@ -85,6 +97,8 @@ namespace Falcor
                 return AV_CODEC_ID_MPEG2VIDEO;
             case VideoEncoder::Codec::MPEG4:
                 return AV_CODEC_ID_MPEG4;
+            case VideoEncoder::Codec::FFV1:
+                return AV_CODEC_ID_FFV1;
             default:
                 should_not_get_here();
                 return AV_CODEC_ID_NONE;
@@ -99,17 +113,27 @@ namespace Falcor
             return false;
         }
 
-        AVCodecContext* createCodecContext(AVFormatContext* pCtx, uint32_t width, uint32_t height, uint32_t fps, float bitrateMbps, uint32_t gopSize, AVCodecID codecID, AVCodec* pCodec)
+        AVCodecContext* createCodecContext(AVFormatContext* pCtx, const VideoEncoder::Desc& desc, AVCodecID codecID, AVCodec* pCodec)
         {
             // Initialize the codec context
             AVCodecContext* pCodecCtx = avcodec_alloc_context3(pCodec);
             pCodecCtx->codec_id = codecID;
-            pCodecCtx->bit_rate = (int)(bitrateMbps * 1000 * 1000);
-            pCodecCtx->width = width;
-            pCodecCtx->height = height;
-            pCodecCtx->time_base = { 1, (int)fps };
-            pCodecCtx->gop_size = gopSize;
-            pCodecCtx->pix_fmt = getPictureFormatFromCodec(codecID);
+            pCodecCtx->bit_rate = (int)(desc.bitrateMbps * 1000 * 1000);
+            pCodecCtx->width = desc.width;
+            pCodecCtx->height = desc.height;
+            pCodecCtx->time_base = { 1, (int)desc.fps };
+            pCodecCtx->gop_size = desc.gopSize;
+            pCodecCtx->pix_fmt = getPictureFormatFromCodec(codecID, desc.bitDepth);
+
+            // Describe the color encoding of VideoFrameConverter
+            const bool pq = desc.transfer == VideoFrameConverter::Transfer::PQ;
+            const auto layout = getLayout(pCodecCtx->pix_fmt);
+            const bool rgb = layout == VideoFrameConverter::Layout::GBR || layout == VideoFrameConverter::Layout::BGR;
+            pCodecCtx->color_primaries = pq ? AVCOL_PRI_BT2020 : AVCOL_PRI_BT709;
+            pCodecCtx->color_trc = pq ? AVCOL_TRC_SMPTE2084 : AVCOL_TRC_IEC61966_2_1;
+            pCodecCtx->colorspace = rgb ? AVCOL_SPC_RGB : (pq ? AVCOL_SPC_BT2020_NCL : AVCOL_SPC_BT709);
+            pCodecCtx->color_range = rgb ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG;
+            if (layout == VideoFrameConverter::Layout::YUV420 || layout == VideoFrameConverter::Layout::YUV422) pCodecCtx->chroma_sample_location = AVCHROMA_LOC_CENTER;
 
             // Some formats want stream headers to be separate
             if (pCtx->oformat->flags & AVFMT_GLOBALHEADER)
@@ -181,6 +205,14 @@ namespace Falcor
                 */
                 av_dict_set(&param, "preset", "veryslow", 0);
             }
+            else if (pCodecCtx->codec_id == AV_CODEC_ID_FFV1)
+            {
+                // Version 3 supports slices, which are encoded in parallel and checksummed
+                av_dict_set(&param, "level", "3", 0);
+                av_dict_set(&param, "slices", "16", 0);
+                av_dict_set(&param, "slicecrc", "1", 0);
+                av_dict_set(&param, "threads", "auto", 0);
+            }
 
             // Open the codec
             if (avcodec_open2(pCodecCtx, pCodec, &param) < 0)
@@ -226,11 +258,36 @@ namespace Falcor
 
     bool VideoEncoder::isFormatSupported(ResourceFormat format)
     {
-        return getPictureFormatFromFalcorFormat(format) != AV_PIX_FMT_NONE;
+        return VideoFrameConverter::isFormatSupported(format);
     }
 
     bool VideoEncoder::init(const Desc& desc)
     {
+        if (desc.bitDepth != 8 && desc.bitDepth != 10)
+        {
+            return error(mFilename, "The bit depth must be 8 or 10.");
+        }
+        const AVPixelFormat pixelFormat = getPictureFormatFromCodec(getCodecID(desc.codec), desc.bitDepth);
+        if (pixelFormat == AV_PIX_FMT_NONE)
+        {
+            return error(mFilename, to_string(desc.codec) + " doesn't support " + std::to_string(desc.bitDepth) + "-bit encoding. Use HEVC or FFV1.");
+        }
+
+        VideoFrameConverter::Desc converterDesc;
+        converterDesc.width = desc.width;
+        converterDesc.height = desc.height;
+        converterDesc.format = desc.format;
+        converterDesc.flipY = desc.flipY;
+        converterDesc.transfer = desc.transfer;
+        converterDesc.pqWhiteNits = desc.pqWhiteNits;
+        converterDesc.layout = getLayout(pixelFormat);
+        converterDesc.bitDepth = desc.bitDepth;
+        mpConverter = VideoFrameConverter::create(converterDesc);
+        if (mpConverter == nullptr)
+        {
+            return error(mFilename, "Can't convert " + to_string(desc.format) + " frames.");
+        }
+
         // av_register_all() is deprecated since 58.9.100, but Linux repos may not get a newer version, so this call cannot be completely removed.
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(58, 9, 100)
         av_register_all();
@@ -255,7 +312,7 @@ namespace Falcor
             return false;
         }
 
-        mpCodecContext = createCodecContext(mpOutputContext, desc.width, desc.height, desc.fps, desc.bitrateMbps, desc.gopSize, getCodecID(desc.codec), pVideoCodec);
+        mpCodecContext = createCodecContext(mpOutputContext, desc, getCodecID(desc.codec), pVideoCodec);
         if(mpCodecContext == nullptr)
         {
             return false;
@@ -287,20 +344,6 @@ namespace Falcor
         {
             return error(mFilename, "Can't write file header.");
         }
-
-        mFormat = desc.format;
-        mRowPitch = getFormatBytesPerBlock(desc.format) * desc.width;
-        if(desc.flipY)
-        {
-            mpFlippedImage = new uint8_t[desc.height * mRowPitch];
-        }
-
-        assert(isFormatSupported(desc.format));
-        mpSwsContext = sws_getContext(desc.width, desc.height, getPictureFormatFromFalcorFormat(desc.format), desc.width, desc.height, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
-        if(mpSwsContext == nullptr)
-        {
-            return error(mFilename, "Failed to allocate SWScale context");
-        }
         return true;
     }
 
@@ -350,36 +393,24 @@ namespace Falcor
             avio_closep(&mpOutputContext->pb);
             avcodec_free_context(&mpCodecContext);
             av_frame_free(&mpFrame);
-            sws_freeContext(mpSwsContext);
             avformat_free_context(mpOutputContext);
             mpOutputContext = nullptr;
             mpOutputStream = nullptr;
         }
-        safe_delete(mpFlippedImage)
+        mpConverter = nullptr;
     }
 
     void VideoEncoder::appendFrame(const void* pData)
     {
-        if(mpFlippedImage)
+        // The codec may still hold a reference to the previous frame's buffers
+        if(av_frame_make_writable(mpFrame) < 0)
         {
-            // Flip the image
-            for(int32_t h = 0; h < mpCodecContext->height; h++)
-            {
-                const uint8_t* pSrc = (uint8_t*)pData + h * mRowPitch;
-                uint8_t* pDst = mpFlippedImage + (mpCodecContext->height - 1 - h) * mRowPitch;
-                memcpy(pDst, pSrc, mRowPitch);
-            }
-
-            pData = mpFlippedImage;
+            error(mFilename, "Can't make the video frame writable");
+            return;
         }
 
-        uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
-        int32_t rowPitch[AV_NUM_DATA_POINTERS] = {0};
-        src[0] = (uint8_t*)pData;
-        rowPitch[0] = (int32_t)mRowPitch;
-
-        // Scale and convert the image
-        sws_scale(mpSwsContext, src, rowPitch, 0, mpCodecContext->height, mpFrame->data, mpFrame->linesize);
+        // Convert the image
+        mpConverter->convert(pData, mpFrame->data, mpFrame->linesize);
 
         // Encode the frame
         int r = avcodec_send_frame(mpCodecContext, mpFrame);
@@ -421,6 +452,10 @@ namespace Falcor
             filters.push_back(MP4);
             filters.push_back(MKV);
             break;
+        case VideoEncoder::Codec::FFV1:
+            filters.push_back(MKV);
+            filters.push_back(AVI);
+            break;
         default:
             should_not_get_here();
         }
@@ -430,6 +465,10 @@ namespace Falcor
     SCRIPT_BINDING(VideoEncoder)
     {
         auto codec = m.enum_<VideoEncoder::Codec>("Codec").regEnumVal(VideoEncoder::Codec::Raw).regEnumVal(VideoEncoder::Codec::MPEG4).regEnumVal(VideoEncoder::Codec::MPEG2);
-        codec.regEnumVal(VideoEncoder::Codec::H264).regEnumVal(VideoEncoder::Codec::HEVC);
+        codec.regEnumVal(VideoEncoder::Codec::H264).regEnumVal(VideoEncoder::Codec::HEVC).regEnumVal(VideoEncoder::Codec::FFV1);
+
+        // Saved scripts name the enum after the C++ type (see Scripting::getArgString()), so it's bound under the same name
+        auto transfer = m.enum_<VideoFrameConverter::Transfer>("Transfer");
+        transfer.regEnumVal(VideoFrameConverter::Transfer::sRGB).regEnumVal(VideoFrameConverter::Transfer::Reinhard).regEnumVal(VideoFrameConverter::Transfer::PQ);
     }
 }
@@ -26,11 +26,11 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include "VideoFrameConverter.h"
 
 struct AVFormatContext;
 struct AVStream;
 struct AVFrame;
-struct SwsContext;
 struct AVCodecContext;
 
 namespace Falcor
@@ -48,6 +48,7 @@ namespace Falcor
             HEVC,
             MPEG2,
             MPEG4,
+            FFV1,       ///< Lossless, stores RGB planes
         };
 
         struct Desc
@@ -60,6 +61,9 @@ namespace Falcor
             Codec codec = Codec::Raw;
             ResourceFormat format = ResourceFormat::BGRA8UnormSrgb;
             bool flipY = false;
+            uint32_t bitDepth = 8;                                                          ///< 8 or 10. 10 bits is supported by HEVC (Main10) and FFV1
+            VideoFrameConverter::Transfer transfer = VideoFrameConverter::Transfer::sRGB;   ///< Encoding of float formats
+            float pqWhiteNits = 203.f;                                                      ///< Luminance of 1.0 with the PQ transfer
             std::string filename;
         };
 
@@ -78,13 +82,10 @@ namespace Falcor
         AVFormatContext* mpOutputContext = nullptr;
         AVStream*        mpOutputStream  = nullptr;
         AVFrame*         mpFrame         = nullptr;
-        SwsContext*      mpSwsContext    = nullptr;
         AVCodecContext*  mpCodecContext = nullptr;
 
         const std::string mFilename;
-        ResourceFormat mFormat;
-        uint32_t mRowPitch = 0;
-        uint8_t* mpFlippedImage = nullptr; // Used in case the image memory layout if bottom->top
+        VideoFrameConverter::UniquePtr mpConverter;     // Converts the frames into the codec's pixel format. Also flips them if needed
     };
 
     inline std::string to_string(VideoEncoder::Codec c)
@@ -97,6 +98,7 @@ namespace Falcor
             c2s(HEVC);
             c2s(MPEG2);
             c2s(MPEG4);
+            c2s(FFV1);
         default:
             should_not_get_here();
             return "";
@@ -37,7 +37,21 @@ namespace Falcor
         { (uint32_t)VideoEncoder::Codec::H264, std::string("H.264") },
         { (uint32_t)VideoEncoder::Codec::HEVC, std::string("HEVC(H.265)") },
         { (uint32_t)VideoEncoder::Codec::MPEG2, std::string("MPEG2") },
-        { (uint32_t)VideoEncoder::Codec::MPEG4, std::string("MPEG4") }
+        { (uint32_t)VideoEncoder::Codec::MPEG4, std::string("MPEG4") },
+        { (uint32_t)VideoEncoder::Codec::FFV1, std::string("FFV1 (lossless)") }
+    };
+
+    static const Gui::DropdownList kBitDepth =
+    {
+        { 8, std::string("8 bits") },
+        { 10, std::string("10 bits") }
+    };
+
+    static const Gui::DropdownList kTransfer =
+    {
+        { (uint32_t)VideoFrameConverter::Transfer::sRGB, std::string("sRGB") },
+        { (uint32_t)VideoFrameConverter::Transfer::Reinhard, std::string("Reinhard (tone mapped)") },
+        { (uint32_t)VideoFrameConverter::Transfer::PQ, std::string("PQ (HDR10)") }
     };
 
     VideoEncoderUI::UniquePtr VideoEncoderUI::create(Callback startCaptureCB, Callback endCaptureCB)
@@ -65,6 +79,11 @@ namespace Falcor
             g.var("Video FPS", mFPS, 0u, 240u, 1);
             g.var("Bitrate (Mbps)", mBitrate, 0.f, FLT_MAX, 0.01f);
             g.var("GOP Size", mGopSize, 0u, 100000u, 1);
+            g.dropdown("Bit Depth", kBitDepth, mBitDepth);
+            g.tooltip("10 bits is supported by HEVC (Main10) and FFV1");
+            g.dropdown("Transfer", kTransfer, (uint32_t&)mTransfer);
+            g.tooltip("How linear frames are encoded. Only applies to floating-point frames, except for PQ");
+            if (mTransfer == VideoFrameConverter::Transfer::PQ) g.var("PQ White (nits)", mPqWhiteNits, 1.f, 10000.f, 1.f);
         }
 
         if (codecOnly) return;
@@ -50,11 +50,17 @@ namespace Falcor
         uint32_t getFPS() const { return mFPS; }
         float getBitrate() const { return mBitrate; }
         uint32_t getGopSize() const { return mGopSize; }
+        uint32_t getBitDepth() const { return mBitDepth; }
+        VideoFrameConverter::Transfer getTransfer() const { return mTransfer; }
+        float getPqWhiteNits() const { return mPqWhiteNits; }
 
         VideoEncoderUI& setCodec(VideoEncoder::Codec c) { mCodec = c; return *this; }
         VideoEncoderUI& setFPS(uint32_t fps) { mFPS = fps; return *this; }
         VideoEncoderUI& setBitrate(float bitrate) { mBitrate = bitrate; return *this; }
         VideoEncoderUI& setGopSize(uint32_t gopSize) { mGopSize = gopSize; return *this; }
+        VideoEncoderUI& setBitDepth(uint32_t bitDepth) { mBitDepth = bitDepth; return *this; }
+        VideoEncoderUI& setTransfer(VideoFrameConverter::Transfer transfer) { mTransfer = transfer; return *this; }
+        VideoEncoderUI& setPqWhiteNits(float nits) { mPqWhiteNits = nits; return *this; }
 
         bool useTimeRange() const { return mUseTimeRange; }
         bool captureUI() const { return mCaptureUI; }
@@ -85,5 +91,8 @@ namespace Falcor
         std::string mFilename;
         float mBitrate = 4;
         uint32_t mGopSize = 10;
+        uint32_t mBitDepth = 8;
+        VideoFrameConverter::Transfer mTransfer = VideoFrameConverter::Transfer::sRGB;
+        float mPqWhiteNits = 203.f;
     };
 }
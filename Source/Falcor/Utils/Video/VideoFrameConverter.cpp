@@ -0,0 +1,468 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "VideoFrameConverter.h"
+#include "Utils/Threading.h"
+#include "Data/HostDeviceData.h"
+#include "glm/gtc/packing.hpp"
+#include <emmintrin.h>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kRowsPerJob = 16;
+
+        // SMPTE ST 2084
+        const float kPqM1 = 2610.f / 16384.f;
+        const float kPqM2 = 2523.f / 4096.f * 128.f;
+        const float kPqC1 = 3424.f / 4096.f;
+        const float kPqC2 = 2413.f / 4096.f * 32.f;
+        const float kPqC3 = 2392.f / 4096.f * 32.f;
+        const float kPqMaxNits = 10000.f;
+
+        // BT.709 to BT.2020 primaries, from BT.2087. Row major
+        const float kRec709ToRec2020[3][3] =
+        {
+            { 0.627403896f, 0.329283039f, 0.043313065f },
+            { 0.069097289f, 0.919540395f, 0.011362316f },
+            { 0.016391439f, 0.088013308f, 0.895595253f },
+        };
+
+        struct YuvCoefficients
+        {
+            float kr;
+            float kb;
+        };
+        const YuvCoefficients kBT709 = { 0.2126f, 0.0722f };
+        const YuvCoefficients kBT2020 = { 0.2627f, 0.0593f };
+
+        float encodePq(float y)
+        {
+            float p = std::pow(glm::clamp(y, 0.f, 1.f), kPqM1);
+            return std::pow((kPqC1 + kPqC2 * p) / (1.f + kPqC3 * p), kPqM2);
+        }
+
+        void convertToRec2020(float* pR, float* pG, float* pB, uint32_t count)
+        {
+            const auto& m = kRec709ToRec2020;
+            uint32_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 r = _mm_loadu_ps(pR + i);
+                __m128 g = _mm_loadu_ps(pG + i);
+                __m128 b = _mm_loadu_ps(pB + i);
+                auto row = [&](const float* c) { return _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(c[0])), _mm_mul_ps(g, _mm_set1_ps(c[1]))), _mm_mul_ps(b, _mm_set1_ps(c[2]))); };
+                _mm_storeu_ps(pR + i, row(m[0]));
+                _mm_storeu_ps(pG + i, row(m[1]));
+                _mm_storeu_ps(pB + i, row(m[2]));
+            }
+            for (; i < count; i++)
+            {
+                float r = pR[i], g = pG[i], b = pB[i];
+                pR[i] = m[0][0] * r + m[0][1] * g + m[0][2] * b;
+                pG[i] = m[1][0] * r + m[1][1] * g + m[1][2] * b;
+                pB[i] = m[2][0] * r + m[2][1] * g + m[2][2] * b;
+            }
+        }
+
+        void rgbToYCbCr(const float* pR, const float* pG, const float* pB, uint32_t count, const YuvCoefficients& k, float* pY, float* pCb, float* pCr)
+        {
+            const float kg = 1.f - k.kr - k.kb;
+            const float cbScale = 0.5f / (1.f - k.kb);
+            const float crScale = 0.5f / (1.f - k.kr);
+            const __m128 vkr = _mm_set1_ps(k.kr), vkg = _mm_set1_ps(kg), vkb = _mm_set1_ps(k.kb);
+            const __m128 vcb = _mm_set1_ps(cbScale), vcr = _mm_set1_ps(crScale);
+            uint32_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 r = _mm_loadu_ps(pR + i);
+                __m128 b = _mm_loadu_ps(pB + i);
+                __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, vkr), _mm_mul_ps(_mm_loadu_ps(pG + i), vkg)), _mm_mul_ps(b, vkb));
+                _mm_storeu_ps(pY + i, y);
+                _mm_storeu_ps(pCb + i, _mm_mul_ps(_mm_sub_ps(b, y), vcb));
+                _mm_storeu_ps(pCr + i, _mm_mul_ps(_mm_sub_ps(r, y), vcr));
+            }
+            for (; i < count; i++)
+            {
+                float y = k.kr * pR[i] + kg * pG[i] + k.kb * pB[i];
+                pY[i] = y;
+                pCb[i] = (pB[i] - y) * cbScale;
+                pCr[i] = (pR[i] - y) * crScale;
+            }
+        }
+
+        /** Average a row into another, for vertical chroma subsampling
+        */
+        void averageRows(float* pDst, const float* pSrc, uint32_t count)
+        {
+            const __m128 half = _mm_set1_ps(0.5f);
+            uint32_t i = 0;
+            for (; i + 4 <= count; i += 4) _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(pDst + i), _mm_loadu_ps(pSrc + i)), half));
+            for (; i < count; i++) pDst[i] = 0.5f * (pDst[i] + pSrc[i]);
+        }
+
+        /** Average pairs of horizontally adjacent samples. The last sample of odd-width rows is kept as is
+        */
+        void downsampleRow(const float* pSrc, uint32_t width, float* pDst)
+        {
+            const __m128 half = _mm_set1_ps(0.5f);
+            const uint32_t count = width / 2;
+            uint32_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 a = _mm_loadu_ps(pSrc + 2 * i);
+                __m128 b = _mm_loadu_ps(pSrc + 2 * i + 4);
+                __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_add_ps(even, odd), half));
+            }
+            for (; i < count; i++) pDst[i] = 0.5f * (pSrc[2 * i] + pSrc[2 * i + 1]);
+            if (width & 1) pDst[count] = pSrc[width - 1];
+        }
+
+        /** Scale, offset, clamp to [0, maxCode] and round a row of samples into 8-bit or 16-bit words
+        */
+        void quantizeRow(const float* pSrc, uint32_t count, float scale, float offset, float maxCode, bool wide, uint8_t* pDst)
+        {
+            const __m128 s = _mm_set1_ps(scale), o = _mm_set1_ps(offset), lo = _mm_setzero_ps(), hi = _mm_set1_ps(maxCode);
+            uint32_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 v = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pSrc + i), s), o), lo), hi);
+                __m128i q = _mm_cvtps_epi32(v);
+                q = _mm_packs_epi32(q, q);
+                if (wide) _mm_storel_epi64((__m128i*)(pDst + 2 * i), q);
+                else
+                {
+                    int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(q, q));
+                    std::memcpy(pDst + i, &packed, sizeof(packed));
+                }
+            }
+            for (; i < count; i++)
+            {
+                // Round to nearest even, like the SSE conversion
+                uint32_t q = (uint32_t)std::nearbyint(glm::clamp(pSrc[i] * scale + offset, 0.f, maxCode));
+                if (wide) ((uint16_t*)pDst)[i] = (uint16_t)q;
+                else pDst[i] = (uint8_t)q;
+            }
+        }
+    }
+
+    bool VideoFrameConverter::isFormatSupported(ResourceFormat format)
+    {
+        switch (format)
+        {
+        case ResourceFormat::RGBA8Unorm:
+        case ResourceFormat::RGBA8UnormSrgb:
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRA8UnormSrgb:
+        case ResourceFormat::RGBA16Float:
+        case ResourceFormat::RGBA32Float:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    VideoFrameConverter::UniquePtr VideoFrameConverter::create(const Desc& desc)
+    {
+        if (!isFormatSupported(desc.format))
+        {
+            logError("VideoFrameConverter::create() - Unsupported format " + to_string(desc.format));
+            return nullptr;
+        }
+        if (desc.bitDepth != 8 && desc.bitDepth != 10)
+        {
+            logError("VideoFrameConverter::create() - The bit depth must be 8 or 10");
+            return nullptr;
+        }
+        if (desc.layout == Layout::BGR && desc.bitDepth != 8)
+        {
+            logError("VideoFrameConverter::create() - The BGR layout only supports 8 bits");
+            return nullptr;
+        }
+        if (desc.width == 0 || desc.height == 0)
+        {
+            logError("VideoFrameConverter::create() - The frame size can't be zero");
+            return nullptr;
+        }
+        return UniquePtr(new VideoFrameConverter(desc));
+    }
+
+    VideoFrameConverter::VideoFrameConverter(const Desc& desc) : mDesc(desc)
+    {
+        mSrcPitch = getFormatBytesPerBlock(desc.format) * desc.width;
+
+        // With PQ the tables hold linear values relative to 10000 nits. The primaries are converted and the curve applied afterwards
+        const bool pq = desc.transfer == Transfer::PQ;
+        const float pqScale = desc.pqWhiteNits / kPqMaxNits;
+        auto encode = [&](float x)
+        {
+            if (std::isnan(x) || x < 0.f) x = 0.f;
+            switch (desc.transfer)
+            {
+            case Transfer::sRGB:
+                return linearToSRGB(std::min(x, 1.f));
+            case Transfer::Reinhard:
+                return std::isinf(x) ? 1.f : linearToSRGB(x / (1.f + x));
+            case Transfer::PQ:
+                return x * pqScale;
+            default:
+                should_not_get_here();
+                return 0.f;
+            }
+        };
+
+        switch (desc.format)
+        {
+        case ResourceFormat::RGBA16Float:
+            mLutHalf.resize(1 << 16);
+            for (uint32_t i = 0; i < mLutHalf.size(); i++) mLutHalf[i] = encode(glm::unpackHalf1x16((uint16_t)i));
+            break;
+        case ResourceFormat::RGBA32Float:
+            mLutFloat.init(encode);
+            break;
+        default:
+            mLut8.resize(256);
+            for (uint32_t i = 0; i < mLut8.size(); i++) mLut8[i] = pq ? encode(sRGBToLinear(i / 255.f)) : i / 255.f;
+        }
+
+        if (pq) mLutPq.init(encodePq);
+    }
+
+    void VideoFrameConverter::FloatLut::init(const std::function<float(float)>& func)
+    {
+        values.resize(((kMaxExponent - kMinExponent) << 10) + 1);
+        for (uint32_t i = 0; i < values.size(); i++)
+        {
+            uint32_t bits = (i + (kMinExponent << 10)) << 13;
+            float x;
+            std::memcpy(&x, &bits, sizeof(x));
+            values[i] = func(i == 0 ? 0.f : x);
+        }
+    }
+
+    void VideoFrameConverter::FloatLut::lookup(float* pData, uint32_t count) const
+    {
+        // Clamping also maps NaN to the first entry. The index rounds to the nearest entry
+        const float minValue = std::ldexp(1.f, (int)kMinExponent - 127);
+        const float maxValue = std::ldexp(1.f, (int)kMaxExponent - 127);
+        const __m128 lo = _mm_set1_ps(minValue), hi = _mm_set1_ps(maxValue);
+        const __m128i bias = _mm_set1_epi32((int32_t)(kMinExponent << 23) - (1 << 12));
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pData + i), lo), hi);
+            __m128i index = _mm_srli_epi32(_mm_sub_epi32(_mm_castps_si128(x), bias), 13);
+            alignas(16) uint32_t indices[4];
+            _mm_store_si128((__m128i*)indices, index);
+            for (uint32_t j = 0; j < 4; j++) pData[i + j] = values[std::min(indices[j], (uint32_t)values.size() - 1)];
+        }
+        for (; i < count; i++)
+        {
+            float x = std::isnan(pData[i]) ? minValue : glm::clamp(pData[i], minValue, maxValue);
+            uint32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            pData[i] = values[std::min((bits - ((kMinExponent << 23) - (1 << 12))) >> 13, (uint32_t)values.size() - 1)];
+        }
+    }
+
+    void VideoFrameConverter::decodeRow(const uint8_t* pSrc, float* pR, float* pG, float* pB) const
+    {
+        const uint32_t width = mDesc.width;
+        switch (mDesc.format)
+        {
+        case ResourceFormat::RGBA8Unorm:
+        case ResourceFormat::RGBA8UnormSrgb:
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRA8UnormSrgb:
+        {
+            const bool bgra = mDesc.format == ResourceFormat::BGRA8Unorm || mDesc.format == ResourceFormat::BGRA8UnormSrgb;
+            const uint32_t r = bgra ? 2 : 0;
+            const uint32_t b = bgra ? 0 : 2;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t* p = pSrc + x * 4;
+                pR[x] = mLut8[p[r]];
+                pG[x] = mLut8[p[1]];
+                pB[x] = mLut8[p[b]];
+            }
+            break;
+        }
+        case ResourceFormat::RGBA16Float:
+        {
+            const uint16_t* p = (const uint16_t*)pSrc;
+            for (uint32_t x = 0; x < width; x++, p += 4)
+            {
+                pR[x] = mLutHalf[p[0]];
+                pG[x] = mLutHalf[p[1]];
+                pB[x] = mLutHalf[p[2]];
+            }
+            break;
+        }
+        case ResourceFormat::RGBA32Float:
+        {
+            const float* p = (const float*)pSrc;
+            for (uint32_t x = 0; x < width; x++, p += 4)
+            {
+                pR[x] = p[0];
+                pG[x] = p[1];
+                pB[x] = p[2];
+            }
+            mLutFloat.lookup(pR, width);
+            mLutFloat.lookup(pG, width);
+            mLutFloat.lookup(pB, width);
+            break;
+        }
+        default:
+            should_not_get_here();
+        }
+
+        if (mDesc.transfer == Transfer::PQ)
+        {
+            convertToRec2020(pR, pG, pB, width);
+            mLutPq.lookup(pR, width);
+            mLutPq.lookup(pG, width);
+            mLutPq.lookup(pB, width);
+        }
+    }
+
+    void VideoFrameConverter::convertRows(const uint8_t* pSrc, uint8_t* const pDst[3], const int32_t dstPitch[3], uint32_t firstRow, uint32_t lastRow) const
+    {
+        const uint32_t width = mDesc.width;
+        const uint32_t chromaWidth = mDesc.layout == Layout::YUV444 ? width : (width + 1) / 2;
+        const bool wide = mDesc.bitDepth > 8;
+        const float maxCode = (float)((1 << mDesc.bitDepth) - 1);
+        const float unit = (float)(1 << (mDesc.bitDepth - 8));
+        const bool fullRange = mDesc.fullRange;
+        const float yScale = fullRange ? maxCode : 219.f * unit;
+        const float yOffset = fullRange ? 0.f : 16.f * unit;
+        const float cScale = fullRange ? maxCode : 224.f * unit;
+        const float cOffset = 128.f * unit;
+        const YuvCoefficients& k = mDesc.transfer == Transfer::PQ ? kBT2020 : kBT709;
+
+        // convert() calls this for every pair of rows, so the scratch rows are reused by the thread
+        thread_local std::vector<float> scratch;
+        scratch.resize(width * 8);
+        float* pR = scratch.data();
+        float* pG = pR + width;
+        float* pB = pG + width;
+        float* pY = pB + width;
+        float* pCb = pY + width;
+        float* pCr = pCb + width;
+        float* pCb1 = pCr + width;
+        float* pCr1 = pCb1 + width;
+
+        auto loadRow = [&](uint32_t y) { decodeRow(pSrc + (mDesc.flipY ? mDesc.height - 1 - y : y) * mSrcPitch, pR, pG, pB); };
+        auto dstRow = [&](uint32_t plane, uint32_t y) { return pDst[plane] + (size_t)y * dstPitch[plane]; };
+        auto storeLuma = [&](uint32_t y) { quantizeRow(pY, width, yScale, yOffset, maxCode, wide, dstRow(0, y)); };
+        auto storeChroma = [&](const float* pC, uint32_t plane, uint32_t y) { quantizeRow(pC, chromaWidth, cScale, cOffset, maxCode, wide, dstRow(plane, y)); };
+
+        switch (mDesc.layout)
+        {
+        case Layout::BGR:
+            for (uint32_t y = firstRow; y < lastRow; y++)
+            {
+                loadRow(y);
+                uint8_t* p = dstRow(0, y);
+                for (uint32_t x = 0; x < width; x++, p += 3)
+                {
+                    p[0] = (uint8_t)(glm::clamp(pB[x], 0.f, 1.f) * 255.f + 0.5f);
+                    p[1] = (uint8_t)(glm::clamp(pG[x], 0.f, 1.f) * 255.f + 0.5f);
+                    p[2] = (uint8_t)(glm::clamp(pR[x], 0.f, 1.f) * 255.f + 0.5f);
+                }
+            }
+            break;
+        case Layout::GBR:
+            for (uint32_t y = firstRow; y < lastRow; y++)
+            {
+                loadRow(y);
+                quantizeRow(pG, width, maxCode, 0.f, maxCode, wide, dstRow(0, y));
+                quantizeRow(pB, width, maxCode, 0.f, maxCode, wide, dstRow(1, y));
+                quantizeRow(pR, width, maxCode, 0.f, maxCode, wide, dstRow(2, y));
+            }
+            break;
+        case Layout::YUV444:
+            for (uint32_t y = firstRow; y < lastRow; y++)
+            {
+                loadRow(y);
+                rgbToYCbCr(pR, pG, pB, width, k, pY, pCb, pCr);
+                storeLuma(y);
+                storeChroma(pCb, 1, y);
+                storeChroma(pCr, 2, y);
+            }
+            break;
+        case Layout::YUV422:
+            for (uint32_t y = firstRow; y < lastRow; y++)
+            {
+                loadRow(y);
+                rgbToYCbCr(pR, pG, pB, width, k, pY, pCb, pCr);
+                storeLuma(y);
+                downsampleRow(pCb, width, pR);
+                storeChroma(pR, 1, y);
+                downsampleRow(pCr, width, pR);
+                storeChroma(pR, 2, y);
+            }
+            break;
+        case Layout::YUV420:
+            for (uint32_t y = firstRow; y < lastRow; y += 2)
+            {
+                loadRow(y);
+                rgbToYCbCr(pR, pG, pB, width, k, pY, pCb, pCr);
+                storeLuma(y);
+                // The last row of odd-height frames is its own pair
+                if (y + 1 < lastRow)
+                {
+                    loadRow(y + 1);
+                    rgbToYCbCr(pR, pG, pB, width, k, pY, pCb1, pCr1);
+                    storeLuma(y + 1);
+                    averageRows(pCb, pCb1, width);
+                    averageRows(pCr, pCr1, width);
+                }
+                downsampleRow(pCb, width, pR);
+                storeChroma(pR, 1, y / 2);
+                downsampleRow(pCr, width, pR);
+                storeChroma(pR, 2, y / 2);
+            }
+            break;
+        default:
+            should_not_get_here();
+        }
+    }
+
+    void VideoFrameConverter::convert(const void* pSrc, uint8_t* const pDst[3], const int32_t dstPitch[3]) const
+    {
+        const uint32_t height = mDesc.height;
+        // Rows are converted in pairs, which 4:2:0 chroma averages
+        Threading::parallelFor(div_round_up(height, 2u), [&](uint32_t pair)
+        {
+            convertRows((const uint8_t*)pSrc, pDst, dstPitch, pair * 2, std::min(height, pair * 2 + 2));
+        }, kRowsPerJob / 2);
+    }
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+
+namespace Falcor
+{
+    /** Converts frames read back from the GPU into the planar pixel formats consumed by the video codecs.
+        The transfer function is applied per channel through lookup tables indexed by the 8-bit or half-float texel values.
+        Color conversion and quantization are vectorized with SSE and the rows are converted on the thread pool.
+        Chroma is box-filtered when subsampled.
+    */
+    class dlldecl VideoFrameConverter
+    {
+    public:
+        using UniquePtr = std::unique_ptr<VideoFrameConverter>;
+
+        /** Encoding of the linear values of float formats. 8-bit formats are assumed to hold sRGB-encoded values
+        */
+        enum class Transfer
+        {
+            sRGB,       ///< Clamp to [0, 1] and apply the sRGB curve
+            Reinhard,   ///< Tone map with x / (1 + x) per channel, then apply the sRGB curve
+            PQ,         ///< SMPTE ST 2084 with BT.2020 primaries, for HDR10. 1.0 maps to Desc::pqWhiteNits
+        };
+
+        enum class Layout
+        {
+            YUV420,     ///< Planar Y, Cb, Cr with chroma subsampled in both directions
+            YUV422,     ///< Planar Y, Cb, Cr with chroma subsampled horizontally
+            YUV444,     ///< Planar Y, Cb, Cr
+            GBR,        ///< Planar G, B, R, in the order of FFmpeg's GBRP formats
+            BGR,        ///< Packed 8-bit B, G, R
+        };
+
+        struct Desc
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            ResourceFormat format = ResourceFormat::BGRA8UnormSrgb;     ///< Format of the source frames
+            bool flipY = false;                                         ///< Whether the source rows are stored bottom to top
+            Transfer transfer = Transfer::sRGB;
+            float pqWhiteNits = 203.f;                                  ///< Luminance of 1.0 with the PQ transfer. The default is the BT.2408 reference white
+            Layout layout = Layout::YUV420;
+            uint32_t bitDepth = 8;                                      ///< 8 or 10. Samples wider than 8 bits are stored in 16-bit words
+            bool fullRange = false;                                     ///< Use the full code range for YUV instead of the studio range. RGB layouts always use the full range
+        };
+
+        static bool isFormatSupported(ResourceFormat format);
+
+        /** Create a converter
+            \param[in] desc The conversion description
+            \return A new object, or nullptr if the description is invalid
+        */
+        static UniquePtr create(const Desc& desc);
+
+        /** Convert a frame
+            \param[in] pSrc The source frame, with tightly packed rows
+            \param[in] pDst Destination planes. Only the first plane is used with the BGR layout
+            \param[in] dstPitch Row pitch of each destination plane in bytes
+        */
+        void convert(const void* pSrc, uint8_t* const pDst[3], const int32_t dstPitch[3]) const;
+
+        const Desc& getDesc() const { return mDesc; }
+
+    private:
+        VideoFrameConverter(const Desc& desc);
+        void decodeRow(const uint8_t* pSrc, float* pR, float* pG, float* pB) const;
+        void convertRows(const uint8_t* pSrc, uint8_t* const pDst[3], const int32_t dstPitch[3], uint32_t firstRow, uint32_t lastRow) const;
+
+        /** Table of a function of x >= 0, indexed by the upper bits of x. It keeps 10 bits of mantissa like a half float, over a wider range
+        */
+        struct FloatLut
+        {
+            static const uint32_t kMinExponent = 127 - 24;  ///< Values below 2^-24 read the first entry
+            static const uint32_t kMaxExponent = 127 + 16;  ///< Values from 2^16 up read the last entry
+
+            std::vector<float> values;
+
+            void init(const std::function<float(float)>& func);
+            void lookup(float* pData, uint32_t count) const;
+        };
+
+        Desc mDesc;
+        uint32_t mSrcPitch = 0;
+        std::vector<float> mLut8;       // Values of 8-bit channels. Encoded values, or scaled linear values with PQ
+        std::vector<float> mLutHalf;    // Values of half-float channels, indexed by their bits. Encoded values, or scaled linear values with PQ
+        FloatLut mLutFloat;             // Values of float channels. Encoded values, or scaled linear values with PQ
+        FloatLut mLutPq;                // PQ curve of the luminance relative to 10000 nits
+    };
+
+    inline std::string to_string(VideoFrameConverter::Transfer t)
+    {
+#define t2s(t_) case VideoFrameConverter::Transfer::t_: return #t_
+        switch (t)
+        {
+            t2s(sRGB);
+            t2s(Reinhard);
+            t2s(PQ);
+        default:
+            should_not_get_here();
+            return "";
+        }
+#undef t2s
+    }
+}
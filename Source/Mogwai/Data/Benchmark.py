@@ -0,0 +1,14 @@
+# Renders the Arcade scene with the forward renderer and writes frame-time statistics
+# Run with `Mogwai.exe -script Data/Benchmark.py`. Pass the results of a previous run as `baselineFile` to check for regressions
+
+# Scene
+m.loadScene("Arcade/Arcade.fscene")
+
+# Graphs
+m.script("Data/ForwardRenderer.py")
+
+# Window Configuration
+m.resizeSwapChain(1920, 1080)
+
+# Benchmark
+bm.run(warmupFrames=60, frameCount=300, fps=60, outputFile="Benchmark.json", baselineFile="", threshold=0.05, exitWhenDone=True)
@@ -39,6 +39,15 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kMemoryBudget = "memoryBudget";
+        const std::string kStats = "stats";
+        const std::string kResetStats = "resetStats";
+        const std::string kExr = "exr";
+        const std::string kExrCompression = "exrCompression";
+        const std::string kExrMultiPart = "exrMultiPart";
+
+        const double kMB = 1024.0 * 1024.0;
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -63,6 +72,32 @@ namespace Mogwai
         {
             auto w = Gui::Window(pGui, "Frame Capture", mShowUI, {}, { 400, 400 });
             CaptureTrigger::renderUI(w);
+
+            {
+                auto g = w.group("OpenEXR", true);
+                g.checkbox("Multi-Layer EXR", mMultiLayerExr);
+                g.tooltip("Write all the graph outputs of a frame as the layers of one OpenEXR file, instead of one file per output");
+                if (mMultiLayerExr)
+                {
+                    static const Gui::DropdownList kCompressions =
+                    {
+                        { (uint32_t)ExrWriter::Compression::None, "None" },
+                        { (uint32_t)ExrWriter::Compression::RLE, "RLE" },
+                        { (uint32_t)ExrWriter::Compression::ZIPS, "ZIPS" },
+                        { (uint32_t)ExrWriter::Compression::ZIP, "ZIP" },
+                    };
+                    uint32_t compression = (uint32_t)mExrOptions.compression;
+                    if (g.dropdown("Compression", kCompressions, compression)) mExrOptions.compression = (ExrWriter::Compression)compression;
+                    g.checkbox("Multi-Part", mExrOptions.multiPart);
+                    g.tooltip("Write each output as a separate part, which readers can load on its own");
+                }
+            }
+
+            {
+                auto g = w.group("Statistics", true);
+                g.text(statsStr());
+                if (g.button("Reset")) resetStats();
+            }
         }
     }
 
@@ -87,10 +122,35 @@ namespace Mogwai
             pybind11::print(s.empty() ? "Empty" : s);
         };
         fc.func_(kPrintFrames.c_str(), printAllGraphs);
+        fc.func_(kFlush.c_str(), [](FrameCapture* pFC) { AsyncImageWriter::flush(); });
+
+        auto printStats = [](FrameCapture* pFC) { pybind11::print(pFC->statsStr()); };
+        fc.func_(kStats.c_str(), printStats);
+        fc.func_(kResetStats.c_str(), &FrameCapture::resetStats);
 
         // Settings
         auto showUI = [](FrameCapture* pFC, bool show) { pFC->mShowUI = show; };
         fc.func_(kUI.c_str(), showUI, "show"_a = true);
+
+        auto getExr = [](FrameCapture* pFC) { return pFC->mMultiLayerExr; };
+        auto setExr = [](FrameCapture* pFC, bool enable) { pFC->mMultiLayerExr = enable; };
+        fc.func_(kExr.c_str(), getExr);
+        fc.func_(kExr.c_str(), setExr, "enable"_a = true);
+
+        auto getExrCompression = [](FrameCapture* pFC) { return pFC->mExrOptions.compression; };
+        auto setExrCompression = [](FrameCapture* pFC, ExrWriter::Compression c) { pFC->mExrOptions.compression = c; };
+        fc.func_(kExrCompression.c_str(), getExrCompression);
+        fc.func_(kExrCompression.c_str(), setExrCompression);
+
+        auto getExrMultiPart = [](FrameCapture* pFC) { return pFC->mExrOptions.multiPart; };
+        auto setExrMultiPart = [](FrameCapture* pFC, bool enable) { pFC->mExrOptions.multiPart = enable; };
+        fc.func_(kExrMultiPart.c_str(), getExrMultiPart);
+        fc.func_(kExrMultiPart.c_str(), setExrMultiPart, "enable"_a = true);
+
+        auto setMemoryBudget = [](FrameCapture* pFC, size_t megabytes) { AsyncImageWriter::setMemoryBudget(megabytes * size_t(kMB)); };
+        fc.func_(kMemoryBudget.c_str(), setMemoryBudget, "megabytes"_a);
+        auto getMemoryBudget = [](FrameCapture* pFC) { return AsyncImageWriter::getMemoryBudget() / size_t(kMB); };
+        fc.func_(kMemoryBudget.c_str(), getMemoryBudget);
     }
 
     std::string FrameCapture::getScript()
@@ -99,6 +159,12 @@ namespace Mogwai
 
         s += "# Frame Capture\n";
         s += CaptureTrigger::getScript(kScriptVar);
+        if (mMultiLayerExr)
+        {
+            s += Scripting::makeMemberFunc(kScriptVar, kExr, true);
+            s += Scripting::makeMemberFunc(kScriptVar, kExrCompression, mExrOptions.compression);
+            s += Scripting::makeMemberFunc(kScriptVar, kExrMultiPart, mExrOptions.multiPart);
+        }
 
         for (const auto& g : mGraphRanges)
         {
@@ -109,6 +175,13 @@ namespace Mogwai
 
     void FrameCapture::triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID)
     {
+        if (mMultiLayerExr)
+        {
+            captureExr(pGraph);
+            mFramesCaptured++;
+            return;
+        }
+
         for (uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
             Texture* pTex = pGraph->getOutput(i)->asTexture().get();
@@ -119,6 +192,51 @@ namespace Mogwai
             auto format = Bitmap::getFormatFromFileExtension(ext);
             pTex->captureToFile(0, 0, filename, format);
         }
+        mFramesCaptured++;
+    }
+
+    void FrameCapture::captureExr(RenderGraph* pGraph)
+    {
+        // Outputs of a different size or in a format the writer doesn't support are written to their own files
+        std::vector<AsyncImageWriter::ExrLayer> layers;
+        uint32_t width = 0, height = 0;
+        for (uint32_t i = 0; i < pGraph->getOutputCount(); i++)
+        {
+            Texture* pTex = pGraph->getOutput(i)->asTexture().get();
+            assert(pTex);
+            std::string name = pGraph->getOutputName(i);
+            if (layers.empty())
+            {
+                width = pTex->getWidth();
+                height = pTex->getHeight();
+            }
+
+            if (pTex->getWidth() == width && pTex->getHeight() == height && ExrWriter::isFormatSupported(pTex->getFormat()))
+            {
+                layers.push_back({ name, pTex, ExrWriter::getDefaultPrecision(pTex->getFormat()) });
+            }
+            else
+            {
+                logWarning("FrameCapture: Output '" + name + "' can't be added to the OpenEXR file, writing it separately");
+                std::string filename = getOutputNamePrefix(name) + to_string(gpFramework->getGlobalClock().frame()) + ".";
+                auto ext = Bitmap::getFileExtFromResourceFormat(pTex->getFormat());
+                pTex->captureToFile(0, 0, filename + ext, Bitmap::getFormatFromFileExtension(ext));
+            }
+        }
+
+        if (layers.empty()) return;
+        std::string filename = getOutputNamePrefix("layers") + to_string(gpFramework->getGlobalClock().frame()) + ".exr";
+        AsyncImageWriter::writeExr(layers, filename, mExrOptions);
+    }
+
+    void FrameCapture::endRange(RenderGraph* pGraph, const Range& r)
+    {
+        // Every frame is its own range. Only wait for the images after the last one, so that encoding overlaps with rendering.
+        for (const auto& range : mGraphRanges[pGraph])
+        {
+            if (range.first > r.first) return;
+        }
+        AsyncImageWriter::flush();
     }
 
     void FrameCapture::frames(const RenderGraph* pGraph, const uint64_vec& frames)
@@ -141,6 +259,29 @@ namespace Mogwai
         return s;
     }
 
+    std::string FrameCapture::statsStr() const
+    {
+        auto stats = AsyncImageWriter::getStats();
+        double seconds = stats.elapsedTime / 1000.0;
+        double megabytes = stats.bytesWritten / kMB;
+
+        std::string s;
+        s += "Frames: " + std::to_string(mFramesCaptured) + ", images: " + std::to_string(stats.imagesWritten) + ", " + std::to_string(megabytes) + " MB in " + std::to_string(seconds) + " s\n";
+        if (seconds > 0)
+        {
+            s += "Throughput: " + std::to_string(mFramesCaptured / seconds) + " frames/s, " + std::to_string(megabytes / seconds) + " MB/s\n";
+        }
+        s += "Budget stalls: " + std::to_string(stats.budgetStalls) + " (" + std::to_string(stats.stallTime) + " ms), peak in flight " + std::to_string(stats.peakBytesInFlight / kMB) + " MB";
+        return s;
+    }
+
+    void FrameCapture::resetStats()
+    {
+        AsyncImageWriter::flush();
+        AsyncImageWriter::resetStats();
+        mFramesCaptured = 0;
+    }
+
     void FrameCapture::capture()
     {
         auto pGraph = mpRenderer->getActiveGraph();
@@ -39,13 +39,20 @@ namespace Mogwai
         virtual void scriptBindings(Bindings& bindings) override;
         virtual std::string getScript() override;
         virtual void triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID);
+        virtual void endRange(RenderGraph* pGraph, const Range& r) override;
         void capture();
     private:
         FrameCapture(Renderer* pRenderer) : CaptureTrigger(pRenderer) {}
         bool mShowUI = false;
+        bool mMultiLayerExr = false;        // Write all the graph outputs of a frame into one OpenEXR file
+        ExrWriter::Options mExrOptions;
+        uint64_t mFramesCaptured = 0;
         using uint64_vec = std::vector<uint64_t>;
         void frames(const RenderGraph* pGraph, const uint64_vec& frames);
         void frames(const std::string& graphName, const uint64_vec& frames);
         std::string graphFramesStr(const RenderGraph* pGraph);
+        std::string statsStr() const;
+        void resetStats();
+        void captureExr(RenderGraph* pGraph);
     };
 }
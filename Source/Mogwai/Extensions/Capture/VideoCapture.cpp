@@ -38,14 +38,27 @@ namespace Mogwai
         const std::string kFps = "fps";
         const std::string kBitrate = "bitrate";
         const std::string kGopSize = "gopSize";
+        const std::string kBitDepth = "bitDepth";
+        const std::string kTransfer = "transfer";
+        const std::string kPqWhiteNits = "pqWhiteNits";
         const std::string kRanges = "ranges";
         const std::string kPrint = "print";
         const std::string kOutputs = "outputs";
 
-        Texture::SharedPtr createTextureForBlit(const Texture* pSource)
+        const size_t kReadbackLatency = 3;      // Number of frames a readback stays in flight before it's consumed
+        const size_t kMaxQueuedFrames = 4;      // Maximum number of frames waiting for the encoder thread
+
+        Texture::SharedPtr createTextureForBlit(const Texture* pSource, ResourceFormat format)
         {
             assert(pSource->getType() == Texture::Type::Texture2D);
-            return Texture::create2D(pSource->getWidth(), pSource->getHeight(), ResourceFormat::RGBA8UnormSrgb, 1, 1, nullptr, Texture::BindFlags::RenderTarget);
+            return Texture::create2D(pSource->getWidth(), pSource->getHeight(), format, 1, 1, nullptr, Texture::BindFlags::RenderTarget);
+        }
+
+        /** Float outputs are blitted to RGBA16Float, which keeps the HDR range and halves the readback size of 32-bit formats
+        */
+        bool shouldBlitToHalf(ResourceFormat format)
+        {
+            return format != ResourceFormat::RGBA16Float && getFormatType(format) == FormatType::Float;
         }
     }
 
@@ -56,6 +69,11 @@ namespace Mogwai
         mpEncoderUI = VideoEncoderUI::create(nullptr, nullptr);
     }
 
+    VideoCapture::~VideoCapture()
+    {
+        finishEncoding();
+    }
+
     VideoCapture::UniquePtr VideoCapture::create(Renderer* pRenderer)
     {
         return UniquePtr(new VideoCapture(pRenderer));
@@ -69,6 +87,16 @@ namespace Mogwai
             CaptureTrigger::renderUI(w);
             w.separator();
             mpEncoderUI->render(w, true);
+
+            Stats stats = getStats();
+            if (stats.framesCaptured)
+            {
+                auto g = w.group("Statistics", true);
+                g.text("Frames captured: " + std::to_string(stats.framesCaptured) + ", encoded: " + std::to_string(stats.framesEncoded));
+                g.text("Readback stalls: " + std::to_string(stats.readbackStalls));
+                g.text("Encode queue stalls: " + std::to_string(stats.queueStalls) + " (" + std::to_string(stats.queueStallTime) + " ms), max depth: " + std::to_string(stats.maxQueueDepth));
+                g.text("Encode time: " + std::to_string(stats.framesEncoded ? stats.encodeTime / stats.framesEncoded : 0.0) + " ms/frame");
+            }
         }
     }
 
@@ -79,6 +107,9 @@ namespace Mogwai
         d.codec = mpEncoderUI->getCodec();
         d.fps = mpEncoderUI->getFPS();
         d.gopSize = mpEncoderUI->getGopSize();
+        d.bitDepth = mpEncoderUI->getBitDepth();
+        d.transfer = mpEncoderUI->getTransfer();
+        d.pqWhiteNits = mpEncoderUI->getPqWhiteNits();
 
         for(uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
@@ -92,11 +123,16 @@ namespace Mogwai
 
             EncodeData encoder;
             auto texFormat = pTex->getFormat();
-            if (VideoEncoder::isFormatSupported(texFormat) == false)
+            if (shouldBlitToHalf(texFormat))
+            {
+                encoder.pBlitTex = createTextureForBlit(pTex.get(), ResourceFormat::RGBA16Float);
+                pTex = encoder.pBlitTex;
+            }
+            else if (VideoEncoder::isFormatSupported(texFormat) == false)
             {
-                auto res = msgBox("Trying to record graph output " + outputName + " but the resource format is not supported by the video encoder.\nWould you like to capture the output as an RGBA8Srgb resource?\n\nFor HDR textures, this operation will clamp the results", MsgBoxType::YesNo);
+                auto res = msgBox("Trying to record graph output " + outputName + " but the resource format is not supported by the video encoder.\nWould you like to capture the output as an RGBA8Srgb resource?", MsgBoxType::YesNo);
                 if(res == MsgBoxButton::No) continue;
-                encoder.pBlitTex = createTextureForBlit(pTex.get());
+                encoder.pBlitTex = createTextureForBlit(pTex.get(), ResourceFormat::RGBA8UnormSrgb);
                 pTex = encoder.pBlitTex;
             }
 
@@ -108,16 +144,23 @@ namespace Mogwai
             encoder.pEncoder = VideoEncoder::create(d);
             mEncoders.push_back(std::move(encoder));
         }
+
+        if (mEncoders.size())
+        {
+            mEncodeQueue.stats = {};
+            mEncodeQueue.stop = false;
+            mEncodeQueue.thread = std::thread(&VideoCapture::encoderThread, this);
+        }
     }
 
     void VideoCapture::endRange(RenderGraph* pGraph, const Range& r)
     {
-        for (const auto& e : mEncoders) e.pEncoder->endCapture();
+        finishEncoding();
     }
 
     void VideoCapture::triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID)
     {
-        for (const auto& e : mEncoders)
+        for (auto& e : mEncoders)
         {
             Texture::SharedPtr pTex = std::dynamic_pointer_cast<Texture>(pGraph->getOutput(e.output));
             if (e.pBlitTex)
@@ -126,8 +169,118 @@ namespace Mogwai
                 pTex = e.pBlitTex;
             }
 
-            e.pEncoder->appendFrame(pCtx->readTextureSubresource(pTex.get(), 0).data());
+            // Reuse a staging buffer from the ring. New ones are only allocated while the ring fills up.
+            if (e.freeReadbacks.size())
+            {
+                e.readbacks.push_back(e.freeReadbacks.back());
+                e.freeReadbacks.pop_back();
+                e.readbacks.back()->reissue(pTex.get(), 0);
+            }
+            else e.readbacks.push_back(pCtx->asyncReadTextureSubresource(pTex.get(), 0));
+
+            if (e.readbacks.size() > kReadbackLatency) consumeReadback(e);
+        }
+    }
+
+    void VideoCapture::consumeReadback(EncodeData& e)
+    {
+        CopyContext::ReadTextureTask::SharedPtr pTask = e.readbacks.front();
+        e.readbacks.pop_front();
+
+        std::vector<uint8_t> data;
+        {
+            std::lock_guard<std::mutex> lock(mEncodeQueue.mutex);
+            if (mEncodeQueue.freeFrames.size())
+            {
+                data = std::move(mEncodeQueue.freeFrames.back());
+                mEncodeQueue.freeFrames.pop_back();
+            }
+        }
+
+        bool ready = pTask->isReady();
+        pTask->getData(data);
+        e.freeReadbacks.push_back(pTask);
+
+        std::unique_lock<std::mutex> lock(mEncodeQueue.mutex);
+        auto& stats = mEncodeQueue.stats;
+        if (!ready) stats.readbackStalls++;
+        if (mEncodeQueue.jobs.size() >= kMaxQueuedFrames)
+        {
+            // Backpressure. The encoder can't keep up, wait for it instead of dropping the frame.
+            auto start = CpuTimer::getCurrentTimePoint();
+            mEncodeQueue.cv.wait(lock, [this]() { return mEncodeQueue.jobs.size() < kMaxQueuedFrames; });
+            stats.queueStalls++;
+            stats.queueStallTime += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
         }
+        mEncodeQueue.jobs.push_back({ e.pEncoder.get(), std::move(data) });
+        stats.framesCaptured++;
+        stats.maxQueueDepth = std::max(stats.maxQueueDepth, mEncodeQueue.jobs.size());
+        lock.unlock();
+        mEncodeQueue.cv.notify_all();
+    }
+
+    void VideoCapture::encoderThread()
+    {
+        while (true)
+        {
+            EncodeJob job;
+            {
+                std::unique_lock<std::mutex> lock(mEncodeQueue.mutex);
+                mEncodeQueue.cv.wait(lock, [this]() { return mEncodeQueue.stop || mEncodeQueue.jobs.size(); });
+                // Only exit once the queue is drained, every captured frame must be encoded
+                if (mEncodeQueue.jobs.empty()) return;
+                job = std::move(mEncodeQueue.jobs.front());
+                mEncodeQueue.jobs.pop_front();
+            }
+            mEncodeQueue.cv.notify_all();
+
+            auto start = CpuTimer::getCurrentTimePoint();
+            job.pEncoder->appendFrame(job.data.data());
+            double encodeTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+            std::lock_guard<std::mutex> lock(mEncodeQueue.mutex);
+            mEncodeQueue.stats.framesEncoded++;
+            mEncodeQueue.stats.encodeTime += encodeTime;
+            mEncodeQueue.freeFrames.push_back(std::move(job.data));
+        }
+    }
+
+    void VideoCapture::finishEncoding()
+    {
+        // Consume the frames still in flight, in order
+        for (auto& e : mEncoders)
+        {
+            while (e.readbacks.size()) consumeReadback(e);
+        }
+
+        if (mEncodeQueue.thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mEncodeQueue.mutex);
+                mEncodeQueue.stop = true;
+            }
+            mEncodeQueue.cv.notify_all();
+            mEncodeQueue.thread.join();
+        }
+
+        for (const auto& e : mEncoders) e.pEncoder->endCapture();
+
+        if (mEncoders.size())
+        {
+            const auto& stats = mEncodeQueue.stats;
+            logInfo("Video capture: " + std::to_string(stats.framesEncoded) + " frames encoded. " + std::to_string(stats.readbackStalls) + " readback stalls, " +
+                std::to_string(stats.queueStalls) + " encode queue stalls (" + std::to_string(stats.queueStallTime) + " ms), " +
+                std::to_string(stats.framesEncoded ? stats.encodeTime / stats.framesEncoded : 0.0) + " ms/frame encode time");
+        }
+
+        mEncoders.clear();
+        mEncodeQueue.freeFrames.clear();
+    }
+
+    VideoCapture::Stats VideoCapture::getStats()
+    {
+        std::lock_guard<std::mutex> lock(mEncodeQueue.mutex);
+        return mEncodeQueue.stats;
     }
 
     void VideoCapture::scriptBindings(Bindings& bindings)
@@ -162,6 +315,21 @@ namespace Mogwai
         vc.func_(kGopSize.c_str(), getGopSize);
         vc.func_(kGopSize.c_str(), setGopSize);
 
+        auto getBitDepth = [](VideoCapture* pVC) {return pVC->mpEncoderUI->getBitDepth(); };
+        auto setBitDepth = [](VideoCapture* pVC, uint32_t bitDepth) {pVC->mpEncoderUI->setBitDepth(bitDepth); return pVC; };
+        vc.func_(kBitDepth.c_str(), getBitDepth);
+        vc.func_(kBitDepth.c_str(), setBitDepth);
+
+        auto getTransfer = [](VideoCapture* pVC) {return pVC->mpEncoderUI->getTransfer(); };
+        auto setTransfer = [](VideoCapture* pVC, VideoFrameConverter::Transfer t) {pVC->mpEncoderUI->setTransfer(t); return pVC; };
+        vc.func_(kTransfer.c_str(), getTransfer);
+        vc.func_(kTransfer.c_str(), setTransfer);
+
+        auto getPqWhiteNits = [](VideoCapture* pVC) {return pVC->mpEncoderUI->getPqWhiteNits(); };
+        auto setPqWhiteNits = [](VideoCapture* pVC, float nits) {pVC->mpEncoderUI->setPqWhiteNits(nits); return pVC; };
+        vc.func_(kPqWhiteNits.c_str(), getPqWhiteNits);
+        vc.func_(kPqWhiteNits.c_str(), setPqWhiteNits);
+
         // Ranges
         vc.func_(kRanges.c_str(), ScriptBindings::overload_cast<const RenderGraph*, const range_vec&>(&VideoCapture::ranges));
         vc.func_(kRanges.c_str(), ScriptBindings::overload_cast<const std::string&, const range_vec&>(&VideoCapture::ranges));
@@ -188,6 +356,9 @@ namespace Mogwai
         s += Scripting::makeMemberFunc(kScriptVar, kFps, mpEncoderUI->getFPS());
         s += Scripting::makeMemberFunc(kScriptVar, kBitrate, mpEncoderUI->getBitrate());
         s += Scripting::makeMemberFunc(kScriptVar, kGopSize, mpEncoderUI->getGopSize());
+        s += Scripting::makeMemberFunc(kScriptVar, kBitDepth, mpEncoderUI->getBitDepth());
+        s += Scripting::makeMemberFunc(kScriptVar, kTransfer, mpEncoderUI->getTransfer());
+        s += Scripting::makeMemberFunc(kScriptVar, kPqWhiteNits, mpEncoderUI->getPqWhiteNits());
 
         for (const auto& g : mGraphRanges)
         {
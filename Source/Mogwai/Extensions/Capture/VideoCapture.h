@@ -29,6 +29,7 @@
 #include "CaptureTrigger.h"
 #include "Utils/Video/VideoEncoderUI.h"
 #include "Utils/Video/VideoEncoder.h"
+#include <deque>
 
 namespace Mogwai
 {
@@ -36,6 +37,7 @@ namespace Mogwai
     {
     public:
         static UniquePtr create(Renderer* pRenderer);
+        ~VideoCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void beginRange(RenderGraph* pGraph, const Range& r) override;
         virtual void endRange(RenderGraph* pGraph, const Range& r) override;
@@ -57,7 +59,45 @@ namespace Mogwai
             std::string output;
             VideoEncoder::UniquePtr pEncoder;
             Texture::SharedPtr pBlitTex;
+            std::deque<CopyContext::ReadTextureTask::SharedPtr> readbacks;          // In flight, oldest first
+            std::vector<CopyContext::ReadTextureTask::SharedPtr> freeReadbacks;     // Finished tasks, their staging buffers are reused
         };
         std::vector<EncodeData> mEncoders;
+
+        /** Frames are read back through a ring of staging buffers and consumed a few frames later, once the GPU is done with them.
+            Color conversion and encoding run on a dedicated thread. The queue is bounded, the render thread blocks when it's full.
+        */
+        struct EncodeJob
+        {
+            VideoEncoder* pEncoder;
+            std::vector<uint8_t> data;
+        };
+
+        struct Stats
+        {
+            uint64_t framesCaptured = 0;
+            uint64_t framesEncoded = 0;
+            uint64_t readbackStalls = 0;    // Readbacks which weren't finished by the GPU when they were consumed
+            uint64_t queueStalls = 0;       // Frames which waited for room in the encode queue
+            double queueStallTime = 0;      // Milliseconds the render thread spent waiting for the encode queue
+            double encodeTime = 0;          // Milliseconds spent converting and encoding on the encoder thread
+            size_t maxQueueDepth = 0;
+        };
+
+        struct
+        {
+            std::thread thread;
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::deque<EncodeJob> jobs;
+            std::vector<std::vector<uint8_t>> freeFrames;   // Frame memory returned by the encoder thread
+            bool stop = false;
+            Stats stats;
+        } mEncodeQueue;
+
+        void consumeReadback(EncodeData& e);
+        void encoderThread();
+        void finishEncoding();
+        Stats getStats();
     };
 }
@@ -0,0 +1,292 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "Benchmark.h"
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include <fstream>
+#include <sstream>
+
+namespace Mogwai
+{
+    namespace
+    {
+        const std::string kScriptVar = "bm";
+        const std::string kRun = "run";
+        const std::string kIsRunning = "isRunning";
+        const std::string kUI = "ui";
+
+        const std::string kFrameTime = "frameTime";
+        const std::string kEvents = "events";
+
+        const double kMinAbsoluteRegression = 0.02; // In ms. Ignore changes below that, they are in the noise for short events
+
+        struct Stats
+        {
+            double min = 0;
+            double median = 0;
+            double p95 = 0;
+            double p99 = 0;
+            double mean = 0;
+        };
+
+        Stats calcStats(std::vector<double> samples)
+        {
+            Stats s;
+            if (samples.empty()) return s;
+            std::sort(samples.begin(), samples.end());
+
+            // Nearest-rank percentile
+            auto percentile = [&samples](double p)
+            {
+                size_t rank = (size_t)std::ceil(p * samples.size());
+                return samples[std::max(rank, (size_t)1) - 1];
+            };
+
+            s.min = samples.front();
+            s.median = percentile(0.5);
+            s.p95 = percentile(0.95);
+            s.p99 = percentile(0.99);
+            for (double d : samples) s.mean += d;
+            s.mean /= samples.size();
+            return s;
+        }
+
+        template<typename Writer>
+        void writeStats(Writer& writer, const Stats& s)
+        {
+            writer.StartObject();
+            writer.Key("min"); writer.Double(s.min);
+            writer.Key("median"); writer.Double(s.median);
+            writer.Key("p95"); writer.Double(s.p95);
+            writer.Key("p99"); writer.Double(s.p99);
+            writer.Key("mean"); writer.Double(s.mean);
+            writer.EndObject();
+        }
+    }
+
+    MOGWAI_EXTENSION(Benchmark);
+
+    Benchmark::UniquePtr Benchmark::create(Renderer* pRenderer)
+    {
+        return UniquePtr(new Benchmark(pRenderer));
+    }
+
+    void Benchmark::run(const Config& config)
+    {
+        if (isRunning())
+        {
+            logWarning("Benchmark::run() - a benchmark is already running. Ignoring call");
+            return;
+        }
+
+        if (config.frameCount == 0) throw std::exception("Benchmark frame count must be greater than 0");
+        if (mpRenderer->getActiveGraph() == nullptr) throw std::exception("Can't run a benchmark without a render graph");
+
+        mConfig = config;
+        if (mConfig.outputFile.empty()) mConfig.outputFile = getExecutableDirectory() + "/Benchmark.json";
+
+        Clock& clock = gpFramework->getGlobalClock();
+        mSaved.profileEnabled = gProfileEnabled;
+        mSaved.showUI = gpFramework->isUiEnabled();
+        mSaved.fps = clock.framerate();
+        mSaved.clockPaused = clock.isPaused();
+
+        // The UI is excluded from the measurements. Restart the clock so each run goes through the same animation frames
+        gProfileEnabled = true;
+        gpFramework->toggleUI(false);
+        clock.framerate(mConfig.fps).now(0).play();
+
+        mFrameTimes.clear();
+        mEvents.clear();
+        // Skip the warm-up state entirely if there are no warm-up frames, otherwise the first frame would be discarded anyway
+        mState = mConfig.warmupFrames ? State::WarmingUp : State::Recording;
+        mFramesLeft = mConfig.warmupFrames ? mConfig.warmupFrames : mConfig.frameCount;
+        logInfo("Benchmark started. Warming up for " + std::to_string(mConfig.warmupFrames) + " frames, recording " + std::to_string(mConfig.frameCount) + " frames");
+    }
+
+    void Benchmark::endFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+    {
+        switch (mState)
+        {
+        case State::WarmingUp:
+            // Exactly warmupFrames frames are discarded, the next frame is the first recorded one
+            if (--mFramesLeft == 0)
+            {
+                mState = State::Recording;
+                mFramesLeft = mConfig.frameCount;
+            }
+            break;
+        case State::Recording:
+            // The profiler's results are for the previous frame, which is fine since we only care about the distribution
+            mFrameTimes.push_back(gpFramework->getFrameRate().getLastFrameTime() * 1000.0);
+            for (const auto& e : Profiler::getLastFrameTimes())
+            {
+                auto& samples = mEvents[e.pEvent->name];
+                samples.cpu.push_back(e.cpuTime);
+                samples.gpu.push_back(e.gpuTime);
+            }
+            if (--mFramesLeft == 0) finish();
+            break;
+        default:
+            break;
+        }
+    }
+
+    void Benchmark::finish()
+    {
+        mState = State::Idle;
+        gProfileEnabled = mSaved.profileEnabled;
+        gpFramework->toggleUI(mSaved.showUI);
+        Clock& clock = gpFramework->getGlobalClock();
+        clock.framerate(mSaved.fps);
+        if (mSaved.clockPaused) clock.pause();
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("graph"); writer.String(mpRenderer->getActiveGraph() ? mpRenderer->getActiveGraph()->getName().c_str() : "");
+        writer.Key("warmupFrames"); writer.Uint(mConfig.warmupFrames);
+        writer.Key("frameCount"); writer.Uint(mConfig.frameCount);
+        writer.Key(kFrameTime.c_str()); writeStats(writer, calcStats(mFrameTimes));
+        writer.Key(kEvents.c_str());
+        writer.StartObject();
+        for (const auto& e : mEvents)
+        {
+            writer.Key(e.first.c_str());
+            writer.StartObject();
+            writer.Key("cpu"); writeStats(writer, calcStats(e.second.cpu));
+            writer.Key("gpu"); writeStats(writer, calcStats(e.second.gpu));
+            writer.EndObject();
+        }
+        writer.EndObject();
+        writer.EndObject();
+
+        std::ofstream(mConfig.outputFile) << buffer.GetString();
+        logInfo("Benchmark results written to `" + mConfig.outputFile + "`");
+
+        bool passed = mConfig.baselineFile.empty() || compareToBaseline(buffer.GetString());
+        mLastResult = passed ? "Passed" : "Regressions found, see the log";
+        if (!passed) Renderer::sExitCode = 1;
+        if (mConfig.exitWhenDone) gpFramework->shutdown();
+    }
+
+    bool Benchmark::compareToBaseline(const std::string& results)
+    {
+        std::ifstream f(mConfig.baselineFile);
+        if (!f.good())
+        {
+            logError("Can't open benchmark baseline `" + mConfig.baselineFile + "`", Logger::MsgBox::Nope);
+            return false;
+        }
+        std::stringstream ss;
+        ss << f.rdbuf();
+
+        rapidjson::Document baseline, current;
+        baseline.Parse(ss.str().c_str());
+        current.Parse(results.c_str());
+        if (baseline.HasParseError() || !baseline.IsObject())
+        {
+            logError("Benchmark baseline `" + mConfig.baselineFile + "` is not a valid JSON file", Logger::MsgBox::Nope);
+            return false;
+        }
+
+        bool passed = true;
+        auto compare = [this, &passed](const std::string& name, const rapidjson::Value& base, const rapidjson::Value& cur)
+        {
+            for (const char* stat : { "median", "p95" })
+            {
+                if (!base.IsObject() || !base.HasMember(stat) || !base[stat].IsNumber()) continue;
+                double b = base[stat].GetDouble();
+                double c = cur[stat].GetDouble();
+                if (c > b * (1 + mConfig.threshold) && c - b > kMinAbsoluteRegression)
+                {
+                    logError("Benchmark regression in `" + name + "` " + stat + ": " + std::to_string(b) + "ms -> " + std::to_string(c) + "ms", Logger::MsgBox::Nope);
+                    passed = false;
+                }
+            }
+        };
+
+        if (baseline.HasMember(kFrameTime.c_str())) compare(kFrameTime, baseline[kFrameTime.c_str()], current[kFrameTime.c_str()]);
+        if (baseline.HasMember(kEvents.c_str()) && baseline[kEvents.c_str()].IsObject())
+        {
+            const auto& baseEvents = baseline[kEvents.c_str()];
+            for (const auto& e : current[kEvents.c_str()].GetObject())
+            {
+                if (!baseEvents.HasMember(e.name)) continue;
+                const auto& base = baseEvents[e.name];
+                if (base.IsObject() && base.HasMember("gpu")) compare(std::string(e.name.GetString()) + " (GPU)", base["gpu"], e.value["gpu"]);
+            }
+        }
+
+        if (passed) logInfo("Benchmark passed. No regressions compared to `" + mConfig.baselineFile + "`");
+        return passed;
+    }
+
+    void Benchmark::renderUI(Gui* pGui)
+    {
+        if (mShowUI)
+        {
+            auto w = Gui::Window(pGui, "Benchmark", mShowUI, {}, { 300, 200 });
+            w.var("Warmup Frames", mConfig.warmupFrames);
+            w.var("Frame Count", mConfig.frameCount, 1u);
+            w.var("Clock FPS", mConfig.fps);
+            w.var("Regression Threshold", mConfig.threshold, 0.0f, 1.0f, 0.01f);
+            if (isRunning()) w.text("Running...");
+            else if (w.button("Run")) run(mConfig);
+            if (mLastResult.size()) w.text("Last result: " + mLastResult);
+        }
+    }
+
+    void Benchmark::scriptBindings(Bindings& bindings)
+    {
+        auto& m = bindings.getModule();
+        auto bm = m.class_<Benchmark>("Benchmark");
+        bindings.addGlobalObject(kScriptVar, this, "Benchmark Helpers");
+
+        auto run = [](Benchmark* pBM, uint32_t warmupFrames, uint32_t frameCount, uint32_t fps, const std::string& outputFile, const std::string& baselineFile, float threshold, bool exitWhenDone)
+        {
+            Config c;
+            c.warmupFrames = warmupFrames;
+            c.frameCount = frameCount;
+            c.fps = fps;
+            c.outputFile = outputFile;
+            c.baselineFile = baselineFile;
+            c.threshold = threshold;
+            c.exitWhenDone = exitWhenDone;
+            pBM->run(c);
+        };
+        Config d;
+        bm.func_(kRun.c_str(), run, "warmupFrames"_a = d.warmupFrames, "frameCount"_a = d.frameCount, "fps"_a = d.fps, "outputFile"_a = d.outputFile, "baselineFile"_a = d.baselineFile, "threshold"_a = d.threshold, "exitWhenDone"_a = d.exitWhenDone);
+        bm.func_(kIsRunning.c_str(), &Benchmark::isRunning);
+
+        auto showUI = [](Benchmark* pBM, bool show) { pBM->mShowUI = show; };
+        bm.func_(kUI.c_str(), showUI, "show"_a = true);
+    }
+}
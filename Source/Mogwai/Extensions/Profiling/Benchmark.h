@@ -0,0 +1,101 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "../../Mogwai.h"
+
+namespace Mogwai
+{
+    /** Runs the active graph for a fixed number of frames and writes frame-time statistics.
+        The benchmark warms up for a number of frames, then records the CPU frame time and the CPU/GPU time of every profiler event (including every render-pass) for a number of frames.
+        The results (min/median/p95/p99) are written to a JSON file. If a baseline file is given, the results are compared against it and regressions above a threshold are reported.
+        To run from the command line, use a script which loads the scene and graph and calls `bm.run(..., exitWhenDone=True)`. Mogwai's exit code is non-zero if a regression was found.
+    */
+    class Benchmark : public Extension
+    {
+    public:
+        static UniquePtr create(Renderer* pRenderer);
+        virtual void endFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo) override;
+        virtual void renderUI(Gui* pGui) override;
+        virtual void scriptBindings(Bindings& bindings) override;
+
+        struct Config
+        {
+            uint32_t warmupFrames = 60;
+            uint32_t frameCount = 300;
+            uint32_t fps = 60;                  ///< The simulated frame-rate of the global clock while benchmarking, so that animations and camera paths are deterministic. 0 to use real time
+            std::string outputFile;             ///< If empty, writes `Benchmark.json` into the executable directory
+            std::string baselineFile;           ///< Optional results of a previous run to compare against
+            float threshold = 0.05f;            ///< Relative slowdown which counts as a regression
+            bool exitWhenDone = false;
+        };
+
+        /** Start a benchmark. Returns immediately, the benchmark runs over the next frames.
+        */
+        void run(const Config& config);
+
+        /** Check if a benchmark is in progress
+        */
+        bool isRunning() const { return mState != State::Idle; }
+
+    private:
+        Benchmark(Renderer* pRenderer) : mpRenderer(pRenderer) {}
+        void finish();
+        bool compareToBaseline(const std::string& results);
+
+        struct Samples
+        {
+            std::vector<double> cpu;
+            std::vector<double> gpu;
+        };
+
+        enum class State
+        {
+            Idle,
+            WarmingUp,
+            Recording
+        };
+
+        Renderer* mpRenderer;
+        Config mConfig;
+        State mState = State::Idle;
+        uint32_t mFramesLeft = 0;
+        std::vector<double> mFrameTimes;
+        std::map<std::string, Samples> mEvents;
+        bool mShowUI = false;
+        std::string mLastResult;
+
+        // Settings to restore when the benchmark ends
+        struct
+        {
+            bool profileEnabled;
+            bool showUI;
+            uint32_t fps;
+            bool clockPaused;
+        } mSaved;
+    };
+}
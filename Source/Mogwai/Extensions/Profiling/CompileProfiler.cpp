@@ -0,0 +1,422 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "stdafx.h"
+#include "CompileProfiler.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include <fstream>
+#include <set>
+
+namespace Mogwai
+{
+    namespace
+    {
+        const std::string kScriptVar = "cp";
+        const std::string kStart = "start";
+        const std::string kStop = "stop";
+        const std::string kReport = "report";
+        const std::string kUI = "ui";
+
+        const uint32_t kDefaultTop = 20;
+        const uint32_t kUITop = 10;
+
+        std::string normalizePath(std::string path)
+        {
+            std::replace(path.begin(), path.end(), '\\', '/');
+            std::transform(path.begin(), path.end(), path.begin(), ::tolower);
+            return path;
+        }
+
+        std::string trim(const std::string& s)
+        {
+            size_t first = s.find_first_not_of(" \t\r");
+            if (first == std::string::npos) return "";
+            size_t last = s.find_last_not_of(" \t\r");
+            return s.substr(first, last - first + 1);
+        }
+
+        /** Get the file name an include/import directive refers to, or an empty string if the line isn't a directive
+        */
+        std::string parseInclude(const std::string& line)
+        {
+            std::string l = trim(line);
+            if (hasPrefix(l, "#include"))
+            {
+                size_t begin = l.find_first_of("\"<");
+                if (begin == std::string::npos) return "";
+                size_t end = l.find_first_of("\">", begin + 1);
+                return end == std::string::npos ? "" : l.substr(begin + 1, end - begin - 1);
+            }
+
+            for (const char* keyword : { "import ", "__import " })
+            {
+                if (hasPrefix(l, keyword))
+                {
+                    // Module names use `.` as the path separator
+                    std::string name = trim(l.substr(strlen(keyword), l.find(';') - strlen(keyword)));
+                    std::replace(name.begin(), name.end(), '.', '/');
+                    return name + ".slang";
+                }
+            }
+            return "";
+        }
+
+        std::string getDefineString(const std::pair<std::string, std::string>& d)
+        {
+            return d.second.empty() ? d.first : d.first + "=" + d.second;
+        }
+
+        std::string getPermutationString(const Program::CompileRecord& r)
+        {
+            std::string s;
+            for (const auto& d : r.defines) s += (s.size() ? " " : "") + getDefineString(d);
+            return s;
+        }
+
+        std::string getProgramName(const std::string& desc)
+        {
+            const std::string header = "Program with Shaders:\n";
+            std::string name = desc.substr(desc.find(header) == 0 ? header.size() : 0);
+            while (name.size() && name.back() == '\n') name.pop_back();
+            return replaceSubstring(name, "\n", " ");
+        }
+    }
+
+    MOGWAI_EXTENSION(CompileProfiler);
+
+    CompileProfiler::UniquePtr CompileProfiler::create(Renderer* pRenderer)
+    {
+        return UniquePtr(new CompileProfiler(pRenderer));
+    }
+
+    void CompileProfiler::start()
+    {
+        Program::setCompileRecording(true);
+        Program::resetRuntimeDefineStats();
+        mRecording = true;
+        mRecords.clear();
+        mRuntimeDefineStats = {};
+        logInfo("Compile profiler started");
+    }
+
+    void CompileProfiler::stop()
+    {
+        if (!mRecording) return;
+        mRecords = Program::getCompileRecords();
+        mRuntimeDefineStats = Program::getRuntimeDefineStats();
+        Program::setCompileRecording(false);
+        mRecording = false;
+    }
+
+    const CompileProfiler::FileInfo& CompileProfiler::getFileInfo(const std::string& path)
+    {
+        auto it = mFileInfo.find(path);
+        if (it != mFileInfo.end()) return it->second;
+
+        FileInfo& info = mFileInfo[path];
+        std::ifstream f(path);
+        std::string line;
+        while (std::getline(f, line))
+        {
+            info.lineCount++;
+            std::string include = parseInclude(line);
+            if (include.size()) info.includes.push_back(normalizePath(include));
+        }
+        return info;
+    }
+
+    void CompileProfiler::analyze()
+    {
+        if (mRecording) mRecords = Program::getCompileRecords();
+
+        // The files may have changed since the last analysis
+        mFileInfo.clear();
+        mIncludeGraph.clear();
+        std::map<std::string, HeaderStats> headers;
+        std::map<std::string, DefineStats> defines;
+        std::map<std::string, std::set<std::string>> includers;
+
+        for (const auto& r : mRecords)
+        {
+            if (!r.success) continue;
+            for (const auto& d : r.defines)
+            {
+                auto& s = defines[getDefineString(d)];
+                s.compileCount++;
+                s.totalTime += r.compileTime;
+            }
+
+            // Cached compiles don't run Slang, so they don't tell us anything about the headers
+            if (r.cacheHit || r.dependencies.empty()) continue;
+
+            const auto& deps = r.dependencies;
+            std::vector<std::string> normalized;
+            std::vector<size_t> lines;
+            size_t totalLines = 0;
+            for (const auto& d : deps)
+            {
+                normalized.push_back(normalizePath(d));
+                lines.push_back(getFileInfo(d).lineCount);
+                totalLines += lines.back();
+            }
+            if (totalLines == 0) continue;
+
+            // Resolve the directives against the files of this compile. The directives are relative to a search path, so match on the path suffix
+            std::vector<std::vector<size_t>> edges(deps.size());
+            for (size_t i = 0; i < deps.size(); i++)
+            {
+                for (const auto& include : getFileInfo(deps[i]).includes)
+                {
+                    for (size_t j = 0; j < deps.size(); j++)
+                    {
+                        if (j != i && hasSuffix(normalized[j], "/" + include))
+                        {
+                            edges[i].push_back(j);
+                            mIncludeGraph[deps[i]].push_back(deps[j]);
+                            includers[deps[j]].insert(deps[i]);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < deps.size(); i++)
+            {
+                // Lines of all the files reachable from this one
+                std::vector<bool> visited(deps.size(), false);
+                std::vector<size_t> stack = { i };
+                visited[i] = true;
+                size_t inclusiveLines = 0;
+                while (stack.size())
+                {
+                    size_t f = stack.back();
+                    stack.pop_back();
+                    inclusiveLines += lines[f];
+                    for (size_t e : edges[f])
+                    {
+                        if (!visited[e])
+                        {
+                            visited[e] = true;
+                            stack.push_back(e);
+                        }
+                    }
+                }
+
+                auto& h = headers[deps[i]];
+                h.compileCount++;
+                h.lineCount = lines[i];
+                h.inclusiveLineCount = std::max(h.inclusiveLineCount, inclusiveLines);
+                h.cost += r.slangTime * lines[i] / totalLines;
+                h.inclusiveCost += r.slangTime * inclusiveLines / totalLines;
+            }
+        }
+
+        for (auto& g : mIncludeGraph)
+        {
+            std::sort(g.second.begin(), g.second.end());
+            g.second.erase(std::unique(g.second.begin(), g.second.end()), g.second.end());
+        }
+
+        mHeaders.clear();
+        for (auto& h : headers)
+        {
+            h.second.path = h.first;
+            h.second.includerCount = (uint32_t)includers[h.first].size();
+            mHeaders.push_back(h.second);
+        }
+        std::sort(mHeaders.begin(), mHeaders.end(), [](const HeaderStats& a, const HeaderStats& b) { return a.inclusiveCost > b.inclusiveCost; });
+
+        mDefines.clear();
+        for (auto& d : defines)
+        {
+            d.second.define = d.first;
+            mDefines.push_back(d.second);
+        }
+        std::sort(mDefines.begin(), mDefines.end(), [](const DefineStats& a, const DefineStats& b) { return a.totalTime > b.totalTime; });
+    }
+
+    void CompileProfiler::report(const std::string& outputFile, uint32_t top)
+    {
+        analyze();
+        std::string filename = outputFile.empty() ? getExecutableDirectory() + "/CompileProfile.json" : outputFile;
+
+        std::vector<const Program::CompileRecord*> permutations;
+        double totalTime = 0;
+        for (const auto& r : mRecords)
+        {
+            permutations.push_back(&r);
+            totalTime += r.compileTime;
+        }
+        std::sort(permutations.begin(), permutations.end(), [](auto a, auto b) { return a->compileTime > b->compileTime; });
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("totalTime"); writer.Double(totalTime);
+
+        writer.Key("runtimeDefines");
+        writer.StartObject();
+        writer.Key("valueUpdates"); writer.Uint64(mRuntimeDefineStats.valueUpdates);
+        writer.Key("compilesAvoided"); writer.Uint64(mRuntimeDefineStats.compilesAvoided);
+        writer.EndObject();
+
+        writer.Key("compiles");
+        writer.StartArray();
+        for (const auto& r : permutations)
+        {
+            writer.StartObject();
+            writer.Key("program"); writer.String(getProgramName(r->program).c_str());
+            writer.Key("defines"); writer.String(getPermutationString(*r).c_str());
+            writer.Key("success"); writer.Bool(r->success);
+            writer.Key("cacheHit"); writer.Bool(r->cacheHit);
+            writer.Key("compileTime"); writer.Double(r->compileTime);
+            writer.Key("setupTime"); writer.Double(r->setupTime);
+            writer.Key("slangTime"); writer.Double(r->slangTime);
+            writer.Key("reflectionTime"); writer.Double(r->reflectionTime);
+            writer.Key("createTime"); writer.Double(r->createTime);
+            writer.Key("dependencies");
+            writer.StartArray();
+            for (const auto& d : r->dependencies) writer.String(d.c_str());
+            writer.EndArray();
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("headers");
+        writer.StartArray();
+        for (const auto& h : mHeaders)
+        {
+            writer.StartObject();
+            writer.Key("path"); writer.String(h.path.c_str());
+            writer.Key("compileCount"); writer.Uint(h.compileCount);
+            writer.Key("includerCount"); writer.Uint(h.includerCount);
+            writer.Key("lineCount"); writer.Uint64(h.lineCount);
+            writer.Key("inclusiveLineCount"); writer.Uint64(h.inclusiveLineCount);
+            writer.Key("cost"); writer.Double(h.cost);
+            writer.Key("inclusiveCost"); writer.Double(h.inclusiveCost);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("defines");
+        writer.StartArray();
+        for (const auto& d : mDefines)
+        {
+            writer.StartObject();
+            writer.Key("define"); writer.String(d.define.c_str());
+            writer.Key("compileCount"); writer.Uint(d.compileCount);
+            writer.Key("totalTime"); writer.Double(d.totalTime);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("includeGraph");
+        writer.StartObject();
+        for (const auto& g : mIncludeGraph)
+        {
+            writer.Key(g.first.c_str());
+            writer.StartArray();
+            for (const auto& i : g.second) writer.String(i.c_str());
+            writer.EndArray();
+        }
+        writer.EndObject();
+        writer.EndObject();
+
+        std::ofstream(filename) << buffer.GetString();
+
+        std::string summary = "Compile profile: " + std::to_string(mRecords.size()) + " program versions, " + std::to_string(totalTime * 1.0e-3) + " s. Report written to `" + filename + "`\n";
+        summary += "Runtime defines: " + std::to_string(mRuntimeDefineStats.valueUpdates) + " value updates, " + std::to_string(mRuntimeDefineStats.compilesAvoided) + " compiles avoided\n";
+        summary += "Most expensive headers (inclusive cost in ms, own cost in ms, compiles, path):\n";
+        for (size_t i = 0; i < std::min<size_t>(top, mHeaders.size()); i++)
+        {
+            const auto& h = mHeaders[i];
+            summary += "  " + std::to_string(h.inclusiveCost) + "  " + std::to_string(h.cost) + "  " + std::to_string(h.compileCount) + "  " + h.path + "\n";
+        }
+        summary += "Most expensive defines (total time in ms, compiles, define):\n";
+        for (size_t i = 0; i < std::min<size_t>(top, mDefines.size()); i++)
+        {
+            const auto& d = mDefines[i];
+            summary += "  " + std::to_string(d.totalTime) + "  " + std::to_string(d.compileCount) + "  " + d.define + "\n";
+        }
+        summary += "Most expensive permutations (time in ms, program, defines):\n";
+        for (size_t i = 0; i < std::min<size_t>(top, permutations.size()); i++)
+        {
+            const auto& r = *permutations[i];
+            summary += "  " + std::to_string(r.compileTime) + "  " + getProgramName(r.program) + "  " + getPermutationString(r) + "\n";
+        }
+        logInfo(summary);
+    }
+
+    void CompileProfiler::renderUI(Gui* pGui)
+    {
+        if (!mShowUI) return;
+
+        auto w = Gui::Window(pGui, "Compile Profiler", mShowUI, {}, { 500, 400 });
+        if (mRecording)
+        {
+            w.text("Recording...");
+            if (w.button("Stop")) stop();
+        }
+        else if (w.button("Start")) start();
+        if (w.button("Analyze", true)) analyze();
+        if (w.button("Write Report", true)) report("", kDefaultTop);
+        w.text("Runtime defines: " + std::to_string(mRuntimeDefineStats.compilesAvoided) + " compiles avoided");
+
+        {
+            auto g = w.group("Headers", true);
+            for (size_t i = 0; i < std::min<size_t>(kUITop, mHeaders.size()); i++)
+            {
+                const auto& h = mHeaders[i];
+                g.text(getFilenameFromPath(h.path) + ": " + std::to_string(h.inclusiveCost) + " ms inclusive, " + std::to_string(h.cost) + " ms own, " + std::to_string(h.compileCount) + " compiles");
+            }
+        }
+
+        {
+            auto g = w.group("Defines", true);
+            for (size_t i = 0; i < std::min<size_t>(kUITop, mDefines.size()); i++)
+            {
+                const auto& d = mDefines[i];
+                g.text(d.define + ": " + std::to_string(d.totalTime) + " ms, " + std::to_string(d.compileCount) + " compiles");
+            }
+        }
+    }
+
+    void CompileProfiler::scriptBindings(Bindings& bindings)
+    {
+        auto& m = bindings.getModule();
+        auto cp = m.class_<CompileProfiler>("CompileProfiler");
+        bindings.addGlobalObject(kScriptVar, this, "Shader Compile Profiler");
+
+        cp.func_(kStart.c_str(), &CompileProfiler::start);
+        cp.func_(kStop.c_str(), &CompileProfiler::stop);
+        cp.func_(kReport.c_str(), &CompileProfiler::report, "outputFile"_a = std::string(), "top"_a = kDefaultTop);
+
+        auto showUI = [](CompileProfiler* pCP, bool show) { pCP->mShowUI = show; };
+        cp.func_(kUI.c_str(), showUI, "show"_a = true);
+    }
+}
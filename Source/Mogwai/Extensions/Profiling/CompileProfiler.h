@@ -0,0 +1,99 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "../../Mogwai.h"
+
+namespace Mogwai
+{
+    /** Records every program version compiled during the session and ranks what makes compilation slow.
+        Each compile is recorded with its phase timings and the files it depends on. The include graph is rebuilt from the `#include` and `import` directives of the dependencies.
+        Every header is charged a share of the Slang time of each compile that uses it, proportional to its size. The inclusive cost also charges the headers it includes, which is what makes headers like `ShaderCommon.slang` stand out.
+        Defines are ranked by the total compile time of the permutations that use them.
+        The report is written to a JSON file by `cp.report()`.
+    */
+    class CompileProfiler : public Extension
+    {
+    public:
+        static UniquePtr create(Renderer* pRenderer);
+        virtual void renderUI(Gui* pGui) override;
+        virtual void scriptBindings(Bindings& bindings) override;
+
+        /** Start recording. Discards the compiles recorded so far
+        */
+        void start();
+
+        /** Stop recording
+        */
+        void stop();
+
+        /** Analyze the compiles recorded so far, write the report and log a summary
+            \param[in] outputFile The report file. If empty, writes `CompileProfile.json` into the executable directory
+            \param[in] top The number of headers, defines and permutations to log
+        */
+        void report(const std::string& outputFile, uint32_t top);
+
+        struct HeaderStats
+        {
+            std::string path;
+            uint32_t compileCount = 0;      ///< Number of non-cached compiles using the header
+            uint32_t includerCount = 0;     ///< Number of files including the header directly
+            size_t lineCount = 0;
+            size_t inclusiveLineCount = 0;  ///< Lines of the header and all the headers it includes
+            double cost = 0;                ///< Estimated Slang time spent on the header itself, in milliseconds
+            double inclusiveCost = 0;       ///< Estimated Slang time spent on the header and the headers it includes, in milliseconds
+        };
+
+        struct DefineStats
+        {
+            std::string define;
+            uint32_t compileCount = 0;
+            double totalTime = 0;           ///< Total compile time of the permutations using the define, in milliseconds
+        };
+
+    private:
+        CompileProfiler(Renderer* pRenderer) : mpRenderer(pRenderer) {}
+        void analyze();
+
+        struct FileInfo
+        {
+            size_t lineCount = 0;
+            std::vector<std::string> includes;  ///< Include/import names, as written in the file
+        };
+        const FileInfo& getFileInfo(const std::string& path);
+
+        Renderer* mpRenderer;
+        bool mRecording = false;
+        bool mShowUI = false;
+        std::vector<Program::CompileRecord> mRecords;
+        Program::RuntimeDefineStats mRuntimeDefineStats;
+        std::vector<HeaderStats> mHeaders;      // Sorted by inclusive cost
+        std::vector<DefineStats> mDefines;      // Sorted by total time
+        std::map<std::string, std::vector<std::string>> mIncludeGraph;
+        std::unordered_map<std::string, FileInfo> mFileInfo;
+    };
+}
@@ -47,6 +47,7 @@ namespace Mogwai
     }
     
     size_t Renderer::DebugWindow::index = 0;
+    int Renderer::sExitCode = 0;
 
     void Renderer::extend(Extension::CreateFunc func, const std::string& name)
     {
@@ -398,7 +399,7 @@ namespace Mogwai
         initGraph(pGraph, pGraphData);
     }
 
-    void Renderer::loadScene(std::string filename)
+    void Renderer::loadScene(std::string filename, SceneBuilder::Flags buildFlags)
     {
         if (filename.empty())
         {
@@ -406,7 +407,7 @@ namespace Mogwai
         }
 
 #ifdef FALCOR_D3D12
-        mpScene = SceneBuilder::create(filename)->getScene();
+        mpScene = SceneBuilder::create(filename, buildFlags)->getScene();
 #else
         mpScene = Scene::loadFromFile(filename);
 #endif
@@ -475,6 +476,15 @@ namespace Mogwai
         for (auto& pe : mpExtensions)  pe->beginFrame(pRenderContext, pTargetFbo);
     }
 
+    void Renderer::endProfileCapture()
+    {
+        if (mProfileCapture.active && Profiler::isCapturing() == false)
+        {
+            gProfileEnabled = mProfileCapture.profileEnabled;
+            mProfileCapture.active = false;
+        }
+    }
+
     void Renderer::onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
     {
         if(mScriptFilename.size())
@@ -484,6 +494,7 @@ namespace Mogwai
             loadScript(s);
         }
 
+        endProfileCapture();
         startFrame(pRenderContext, pTargetFbo);
         applyEditorChanges();
 
@@ -502,6 +513,7 @@ namespace Mogwai
             }
 
             executeActiveGraph(pRenderContext);
+            if (mpScene) mpScene->endFrame(pRenderContext);
 
             // Blit main graph output to frame buffer.
             if (mGraphs[mActiveGraph].mainOutput.size())
@@ -598,5 +610,5 @@ int main(int argc, char** argv)
     {
         msgBox("Mogwai crashed unexpectedly...\n" + std::string(e.what()));
     }
-    return 0;
+    return Mogwai::Renderer::sExitCode;
 }
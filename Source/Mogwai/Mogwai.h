@@ -98,6 +98,8 @@ namespace Mogwai
         static constexpr uint32_t kMinorVersion = 1;
 
         RenderGraph* getActiveGraph() const;
+
+        static int sExitCode;   ///< Mogwai's exit code. Extensions set it to report failures when running unattended
 //    private: // MOGWAI
         friend class Extension;
         std::vector<Extension::UniquePtr> mpExtensions;
@@ -128,7 +130,7 @@ namespace Mogwai
         void initGraph(const RenderGraph::SharedPtr& pGraph, GraphData* pData);
 
         void removeActiveGraph();
-        void loadScene(std::string filename = "");
+        void loadScene(std::string filename = "", SceneBuilder::Flags buildFlags = SceneBuilder::Flags::Default);
         Scene::SharedPtr getScene() const;
         void executeActiveGraph(RenderContext* pRenderContext);
         void startFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo);
@@ -163,6 +165,14 @@ namespace Mogwai
         // Scripting
         void registerScriptBindings(ScriptBindings::Module& m);
         std::string mGlobalHelpMessage;
+
+        // Profile capture. The profiler is enabled for the capture and restored once the file is written
+        struct
+        {
+            bool active = false;
+            bool profileEnabled = false;
+        } mProfileCapture;
+        void endProfileCapture();
     };
 
 #define MOGWAI_EXTENSION(Name)                         \
@@ -41,6 +41,7 @@ namespace Mogwai
         const std::string kActiveGraph = "activeGraph";
         const std::string kGetGraph = "graph";
         const std::string kGetScene = "scene";
+        const std::string kCaptureProfile = "captureProfile";
 
         template<typename T>
         std::string prepareHelpMessage(const T& g)
@@ -110,7 +111,7 @@ namespace Mogwai
         auto c = m.class_<Renderer>("Renderer");
 
         c.func_(kRunScript.c_str(), &Renderer::loadScript, "filename"_a = std::string());
-        c.func_(kLoadScene.c_str(), &Renderer::loadScene);
+        c.func_(kLoadScene.c_str(), &Renderer::loadScene, "filename"_a, "buildFlags"_a = SceneBuilder::Flags::Default);
         c.func_(kSaveConfig.c_str(), &Renderer::dumpConfig, "filename"_a = std::string());
         c.func_(kAddGraph.c_str(), &Renderer::addGraph);
         c.func_(kRemoveGraph.c_str(), ScriptBindings::overload_cast<const std::string&>(&Renderer::removeGraph));
@@ -141,5 +142,17 @@ namespace Mogwai
         auto toggleUI = [](Renderer* pRenderer, bool show) {gpFramework->toggleUI(show); };
         c.func_(kToggleUI.c_str(), toggleUI, "show"_a = true);
         c.func_(kActiveGraph.c_str(), &Renderer::getActiveGraph);
+
+        auto captureProfile = [](Renderer* pRenderer, const std::string& filename, uint32_t frameCount)
+        {
+            if (Profiler::isCapturing() == false)
+            {
+                pRenderer->mProfileCapture.active = true;
+                pRenderer->mProfileCapture.profileEnabled = gProfileEnabled;
+            }
+            gProfileEnabled = true;
+            Profiler::startCapture(filename, frameCount);
+        };
+        c.func_(kCaptureProfile.c_str(), captureProfile, "filename"_a, "frameCount"_a = 1);
     }
 }
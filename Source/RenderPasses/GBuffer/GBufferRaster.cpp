@@ -163,6 +163,13 @@ void GBufferRaster::execute(RenderContext* pRenderContext, const RenderData& ren
         mRaster.pVars[it.texname] = pTex;
     }
 
+    // The pixel shader writes the virtual texture feedback at the output resolution. The scene binds the resized buffer on its next update
+    if (const auto& pVirtualTextures = mpScene->getVirtualTextureSystem())
+    {
+        Texture::SharedPtr pDepth = renderData["depthStencil"]->asTexture();
+        pVirtualTextures->setFrameSize(pDepth->getWidth(), pDepth->getHeight());
+    }
+
     Scene::RenderFlags flags = mForceCullMode ? Scene::RenderFlags::UserRasterizerState : Scene::RenderFlags::None;
     mpScene->render(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), flags);
 
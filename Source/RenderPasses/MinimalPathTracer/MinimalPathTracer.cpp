@@ -90,6 +90,10 @@ bool MinimalPathTracer::init(const Dictionary& dict)
     mTracer.pProgram = RtProgram::create(progDesc, kMaxPayloadSizeBytes, kMaxAttributesSizeBytes);
     if (!mTracer.pProgram) return false;
 
+    // The bounce count and direct lighting toggle are changed interactively. Read them from a constant buffer instead of compiling a version per value.
+    mTracer.pProgram->addRuntimeDefine("MAX_BOUNCES");
+    mTracer.pProgram->addRuntimeDefine("COMPUTE_DIRECT");
+
     // Setup ray tracing state.
     mTracer.pState = RtState::create();
     assert(mTracer.pState);
@@ -164,6 +168,7 @@ void MinimalPathTracer::execute(RenderContext* pRenderContext, const RenderData&
 
     // Specialize program.
     // These defines should not modify the program vars. Do not trigger program vars re-creation.
+    // MAX_BOUNCES and COMPUTE_DIRECT are runtime defines and don't trigger a compilation.
     mTracer.pProgram->addDefine("MAX_BOUNCES", std::to_string(mMaxBounces));
     mTracer.pProgram->addDefine("COMPUTE_DIRECT", mComputeDirect ? "1" : "0");
     mTracer.pProgram->addDefine("USE_ANALYTIC_LIGHTS", mUseAnalyticLights ? "1" : "0");
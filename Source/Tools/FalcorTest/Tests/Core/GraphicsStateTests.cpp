@@ -0,0 +1,83 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    GPU_TEST(GraphicsStateObjectCache)
+    {
+        GraphicsProgram::SharedPtr pProgram = GraphicsProgram::createFromFile("Tests/Core/GraphicsStateTests.slang", "vsMain", "psMain");
+        GraphicsVars::SharedPtr pVars = GraphicsVars::create(pProgram->getReflector());
+        Vao::SharedPtr pVao = Vao::create(Vao::Topology::TriangleList);
+
+        Fbo::Desc fboDesc;
+        fboDesc.setColorTarget(0, ResourceFormat::RGBA8Unorm);
+        Fbo::SharedPtr pFbo = Fbo::create2D(16, 16, fboDesc);
+
+        auto createState = [&](const Fbo::SharedPtr& pStateFbo)
+        {
+            GraphicsState::SharedPtr pState = GraphicsState::create();
+            pState->setProgram(pProgram).setVao(pVao).setFbo(pStateFbo);
+            return pState;
+        };
+
+        GraphicsStateObjectCache::resetStats();
+        GraphicsState::SharedPtr pStateA = createState(pFbo);
+        GraphicsStateObject::SharedPtr pGsoA = pStateA->getGSO(pVars.get());
+        EXPECT(pGsoA != nullptr);
+
+        // A different state object with the same state, and an FBO created from a separate desc object with the same formats, must share the GSO.
+        Fbo::Desc otherDesc;
+        otherDesc.setColorTarget(0, ResourceFormat::RGBA8Unorm);
+        GraphicsState::SharedPtr pStateB = createState(Fbo::create2D(32, 32, otherDesc));
+        EXPECT(pStateB->getGSO(pVars.get()) == pGsoA);
+
+        // Changing the state must create a new GSO, and restoring it must find the original one.
+        pStateB->setRasterizerState(RasterizerState::create(RasterizerState::Desc().setCullMode(RasterizerState::CullMode::Front)));
+        GraphicsStateObject::SharedPtr pGsoB = pStateB->getGSO(pVars.get());
+        EXPECT(pGsoB != nullptr && pGsoB != pGsoA);
+        pStateB->setRasterizerState(nullptr);
+        EXPECT(pStateB->getGSO(pVars.get()) == pGsoA);
+
+        GraphicsStateObjectCache::Stats stats = GraphicsStateObjectCache::getStats();
+        EXPECT_EQ(stats.misses, 2ull);
+        EXPECT_EQ(stats.creations, 2ull);
+        EXPECT_EQ(stats.hits, 2ull);
+
+        // Prewarming recorded descs returns the existing objects.
+        GraphicsStateObjectCache::setRecording(true);
+        pStateB->setSampleMask(0x1);
+        GraphicsStateObject::SharedPtr pGsoC = pStateB->getGSO(pVars.get());
+        std::vector<GraphicsStateObject::Desc> descs = GraphicsStateObjectCache::getRecordedDescs();
+        GraphicsStateObjectCache::setRecording(false);
+        EXPECT_EQ(descs.size(), 1ull);
+        std::vector<GraphicsStateObject::SharedPtr> gsos = GraphicsStateObjectCache::prewarm(descs);
+        EXPECT_EQ(gsos.size(), 1ull);
+        if (gsos.size() == 1) EXPECT(gsos[0] == pGsoC);
+    }
+}
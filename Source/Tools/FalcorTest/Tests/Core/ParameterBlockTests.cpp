@@ -0,0 +1,127 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kElementCount = 256;
+        const uint32_t kBenchmarkIterations = 10000;
+
+        Buffer::SharedPtr createInput(uint32_t firstValue)
+        {
+            std::vector<uint32_t> data(kElementCount);
+            for (uint32_t i = 0; i < kElementCount; i++) data[i] = firstValue + i;
+            return Buffer::create(kElementCount * sizeof(uint32_t), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.data());
+        }
+
+        void verifyResult(GPUUnitTestContext& ctx, uint32_t firstValue, uint32_t bias)
+        {
+            ctx.runProgram(kElementCount, 1, 1);
+            const uint32_t* pResult = ctx.mapBuffer<const uint32_t>("result");
+            for (uint32_t i = 0; i < kElementCount; i++)
+            {
+                EXPECT_EQ(pResult[i], firstValue + i + bias) << "i = " << i;
+            }
+            ctx.unmapBuffer("result");
+        }
+    }
+
+    GPU_TEST(ParameterBlockHandles)
+    {
+        Buffer::SharedPtr pInputA = createInput(0);
+        Buffer::SharedPtr pInputB = createInput(1000);
+
+        ParameterBlock::BindingHandle inputHandle("input");
+        VariablesBuffer::VariableHandle biasHandle("bias");
+
+        ctx.createProgram("Tests/Core/ParameterBlockTests.cs.slang");
+        ctx.allocateStructuredBuffer("result", kElementCount);
+        ParameterBlock* pBlock = ctx.vars().getDefaultBlock().get();
+
+        EXPECT(pBlock->setRawBuffer(inputHandle, pInputA));
+        EXPECT(ctx["CB"]->setVariable(biasHandle, 3u));
+        EXPECT(inputHandle.isValid());
+        EXPECT(biasHandle.isValid());
+        verifyResult(ctx, 0, 3);
+
+        // Rebinding through the same handles must update the bindings.
+        EXPECT(pBlock->setRawBuffer(inputHandle, pInputB));
+        EXPECT(ctx["CB"]->setVariable(biasHandle, 7u));
+        verifyResult(ctx, 1000, 7);
+
+        // Recreating the program creates new reflection. The handles must be resolved again.
+        ctx.createProgram("Tests/Core/ParameterBlockTests.cs.slang");
+        ctx.allocateStructuredBuffer("result", kElementCount);
+        pBlock = ctx.vars().getDefaultBlock().get();
+
+        EXPECT(pBlock->setRawBuffer(inputHandle, pInputA));
+        EXPECT(ctx["CB"]->setVariable(biasHandle, 11u));
+        verifyResult(ctx, 0, 11);
+
+        // Names that don't exist give invalid handles and the calls fail.
+        ParameterBlock::BindingHandle missingHandle = pBlock->getHandle("missing");
+        EXPECT(!missingHandle.isValid());
+        EXPECT(!pBlock->setRawBuffer(missingHandle, pInputA));
+    }
+
+    GPU_TEST(ParameterBlockHandlesBenchmark)
+    {
+        Buffer::SharedPtr pInputs[] = { createInput(0), createInput(1000) };
+
+        ctx.createProgram("Tests/Core/ParameterBlockTests.cs.slang");
+        ctx.allocateStructuredBuffer("result", kElementCount);
+        ParameterBlock* pBlock = ctx.vars().getDefaultBlock().get();
+        ConstantBuffer::SharedPtr pCB = ctx["CB"];
+
+        // Alternate between two buffers so every call changes the binding.
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kBenchmarkIterations; i++)
+        {
+            pBlock->setRawBuffer("input", pInputs[i & 1]);
+            pCB->setVariable("bias", i);
+        }
+        double nameTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        ParameterBlock::BindingHandle inputHandle = pBlock->getHandle("input");
+        VariablesBuffer::VariableHandle biasHandle = pCB->getVariableHandle("bias");
+        start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kBenchmarkIterations; i++)
+        {
+            pBlock->setRawBuffer(inputHandle, pInputs[i & 1]);
+            pCB->setVariable(biasHandle, i);
+        }
+        double handleTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        logInfo("ParameterBlockHandlesBenchmark: " + std::to_string(kBenchmarkIterations) + " resource and variable sets took " + std::to_string(nameTime) + " ms by name and " + std::to_string(handleTime) + " ms by handle.");
+
+        // The last iteration bound the second buffer and the last loop index.
+        verifyResult(ctx, 1000, kBenchmarkIterations - 1);
+    }
+}
@@ -0,0 +1,114 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        void compareReflectors(GPUUnitTestContext& ctx, const ProgramReflection::SharedConstPtr& pOrig, const ProgramReflection::SharedConstPtr& pNew)
+        {
+            EXPECT_EQ(pOrig->getThreadGroupSize().x, pNew->getThreadGroupSize().x);
+            EXPECT_EQ(pOrig->getThreadGroupSize().y, pNew->getThreadGroupSize().y);
+            EXPECT_EQ(pOrig->getThreadGroupSize().z, pNew->getThreadGroupSize().z);
+            EXPECT_EQ(pOrig->isSampleFrequency(), pNew->isSampleFrequency());
+            EXPECT_EQ(pOrig->getParameterBlockCount(), pNew->getParameterBlockCount());
+            if (pOrig->getParameterBlockCount() != pNew->getParameterBlockCount()) return;
+
+            for (uint32_t b = 0; b < (uint32_t)pOrig->getParameterBlockCount(); b++)
+            {
+                const auto& pOrigBlock = pOrig->getParameterBlock(b);
+                const auto& pNewBlock = pNew->getParameterBlock(b);
+                EXPECT_EQ(pOrigBlock->getName(), pNewBlock->getName());
+                EXPECT(*pOrigBlock == *pNewBlock) << "block = " << pOrigBlock->getName();
+                EXPECT_EQ(pOrigBlock->getDescriptorSetLayouts().size(), pNewBlock->getDescriptorSetLayouts().size());
+
+                const auto& origResources = pOrigBlock->getResourceVec();
+                const auto& newResources = pNewBlock->getResourceVec();
+                EXPECT_EQ(origResources.size(), newResources.size());
+                if (origResources.size() != newResources.size()) continue;
+                for (size_t r = 0; r < origResources.size(); r++)
+                {
+                    const auto& orig = origResources[r];
+                    const auto& res = newResources[r];
+                    EXPECT_EQ(orig.name, res.name);
+                    EXPECT(orig.setType == res.setType) << "resource = " << orig.name;
+                    EXPECT_EQ(orig.regIndex, res.regIndex);
+                    EXPECT_EQ(orig.regSpace, res.regSpace);
+                    EXPECT_EQ(orig.descCount, res.descCount);
+                    EXPECT_EQ(orig.descOffset, res.descOffset);
+                    EXPECT(*orig.pType == *res.pType) << "resource = " << orig.name;
+
+                    auto origLoc = pOrigBlock->getResourceBinding(orig.name);
+                    auto newLoc = pNewBlock->getResourceBinding(res.name);
+                    EXPECT_EQ(origLoc.setIndex, newLoc.setIndex);
+                    EXPECT_EQ(origLoc.rangeIndex, newLoc.rangeIndex);
+                }
+            }
+        }
+    }
+
+    GPU_TEST(ProgramReflectionSerialization)
+    {
+        ctx.createProgram("Tests/Core/ProgramReflectionTests.cs.slang");
+        ComputeProgram* pProgram = ctx.getProgram();
+        std::vector<ProgramReflection::SharedConstPtr> reflectors = { pProgram->getReflector(), pProgram->getLocalReflector(), pProgram->getGlobalReflector() };
+
+        std::vector<uint8_t> blob;
+        ProgramReflection::serialize(reflectors, blob);
+        EXPECT(!blob.empty());
+
+        std::vector<ProgramReflection::SharedPtr> loaded;
+        EXPECT(ProgramReflection::deserialize(blob, loaded));
+        EXPECT_EQ(loaded.size(), reflectors.size());
+        if (loaded.size() != reflectors.size()) return;
+        for (size_t i = 0; i < reflectors.size(); i++) compareReflectors(ctx, reflectors[i], loaded[i]);
+
+        // The full and the local scopes describe the same resources, so they must share the type objects.
+        auto pFullCB = loaded[0]->getResource("CB");
+        auto pLocalCB = loaded[1]->getResource("CB");
+        EXPECT(pFullCB != nullptr && pLocalCB != nullptr);
+        if (pFullCB && pLocalCB) EXPECT(pFullCB->getType() == pLocalCB->getType());
+
+        // The variables must be reachable through the recreated types.
+        auto pCount = loaded[0]->getDefaultParameterBlock()->getResource("CB")->getType()->findMember("count");
+        auto pOrigCount = reflectors[0]->getDefaultParameterBlock()->getResource("CB")->getType()->findMember("count");
+        EXPECT(pCount != nullptr && pOrigCount != nullptr);
+        if (pCount && pOrigCount) EXPECT_EQ(pCount->getOffset(), pOrigCount->getOffset());
+
+        // Serializing the loaded objects must produce the same data.
+        std::vector<uint8_t> blob2;
+        ProgramReflection::serialize({ loaded[0], loaded[1], loaded[2] }, blob2);
+        EXPECT(blob == blob2);
+
+        // Malformed blobs are rejected.
+        std::vector<uint8_t> truncated(blob.begin(), blob.begin() + blob.size() / 2);
+        EXPECT(!ProgramReflection::deserialize(truncated, loaded));
+        EXPECT(!ProgramReflection::deserialize({}, loaded));
+    }
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kElementCount = 64;
+
+        size_t countCompiles(const std::vector<Program::CompileRecord>& records)
+        {
+            return (size_t)std::count_if(records.begin(), records.end(), [](const Program::CompileRecord& r) { return r.program.find("ProgramTests.cs.slang") != std::string::npos; });
+        }
+    }
+
+    GPU_TEST(RuntimeDefines)
+    {
+        Program::setCompileRecording(true);
+        Program::resetRuntimeDefineStats();
+
+        // SCALE starts as a regular define and keeps its value when it becomes a runtime define
+        ctx.createProgram("Tests/Core/ProgramTests.cs.slang", "main", { {"SCALE", "2"} }, Shader::CompilerFlags::None, "", false);
+        ComputeProgram* pProgram = ctx.getProgram();
+        pProgram->addRuntimeDefine("SCALE");
+        pProgram->addRuntimeDefine("OFFSET");
+        EXPECT(pProgram->isRuntimeDefine("SCALE"));
+        EXPECT(pProgram->getDefines().find("SCALE") == pProgram->getDefines().end());
+        EXPECT_EQ(pProgram->getRuntimeDefine("SCALE"), 2);
+        EXPECT_EQ(pProgram->getRuntimeDefine("OFFSET"), 0);
+
+        ctx.createVars();
+        ctx.allocateStructuredBuffer("result", kElementCount);
+
+        // Every combination would have been a separate program version with regular defines
+        const int32_t scales[] = { 2, 3, -1 };
+        const int32_t offsets[] = { 0, 5 };
+        for (int32_t scale : scales)
+        {
+            for (int32_t offset : offsets)
+            {
+                EXPECT(!pProgram->addDefine("SCALE", std::to_string(scale)));
+                EXPECT(!pProgram->addDefine("OFFSET", std::to_string(offset)));
+                ctx.runProgram(kElementCount);
+
+                const int32_t* result = ctx.mapBuffer<const int32_t>("result");
+                for (int32_t i = 0; i < (int32_t)kElementCount; i++)
+                {
+                    EXPECT_EQ(result[i], i * scale + offset) << "i = " << i << ", scale = " << scale << ", offset = " << offset;
+                }
+                ctx.unmapBuffer("result");
+            }
+        }
+
+        // Regular defines still create new versions
+        pProgram->addDefine("NEGATE");
+        ctx.runProgram(kElementCount);
+        const int32_t* result = ctx.mapBuffer<const int32_t>("result");
+        EXPECT_EQ(result[1], -(1 * -1 + 5));
+        ctx.unmapBuffer("result");
+
+        size_t compiles = countCompiles(Program::getCompileRecords());
+        Program::RuntimeDefineStats stats = Program::getRuntimeDefineStats();
+        Program::setCompileRecording(false);
+
+        EXPECT_EQ(compiles, (size_t)2);
+        EXPECT_EQ(stats.valueUpdates, 7ull);
+        EXPECT_EQ(stats.compilesAvoided, 5ull);
+    }
+
+    CPU_TEST(ShaderCacheCorruptEntry)
+    {
+        const std::string prevDirectory = ShaderCache::getDirectory();
+        ShaderCache::setDirectory(getExecutableDirectory() + "/ShaderCacheTests");
+        ShaderCache::clear();
+
+        const std::string key = ShaderCache::createKey("ShaderCacheCorruptEntry");
+        ShaderCache::Entry entry;
+        entry.reflection = { 1, 2, 3, 4 };
+        ShaderCache::store(key, entry);
+
+        ShaderCache::Entry loaded;
+        EXPECT(ShaderCache::load(key, loaded));
+        EXPECT(loaded.reflection == entry.reflection);
+
+        // Patch the dependency count, which follows the magic and version, to a huge value. The load must fail instead of allocating the dependencies
+        const std::string path = ShaderCache::getDirectory() + "/" + key + ".bin";
+        {
+            std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+            f.seekp(2 * sizeof(uint32_t));
+            uint32_t depCount = 0x7fffffff;
+            f.write((const char*)&depCount, sizeof(depCount));
+        }
+        EXPECT(!ShaderCache::load(key, loaded));
+
+        // Same for the reflection size, which follows the dependency count and the stage mask
+        ShaderCache::store(key, entry);
+        {
+            std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+            f.seekp(4 * sizeof(uint32_t));
+            uint64_t reflectionSize = 1ull << 40;
+            f.write((const char*)&reflectionSize, sizeof(reflectionSize));
+        }
+        EXPECT(!ShaderCache::load(key, loaded));
+
+        ShaderCache::clear();
+        ShaderCache::setDirectory(prevDirectory);
+    }
+}
@@ -59,4 +59,26 @@ namespace Falcor
         EXPECT_EQ(w, h);
         EXPECT_EQ(w, 1 << (mipCount - 1));
     }
+
+    GPU_TEST(EnvProbeStreamingOptions)
+    {
+        // HDR env-maps are streamed to half floats by default
+        EnvProbe::SharedPtr pEnvProbe = EnvProbe::create(ctx.getRenderContext(), kLightProbeFile);
+        EXPECT_NE(pEnvProbe, nullptr);
+        if (pEnvProbe == nullptr) return;
+        EXPECT(pEnvProbe->getEnvMap()->getFormat() == ResourceFormat::RGBA16Float);
+        uint32_t fullWidth = pEnvProbe->getEnvMap()->getWidth();
+
+        // Downsampled while loading
+        StreamingImageLoader::Options options;
+        options.format = ResourceFormat::RGB9E5Float;
+        options.maxWidth = 64;
+        pEnvProbe = EnvProbe::create(ctx.getRenderContext(), kLightProbeFile, options);
+        EXPECT_NE(pEnvProbe, nullptr);
+        if (pEnvProbe == nullptr) return;
+        const Texture::SharedPtr& pEnvMap = pEnvProbe->getEnvMap();
+        EXPECT(pEnvMap->getFormat() == ResourceFormat::RGB9E5Float);
+        EXPECT(pEnvMap->getWidth() <= 64);
+        EXPECT_EQ(pEnvMap->getWidth(), div_round_up(fullWidth, div_round_up(fullWidth, 64u)));
+    }
 }
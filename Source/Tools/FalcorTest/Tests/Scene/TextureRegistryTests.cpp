@@ -0,0 +1,97 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/TextureRegistry.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        std::string writeImage(uint8_t value)
+        {
+            std::vector<uint8_t> texels(8 * 8 * 4, value);
+            std::string filename = getTempFilename() + ".png";
+            Bitmap::saveImage(filename, 8, 8, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, texels.data());
+            return filename;
+        }
+    }
+
+    CPU_TEST(TextureRegistryHash)
+    {
+        // Reference values of xxHash64 with seed 0
+        const char* kText = "Nobody inspects the spammish repetition";
+        EXPECT_EQ(TextureRegistry::hash("", 0), 0xef46db3751d8e999ull);
+        EXPECT_EQ(TextureRegistry::hash("abc", 3), 0x44bc2cf5ad770999ull);
+        EXPECT_EQ(TextureRegistry::hash(kText, strlen(kText)), 0xfbcea83c8a378bf1ull);
+    }
+
+    GPU_TEST(TextureRegistryDedup)
+    {
+        TextureRegistry::clear();
+
+        // Two copies of the same image under different names, and a different image
+        std::string fileA = writeImage(10);
+        std::string fileB = writeImage(10);
+        std::string fileC = writeImage(20);
+
+        Texture::SharedPtr pA = TextureRegistry::load(fileA, false, false);
+        Texture::SharedPtr pB = TextureRegistry::load(fileB, false, false);
+        Texture::SharedPtr pC = TextureRegistry::load(fileC, false, false);
+        Texture::SharedPtr pSrgb = TextureRegistry::load(fileA, false, true);
+        EXPECT(pA != nullptr && pC != nullptr && pSrgb != nullptr);
+        EXPECT(pA == pB);
+        EXPECT(pA != pC);
+        EXPECT(pA != pSrgb);
+
+        TextureRegistry::Stats stats = TextureRegistry::getStats();
+        EXPECT_EQ(stats.loadCount, 4ull);
+        EXPECT_EQ(stats.hitCount, 1ull);
+        EXPECT_EQ(stats.textureCount, 3u);
+        EXPECT_EQ(stats.bytesSaved, 8ull * 8 * 4);
+
+        // The shared texture is owned by pA and pB
+        auto textures = TextureRegistry::getTextures();
+        auto shared = std::find_if(textures.begin(), textures.end(), [](const TextureRegistry::TextureInfo& t) { return t.loadCount == 2; });
+        EXPECT(shared != textures.end());
+        if (shared != textures.end()) EXPECT_EQ(shared->refCount, 2u);
+
+        // A report of some of the textures only lists those
+        std::string report = TextureRegistry::getReport({ pC });
+        EXPECT_EQ(report.compare(0, 12, "Textures: 1,"), 0) << report;
+
+        // Entries are dropped with the last reference to their texture, which changes the generation
+        uint64_t generation = TextureRegistry::getGeneration();
+        EXPECT_EQ(TextureRegistry::getGeneration(), generation);
+        pA = pB = nullptr;
+        EXPECT_NE(TextureRegistry::getGeneration(), generation);
+        EXPECT_EQ(TextureRegistry::getStats().textureCount, 2u);
+
+        TextureRegistry::clear();
+        for (const auto& f : { fileA, fileB, fileC }) std::remove(f.c_str());
+    }
+}
@@ -0,0 +1,324 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/VirtualTexturing/VirtualTextureCache.h"
+#include "Scene/VirtualTexturing/TiledTextureFile.h"
+#include "Scene/SceneBuilder.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t T = kVirtualTextureTileSize;
+
+        uint32_t slotOf(uint32_t entry) { return entry & 0xffff; }
+        uint32_t mipOf(uint32_t entry) { return (entry >> 16) & 0xf; }
+    }
+
+    CPU_TEST(VirtualTileIdPacking)
+    {
+        VirtualTileId tile = { kVirtualTextureMaxTextures - 1, kVirtualTextureMaxMips - 1, 511, 300 };
+        EXPECT(VirtualTileId::unpack(tile.pack()) == tile);
+        EXPECT_NE(tile.pack(), kVirtualTextureInvalidTile);
+
+        VirtualTextureCache cache;
+        uint32_t pool = cache.addPool(16);
+        EXPECT_EQ(cache.addTexture(T * kVirtualTextureMaxTilesPerAxis + 1, T, 1, pool), VirtualTextureCache::kInvalidTexture);
+
+        // 300x200 has 3x2 tiles, then 2x1, then single tiles. The parent of the last column of mip 0 is clamped to mip 1
+        uint32_t id = cache.addTexture(300, 200, 9, pool);
+        EXPECT(cache.getTileCount(id, 0) == uvec2(3, 2));
+        EXPECT(cache.getTileCount(id, 1) == uvec2(2, 1));
+        EXPECT(cache.getTileCount(id, 2) == uvec2(1, 1));
+        EXPECT(cache.getParent({ id, 0, 2, 1 }) == VirtualTileId({ id, 1, 1, 0 }));
+        EXPECT(cache.getParent({ id, 1, 1, 0 }) == VirtualTileId({ id, 2, 0, 0 }));
+        EXPECT_EQ(cache.getPageTableSize(id), 6u + 2u + 7u);
+    }
+
+    CPU_TEST(VirtualTextureFeedback)
+    {
+        VirtualTextureCache cache;
+        uint32_t pool = cache.addPool(16);
+        uint32_t id = cache.addTexture(4 * T, 4 * T, 3, pool);     // 4x4, 2x2 and 1x1 tiles
+        cache.allocateTile({ id, 2, 0, 0 }, true);
+
+        std::vector<uint32_t> feedback =
+        {
+            VirtualTileId{ id, 0, 0, 0 }.pack(),
+            VirtualTileId{ id, 0, 0, 0 }.pack(),
+            VirtualTileId{ id, 0, 1, 0 }.pack(),
+            VirtualTileId{ id, 0, 3, 3 }.pack(),
+            VirtualTileId{ id, 2, 0, 0 }.pack(),
+            VirtualTileId{ id, 0, 4, 0 }.pack(),    // Out of range
+            VirtualTileId{ id + 1, 0, 0, 0 }.pack(),// Unknown texture
+            kVirtualTextureInvalidTile,
+        };
+
+        // The parents get the samples of their children. The resident root is not requested
+        auto requests = cache.processFeedback(feedback.data(), feedback.size());
+        EXPECT_EQ(requests.size(), 5u);
+        if (requests.size() != 5) return;
+        EXPECT(requests[0].tile == VirtualTileId({ id, 1, 0, 0 }));
+        EXPECT_EQ(requests[0].priority, 3u);
+        EXPECT(requests[1].tile == VirtualTileId({ id, 0, 0, 0 }));
+        EXPECT_EQ(requests[1].priority, 2u);
+        EXPECT(requests[2].tile == VirtualTileId({ id, 1, 1, 1 }));
+        EXPECT_EQ(requests[2].priority, 1u);
+        EXPECT_EQ(requests[3].tile.mip, 0u);
+        EXPECT_EQ(requests[4].tile.mip, 0u);
+
+        auto stats = cache.getStats();
+        EXPECT_EQ(stats.feedbackSamples, 5ull);
+        EXPECT_EQ(stats.requestedTiles, 6u);
+        EXPECT_EQ(stats.missingTiles, 5u);
+    }
+
+    CPU_TEST(VirtualTextureEviction)
+    {
+        VirtualTextureCache cache;
+        uint32_t pool = cache.addPool(3);
+        uint32_t id = cache.addTexture(4 * T, 4 * T, 3, pool);
+
+        VirtualTileId root = { id, 2, 0, 0 };
+        VirtualTileId a = { id, 0, 0, 0 }, b = { id, 0, 1, 0 }, c = { id, 0, 2, 0 };
+        EXPECT_NE(cache.allocateTile(root, true), VirtualTextureCache::kInvalidSlot);
+        EXPECT_NE(cache.allocateTile(a), VirtualTextureCache::kInvalidSlot);
+        EXPECT_NE(cache.allocateTile(b), VirtualTextureCache::kInvalidSlot);
+
+        // Everything is pinned or used in the current frame
+        EXPECT_EQ(cache.allocateTile(c), VirtualTextureCache::kInvalidSlot);
+
+        // The next frame only uses a, so b is evicted
+        cache.beginFrame();
+        uint32_t used = a.pack();
+        cache.processFeedback(&used, 1);
+        uint32_t slotB = cache.getSlot(b);
+        EXPECT_EQ(cache.allocateTile(c), slotB);
+        EXPECT(cache.isResident(a));
+        EXPECT(!cache.isResident(b));
+        EXPECT(cache.isResident(root));
+        EXPECT_EQ(cache.getStats().evictions, 1ull);
+        EXPECT_EQ(cache.getStats().residentTiles, 3u);
+    }
+
+    CPU_TEST(VirtualTexturePageTable)
+    {
+        VirtualTextureCache cache;
+        uint32_t pool = cache.addPool(8);
+        uint32_t id = cache.addTexture(4 * T, 4 * T, 3, pool);
+        uint32_t other = cache.addTexture(T, T, 1, pool);
+        EXPECT_EQ(cache.getPageTableOffset(other), 16u + 4u + 1u);
+
+        uint32_t rootSlot = cache.allocateTile({ id, 2, 0, 0 }, true);
+        uint32_t midSlot = cache.allocateTile({ id, 1, 1, 0 });
+        uint32_t leafSlot = cache.allocateTile({ id, 0, 2, 1 });
+        auto updated = cache.updatePageTable();
+        EXPECT_EQ(updated.size(), 2u);
+
+        // Resident tiles point to themselves, the others to their closest resident ancestor
+        uint32_t entry = cache.getPageTableEntry({ id, 0, 2, 1 });
+        EXPECT(entry & kVirtualTexturePageValid);
+        EXPECT_EQ(slotOf(entry), leafSlot);
+        EXPECT_EQ(mipOf(entry), 0u);
+        entry = cache.getPageTableEntry({ id, 0, 3, 0 });
+        EXPECT_EQ(slotOf(entry), midSlot);
+        EXPECT_EQ(mipOf(entry), 1u);
+        entry = cache.getPageTableEntry({ id, 0, 0, 3 });
+        EXPECT_EQ(slotOf(entry), rootSlot);
+        EXPECT_EQ(mipOf(entry), 2u);
+        EXPECT_EQ(cache.getPageTableEntry({ other, 0, 0, 0 }), 0u);
+
+        // Nothing changed
+        EXPECT_EQ(cache.updatePageTable().size(), 0u);
+    }
+
+    CPU_TEST(TiledTextureFileRoundTrip)
+    {
+        // Each texel holds its mip, x and y
+        MipGenerator::MipChain chain;
+        chain.width = 300;
+        chain.height = 130;
+        chain.mipCount = 3;
+        chain.format = ResourceFormat::RGBA8Uint;
+        for (uint32_t mip = 0; mip < chain.mipCount; mip++)
+        {
+            uint32_t w = chain.width >> mip, h = chain.height >> mip;
+            for (uint32_t y = 0; y < h; y++)
+            {
+                for (uint32_t x = 0; x < w; x++)
+                {
+                    uint8_t texel[4] = { (uint8_t)mip, (uint8_t)x, (uint8_t)(x >> 8), (uint8_t)y };
+                    chain.data.insert(chain.data.end(), texel, texel + 4);
+                }
+            }
+        }
+
+        std::string filename = getTempFilename();
+        EXPECT(TiledTextureFile::write(filename, chain));
+        {
+            auto pFile = TiledTextureFile::open(filename);
+            EXPECT(pFile != nullptr);
+            if (!pFile) return;
+            EXPECT_EQ(pFile->getWidth(), chain.width);
+            EXPECT_EQ(pFile->getMipCount(), chain.mipCount);
+            EXPECT_EQ(pFile->getTileDataSize(), TiledTextureFile::getStoredTileSize() * TiledTextureFile::getStoredTileSize() * 4);
+
+            auto check = [&](uint32_t mip, uint32_t tx, uint32_t ty, uint32_t x, uint32_t y, uint32_t expectedX, uint32_t expectedY)
+            {
+                const uint8_t* p = pFile->getTileData(mip, tx, ty) + (y * TiledTextureFile::getStoredTileSize() + x) * 4;
+                EXPECT_EQ(p[0], mip);
+                EXPECT_EQ(p[1] | (p[2] << 8), expectedX) << "mip " << mip << ", tile " << tx << "," << ty << ", texel " << x << "," << y;
+                EXPECT_EQ(p[3], expectedY) << "mip " << mip << ", tile " << tx << "," << ty << ", texel " << x << "," << y;
+            };
+
+            const uint32_t B = kVirtualTextureTileBorder;
+            check(0, 0, 0, B, B, 0, 0);                 // First texel
+            check(0, 0, 0, 0, 0, 300 - B, 130 - B);     // Border wraps around
+            check(0, 1, 0, B + 5, B + 2, T + 5, 2);
+            check(0, 2, 1, B + 43, B + 1, 299, 129);    // Last texel
+            check(0, 2, 1, B + 44, B + 2, 0, 0);        // Past the edge wraps around
+            check(2, 0, 0, B + 74, B + 31, 74, 31);
+        }
+        std::remove(filename.c_str());
+
+        chain.format = ResourceFormat::BC1Unorm;
+        EXPECT(!TiledTextureFile::write(filename, chain));
+    }
+
+    GPU_TEST(VirtualTextureScene)
+    {
+        // A 4x4 grid of tiles, each with a constant color
+        const uint32_t kTiles = 4, kSize = kTiles * T;
+        auto tileColor = [](uint32_t tx, uint32_t ty) { return uvec4(tx * 64 + 32, ty * 64 + 32, 200, 255); };
+        std::vector<uint8_t> texels(kSize * kSize * 4);
+        for (uint32_t y = 0; y < kSize; y++)
+        {
+            for (uint32_t x = 0; x < kSize; x++)
+            {
+                uvec4 c = tileColor(x / T, y / T);
+                for (uint32_t i = 0; i < 4; i++) texels[(y * kSize + x) * 4 + i] = (uint8_t)c[i];
+            }
+        }
+        std::string filename = getTempFilename() + ".png";
+        Bitmap::saveImage(filename, kSize, kSize, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, texels.data());
+
+        // A quad with the image as its base color
+        const vec3 positions[] = { vec3(-1, -1, 0), vec3(1, -1, 0), vec3(-1, 1, 0), vec3(1, 1, 0) };
+        const vec3 normals[] = { vec3(0, 0, 1), vec3(0, 0, 1), vec3(0, 0, 1), vec3(0, 0, 1) };
+        const vec2 texCrd[] = { vec2(0, 0), vec2(1, 0), vec2(0, 1), vec2(1, 1) };
+        const uint32_t indices[] = { 0, 1, 2, 2, 1, 3 };
+
+        VirtualTextureSystem::Desc desc;
+        desc.poolSizeInBytes = 16 * 1024 * 1024;
+        SceneBuilder::SharedPtr pBuilder = SceneBuilder::create(SceneBuilder::Flags::UseVirtualTextures);
+        pBuilder->setVirtualTextureDesc(desc);
+
+        // Registered like the importers do, no full texture is created
+        ResourceFormat format = ResourceFormat::Unknown;
+        uint32_t id = pBuilder->addVirtualTexture(filename, true, format);
+        EXPECT_NE(id, VirtualTextureCache::kInvalidTexture);
+        EXPECT(isSrgbFormat(format) && doesFormatHasAlpha(format));
+        ResourceFormat sharedFormat;
+        EXPECT_EQ(pBuilder->addVirtualTexture(filename, true, sharedFormat), id);
+
+        Material::SharedPtr pMaterial = Material::create("Quad");
+        pMaterial->setVirtualTexture(Material::VirtualTextureSlot::BaseColor, id, format);
+        EXPECT_EQ(pMaterial->getAlphaMode(), (uint32_t)AlphaModeMask);
+
+        SceneBuilder::Mesh mesh;
+        mesh.name = "Quad";
+        mesh.vertexCount = 4;
+        mesh.indexCount = 6;
+        mesh.pIndices = indices;
+        mesh.pPositions = positions;
+        mesh.pNormals = normals;
+        mesh.pTexCrd = texCrd;
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = pMaterial;
+
+        SceneBuilder::Node node;
+        node.name = "Quad";
+        node.transform = mat4(1.f);
+        node.localToBindPose = mat4(1.f);
+        pBuilder->addMeshInstance(pBuilder->addNode(node), pBuilder->addMesh(mesh));
+        Scene::SharedPtr pScene = pBuilder->getScene();
+        EXPECT(pScene != nullptr);
+        if (!pScene) return;
+
+        // The scene owns the system the texture was registered with
+        const VirtualTextureSystem::SharedPtr& pVirtualTextures = pScene->getVirtualTextureSystem();
+        EXPECT_EQ(pScene->getMaterial(0)->getVirtualTexture(Material::VirtualTextureSlot::BaseColor), id);
+        EXPECT(pScene->getMaterial(0)->getBaseColorTexture() == nullptr);
+        EXPECT_EQ(pVirtualTextures->getStats().textureCount, 1u);
+
+        // Feedback of the previous frame is read back by the next update, so the tiles become resident after a few frames
+        const uint32_t kFrameSize = 64;
+        RenderContext* pContext = ctx.getRenderContext();
+        pVirtualTextures->setFrameSize(kFrameSize, kFrameSize);
+        pScene->update(pContext, 0);
+        ctx.createProgram("Tests/Scene/VirtualTextureTests.cs.slang", "main", pScene->getSceneDefines());
+        ctx.allocateStructuredBuffer("result", kFrameSize * kFrameSize);
+        ctx["TestCB"]["frameDim"] = uvec2(kFrameSize);
+        for (uint32_t frame = 0; frame < 8; frame++)
+        {
+            ctx.vars().setParameterBlock("gScene", pScene->getParameterBlock());
+            ctx.runProgram(kFrameSize, kFrameSize, 1);
+            pScene->endFrame(pContext);
+            pContext->flush(true);
+            pScene->update(pContext, 0);
+        }
+
+        for (uint32_t ty = 0; ty < kTiles; ty++)
+        {
+            for (uint32_t tx = 0; tx < kTiles; tx++)
+            {
+                EXPECT(pVirtualTextures->getCache().isResident({ id, 0, tx, ty })) << "tile " << tx << "," << ty;
+            }
+        }
+
+        // Sample the resident tiles
+        ctx.vars().setParameterBlock("gScene", pScene->getParameterBlock());
+        ctx.runProgram(kFrameSize, kFrameSize, 1);
+        const vec4* pResult = ctx.mapBuffer<const vec4>("result");
+        for (uint32_t y = 0; y < kFrameSize; y++)
+        {
+            for (uint32_t x = 0; x < kFrameSize; x++)
+            {
+                uint32_t tx = x * kTiles / kFrameSize, ty = y * kTiles / kFrameSize;
+                vec4 expected = vec4(tileColor(tx, ty)) / 255.f;
+                vec4 result = pResult[y * kFrameSize + x];
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    EXPECT(std::abs(result[i] - expected[i]) < 1e-3f) << "pixel " << x << "," << y << ", channel " << i << ": " << result[i] << " expected " << expected[i];
+                }
+            }
+        }
+        ctx.unmapBuffer("result");
+        std::remove(filename.c_str());
+    }
+}
@@ -0,0 +1,214 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ExrWriter.h"
+#include "Utils/Image/StreamingImageLoader.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kWidth = 45;
+        const uint32_t kHeight = 37;    // Not a multiple of the 16 scanlines of a ZIP chunk
+
+        /** Texel (x, y) of the color layer. Constant runs of 8 texels give the compressors something to work with. All values are exact in half precision
+        */
+        float4 getColor(uint32_t x, uint32_t y)
+        {
+            return float4((float)(x / 8), 0.25f * y, 7.f, 1.f);
+        }
+
+        struct TestLayers
+        {
+            std::vector<float4> color;
+            std::vector<uint8_t> albedo;
+            std::vector<float> depth;
+            std::vector<ExrWriter::Layer> layers;
+        };
+
+        void createLayers(TestLayers& t)
+        {
+            for (uint32_t y = 0; y < kHeight; y++)
+            {
+                for (uint32_t x = 0; x < kWidth; x++)
+                {
+                    t.color.push_back(getColor(x, y));
+                    for (uint32_t c = 0; c < 4; c++) t.albedo.push_back((uint8_t)(x + c));
+                    t.depth.push_back(1.f / (1 + x + y * kWidth));
+                }
+            }
+
+            t.layers.push_back({ "", ResourceFormat::RGBA32Float, t.color.data(), ExrWriter::Precision::Half });
+            t.layers.push_back({ "albedo", ResourceFormat::RGBA8Unorm, t.albedo.data(), ExrWriter::Precision::Half });
+            t.layers.push_back({ "depth", ResourceFormat::D32Float, t.depth.data(), ExrWriter::Precision::Float });
+        }
+
+        template<typename T>
+        T read(const std::vector<uint8_t>& data, size_t& offset)
+        {
+            T value = {};
+            if (offset + sizeof(T) <= data.size()) std::memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        std::string readString(const std::vector<uint8_t>& data, size_t& offset)
+        {
+            std::string s;
+            while (offset < data.size() && data[offset] != 0) s += (char)data[offset++];
+            offset++;
+            return s;
+        }
+    }
+
+    CPU_TEST(ExrWriterRoundTrip)
+    {
+        TestLayers t;
+        createLayers(t);
+
+        EXPECT(ExrWriter::isFormatSupported(ResourceFormat::BGRA8UnormSrgb));
+        EXPECT(ExrWriter::isFormatSupported(ResourceFormat::R11G11B10Float));
+        EXPECT(!ExrWriter::isFormatSupported(ResourceFormat::BC1Unorm));
+        EXPECT(!ExrWriter::isFormatSupported(ResourceFormat::D24UnormS8));
+        EXPECT(ExrWriter::getDefaultPrecision(ResourceFormat::RGBA16Float) == ExrWriter::Precision::Half);
+        EXPECT(ExrWriter::getDefaultPrecision(ResourceFormat::R16Unorm) == ExrWriter::Precision::Float);
+        EXPECT(ExrWriter::getDefaultPrecision(ResourceFormat::D32Float) == ExrWriter::Precision::Float);
+
+        // The loader reads the unnamed layer and skips the channels of the others, which checks the layout of the scanlines
+        for (auto compression : { ExrWriter::Compression::None, ExrWriter::Compression::RLE, ExrWriter::Compression::ZIPS, ExrWriter::Compression::ZIP })
+        {
+            std::string path = getTempFilename() + ".exr";
+            ExrWriter::Options options;
+            options.compression = compression;
+            EXPECT(ExrWriter::write(path, kWidth, kHeight, t.layers, options)) << to_string(compression);
+
+            StreamingImageLoader::Options loadOptions;
+            loadOptions.format = ResourceFormat::RGBA32Float;
+            StreamingImageLoader::Image image;
+            EXPECT(StreamingImageLoader::load(path, loadOptions, image)) << to_string(compression);
+            EXPECT_EQ(image.width, kWidth);
+            EXPECT_EQ(image.height, kHeight);
+            if (image.data.size() == kWidth * kHeight * sizeof(float4))
+            {
+                const float4* pTexels = (const float4*)image.data.data();
+                for (uint32_t y = 0; y < kHeight; y++)
+                {
+                    for (uint32_t x = 0; x < kWidth; x++)
+                    {
+                        EXPECT(pTexels[y * kWidth + x] == getColor(x, y)) << to_string(compression) << ", x = " << x << ", y = " << y;
+                    }
+                }
+            }
+            std::remove(path.c_str());
+        }
+
+        // Layer names must be unique
+        std::vector<ExrWriter::Layer> duplicates = { t.layers[1], t.layers[1] };
+        std::string path = getTempFilename() + ".exr";
+        EXPECT(!ExrWriter::write(path, kWidth, kHeight, duplicates, ExrWriter::Options()));
+        std::remove(path.c_str());
+    }
+
+    CPU_TEST(ExrWriterMultiPart)
+    {
+        TestLayers t;
+        createLayers(t);
+
+        std::string path = getTempFilename() + ".exr";
+        ExrWriter::Options options;
+        options.multiPart = true;
+        EXPECT(ExrWriter::write(path, kWidth, kHeight, t.layers, options));
+
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+        std::remove(path.c_str());
+
+        size_t offset = 0;
+        EXPECT_EQ(read<int32_t>(data, offset), 20000630);
+        EXPECT_EQ(read<int32_t>(data, offset), 0x1002);
+
+        // One header per layer, each with its name and chunk count, terminated by an empty header
+        const uint32_t chunkCount = (kHeight + 15) / 16;
+        std::vector<std::string> partNames;
+        while (offset < data.size() && data[offset] != 0)
+        {
+            std::string name;
+            int32_t chunks = 0;
+            std::string attribute;
+            while (!(attribute = readString(data, offset)).empty())
+            {
+                std::string type = readString(data, offset);
+                int32_t size = read<int32_t>(data, offset);
+                size_t valueOffset = offset;
+                if (attribute == "name") name = std::string((const char*)data.data() + offset, size);
+                if (attribute == "chunkCount") chunks = read<int32_t>(data, valueOffset);
+                offset += size;
+            }
+            partNames.push_back(name);
+            EXPECT_EQ(chunks, (int32_t)chunkCount) << name;
+        }
+        offset++;
+        EXPECT(partNames == std::vector<std::string>({ "rgba", "albedo", "depth" }));
+
+        // The offset tables list the chunks of each part in order. Chunks start with the part number and the first scanline
+        for (uint32_t part = 0; part < 3; part++)
+        {
+            for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                size_t chunkOffset = (size_t)read<uint64_t>(data, offset);
+                EXPECT_EQ(read<int32_t>(data, chunkOffset), (int32_t)part);
+                EXPECT_EQ(read<int32_t>(data, chunkOffset), (int32_t)(chunk * 16));
+                int32_t size = read<int32_t>(data, chunkOffset);
+                EXPECT(size > 0 && chunkOffset + size <= data.size());
+            }
+        }
+    }
+
+    CPU_TEST(ExrWriterScriptRoundTrip)
+    {
+        // Mogwai's frame capture saves the compression with Scripting::makeMemberFunc(). Run the saved line against a stand-in for the capture object
+        for (auto compression : { ExrWriter::Compression::None, ExrWriter::Compression::RLE, ExrWriter::Compression::ZIPS, ExrWriter::Compression::ZIP })
+        {
+            std::string script = "class FrameCapture:\n    def exrCompression(self, c): self.compression = c\nfc = FrameCapture()\n";
+            script += Scripting::makeMemberFunc("fc", "exrCompression", compression);
+            script += "compression = fc.compression\n";
+            try
+            {
+                Scripting::Context context;
+                Scripting::runScript(script, context);
+                EXPECT(context.getObject<ExrWriter::Compression>("compression") == compression) << to_string(compression);
+            }
+            catch (const std::exception& e)
+            {
+                EXPECT(false) << script << e.what();
+            }
+        }
+    }
+}
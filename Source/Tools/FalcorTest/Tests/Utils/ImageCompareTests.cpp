@@ -0,0 +1,142 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ImageCompare.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kWidth = 61;
+        const uint32_t kHeight = 47;    // Not a multiple of the rows processed per job
+
+        /** 8x8 checkerboard with different values in each channel
+        */
+        ImageCompare::Image createImage(bool srgb)
+        {
+            ImageCompare::Image image;
+            image.width = kWidth;
+            image.height = kHeight;
+            image.srgb = srgb;
+            for (uint32_t y = 0; y < kHeight; y++)
+            {
+                for (uint32_t x = 0; x < kWidth; x++)
+                {
+                    float v = ((x / 8 + y / 8) % 2) ? 0.8f : 0.2f;
+                    image.data.push_back(float4(v, 0.5f * v, 1.f - v, 1.f));
+                }
+            }
+            return image;
+        }
+    }
+
+    CPU_TEST(ImageCompareIdentical)
+    {
+        ImageCompare::Image image = createImage(true);
+        ImageCompare::Result result;
+        std::vector<float> errorMap;
+        EXPECT(ImageCompare::compare(image, image, ImageCompare::Options(), result, &errorMap));
+
+        EXPECT_EQ(result.mse, 0.0);
+        EXPECT_EQ(result.relMse, 0.0);
+        EXPECT(std::isinf(result.psnr));
+        EXPECT(std::abs(result.ssim - 1.0) < 1e-5) << "SSIM " << result.ssim;
+        EXPECT_EQ(result.flip, 0.0);
+        EXPECT_EQ(errorMap.size(), (size_t)kWidth * kHeight);
+        for (float v : errorMap) EXPECT_EQ(v, 0.f);
+    }
+
+    CPU_TEST(ImageCompareMetrics)
+    {
+        ImageCompare::Image reference = createImage(false);
+        ImageCompare::Image offset = reference;
+        for (auto& v : offset.data) v += float4(0.1f, 0.1f, 0.1f, 0.f);
+
+        // A constant offset of 0.1 gives an MSE of 0.01, so 20dB. The relative MSE is the mean of 0.01 / (ref^2 + 0.01)
+        double relMse = 0;
+        for (const auto& v : reference.data)
+        {
+            for (uint32_t c = 0; c < 3; c++) relMse += 0.01 / (v[c] * v[c] + 0.01) / 3;
+        }
+        relMse /= reference.data.size();
+
+        ImageCompare::Options options;
+        options.errorMapMetric = ImageCompare::Metric::RMSE;
+        ImageCompare::Result result;
+        std::vector<float> errorMap;
+        EXPECT(ImageCompare::compare(offset, reference, options, result, &errorMap));
+        EXPECT(std::abs(result.mse - 0.01) < 1e-6) << "MSE " << result.mse;
+        EXPECT(std::abs(result.rmse - 0.1) < 1e-5) << "RMSE " << result.rmse;
+        EXPECT(std::abs(result.psnr - 20.0) < 1e-3) << "PSNR " << result.psnr;
+        EXPECT(std::abs(result.relMse - relMse) < 1e-6) << "RelMSE " << result.relMse << ", expected " << relMse;
+        EXPECT(result.ssim < 1.0 && result.ssim > 0.9) << "SSIM " << result.ssim;
+        for (float v : errorMap) EXPECT(std::abs(v - 0.1f) < 1e-5f) << "RMSE error map " << v;
+
+        // Noise is less similar than the offset, and FLIP stays in [0, 1]
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> u(-0.15f, 0.15f);
+        ImageCompare::Image noisy = reference;
+        for (auto& v : noisy.data) v += float4(u(rng), u(rng), u(rng), 0.f);
+
+        ImageCompare::Result noisyResult;
+        options.errorMapMetric = ImageCompare::Metric::FLIP;
+        EXPECT(ImageCompare::compare(noisy, reference, options, noisyResult, &errorMap));
+        EXPECT(noisyResult.ssim < result.ssim) << "SSIM " << noisyResult.ssim;
+        EXPECT(noisyResult.flip > 0.0 && noisyResult.flip < 1.0) << "FLIP " << noisyResult.flip;
+        for (float v : errorMap) EXPECT(v >= 0.f && v <= 1.f) << "FLIP error map " << v;
+
+        // Mismatching sizes are rejected
+        ImageCompare::Image small = reference;
+        small.height--;
+        small.data.resize(small.width * small.height);
+        EXPECT(!ImageCompare::compare(small, reference, options, result));
+    }
+
+    CPU_TEST(ImageCompareThresholds)
+    {
+        using Metric = ImageCompare::Metric;
+        EXPECT(ImageCompare::passes(Metric::FLIP, 0.01, 0.05));
+        EXPECT(!ImageCompare::passes(Metric::MSE, 0.1, 0.01));
+        EXPECT(ImageCompare::passes(Metric::PSNR, 30.0, 25.0));
+        EXPECT(!ImageCompare::passes(Metric::SSIM, 0.9, 0.95));
+
+        Metric metric = Metric::MSE;
+        EXPECT(ImageCompare::parseMetric("relmse", metric));
+        EXPECT(metric == Metric::RelMSE);
+        EXPECT(!ImageCompare::parseMetric("l1", metric));
+
+        // Same results as colormapJet() in ColorMap.slang
+        float3 c = ImageCompare::applyColorMap(ImageCompare::ColorMap::Jet, 0.f);
+        EXPECT(c == float3(0.f, 0.f, 0.5f));
+        c = ImageCompare::applyColorMap(ImageCompare::ColorMap::Jet, 0.5f);
+        EXPECT(c == float3(0.5f, 1.f, 0.5f));
+        c = ImageCompare::applyColorMap(ImageCompare::ColorMap::Jet, 2.f);
+        EXPECT(c == float3(0.5f, 0.f, 0.f));
+    }
+}
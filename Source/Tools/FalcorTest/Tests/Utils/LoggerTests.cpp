@@ -0,0 +1,126 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        class CollectingSink : public Logger::Sink
+        {
+        public:
+            void write(const Logger::Message& msg) override
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mMessages.push_back(msg.text);
+            }
+
+            size_t count(const std::string& prefix)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                return std::count_if(mMessages.begin(), mMessages.end(), [&prefix](const std::string& s) { return s.compare(0, prefix.size(), prefix) == 0; });
+            }
+
+        private:
+            std::mutex mMutex;
+            std::vector<std::string> mMessages;
+        };
+
+        /** Logs an error the first time it writes a message, like a sink reporting a failed write
+        */
+        class ErrorReportingSink : public Logger::Sink
+        {
+        public:
+            void write(const Logger::Message& msg) override
+            {
+                if (msg.text == "LoggerTest trigger" && !mReported.exchange(true)) logError("LoggerTest sink error", Logger::MsgBox::Nope);
+            }
+
+        private:
+            std::atomic<bool> mReported = false;
+        };
+    }
+
+    CPU_TEST(LoggerConcurrentMessages)
+    {
+        const uint32_t kThreadCount = 4;
+        const uint32_t kMessagesPerThread = 256;
+
+        auto pSink = std::make_shared<CollectingSink>();
+        Logger::addSink(pSink);
+        uint64_t droppedBefore = Logger::getDroppedMessageCount();
+
+        std::vector<Threading::Task> tasks;
+        for (uint32_t t = 0; t < kThreadCount; t++)
+        {
+            tasks.push_back(Threading::dispatchTask([t, kMessagesPerThread]()
+            {
+                for (uint32_t i = 0; i < kMessagesPerThread; i++) logWarning("LoggerTest " + std::to_string(t) + " " + std::to_string(i), Logger::MsgBox::Nope);
+            }));
+        }
+        for (auto& t : tasks) t.finish();
+        Logger::flush();
+        Logger::removeSink(pSink);
+
+        size_t dropped = (size_t)(Logger::getDroppedMessageCount() - droppedBefore);
+        EXPECT_EQ(pSink->count("LoggerTest ") + dropped, kThreadCount * kMessagesPerThread);
+    }
+
+    CPU_TEST(LoggerRateLimit)
+    {
+        const uint32_t kRateLimit = 5;
+        auto pSink = std::make_shared<CollectingSink>();
+        Logger::addSink(pSink);
+        // A window much longer than the test, so that all the messages fall into the same window however slowly they are written
+        Logger::setRateLimit(kRateLimit, std::chrono::hours(1));
+
+        for (uint32_t i = 0; i < 100; i++) logWarning("LoggerTest repeated message", Logger::MsgBox::Nope);
+        Logger::flush();
+        Logger::removeSink(pSink);
+        Logger::setRateLimit(0);
+
+        EXPECT_EQ(pSink->count("LoggerTest repeated message"), kRateLimit);
+    }
+
+    CPU_TEST(LoggerErrorFromSink)
+    {
+        // The error is logged on the logger thread. This used to deadlock, since the thread waited for itself to write the error
+        auto pErrorSink = std::make_shared<ErrorReportingSink>();
+        auto pSink = std::make_shared<CollectingSink>();
+        Logger::addSink(pErrorSink);
+        Logger::addSink(pSink);
+
+        logWarning("LoggerTest trigger", Logger::MsgBox::Nope);
+        Logger::flush();
+        Logger::flush(); // The sink's error is written in the batch after the trigger
+        Logger::removeSink(pErrorSink);
+        Logger::removeSink(pSink);
+
+        EXPECT_EQ(pSink->count("LoggerTest sink error"), 1u);
+    }
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/MipGenerator.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const MipGenerator::Filter kFilters[] = { MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser, MipGenerator::Filter::Lanczos };
+
+        size_t getLevelOffset(uint32_t width, uint32_t height, uint32_t texelSize, uint32_t mip)
+        {
+            size_t offset = 0;
+            for (uint32_t m = 0; m < mip; m++) offset += (size_t)std::max(width >> m, 1u) * std::max(height >> m, 1u) * texelSize;
+            return offset;
+        }
+    }
+
+    CPU_TEST(MipGeneratorChainLayout)
+    {
+        EXPECT_EQ(MipGenerator::getMipCount(1, 1), 1u);
+        EXPECT_EQ(MipGenerator::getMipCount(37, 20), 6u);
+        EXPECT_EQ(MipGenerator::getMipCount(1024, 512), 11u);
+        EXPECT(!MipGenerator::isFormatSupported(ResourceFormat::BC1Unorm));
+
+        const uint32_t width = 37, height = 20;
+        std::vector<float> data(width * height * 4, 0.25f);
+        for (auto filter : kFilters)
+        {
+            MipGenerator::Options options;
+            options.filter = filter;
+            MipGenerator::MipChain chain;
+            EXPECT(MipGenerator::generate(data.data(), width, height, ResourceFormat::RGBA32Float, options, chain));
+            EXPECT_EQ(chain.mipCount, 6u);
+            EXPECT_EQ(chain.data.size(), getLevelOffset(width, height, 16, chain.mipCount));
+
+            // The filters are normalized, a constant image stays constant
+            const float* pData = (const float*)chain.data.data();
+            for (size_t i = 0; i < chain.data.size() / sizeof(float); i++) EXPECT_LE(std::abs(pData[i] - 0.25f), 1e-5f) << "i = " << i;
+        }
+    }
+
+    CPU_TEST(MipGeneratorSrgb)
+    {
+        // A black and white checkerboard averages to 0.5 in linear space, which is 188 in sRGB
+        const uint32_t size = 16;
+        std::vector<uint8_t> data(size * size * 4);
+        for (uint32_t i = 0; i < size * size; i++)
+        {
+            uint8_t v = ((i % size + i / size) & 1) ? 255 : 0;
+            data[i * 4 + 0] = data[i * 4 + 1] = data[i * 4 + 2] = v;
+            data[i * 4 + 3] = 255;
+        }
+
+        MipGenerator::Options options;
+        options.filter = MipGenerator::Filter::Box;
+        MipGenerator::MipChain chain;
+        EXPECT(MipGenerator::generate(data.data(), size, size, ResourceFormat::RGBA8UnormSrgb, options, chain));
+        const uint8_t* pMip1 = chain.data.data() + getLevelOffset(size, size, 4, 1);
+        for (uint32_t i = 0; i < (size / 2) * (size / 2); i++)
+        {
+            EXPECT_EQ((uint32_t)pMip1[i * 4], 188u) << "i = " << i;
+            EXPECT_EQ((uint32_t)pMip1[i * 4 + 3], 255u) << "i = " << i;
+        }
+    }
+
+    CPU_TEST(MipGeneratorNormalMap)
+    {
+        // Alternating +X and -X normals average to a zero-length vector in x. Renormalization brings the result back to unit length
+        const uint32_t size = 8;
+        std::vector<uint8_t> data(size * size * 4);
+        for (uint32_t i = 0; i < size * size; i++)
+        {
+            bool odd = (i & 1) != 0;
+            data[i * 4 + 0] = odd ? 255 : 0;
+            data[i * 4 + 1] = 128;
+            data[i * 4 + 2] = odd ? 128 : 255;
+            data[i * 4 + 3] = 255;
+        }
+
+        MipGenerator::Options options;
+        options.filter = MipGenerator::Filter::Box;
+        options.normalMap = true;
+        MipGenerator::MipChain chain;
+        EXPECT(MipGenerator::generate(data.data(), size, size, ResourceFormat::RGBA8Unorm, options, chain));
+        for (uint32_t m = 1; m < chain.mipCount; m++)
+        {
+            const uint8_t* pTexel = chain.data.data() + getLevelOffset(size, size, 4, m);
+            float3 n = float3(pTexel[0], pTexel[1], pTexel[2]) / 255.f * 2.f - 1.f;
+            EXPECT_LE(std::abs(glm::length(n) - 1.f), 0.02f) << "mip = " << m;
+        }
+    }
+
+    CPU_TEST(MipGeneratorAlphaCoverage)
+    {
+        // One texel column in four is opaque. Without correction the coverage drops to zero once the columns are averaged
+        const uint32_t size = 64;
+        std::vector<uint8_t> rgba(size * size * 4, 255);
+        for (uint32_t i = 0; i < size * size; i++) rgba[i * 4 + 3] = (i % 4 == 0) ? 255 : 0;
+
+        for (auto filter : kFilters)
+        {
+            MipGenerator::Options options;
+            options.filter = filter;
+            options.alphaCoverageRef = 0.5f;
+            MipGenerator::MipChain chain;
+            EXPECT(MipGenerator::generate(rgba.data(), size, size, ResourceFormat::RGBA8Unorm, options, chain));
+
+            for (uint32_t m = 1; m < 4; m++)
+            {
+                uint32_t mipSize = size >> m;
+                const uint8_t* pLevel = chain.data.data() + getLevelOffset(size, size, 4, m);
+                uint32_t covered = 0;
+                for (uint32_t i = 0; i < mipSize * mipSize; i++) covered += pLevel[i * 4 + 3] > 127 ? 1 : 0;
+                float coverage = float(covered) / (mipSize * mipSize);
+                EXPECT_GE(coverage, 0.25f) << "mip = " << m;
+            }
+        }
+    }
+}
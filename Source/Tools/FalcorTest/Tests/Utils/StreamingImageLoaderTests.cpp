@@ -0,0 +1,317 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/StreamingImageLoader.h"
+#include "glm/gtc/packing.hpp"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Write a Radiance file. Texel (x, y) has the RGBE value (x + 1, y + 1, 100, 136), which decodes to (x + 1, y + 1, 100)
+        */
+        void writeHdr(const std::string& path, uint32_t width, uint32_t height, bool rle)
+        {
+            std::ofstream f(path, std::ios::binary);
+            f << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << height << " +X " << width << "\n";
+            for (uint32_t y = 0; y < height; y++)
+            {
+                std::vector<uint8_t> texels(width * 4);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    texels[x * 4 + 0] = (uint8_t)(x + 1);
+                    texels[x * 4 + 1] = (uint8_t)(y + 1);
+                    texels[x * 4 + 2] = 100;
+                    texels[x * 4 + 3] = 128 + 8;
+                }
+
+                if (!rle)
+                {
+                    f.write((const char*)texels.data(), texels.size());
+                    continue;
+                }
+
+                // Literal runs for R and G, repeated runs for B and E
+                f.put(2);
+                f.put(2);
+                f.put((char)(width >> 8));
+                f.put((char)(width & 0xff));
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    for (uint32_t x = 0; x < width;)
+                    {
+                        if (c < 2)
+                        {
+                            uint32_t count = std::min(128u, width - x);
+                            f.put((char)count);
+                            for (uint32_t i = 0; i < count; i++) f.put((char)texels[(x + i) * 4 + c]);
+                            x += count;
+                        }
+                        else
+                        {
+                            uint32_t count = std::min(127u, width - x);
+                            f.put((char)(128 + count));
+                            f.put((char)texels[x * 4 + c]);
+                            x += count;
+                        }
+                    }
+                }
+            }
+        }
+
+        void writeExrAttribute(std::ofstream& f, const std::string& name, const std::string& type, const void* pValue, int32_t size)
+        {
+            f.write(name.c_str(), name.size() + 1);
+            f.write(type.c_str(), type.size() + 1);
+            f.write((const char*)&size, sizeof(size));
+            f.write((const char*)pValue, size);
+        }
+
+        /** Write an uncompressed half-float OpenEXR file with B, G and R channels. Texel (x, y) is (0.5 * x, 0.25 * y, 7)
+        */
+        void writeExr(const std::string& path, uint32_t width, uint32_t height)
+        {
+            std::ofstream f(path, std::ios::binary);
+            uint32_t header[2] = { 20000630, 2 };
+            f.write((const char*)header, sizeof(header));
+
+            std::string channels;
+            for (const char* name : { "B", "G", "R" })
+            {
+                int32_t desc[4] = { 1, 0, 1, 1 };   // Half, not linear, no subsampling
+                channels += name;
+                channels += '\0';
+                channels.append((const char*)desc, sizeof(desc));
+            }
+            channels += '\0';
+            writeExrAttribute(f, "channels", "chlist", channels.data(), (int32_t)channels.size());
+            uint8_t compression = 0;
+            writeExrAttribute(f, "compression", "compression", &compression, 1);
+            int32_t window[4] = { 0, 0, (int32_t)width - 1, (int32_t)height - 1 };
+            writeExrAttribute(f, "dataWindow", "box2i", window, sizeof(window));
+            writeExrAttribute(f, "displayWindow", "box2i", window, sizeof(window));
+            f.put(0);
+
+            uint64_t offset = (uint64_t)f.tellp() + height * sizeof(uint64_t);
+            uint32_t chunkSize = 8 + width * 3 * 2;
+            for (uint32_t y = 0; y < height; y++, offset += chunkSize) f.write((const char*)&offset, sizeof(offset));
+
+            for (int32_t y = 0; y < (int32_t)height; y++)
+            {
+                int32_t size = width * 3 * 2;
+                f.write((const char*)&y, sizeof(y));
+                f.write((const char*)&size, sizeof(size));
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        float value = c == 0 ? 7.f : (c == 1 ? 0.25f * y : 0.5f * x);
+                        uint16_t h = glm::packHalf1x16(value);
+                        f.write((const char*)&h, sizeof(h));
+                    }
+                }
+            }
+        }
+
+        /** 16x3 half-float OpenEXR files with B, G and R channels, one RLE and one ZIP compressed. Texel (x, y) is (0.5 * x, y, 7).
+            They were built with zlib and a separate implementation of the OpenEXR byte interleave and predictor, not with ExrWriter.
+        */
+        const uint8_t kRleExr[] =
+        {
+            0x76, 0x2f, 0x31, 0x01, 0x02, 0x00, 0x00, 0x00, 0x63, 0x68, 0x61, 0x6e, 0x6e, 0x65, 0x6c, 0x73, 0x00, 0x63, 0x68, 0x6c, 0x69, 0x73, 0x74, 0x00,
+            0x37, 0x00, 0x00, 0x00, 0x42, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x47, 0x00,
+            0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x52, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x63, 0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x63,
+            0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x64, 0x61, 0x74, 0x61, 0x57, 0x69, 0x6e, 0x64,
+            0x6f, 0x77, 0x00, 0x62, 0x6f, 0x78, 0x32, 0x69, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00,
+            0x00, 0x02, 0x00, 0x00, 0x00, 0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x57, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x00, 0x62, 0x6f, 0x78, 0x32, 0x69,
+            0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x6c, 0x69, 0x6e,
+            0x65, 0x4f, 0x72, 0x64, 0x65, 0x72, 0x00, 0x6c, 0x69, 0x6e, 0x65, 0x4f, 0x72, 0x64, 0x65, 0x72, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x70, 0x69,
+            0x78, 0x65, 0x6c, 0x41, 0x73, 0x70, 0x65, 0x63, 0x74, 0x52, 0x61, 0x74, 0x69, 0x6f, 0x00, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x00, 0x04, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x3f, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x57, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x43, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x00,
+            0x76, 0x32, 0x66, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x57, 0x69,
+            0x6e, 0x64, 0x6f, 0x77, 0x57, 0x69, 0x64, 0x74, 0x68, 0x00, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3f,
+            0x00, 0x51, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9c, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x1d, 0x00, 0x00, 0x00, 0xff, 0x00, 0x27, 0x80, 0x06, 0x00, 0xff, 0x47, 0x0e, 0x80, 0xff, 0x39, 0x0f, 0x80, 0xfc,
+            0xb8, 0x84, 0x82, 0x82, 0x03, 0x81, 0xf9, 0x80, 0x81, 0x80, 0x81, 0x80, 0x81, 0x80, 0x01, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0xff, 0x00,
+            0x27, 0x80, 0x06, 0x00, 0xff, 0x47, 0x0e, 0x80, 0xff, 0x75, 0x0e, 0x80, 0xfb, 0x44, 0xb8, 0x84, 0x82, 0x82, 0x03, 0x81, 0xf9, 0x80, 0x81, 0x80,
+            0x81, 0x80, 0x81, 0x80, 0x02, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0xff, 0x00, 0x27, 0x80, 0x06, 0x00, 0xff, 0x47, 0x0e, 0x80, 0xff, 0x79,
+            0x0e, 0x80, 0xfb, 0x40, 0xb8, 0x84, 0x82, 0x82, 0x03, 0x81, 0xf9, 0x80, 0x81, 0x80, 0x81, 0x80, 0x81, 0x80,
+        };
+        const uint8_t kZipExr[] =
+        {
+            0x76, 0x2f, 0x31, 0x01, 0x02, 0x00, 0x00, 0x00, 0x63, 0x68, 0x61, 0x6e, 0x6e, 0x65, 0x6c, 0x73, 0x00, 0x63, 0x68, 0x6c, 0x69, 0x73, 0x74, 0x00,
+            0x37, 0x00, 0x00, 0x00, 0x42, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x47, 0x00,
+            0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x52, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x63, 0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x63,
+            0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x64, 0x61, 0x74, 0x61, 0x57, 0x69, 0x6e, 0x64,
+            0x6f, 0x77, 0x00, 0x62, 0x6f, 0x78, 0x32, 0x69, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00,
+            0x00, 0x02, 0x00, 0x00, 0x00, 0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x57, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x00, 0x62, 0x6f, 0x78, 0x32, 0x69,
+            0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x6c, 0x69, 0x6e,
+            0x65, 0x4f, 0x72, 0x64, 0x65, 0x72, 0x00, 0x6c, 0x69, 0x6e, 0x65, 0x4f, 0x72, 0x64, 0x65, 0x72, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x70, 0x69,
+            0x78, 0x65, 0x6c, 0x41, 0x73, 0x70, 0x65, 0x63, 0x74, 0x52, 0x61, 0x74, 0x69, 0x6f, 0x00, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x00, 0x04, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x80, 0x3f, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x57, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x43, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x00,
+            0x76, 0x32, 0x66, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x57, 0x69,
+            0x6e, 0x64, 0x6f, 0x77, 0x57, 0x69, 0x64, 0x74, 0x68, 0x00, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3f,
+            0x00, 0x41, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2e, 0x00, 0x00, 0x00, 0x78, 0xda, 0x63, 0x68, 0x20, 0x12, 0x30,
+            0x40, 0x01, 0x8d, 0xd5, 0xbb, 0xa3, 0x09, 0x5b, 0xa2, 0xab, 0xdb, 0xd1, 0xd2, 0xd4, 0xd4, 0x08, 0x04, 0x0d, 0x10, 0x88, 0x0e, 0x4a, 0xd1, 0xf8,
+            0x2e, 0x04, 0xd4, 0x57, 0xa2, 0xf1, 0x1d, 0xd0, 0xd4, 0x03, 0x00, 0xb4, 0x05, 0x83, 0xc8,
+        };
+
+        std::string writeFile(const std::string& extension, const uint8_t* pData, size_t size)
+        {
+            std::string path = getTempFilename() + extension;
+            std::ofstream(path, std::ios::binary).write((const char*)pData, size);
+            return path;
+        }
+    }
+
+    CPU_TEST(StreamingImageLoaderHdr)
+    {
+        const uint32_t width = 20, height = 5;
+        for (bool rle : { false, true })
+        {
+            std::string path = getTempFilename() + ".hdr";
+            writeHdr(path, width, height, rle);
+            EXPECT(StreamingImageLoader::canStream(path));
+
+            StreamingImageLoader::Options options;
+            StreamingImageLoader::Image image;
+            EXPECT(StreamingImageLoader::load(path, options, image));
+            EXPECT_EQ(image.format, ResourceFormat::RGBA32Float);
+            EXPECT_EQ(image.width, width);
+            EXPECT_EQ(image.height, height);
+            const float4* pTexels = (const float4*)image.data.data();
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float4 t = pTexels[y * width + x];
+                    EXPECT(t == float4(x + 1, y + 1, 100, 1)) << "rle = " << rle << ", x = " << x << ", y = " << y;
+                }
+            }
+
+            // A factor of 3 fits the width. The last column and row average the texels they cover
+            options.maxWidth = 8;
+            EXPECT(StreamingImageLoader::load(path, options, image));
+            EXPECT_EQ(image.width, 7u);
+            EXPECT_EQ(image.height, 2u);
+            pTexels = (const float4*)image.data.data();
+            EXPECT_EQ(pTexels[0].x, 2.f);
+            EXPECT_EQ(pTexels[0].y, 2.f);
+            EXPECT_EQ(pTexels[6].x, 19.5f);
+            EXPECT_EQ(pTexels[7].y, 4.5f);
+
+            std::remove(path.c_str());
+        }
+    }
+
+    CPU_TEST(StreamingImageLoaderExr)
+    {
+        const uint32_t width = 33, height = 17;
+        std::string path = getTempFilename() + ".exr";
+        writeExr(path, width, height);
+
+        // Half-float sources default to a half-float texture
+        StreamingImageLoader::Options options;
+        StreamingImageLoader::Image image;
+        EXPECT(StreamingImageLoader::load(path, options, image));
+        EXPECT_EQ(image.format, ResourceFormat::RGBA16Float);
+        EXPECT_EQ(image.width, width);
+        EXPECT_EQ(image.height, height);
+
+        const uint16_t* pTexels = (const uint16_t*)image.data.data();
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint16_t* t = pTexels + (y * width + x) * 4;
+                float4 v(glm::unpackHalf1x16(t[0]), glm::unpackHalf1x16(t[1]), glm::unpackHalf1x16(t[2]), glm::unpackHalf1x16(t[3]));
+                EXPECT(v == float4(0.5f * x, 0.25f * y, 7.f, 1.f)) << "x = " << x << ", y = " << y;
+            }
+        }
+
+        options.format = ResourceFormat::RGBA32Float;
+        EXPECT(StreamingImageLoader::load(path, options, image));
+        EXPECT_EQ(((const float4*)image.data.data())[width + 2].x, 1.f);
+
+        std::remove(path.c_str());
+    }
+
+    CPU_TEST(StreamingImageLoaderCompressedExr)
+    {
+        for (const auto& file : { std::make_pair(kRleExr, sizeof(kRleExr)), std::make_pair(kZipExr, sizeof(kZipExr)) })
+        {
+            std::string path = writeFile(".exr", file.first, file.second);
+            StreamingImageLoader::Options options;
+            options.format = ResourceFormat::RGBA32Float;
+            StreamingImageLoader::Image image;
+            EXPECT(StreamingImageLoader::load(path, options, image));
+            EXPECT_EQ(image.width, 16u);
+            EXPECT_EQ(image.height, 3u);
+            const float4* pTexels = (const float4*)image.data.data();
+            for (uint32_t y = 0; y < image.height; y++)
+            {
+                for (uint32_t x = 0; x < image.width; x++)
+                {
+                    float4 t = pTexels[y * image.width + x];
+                    EXPECT(t == float4(0.5f * x, y, 7.f, 1.f)) << "file size = " << file.second << ", x = " << x << ", y = " << y;
+                }
+            }
+            std::remove(path.c_str());
+        }
+    }
+
+    CPU_TEST(StreamingImageLoaderCorruptHeader)
+    {
+        StreamingImageLoader::Image image;
+
+        // The dimensions are far larger than the file
+        const char kHdr[] = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y 4000000 +X 4000000\n";
+        std::string path = writeFile(".hdr", (const uint8_t*)kHdr, sizeof(kHdr) - 1);
+        EXPECT(!StreamingImageLoader::load(path, {}, image));
+        std::remove(path.c_str());
+
+        std::vector<uint8_t> exr(kZipExr, kZipExr + sizeof(kZipExr));
+        std::string name = "dataWindow";
+        auto it = std::search(exr.begin(), exr.end(), name.begin(), name.end());
+        EXPECT(it != exr.end());
+        if (it == exr.end()) return;
+        // Skip the name, the type string and the size to get to xMax
+        size_t xMax = (it - exr.begin()) + name.size() + 1 + 6 + 4 + 8;
+        for (int32_t value : { 0x7fffff00, 0x1000000 })
+        {
+            std::memcpy(&exr[xMax], &value, sizeof(value));
+            path = writeFile(".exr", exr.data(), exr.size());
+            EXPECT(!StreamingImageLoader::canStream(path)) << "xMax = " << value;
+            EXPECT(!StreamingImageLoader::load(path, {}, image)) << "xMax = " << value;
+            std::remove(path.c_str());
+        }
+    }
+}
@@ -0,0 +1,138 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include <atomic>
+
+namespace Falcor
+{
+    CPU_TEST(ThreadingTasks)
+    {
+        const uint32_t kTaskCount = 256;
+        std::atomic<uint32_t> counter = 0;
+        std::vector<Threading::Task> tasks;
+
+        for (uint32_t i = 0; i < kTaskCount; i++)
+        {
+            tasks.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+        }
+
+        for (auto& t : tasks) t.finish();
+        for (auto& t : tasks) EXPECT(!t.isRunning());
+        EXPECT_EQ(counter.load(), kTaskCount);
+    }
+
+    CPU_TEST(ThreadingTaskException)
+    {
+        // The exception is rethrown by every finish() call, and the task is still marked as done
+        auto task = Threading::dispatchTask([]() { throw std::runtime_error("task failed"); });
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            bool caught = false;
+            try { task.finish(); }
+            catch (const std::runtime_error&) { caught = true; }
+            EXPECT(caught);
+        }
+        EXPECT(!task.isRunning());
+
+        bool caught = false;
+        try { Threading::parallelFor(64, [](uint32_t i) { if (i == 33) throw std::runtime_error("index failed"); }); }
+        catch (const std::runtime_error&) { caught = true; }
+        EXPECT(caught);
+    }
+
+    CPU_TEST(ThreadingNestedFinish)
+    {
+        // Every pool thread waits on a task it dispatched itself. This deadlocks unless finish() runs queued work on the waiting thread
+        const uint32_t kTaskCount = 4 * Threading::getThreadSlotCount();
+        std::atomic<uint32_t> counter = 0;
+        std::vector<Threading::Task> tasks;
+        for (uint32_t i = 0; i < kTaskCount; i++)
+        {
+            tasks.push_back(Threading::dispatchTask([&counter]()
+            {
+                Threading::dispatchTask([&counter]() { counter++; }).finish();
+            }));
+        }
+        for (auto& t : tasks) t.finish();
+        EXPECT_EQ(counter.load(), kTaskCount);
+    }
+
+    CPU_TEST(ThreadingParallelFor)
+    {
+        // Every index must be visited exactly once, including the partial last batch, and the nested call runs from pool threads
+        const uint32_t kCount = 1000;
+        for (uint32_t grainSize : { 1u, 7u, 16u, 2000u })
+        {
+            std::vector<std::atomic<uint32_t>> visits(kCount);
+            Threading::parallelFor(kCount, [&](uint32_t i)
+            {
+                visits[i]++;
+                if (i == 0) Threading::parallelFor(4, [](uint32_t) {});
+            }, grainSize);
+            for (uint32_t i = 0; i < kCount; i++) EXPECT_EQ(visits[i].load(), 1u) << "grainSize = " << grainSize << ", i = " << i;
+        }
+
+        bool called = false;
+        Threading::parallelFor(0, [&](uint32_t) { called = true; });
+        EXPECT(!called);
+    }
+
+    GPU_TEST(UploadHeapConcurrentAllocations)
+    {
+        const uint32_t kThreadCount = 8;
+        const uint32_t kAllocationsPerThread = 512;
+        const size_t kAllocationSize = 256;
+
+        // Allocate from multiple threads concurrently and make sure no two allocations overlap
+        auto pHeap = gpDevice->getUploadHeap();
+        std::vector<std::vector<GpuMemoryHeap::Allocation>> allocations(kThreadCount);
+        std::vector<Threading::Task> tasks;
+        for (uint32_t t = 0; t < kThreadCount; t++)
+        {
+            auto& threadAllocations = allocations[t];
+            tasks.push_back(Threading::dispatchTask([&threadAllocations, pHeap, kAllocationsPerThread, kAllocationSize]()
+            {
+                for (uint32_t i = 0; i < kAllocationsPerThread; i++) threadAllocations.push_back(pHeap->allocate(kAllocationSize, 256));
+            }));
+        }
+        for (auto& t : tasks) t.finish();
+
+        std::vector<uint8_t*> ptrs;
+        for (const auto& a : allocations)
+        {
+            for (const auto& data : a) ptrs.push_back(data.pData);
+        }
+        std::sort(ptrs.begin(), ptrs.end());
+        for (size_t i = 1; i < ptrs.size(); i++) EXPECT_GE((size_t)(ptrs[i] - ptrs[i - 1]), kAllocationSize);
+
+        for (auto& a : allocations)
+        {
+            for (auto& data : a) pHeap->release(data);
+        }
+    }
+}
@@ -0,0 +1,235 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Video/VideoFrameConverter.h"
+#include "glm/gtc/packing.hpp"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct Planes
+        {
+            std::vector<uint8_t> data[3];
+            uint8_t* pData[3] = {};
+            int32_t pitch[3] = {};
+
+            Planes(uint32_t width, uint32_t height, uint32_t bytesPerSample)
+            {
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    pitch[i] = (int32_t)(width * bytesPerSample);
+                    data[i].resize(pitch[i] * height);
+                    pData[i] = data[i].data();
+                }
+            }
+
+            uint32_t get(uint32_t plane, uint32_t x, uint32_t y, bool wide) const
+            {
+                const uint8_t* p = data[plane].data() + y * pitch[plane];
+                return wide ? ((const uint16_t*)p)[x] : p[x];
+            }
+        };
+
+        VideoFrameConverter::UniquePtr createConverter(uint32_t width, uint32_t height, ResourceFormat format, VideoFrameConverter::Layout layout, uint32_t bitDepth)
+        {
+            VideoFrameConverter::Desc desc;
+            desc.width = width;
+            desc.height = height;
+            desc.format = format;
+            desc.layout = layout;
+            desc.bitDepth = bitDepth;
+            return VideoFrameConverter::create(desc);
+        }
+    }
+
+    CPU_TEST(VideoFrameConverterYuv)
+    {
+        // White, black, red and blue, in BT.709 studio range
+        const uint8_t pixels[] = { 255, 255, 255, 255, 0, 0, 0, 255, 255, 0, 0, 255, 0, 0, 255, 255 };
+        const uint32_t expected8[4][3] = { { 235, 128, 128 }, { 16, 128, 128 }, { 63, 102, 240 }, { 32, 240, 118 } };
+
+        for (uint32_t bitDepth : { 8u, 10u })
+        {
+            const bool wide = bitDepth > 8;
+            auto pConverter = createConverter(4, 1, ResourceFormat::RGBA8UnormSrgb, VideoFrameConverter::Layout::YUV444, bitDepth);
+            EXPECT(pConverter != nullptr);
+            if (!pConverter) return;
+
+            Planes planes(4, 1, wide ? 2 : 1);
+            pConverter->convert(pixels, planes.pData, planes.pitch);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    // 10-bit codes are the 8-bit codes times 4, give or take the rounding
+                    int32_t value = (int32_t)planes.get(c, x, 0, wide);
+                    int32_t expected = (int32_t)expected8[x][c] << (bitDepth - 8);
+                    EXPECT(std::abs(value - expected) <= (wide ? 2 : 0)) << "pixel " << x << ", plane " << c << ", " << bitDepth << " bits: " << value << ", expected " << expected;
+                }
+            }
+        }
+
+        // 10-bit white is exact
+        auto pConverter = createConverter(1, 1, ResourceFormat::RGBA8Unorm, VideoFrameConverter::Layout::YUV444, 10);
+        Planes planes(1, 1, 2);
+        pConverter->convert(pixels, planes.pData, planes.pitch);
+        EXPECT_EQ(planes.get(0, 0, 0, true), 940u);
+        EXPECT_EQ(planes.get(1, 0, 0, true), 512u);
+        EXPECT_EQ(planes.get(2, 0, 0, true), 512u);
+    }
+
+    CPU_TEST(VideoFrameConverterLossless)
+    {
+        // 8-bit GBR is lossless, and flipY reverses the rows. Odd sizes exercise the SIMD tails
+        const uint32_t width = 37;
+        const uint32_t height = 19;
+        std::vector<uint8_t> pixels(width * height * 4);
+        std::mt19937 rng(7);
+        for (auto& p : pixels) p = (uint8_t)rng();
+
+        VideoFrameConverter::Desc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.format = ResourceFormat::BGRA8UnormSrgb;
+        desc.layout = VideoFrameConverter::Layout::GBR;
+        desc.flipY = true;
+        auto pConverter = VideoFrameConverter::create(desc);
+
+        Planes planes(width, height, 1);
+        pConverter->convert(pixels.data(), planes.pData, planes.pitch);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t* p = pixels.data() + ((height - 1 - y) * width + x) * 4;
+                EXPECT_EQ(planes.get(0, x, y, false), p[1]) << "G at " << x << ", " << y;
+                EXPECT_EQ(planes.get(1, x, y, false), p[0]) << "B at " << x << ", " << y;
+                EXPECT_EQ(planes.get(2, x, y, false), p[2]) << "R at " << x << ", " << y;
+            }
+        }
+
+        desc.layout = VideoFrameConverter::Layout::BGR;
+        desc.bitDepth = 10;
+        EXPECT(VideoFrameConverter::create(desc) == nullptr);
+    }
+
+    CPU_TEST(VideoFrameConverterChroma)
+    {
+        // 3x3 frame of red and blue columns. 4:2:0 chroma is the average of each 2x2 block, the odd column and row are kept
+        const uint32_t size = 3;
+        std::vector<uint8_t> pixels;
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                bool red = (x % 2) == 0;
+                pixels.insert(pixels.end(), { (uint8_t)(red ? 255 : 0), 0, (uint8_t)(red ? 0 : 255), 255 });
+            }
+        }
+
+        auto pFull = createConverter(size, size, ResourceFormat::RGBA8Unorm, VideoFrameConverter::Layout::YUV444, 10);
+        auto pSubsampled = createConverter(size, size, ResourceFormat::RGBA8Unorm, VideoFrameConverter::Layout::YUV420, 10);
+        Planes full(size, size, 2);
+        Planes subsampled(size, size, 2);
+        pFull->convert(pixels.data(), full.pData, full.pitch);
+        pSubsampled->convert(pixels.data(), subsampled.pData, subsampled.pitch);
+
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++) EXPECT_EQ(subsampled.get(0, x, y, true), full.get(0, x, y, true)) << "Y at " << x << ", " << y;
+        }
+        for (uint32_t c = 1; c < 3; c++)
+        {
+            float average = 0.5f * (full.get(c, 0, 0, true) + full.get(c, 1, 0, true));
+            EXPECT(std::abs((float)subsampled.get(c, 0, 0, true) - average) <= 1.f) << "plane " << c;
+            EXPECT(std::abs((float)subsampled.get(c, 0, 1, true) - average) <= 1.f) << "plane " << c;
+            EXPECT_EQ(subsampled.get(c, 1, 0, true), full.get(c, 2, 0, true)) << "plane " << c;
+            EXPECT_EQ(subsampled.get(c, 1, 1, true), full.get(c, 2, 2, true)) << "plane " << c;
+        }
+    }
+
+    CPU_TEST(VideoFrameConverterTransfer)
+    {
+        // Linear 0.5, 2 and 1 in half floats, written as 10-bit GBR so the codes are the encoded values
+        std::vector<uint16_t> pixels;
+        for (float v : { 0.5f, 2.f, 1.f }) pixels.insert(pixels.end(), { glm::packHalf1x16(v), glm::packHalf1x16(v), glm::packHalf1x16(v), glm::packHalf1x16(1.f) });
+        auto code = [](float v) { return (uint32_t)std::round(v * 1023.f); };
+
+        VideoFrameConverter::Desc desc;
+        desc.width = 3;
+        desc.height = 1;
+        desc.format = ResourceFormat::RGBA16Float;
+        desc.layout = VideoFrameConverter::Layout::GBR;
+        desc.bitDepth = 10;
+        Planes planes(3, 1, 2);
+
+        desc.transfer = VideoFrameConverter::Transfer::sRGB;
+        VideoFrameConverter::create(desc)->convert(pixels.data(), planes.pData, planes.pitch);
+        EXPECT_EQ(planes.get(0, 0, 0, true), code(0.735357f));
+        EXPECT_EQ(planes.get(0, 1, 0, true), 1023u);
+
+        desc.transfer = VideoFrameConverter::Transfer::Reinhard;
+        VideoFrameConverter::create(desc)->convert(pixels.data(), planes.pData, planes.pitch);
+        EXPECT_EQ(planes.get(0, 2, 0, true), code(0.735357f));
+
+        // 1.0 maps to the peak of PQ at 10000 nits. Gray stays gray in BT.2020
+        desc.transfer = VideoFrameConverter::Transfer::PQ;
+        desc.pqWhiteNits = 10000.f;
+        VideoFrameConverter::create(desc)->convert(pixels.data(), planes.pData, planes.pitch);
+        EXPECT_EQ(planes.get(0, 2, 0, true), 1023u);
+        EXPECT_EQ(planes.get(2, 2, 0, true), 1023u);
+
+        // 100 nits is 0.5081 in PQ
+        desc.pqWhiteNits = 200.f;
+        VideoFrameConverter::create(desc)->convert(pixels.data(), planes.pData, planes.pitch);
+        for (uint32_t c = 0; c < 3; c++) EXPECT(std::abs((int32_t)planes.get(c, 0, 0, true) - (int32_t)code(0.5081f)) <= 1) << "plane " << c << ": " << planes.get(c, 0, 0, true);
+    }
+
+    CPU_TEST(VideoTransferScriptRoundTrip)
+    {
+        // Mogwai's video capture saves the transfer with Scripting::makeMemberFunc(). Run the saved line against a stand-in for the capture object
+        for (auto transfer : { VideoFrameConverter::Transfer::sRGB, VideoFrameConverter::Transfer::Reinhard, VideoFrameConverter::Transfer::PQ })
+        {
+            std::string script = "class VideoCapture:\n    def transfer(self, t): self.value = t\nvc = VideoCapture()\n";
+            script += Scripting::makeMemberFunc("vc", "transfer", transfer);
+            script += "transfer = vc.value\n";
+            try
+            {
+                Scripting::Context context;
+                Scripting::runScript(script, context);
+                EXPECT(context.getObject<VideoFrameConverter::Transfer>("transfer") == transfer) << to_string(transfer);
+            }
+            catch (const std::exception& e)
+            {
+                EXPECT(false) << script << e.what();
+            }
+        }
+    }
+}
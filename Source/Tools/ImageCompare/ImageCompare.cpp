@@ -0,0 +1,150 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Falcor.h"
+#include <cstdio>
+
+using namespace Falcor;
+
+namespace
+{
+    const char* kMetricSwitch = "metric";
+    const char* kThresholdSwitch = "threshold";
+    const char* kHeatmapSwitch = "heatmap";
+    const char* kColorMapSwitch = "colormap";
+    const char* kMaxSwitch = "max";
+    const char* kPpdSwitch = "ppd";
+
+    // Exit codes
+    const int kPass = 0;
+    const int kFail = 1;
+    const int kError = 2;
+
+    const char* kUsage = R"(usage: ImageCompare <test> <reference> [-metric <name>] [-threshold <value>] [-heatmap <file.png>] [-colormap jet|gray] [-max <value>] [-ppd <value>]
+    -metric     Metric to check and to show in the heatmap: mse, rmse, relmse, psnr, ssim or flip. Defaults to flip.
+    -threshold  The test fails if the metric is above this value, or below it for psnr and ssim. Without it the test always passes.
+    -heatmap    Write the per-pixel error as a color-mapped PNG, JPEG, TGA or BMP image.
+    -colormap   Color map of the heatmap. Defaults to jet.
+    -max        Error at the end of the color map. Defaults to 1 for flip and ssim, and to the largest error for the other metrics.
+    -ppd        FLIP viewing condition in pixels per degree. Defaults to 67, a 0.7m wide 4K display seen from 0.7m.
+Returns 0 if the test passes, 1 if it fails and 2 on errors.
+)";
+
+    int run(const ArgList& argList)
+    {
+        std::vector<ArgList::Arg> files = argList.getValues("");
+        if (argList.argExists("h") || argList.argExists("help") || files.size() != 2)
+        {
+            fprintf(stderr, "%s", kUsage);
+            return files.size() == 2 ? kPass : kError;
+        }
+
+        ImageCompare::Metric metric = ImageCompare::Metric::FLIP;
+        if (argList.argExists(kMetricSwitch) && !ImageCompare::parseMetric(argList[kMetricSwitch].asString(), metric))
+        {
+            fprintf(stderr, "Unknown metric `%s`\n", argList[kMetricSwitch].asString().c_str());
+            return kError;
+        }
+
+        ImageCompare::ColorMap colorMap = ImageCompare::ColorMap::Jet;
+        if (argList.argExists(kColorMapSwitch))
+        {
+            std::string name = argList[kColorMapSwitch].asString();
+            if (name == "gray") colorMap = ImageCompare::ColorMap::Gray;
+            else if (name != "jet")
+            {
+                fprintf(stderr, "Unknown color map `%s`\n", name.c_str());
+                return kError;
+            }
+        }
+
+        ImageCompare::Image test, reference;
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            std::string filename = files[i].asString();
+            if (!ImageCompare::loadImage(filename, i == 0 ? test : reference))
+            {
+                fprintf(stderr, "Can't load image `%s`\n", filename.c_str());
+                return kError;
+            }
+        }
+
+        ImageCompare::Options options;
+        options.errorMapMetric = metric;
+        if (argList.argExists(kPpdSwitch)) options.pixelsPerDegree = argList[kPpdSwitch].asFloat();
+        if (options.pixelsPerDegree <= 0.f)
+        {
+            fprintf(stderr, "The pixels per degree must be positive\n");
+            return kError;
+        }
+
+        ImageCompare::Result result;
+        std::vector<float> errorMap;
+        bool writeHeatmap = argList.argExists(kHeatmapSwitch);
+        if (!ImageCompare::compare(test, reference, options, result, writeHeatmap ? &errorMap : nullptr))
+        {
+            fprintf(stderr, "The images have different sizes (%ux%u and %ux%u)\n", test.width, test.height, reference.width, reference.height);
+            return kError;
+        }
+
+        fprintf(stdout, "MSE     %g\nRMSE    %g\nRelMSE  %g\nPSNR    %g dB\nSSIM    %g\nFLIP    %g\n", result.mse, result.rmse, result.relMse, result.psnr, result.ssim, result.flip);
+
+        if (writeHeatmap)
+        {
+            float maxValue = metric == ImageCompare::Metric::FLIP || metric == ImageCompare::Metric::SSIM ? 1.f : 0.f;
+            if (argList.argExists(kMaxSwitch)) maxValue = argList[kMaxSwitch].asFloat();
+            std::string filename = argList[kHeatmapSwitch].asString();
+            if (!ImageCompare::saveHeatmap(filename, test.width, test.height, errorMap, colorMap, maxValue))
+            {
+                fprintf(stderr, "Can't write heatmap `%s`\n", filename.c_str());
+                return kError;
+            }
+        }
+
+        if (!argList.argExists(kThresholdSwitch)) return kPass;
+
+        double threshold = argList[kThresholdSwitch].asFloat();
+        bool passed = ImageCompare::passes(metric, result.get(metric), threshold);
+        fprintf(stdout, "%s: %s %g, threshold %g\n", passed ? "PASS" : "FAIL", to_string(metric).c_str(), result.get(metric), threshold);
+        return passed ? kPass : kFail;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Logger::showBoxOnError(false);
+    Threading::start();
+
+    // Arguments before the first switch are the image files
+    ArgList argList;
+    argList.parseCommandLine(concatCommandLine(argc - 1, argv + 1));
+    int exitCode = run(argList);
+
+    Threading::shutdown();
+    Logger::shutdown();
+    return exitCode;
+}
@@ -0,0 +1,291 @@
+/***************************************************************************
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ShaderPrecompiler.h"
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+int ShaderPrecompiler::sExitCode = 0;
+
+namespace
+{
+    const char* kScriptSwitch = "script";
+    const char* kSceneSwitch = "scene";
+    const char* kFramesSwitch = "frames";
+    const char* kManifestSwitch = "manifest";
+    const char* kCacheDirSwitch = "cache_dir";
+
+    const std::string kDefaultScene = "Arcade/Arcade.fscene";
+    const uint32_t kDefaultFrameCount = 2;
+
+    // Programs with more permutations than this are flagged in the report
+    const size_t kPermutationWarningCount = 16;
+
+    const char* kUsage = R"(usage: ShaderPrecompiler -script <graph.py> [-scene <scene>] [-frames <count>] [-manifest <file.json>] [-cache_dir <dir>]
+    -script     A render graph script, as used by Mogwai. All the graphs it defines are compiled.
+    -scene      The scene to render. Scene-dependent defines are only known once a scene is bound. Defaults to Arcade/Arcade.fscene.
+    -frames     Number of frames to execute each graph for. Defaults to 2.
+    -manifest   Permutation manifest. Permutations listed in it are compiled in parallel. The file is updated with the permutations found in this run.
+    -cache_dir  Shader cache directory. Defaults to the directory used by the applications.
+)";
+
+    std::string getProgramName(const std::string& desc)
+    {
+        // Strip the header and flatten the description into a single line
+        const std::string header = "Program with Shaders:\n";
+        std::string name = desc.substr(desc.find(header) == 0 ? header.size() : 0);
+        while (name.size() && name.back() == '\n') name.pop_back();
+        return replaceSubstring(name, "\n", " ");
+    }
+
+    std::string getDefinesString(const Program::DefineList& defines)
+    {
+        std::string s;
+        for (const auto& d : defines)
+        {
+            if (s.size()) s += " ";
+            s += d.first;
+            if (d.second.size()) s += "=" + d.second;
+        }
+        return s.empty() ? "<no defines>" : s;
+    }
+}
+
+void ShaderPrecompiler::onLoad(RenderContext* pRenderContext)
+{
+    ShaderCache::setEnabled(true);
+    ArgList argList = gpFramework->getArgList();
+    if (argList.argExists(kCacheDirSwitch)) ShaderCache::setDirectory(argList[kCacheDirSwitch].asString());
+}
+
+void ShaderPrecompiler::onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+{
+    ArgList argList = gpFramework->getArgList();
+    if (argList.argExists("h") || argList.argExists("help") || !argList.argExists(kScriptSwitch))
+    {
+        fprintf(stderr, "%s", kUsage);
+        sExitCode = argList.argExists(kScriptSwitch) ? 0 : 1;
+        gpFramework->shutdown();
+        return;
+    }
+
+    std::string script = argList[kScriptSwitch].asString();
+    std::string sceneFile = argList.argExists(kSceneSwitch) ? argList[kSceneSwitch].asString() : kDefaultScene;
+    uint32_t frameCount = argList.argExists(kFramesSwitch) ? std::max(1u, argList[kFramesSwitch].asUint()) : kDefaultFrameCount;
+    std::string manifest = argList.argExists(kManifestSwitch) ? argList[kManifestSwitch].asString() : "";
+
+    // Permutations from the manifest start compiling as soon as their program is created
+    if (manifest.size() && doesFileExist(manifest) && loadManifest(manifest))
+    {
+        for (const auto& p : mManifest) Program::addPrewarmPermutations(p.first, p.second);
+    }
+
+    Program::setCompileRecording(true);
+    auto start = CpuTimer::getCurrentTimePoint();
+
+#ifdef FALCOR_D3D12
+    Scene::SharedPtr pScene = SceneBuilder::create(sceneFile)->getScene();
+#else
+    Scene::SharedPtr pScene = Scene::loadFromFile(sceneFile);
+#endif
+    if (!pScene)
+    {
+        fprintf(stderr, "Can't load scene `%s`\n", sceneFile.c_str());
+        sExitCode = 1;
+        gpFramework->shutdown();
+        return;
+    }
+
+    auto graphs = RenderGraphImporter::importAllGraphs(script);
+    if (graphs.empty())
+    {
+        fprintf(stderr, "No render graphs found in `%s`\n", script.c_str());
+        sExitCode = 1;
+        gpFramework->shutdown();
+        return;
+    }
+
+    for (const auto& pGraph : graphs)
+    {
+        fprintf(stdout, "Compiling graph `%s`\n", pGraph->getName().c_str());
+        pGraph->setScene(pScene);
+        pGraph->onResize(pTargetFbo.get());
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            pScene->update(pRenderContext, 0);
+            pGraph->execute(pRenderContext);
+        }
+    }
+    pRenderContext->flush(true);
+
+    double totalTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    auto records = Program::getCompileRecords();
+    Program::setCompileRecording(false);
+
+    printReport(records, totalTime);
+    if (manifest.size()) saveManifest(manifest, records);
+
+    if (std::any_of(records.begin(), records.end(), [](const Program::CompileRecord& r) { return !r.success; })) sExitCode = 1;
+    gpFramework->shutdown();
+}
+
+void ShaderPrecompiler::printReport(const std::vector<Program::CompileRecord>& records, double totalTime)
+{
+    std::vector<const Program::CompileRecord*> sorted;
+    std::map<std::string, size_t> permutationCount;
+    size_t cacheHits = 0;
+    for (const auto& r : records)
+    {
+        sorted.push_back(&r);
+        permutationCount[r.program]++;
+        if (r.cacheHit) cacheHits++;
+    }
+    std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->compileTime > b->compileTime; });
+
+    fprintf(stdout, "\n%10s  %-6s  %s\n", "Time (ms)", "Status", "Program / Defines");
+    for (const auto& r : sorted)
+    {
+        const char* status = r->success ? (r->cacheHit ? "cached" : "ok") : "FAILED";
+        fprintf(stdout, "%10.1f  %-6s  %s\n%20s%s\n", r->compileTime, status, getProgramName(r->program).c_str(), "", getDefinesString(r->defines).c_str());
+    }
+
+    fprintf(stdout, "\n%zu permutations of %zu programs, %zu from the shader cache. Total time %.1f s\n", records.size(), permutationCount.size(), cacheHits, totalTime * 1.0e-3);
+
+    for (const auto& p : permutationCount)
+    {
+        if (p.second > kPermutationWarningCount)
+        {
+            fprintf(stdout, "Warning: %zu permutations of %s\n", p.second, getProgramName(p.first).c_str());
+        }
+    }
+}
+
+bool ShaderPrecompiler::loadManifest(const std::string& filename)
+{
+    std::ifstream f(filename);
+    std::stringstream ss;
+    ss << f.rdbuf();
+
+    rapidjson::Document doc;
+    doc.Parse(ss.str().c_str());
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("programs") || !doc["programs"].IsArray())
+    {
+        logError("`" + filename + "` is not a valid permutation manifest", Logger::MsgBox::Nope);
+        return false;
+    }
+
+    // Validate everything before touching the manifest, so that a malformed file doesn't leave it half-loaded
+    auto invalid = [&filename](const std::string& msg)
+    {
+        logError("`" + filename + "` is not a valid permutation manifest. " + msg, Logger::MsgBox::Nope);
+        return false;
+    };
+
+    decltype(mManifest) manifest;
+    for (const auto& p : doc["programs"].GetArray())
+    {
+        if (!p.IsObject() || !p.HasMember("program") || !p["program"].IsString()) return invalid("Every program must be an object with a `program` string");
+        const std::string program = p["program"].GetString();
+        if (!p.HasMember("permutations") || !p["permutations"].IsArray()) return invalid("`" + program + "` has no `permutations` array");
+
+        auto& permutations = manifest[program];
+        for (const auto& d : p["permutations"].GetArray())
+        {
+            if (!d.IsObject()) return invalid("A permutation of `" + program + "` is not an object");
+            Program::DefineList defines;
+            for (const auto& m : d.GetObject())
+            {
+                if (!m.value.IsString()) return invalid("The value of define `" + std::string(m.name.GetString()) + "` in `" + program + "` is not a string");
+                defines.add(m.name.GetString(), m.value.GetString());
+            }
+            permutations.push_back(defines);
+        }
+    }
+
+    for (auto& p : manifest)
+    {
+        auto& permutations = mManifest[p.first];
+        permutations.insert(permutations.end(), p.second.begin(), p.second.end());
+    }
+    return true;
+}
+
+void ShaderPrecompiler::saveManifest(const std::string& filename, const std::vector<Program::CompileRecord>& records)
+{
+    // Merge the permutations found in this run into the existing ones
+    for (const auto& r : records)
+    {
+        if (!r.success) continue;
+        auto& permutations = mManifest[r.program];
+        if (std::find(permutations.begin(), permutations.end(), r.defines) == permutations.end()) permutations.push_back(r.defines);
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("programs");
+    writer.StartArray();
+    for (const auto& p : mManifest)
+    {
+        writer.StartObject();
+        writer.Key("program"); writer.String(p.first.c_str());
+        writer.Key("permutations");
+        writer.StartArray();
+        for (const auto& defines : p.second)
+        {
+            writer.StartObject();
+            for (const auto& d : defines)
+            {
+                writer.Key(d.first.c_str());
+                writer.String(d.second.c_str());
+            }
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    std::ofstream(filename) << buffer.GetString();
+    fprintf(stdout, "Permutation manifest written to `%s`\n", filename.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    ShaderPrecompiler::UniquePtr pRenderer = std::make_unique<ShaderPrecompiler>();
+    SampleConfig config;
+    config.windowDesc.title = "ShaderPrecompiler";
+    config.windowDesc.width = config.windowDesc.height = 256;
+    config.showMessageBoxOnError = false;
+    Sample::run(config, pRenderer, argc, argv);
+    return ShaderPrecompiler::sExitCode;
+}